@@ -0,0 +1,453 @@
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include "tinyc/parser/Parser.h"
+#include "tinyc/ast/FlatAST.h"
+#include "tinyc/ast/visitors/CompactJSONVisitor.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/ast/visitors/DumpVisitor.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace tinyc;
+
+namespace {
+
+	// Heap bytes in use by blocks allocated while heapTracking is set (see peakHeapBytes())
+	bool heapTracking = false;
+	std::size_t heapLive = 0;
+	std::size_t heapPeak = 0;
+
+	// Each block is preceded by its size and whether it is tracked, padded to its alignment
+	constexpr std::size_t HEAP_HEADER = alignof(std::max_align_t);
+	static_assert(HEAP_HEADER >= 2 * sizeof(std::size_t), "Heap header too small");
+
+	void *allocateBlock(std::size_t size, std::size_t alignment) {
+		std::size_t header = std::max(alignment, HEAP_HEADER);
+		std::size_t total = (size + 2 * header - 1) / header * header;
+#ifdef _WIN32
+		auto *raw = static_cast<char *>(_aligned_malloc(total, header));
+#else
+		auto *raw = static_cast<char *>(std::aligned_alloc(header, total));
+#endif
+		if (raw == nullptr) {
+			throw std::bad_alloc();
+		}
+
+		auto *info = reinterpret_cast<std::size_t *>(raw + header) - 2;
+		info[0] = size;
+		info[1] = heapTracking;
+		if (heapTracking) {
+			heapLive += size;
+			heapPeak = std::max(heapPeak, heapLive);
+		}
+		return raw + header;
+	}
+
+	void releaseBlock(void *pointer, std::size_t alignment) noexcept {
+		if (pointer == nullptr) {
+			return;
+		}
+		auto *info = static_cast<std::size_t *>(pointer) - 2;
+		if (info[1]) {
+			heapLive -= info[0];
+		}
+		char *raw = static_cast<char *>(pointer) - std::max(alignment, HEAP_HEADER);
+#ifdef _WIN32
+		_aligned_free(raw);
+#else
+		std::free(raw);
+#endif
+	}
+
+} // anonymous namespace
+
+// The array forms call these, and the arenas' upstream resource uses the aligned ones
+void *operator new(std::size_t size) {
+	return allocateBlock(size, HEAP_HEADER);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	return allocateBlock(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+	releaseBlock(pointer, HEAP_HEADER);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+	releaseBlock(pointer, HEAP_HEADER);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment) noexcept {
+	releaseBlock(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t alignment) noexcept {
+	releaseBlock(pointer, static_cast<std::size_t>(alignment));
+}
+
+namespace {
+
+	// Directory of the sample corpus, settable as the only non-benchmark argument
+	std::string corpusDirectory = TINYC_BENCHMARK_CORPUS;
+
+	/**
+	 * @brief Sources a benchmark runs over, with their totals per pass
+	 */
+	struct Input {
+		std::vector<std::string> texts;
+		std::size_t bytes = 0;
+		std::size_t tokens = 0;
+		std::size_t nodes = 0;
+	};
+
+	// Sink counting the output instead of storing it
+	class NullSink final : public ast::OutputSink {
+	public:
+		~NullSink() override { flush(); }
+
+	protected:
+		void write(const char *, std::size_t) override {}
+	};
+
+	// Stream buffer dropping everything written to it
+	class NullBuffer final : public std::streambuf {
+	protected:
+		int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+
+		std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+	};
+
+	// Add a source to an input if it lexes and parses
+	void addSource(Input &input, std::string text) {
+		try {
+			auto buffer = lexer::SourceBuffer::view(text, "<benchmark>");
+			lexer::Lexer tokenLexer(buffer);
+			std::size_t tokens = tokenLexer.tokenize().size();
+
+			lexer::Lexer lexer(buffer);
+			parser::Parser parser(lexer);
+			std::size_t nodes = ast::FlatAST::fromTree(*parser.parseProgram()).size();
+
+			input.bytes += text.size();
+			input.tokens += tokens;
+			input.nodes += nodes;
+			input.texts.push_back(std::move(text));
+		} catch (const std::exception &) {
+			// Error samples measure error reporting, not throughput
+		}
+	}
+
+	// The sample files that lex and parse, each a separate source
+	const Input &corpus() {
+		static const Input input = []() {
+			std::vector<std::filesystem::path> paths;
+			for (const auto &entry: std::filesystem::directory_iterator(corpusDirectory)) {
+				if (entry.path().extension() == ".tc") {
+					paths.push_back(entry.path());
+				}
+			}
+			std::sort(paths.begin(), paths.end());
+
+			Input result;
+			for (const auto &path: paths) {
+				std::ifstream file(path, std::ios::binary);
+				std::ostringstream text;
+				text << file.rdbuf();
+				addSource(result, text.str());
+			}
+			return result;
+		}();
+		return input;
+	}
+
+	// One source of at least the given size, the corpus repeated
+	Input scaled(std::size_t kibibytes) {
+		std::string text;
+		while (text.size() < kibibytes * 1024) {
+			for (const auto &sample: corpus().texts) {
+				text += sample;
+				text += '\n';
+			}
+		}
+		Input input;
+		addSource(input, std::move(text));
+		return input;
+	}
+
+	// Input of a benchmark: the corpus for argument 0, otherwise a scaled source of that many KiB
+	const Input &inputFor(const benchmark::State &state) {
+		// Map elements do not move, so references stay valid as inputs are added
+		static std::map<std::size_t, Input> cache;
+		auto size = static_cast<std::size_t>(state.range(0));
+		if (size == 0) {
+			return corpus();
+		}
+		auto cached = cache.find(size);
+		if (cached == cache.end()) {
+			cached = cache.emplace(size, scaled(size)).first;
+		}
+		return cached->second;
+	}
+
+	// The parsed ASTs of an input, built once per input
+	const std::vector<ast::ASTNodePtr> &treesFor(const Input &input) {
+		static std::map<const Input *, std::vector<ast::ASTNodePtr>> cache;
+		auto cached = cache.find(&input);
+		if (cached != cache.end()) {
+			return cached->second;
+		}
+		std::vector<ast::ASTNodePtr> trees;
+		for (const auto &text: input.texts) {
+			lexer::Lexer lexer(text, "<benchmark>");
+			parser::Parser parser(lexer);
+			trees.push_back(parser.parseProgram());
+		}
+		return cache.emplace(&input, std::move(trees)).first->second;
+	}
+
+	void setCounters(benchmark::State &state, const Input &input) {
+		if (input.texts.empty()) {
+			state.SkipWithError("No samples could be parsed");
+			return;
+		}
+		state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.bytes));
+		state.counters["tokens"] = benchmark::Counter(static_cast<double>(input.tokens),
+													  benchmark::Counter::kIsIterationInvariantRate);
+		state.counters["nodes"] = benchmark::Counter(static_cast<double>(input.nodes),
+													 benchmark::Counter::kIsIterationInvariantRate);
+	}
+
+	void BM_LexerTokenize(benchmark::State &state) {
+		const Input &input = inputFor(state);
+		for (auto _: state) {
+			for (const auto &text: input.texts) {
+				auto buffer = lexer::SourceBuffer::view(text, "<benchmark>");
+				lexer::Lexer lexer(buffer);
+				auto tokens = lexer.tokenize();
+				benchmark::DoNotOptimize(tokens.data());
+			}
+		}
+		setCounters(state, input);
+	}
+
+	void BM_ParserParseProgram(benchmark::State &state) {
+		const Input &input = inputFor(state);
+		for (auto _: state) {
+			for (const auto &text: input.texts) {
+				auto buffer = lexer::SourceBuffer::view(text, "<benchmark>");
+				lexer::Lexer lexer(buffer);
+				parser::Parser parser(lexer);
+				auto program = parser.parseProgram();
+				benchmark::DoNotOptimize(program.get());
+			}
+		}
+		setCounters(state, input);
+	}
+
+	void runJSON(benchmark::State &state, bool prettyPrint) {
+		const Input &input = inputFor(state);
+		const auto &trees = treesFor(input);
+		for (auto _: state) {
+			for (const auto &tree: trees) {
+				NullSink out;
+				ast::JSONVisitor visitor(out, prettyPrint);
+				tree->accept(visitor);
+			}
+		}
+		setCounters(state, input);
+	}
+
+	void BM_JSONVisitorCompact(benchmark::State &state) {
+		runJSON(state, false);
+	}
+
+	void BM_JSONVisitorPretty(benchmark::State &state) {
+		runJSON(state, true);
+	}
+
+	void BM_CompactJSONVisitor(benchmark::State &state) {
+		const Input &input = inputFor(state);
+		const auto &trees = treesFor(input);
+		for (auto _: state) {
+			for (const auto &tree: trees) {
+				NullSink out;
+				ast::CompactJSONVisitor visitor(out);
+				tree->accept(visitor);
+			}
+		}
+		setCounters(state, input);
+	}
+
+	void BM_DumpVisitor(benchmark::State &state) {
+		const Input &input = inputFor(state);
+		const auto &trees = treesFor(input);
+		NullBuffer buffer;
+		std::ostream out(&buffer);
+		for (auto _: state) {
+			for (const auto &tree: trees) {
+				ast::DumpVisitor visitor(out);
+				tree->accept(visitor);
+			}
+		}
+		setCounters(state, input);
+	}
+
+	// Peak heap use of a piece of work, counting only what it allocates itself
+	template<typename Work>
+	std::size_t peakHeapBytes(Work &&work) {
+		heapLive = 0;
+		heapPeak = 0;
+		heapTracking = true;
+		work();
+		heapTracking = false;
+		return heapPeak;
+	}
+
+	// Generated sources by shape and size in KiB (see test_suite/corpus_generator.py)
+	using GeneratedSources = std::map<std::int64_t, std::string>;
+
+	std::map<std::string, GeneratedSources> loadGenerated(const std::string &directory) {
+		std::map<std::string, GeneratedSources> sources;
+		std::error_code error;
+		for (const auto &entry: std::filesystem::directory_iterator(directory, error)) {
+			// Files are named <shape>_<size>k.tc
+			std::string stem = entry.path().stem().string();
+			std::size_t separator = stem.rfind('_');
+			if (entry.path().extension() != ".tc" || separator == std::string::npos || stem.back() != 'k') {
+				continue;
+			}
+			std::int64_t kibibytes = std::atoll(stem.substr(separator + 1).c_str());
+			if (kibibytes <= 0) {
+				continue;
+			}
+
+			std::ifstream file(entry.path(), std::ios::binary);
+			std::ostringstream text;
+			text << file.rdbuf();
+			sources[stem.substr(0, separator)][kibibytes] = text.str();
+		}
+		return sources;
+	}
+
+	// Size, memory and complexity reporting shared by the generated input benchmarks
+	template<typename Work>
+	void setScalingCounters(benchmark::State &state, const std::string &text, std::size_t tokens, Work &&work) {
+		auto bytes = static_cast<std::int64_t>(text.size());
+		state.SetComplexityN(bytes);
+		state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * bytes);
+		state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokens),
+													  benchmark::Counter::kIsIterationInvariantRate);
+
+		std::size_t peak = peakHeapBytes(work);
+		state.counters["peak_heap"] = benchmark::Counter(static_cast<double>(peak), benchmark::Counter::kDefaults,
+														 benchmark::Counter::kIs1024);
+		state.counters["heap_per_byte"] = static_cast<double>(peak) / static_cast<double>(text.size());
+	}
+
+	void BM_GeneratedLexer(benchmark::State &state, const GeneratedSources *sources) {
+		const std::string &text = sources->at(state.range(0));
+		auto buffer = lexer::SourceBuffer::view(text, "<generated>");
+		std::size_t tokens = 0;
+		auto tokenize = [&]() {
+			lexer::Lexer lexer(buffer);
+			tokens = lexer.tokenize().size();
+		};
+		for (auto _: state) {
+			tokenize();
+		}
+		setScalingCounters(state, text, tokens, tokenize);
+	}
+
+	void BM_GeneratedParser(benchmark::State &state, const GeneratedSources *sources, parser::NodeSharing sharing) {
+		const std::string &text = sources->at(state.range(0));
+		auto buffer = lexer::SourceBuffer::view(text, "<generated>");
+		parser::ParserOptions options;
+		options.sharing = sharing;
+		auto parse = [&]() {
+			lexer::Lexer lexer(buffer);
+			parser::Parser parser(lexer, options);
+			auto program = parser.parseProgram();
+			benchmark::DoNotOptimize(program.get());
+		};
+		for (auto _: state) {
+			parse();
+		}
+
+		lexer::Lexer lexer(buffer);
+		setScalingCounters(state, text, lexer.tokenize().size(), parse);
+	}
+
+	// Register a lexer and two parser benchmarks per shape (the second sharing equal types and pure
+	// expressions), fitting time against size to expose super-linear growth
+	void registerGenerated(const std::map<std::string, GeneratedSources> &generated) {
+		for (const auto &[shape, sources]: generated) {
+			auto *lexerBenchmark = benchmark::RegisterBenchmark(("BM_GeneratedLexer/" + shape).c_str(),
+																BM_GeneratedLexer, &sources);
+			auto *parserBenchmark = benchmark::RegisterBenchmark(("BM_GeneratedParser/" + shape).c_str(),
+																 BM_GeneratedParser, &sources,
+																 parser::NodeSharing::NONE);
+			auto *sharedBenchmark = benchmark::RegisterBenchmark(("BM_GeneratedSharedParser/" + shape).c_str(),
+																 BM_GeneratedParser, &sources,
+																 parser::NodeSharing::EXPRESSIONS);
+			for (auto *registered: {lexerBenchmark, parserBenchmark, sharedBenchmark}) {
+				registered->ArgName("KiB")->Unit(benchmark::kMillisecond)->Complexity(benchmark::oAuto);
+				for (const auto &entry: sources) {
+					registered->Arg(entry.first);
+				}
+			}
+		}
+	}
+
+	// The corpus, then sources of 64 KiB, 1 MiB and 8 MiB
+	void inputs(benchmark::internal::Benchmark *benchmark) {
+		benchmark->ArgName("KiB")->Arg(0)->Arg(64)->Arg(1024)->Arg(8 * 1024)->Unit(benchmark::kMicrosecond);
+	}
+
+} // anonymous namespace
+
+BENCHMARK(BM_LexerTokenize)->Apply(inputs);
+BENCHMARK(BM_ParserParseProgram)->Apply(inputs);
+BENCHMARK(BM_JSONVisitorCompact)->Apply(inputs);
+BENCHMARK(BM_JSONVisitorPretty)->Apply(inputs);
+BENCHMARK(BM_CompactJSONVisitor)->Apply(inputs);
+BENCHMARK(BM_DumpVisitor)->Apply(inputs);
+
+int main(int argc, char **argv) {
+	benchmark::Initialize(&argc, argv);
+	if (argc > 2) {
+		std::cerr << "Usage: " << argv[0] << " [benchmark options] [corpus_directory]" << std::endl;
+		return 1;
+	}
+	if (argc == 2) {
+		corpusDirectory = argv[1];
+	}
+	benchmark::AddCustomContext("corpus", corpusDirectory);
+
+#ifdef TINYC_BENCHMARK_GENERATED
+	// Kept alive for the registered benchmarks
+	static const auto generated = loadGenerated(TINYC_BENCHMARK_GENERATED);
+	registerGenerated(generated);
+	benchmark::AddCustomContext("generated_corpus", TINYC_BENCHMARK_GENERATED);
+#endif
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+TinyC Benchmark Comparison
+
+This script compares two Google Benchmark JSON reports (written with --benchmark_out and
+--benchmark_out_format=json), e.g. of a default Release build and of an LTO or PGO build,
+and prints the time of every benchmark in both and the speedup of the second.
+"""
+
+import argparse
+import json
+import sys
+from typing import Dict, List, Tuple
+
+UNITS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_times(path: str) -> Tuple[List[str], Dict[str, float]]:
+    """Benchmark names in report order and their real time per iteration in nanoseconds"""
+    with open(path) as f:
+        report = json.load(f)
+
+    names: List[str] = []
+    times: Dict[str, float] = {}
+    for benchmark in report.get('benchmarks', []):
+        # Repetitions are summarized by aggregates such as _mean, compare the iterations
+        if benchmark.get('run_type') == 'aggregate' or 'error_occurred' in benchmark:
+            continue
+        name = benchmark['name']
+        time = benchmark['real_time'] * UNITS.get(benchmark.get('time_unit', 'ns'), 1.0)
+        if name not in times:
+            names.append(name)
+            times[name] = time
+        else:
+            times[name] = min(times[name], time)
+    return names, times
+
+
+def format_time(nanoseconds: float) -> str:
+    for unit in ['s', 'ms', 'us']:
+        if nanoseconds >= UNITS[unit]:
+            return f"{nanoseconds / UNITS[unit]:.3f} {unit}"
+    return f"{nanoseconds:.1f} ns"
+
+
+def main():
+    """Main function"""
+    parser = argparse.ArgumentParser(description='Compare the benchmarks of two builds')
+    parser.add_argument('baseline', help='JSON report of the baseline build')
+    parser.add_argument('contender', help='JSON report of the build to compare')
+    args = parser.parse_args()
+
+    baseline_names, baseline = load_times(args.baseline)
+    contender_names, contender = load_times(args.contender)
+    names = [name for name in baseline_names if name in contender]
+    if not names:
+        print("No benchmarks in common", file=sys.stderr)
+        return 1
+
+    width = max(len('Geometric mean'), *(len(name) for name in names))
+    print(f"{'Benchmark':<{width}}  {'Baseline':>12}  {'This build':>12}  {'Speedup':>8}")
+    speedups = []
+    for name in names:
+        speedup = baseline[name] / contender[name] if contender[name] > 0 else float('inf')
+        speedups.append(speedup)
+        print(f"{name:<{width}}  {format_time(baseline[name]):>12}  {format_time(contender[name]):>12}  "
+              f"{speedup:>7.2f}x")
+
+    # Geometric mean, so every benchmark counts the same whatever its time
+    product = 1.0
+    for speedup in speedups:
+        product *= speedup
+    print(f"{'Geometric mean':<{width}}  {'':>12}  {'':>12}  {product ** (1 / len(speedups)):>7.2f}x")
+
+    missing = sorted(set(baseline_names) ^ set(contender_names))
+    if missing:
+        print(f"Not in both reports: {', '.join(missing)}", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,21 @@
+# Build step (cmake -P) writing the hash of the frontend sources to a header, read by the
+# output cache so a rebuilt frontend never reuses entries written by another build
+#
+# Variables: SOURCE_DIR, OUTPUT
+
+file(GLOB_RECURSE sources ${SOURCE_DIR}/include/*.h ${SOURCE_DIR}/src/*.cpp)
+list(SORT sources)
+
+set(hashes "")
+foreach (source ${sources})
+    file(SHA256 ${source} hash)
+    file(RELATIVE_PATH name ${SOURCE_DIR} ${source})
+    string(APPEND hashes "${name} ${hash}\n")
+endforeach ()
+string(SHA256 id "${hashes}")
+string(SUBSTRING ${id} 0 16 id)
+
+# Only rewritten when the hash changes, so an unchanged tree does not recompile the cache
+file(WRITE ${OUTPUT}.tmp "#define TINYC_BUILD_ID \"${id}\"\n")
+configure_file(${OUTPUT}.tmp ${OUTPUT} COPYONLY)
+file(REMOVE ${OUTPUT}.tmp)
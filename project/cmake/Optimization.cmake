@@ -0,0 +1,143 @@
+# High-performance builds: link-time optimization, profile-guided optimization and a
+# replacement global allocator, applied to targets with tinyc_optimize()
+
+option(TINYC_ENABLE_LTO "Optimize the tinyc library and the executables at link time" OFF)
+
+set(TINYC_PGO "OFF" CACHE STRING
+        "Profile-guided optimization stage: OFF, GENERATE (instrumented build) or USE (optimize with the profile). \
+Set by the pgo target, which is the supported way to make a PGO build; set by hand, the profile must \
+come from a build in the same directory")
+set_property(CACHE TINYC_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(TINYC_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Directory of the profile data")
+
+set(TINYC_ALLOCATOR "default" CACHE STRING "Global allocator of the executables: default, mimalloc or jemalloc")
+set_property(CACHE TINYC_ALLOCATOR PROPERTY STRINGS default mimalloc jemalloc)
+
+if (TINYC_ENABLE_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT TINYC_LTO_SUPPORTED OUTPUT TINYC_LTO_ERROR)
+    if (NOT TINYC_LTO_SUPPORTED)
+        message(FATAL_ERROR "Link-time optimization is not supported: ${TINYC_LTO_ERROR}")
+    endif ()
+endif ()
+
+# Compiler and linker flags of the PGO stage. GCC names the profile of each object after its
+# path, so both stages must be built in the same build directory (the pgo target does this).
+set(TINYC_PGO_FLAGS)
+if (TINYC_PGO STREQUAL "GENERATE")
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # The compiler runs several threads, whose counters must not race
+        set(TINYC_PGO_FLAGS -fprofile-generate=${TINYC_PGO_DIR} -fprofile-update=atomic)
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set(TINYC_PGO_FLAGS -fprofile-instr-generate=${TINYC_PGO_DIR}/tinyc-%p.profraw)
+    else ()
+        message(FATAL_ERROR "Profile-guided optimization is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif ()
+elseif (TINYC_PGO STREQUAL "USE")
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # Code the training did not run is optimized as usual rather than for size
+        set(TINYC_PGO_FLAGS -fprofile-use=${TINYC_PGO_DIR} -fprofile-partial-training -Wno-missing-profile)
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set(TINYC_PGO_FLAGS -fprofile-instr-use=${TINYC_PGO_DIR}/tinyc.profdata
+                -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date)
+    else ()
+        message(FATAL_ERROR "Profile-guided optimization is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif ()
+elseif (NOT TINYC_PGO STREQUAL "OFF")
+    message(FATAL_ERROR "TINYC_PGO must be OFF, GENERATE or USE, not ${TINYC_PGO}")
+endif ()
+
+# The allocator replaces malloc and operator new in the executables, and with them the blocks
+# of the AST arenas (ASTContext allocates from the default memory resource)
+set(TINYC_ALLOCATOR_LIBRARY)
+if (TINYC_ALLOCATOR STREQUAL "mimalloc")
+    find_package(mimalloc REQUIRED)
+    set(TINYC_ALLOCATOR_LIBRARY mimalloc)
+elseif (TINYC_ALLOCATOR STREQUAL "jemalloc")
+    find_library(TINYC_JEMALLOC_LIBRARY NAMES jemalloc)
+    if (NOT TINYC_JEMALLOC_LIBRARY)
+        message(FATAL_ERROR "TINYC_ALLOCATOR is jemalloc, but the jemalloc library was not found")
+    endif ()
+    set(TINYC_ALLOCATOR_LIBRARY ${TINYC_JEMALLOC_LIBRARY})
+elseif (NOT TINYC_ALLOCATOR STREQUAL "default")
+    message(FATAL_ERROR "TINYC_ALLOCATOR must be default, mimalloc or jemalloc, not ${TINYC_ALLOCATOR}")
+endif ()
+
+# Apply the optimization options to a target; executables also get the allocator
+function(tinyc_optimize target)
+    if (TINYC_ENABLE_LTO)
+        set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    endif ()
+
+    get_target_property(type ${target} TYPE)
+    if (TINYC_PGO_FLAGS)
+        target_compile_options(${target} PRIVATE ${TINYC_PGO_FLAGS})
+        string(REPLACE ";" " " flags "${TINYC_PGO_FLAGS}")
+        set_property(TARGET ${target} APPEND_STRING PROPERTY LINK_FLAGS " ${flags}")
+
+        # Instrumented objects of a static library need the profiling runtime in every
+        # executable linking it, such as the tests
+        if (type STREQUAL "STATIC_LIBRARY")
+            target_link_libraries(${target} INTERFACE ${TINYC_PGO_FLAGS})
+        endif ()
+    endif ()
+
+    if (TINYC_ALLOCATOR_LIBRARY AND type STREQUAL "EXECUTABLE")
+        target_link_libraries(${target} ${TINYC_ALLOCATOR_LIBRARY})
+    endif ()
+endfunction()
+
+# Targets building an optimized copy of the project in a subdirectory of the build directory
+function(tinyc_add_optimization_targets)
+    set(source ${CMAKE_CURRENT_SOURCE_DIR})
+    set(flags -DCMAKE_BUILD_TYPE=Release -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+            -DTINYC_ENABLE_SIMD=${TINYC_ENABLE_SIMD})
+    find_program(TINYC_PYTHON NAMES python3 python)
+    find_program(TINYC_LLVM_PROFDATA NAMES llvm-profdata)
+
+    # Two-stage PGO build in pgo/: instrument, train on the samples and generated programs,
+    # then rebuild with the profile (and the LTO and allocator options of this build)
+    set(pgo ${CMAKE_BINARY_DIR}/pgo)
+    set(profile ${pgo}/profile)
+    set(options -DTINYC_ENABLE_LTO=${TINYC_ENABLE_LTO} -DTINYC_ALLOCATOR=${TINYC_ALLOCATOR} -DTINYC_PGO_DIR=${profile})
+    set(configure ${CMAKE_COMMAND} -E chdir ${pgo} ${CMAKE_COMMAND} ${flags} ${options})
+    set(build_benchmarks)
+    if (TARGET tinyc_benchmarks)
+        set(build_benchmarks COMMAND ${CMAKE_COMMAND} --build ${pgo} --target tinyc_benchmarks)
+    endif ()
+    add_custom_target(pgo
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${pgo}
+            COMMAND ${configure} -DTINYC_PGO=GENERATE ${source}
+            COMMAND ${CMAKE_COMMAND} --build ${pgo} --target tinyc-compiler
+            COMMAND ${CMAKE_COMMAND} -DCOMPILER=${pgo}/tinyc-compiler -DPROFILE_DIR=${profile}
+            -DWORK_DIR=${pgo}/training -DSAMPLES_DIR=${source}/test_suite/samples
+            -DGENERATOR=${source}/test_suite/corpus_generator.py -DPYTHON=${TINYC_PYTHON}
+            -DPROFDATA=${TINYC_LLVM_PROFDATA} -DCOMPILER_ID=${CMAKE_CXX_COMPILER_ID}
+            -P ${source}/cmake/PGOTraining.cmake
+            COMMAND ${configure} -DTINYC_PGO=USE ${source}
+            COMMAND ${CMAKE_COMMAND} --build ${pgo} --target tinyc-compiler
+            ${build_benchmarks}
+            COMMENT "Building a profile-guided optimized tinyc-compiler in ${pgo}"
+            USES_TERMINAL
+            VERBATIM)
+
+    # Benchmarks of this build against a default Release build in baseline/
+    if (TARGET tinyc_benchmarks AND TINYC_PYTHON)
+        set(baseline ${CMAKE_BINARY_DIR}/baseline)
+        add_custom_target(compare_benchmarks
+                COMMAND ${CMAKE_COMMAND} -E make_directory ${baseline}
+                COMMAND ${CMAKE_COMMAND} -E chdir ${baseline} ${CMAKE_COMMAND} ${flags}
+                -DTINYC_ENABLE_LTO=OFF -DTINYC_PGO=OFF -DTINYC_ALLOCATOR=default ${source}
+                COMMAND ${CMAKE_COMMAND} --build ${baseline} --target tinyc_benchmarks
+                COMMAND ${baseline}/tinyc_benchmarks --benchmark_out=${baseline}/benchmarks.json
+                --benchmark_out_format=json
+                COMMAND tinyc_benchmarks --benchmark_out=${CMAKE_BINARY_DIR}/benchmarks.json
+                --benchmark_out_format=json
+                COMMAND ${TINYC_PYTHON} ${source}/benchmarks/compare_builds.py
+                ${baseline}/benchmarks.json ${CMAKE_BINARY_DIR}/benchmarks.json
+                DEPENDS tinyc_benchmarks
+                COMMENT "Comparing the benchmarks of this build with a default Release build"
+                USES_TERMINAL
+                VERBATIM)
+    endif ()
+endfunction()
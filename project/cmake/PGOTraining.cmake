@@ -0,0 +1,50 @@
+# Training run of the pgo target (cmake -P): runs the instrumented compiler over the sample
+# corpus and generated programs in every mode, then merges the profile for Clang
+#
+# Variables: COMPILER, PROFILE_DIR, WORK_DIR, SAMPLES_DIR, GENERATOR, PYTHON (optional),
+# PROFDATA (llvm-profdata, needed with Clang), COMPILER_ID
+
+# Start from an empty profile, so it only describes the current sources
+file(REMOVE_RECURSE ${PROFILE_DIR} ${WORK_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR} ${WORK_DIR})
+
+file(GLOB inputs ${SAMPLES_DIR}/*.tc)
+
+# Larger programs of every shape, so the hot loops dominate the profile
+if (PYTHON)
+    foreach (shape nesting expressions switch structs mixed)
+        set(file ${WORK_DIR}/${shape}.tc)
+        execute_process(COMMAND ${PYTHON} ${GENERATOR} --shape ${shape} --size 512K --seed 1 --output ${file}
+                RESULT_VARIABLE result)
+        if (NOT result EQUAL 0)
+            message(FATAL_ERROR "Generating the ${shape} training program failed")
+        endif ()
+        list(APPEND inputs ${file})
+    endforeach ()
+else ()
+    message(WARNING "Python not found, training on the samples only")
+endif ()
+
+# Error samples exit with non-zero codes, which is part of what is trained
+foreach (input ${inputs})
+    foreach (mode "--lex" "--parse" "--parse;--pretty" "--parse;--emit=bin"
+            "--parse;--parse-jobs;4;--serialize-jobs;4")
+        execute_process(COMMAND ${COMPILER} ${mode} ${input}
+                OUTPUT_FILE ${WORK_DIR}/output ERROR_FILE ${WORK_DIR}/errors)
+    endforeach ()
+endforeach ()
+
+if (COMPILER_ID MATCHES "Clang")
+    if (NOT PROFDATA)
+        message(FATAL_ERROR "llvm-profdata is needed to merge the profile of a Clang build")
+    endif ()
+    file(GLOB raw ${PROFILE_DIR}/*.profraw)
+    execute_process(COMMAND ${PROFDATA} merge -output=${PROFILE_DIR}/tinyc.profdata ${raw}
+            RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Merging the profile failed")
+    endif ()
+endif ()
+
+list(LENGTH inputs count)
+message(STATUS "Trained on ${count} inputs")
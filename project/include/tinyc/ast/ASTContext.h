@@ -0,0 +1,177 @@
+#ifndef TINYC_AST_CONTEXT_H
+#define TINYC_AST_CONTEXT_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/NodeTable.h"
+#include "tinyc/ast/SymbolTable.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Arena owning the nodes, child lists and strings of an AST
+	 *
+	 * Everything is bump-allocated from a monotonic buffer, so the nodes of a tree sit next to
+	 * each other in memory and the whole tree is released at once when the context is destroyed.
+	 * Node destructors are never run for arena nodes; their members must therefore either be
+	 * trivially destructible or allocate from the context (see makeList() and copyString()).
+	 */
+	class ASTContext {
+	public:
+		/**
+		 * @brief Construct a new AST context
+		 *
+		 * @param initialSize Size of the first arena block in bytes
+		 * @param upstream Resource the arena blocks are allocated from (and returned to by reset())
+		 */
+		explicit ASTContext(std::size_t initialSize = 64 * 1024,
+							std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+		ASTContext(const ASTContext &) = delete;
+
+		ASTContext &operator=(const ASTContext &) = delete;
+
+		/**
+		 * @brief Create a node in the arena
+		 *
+		 * @tparam T The node type
+		 * @param args Arguments forwarded to the node constructor
+		 * @return NodePtr<T> Non-owning handle to the node (releasing it does nothing)
+		 */
+		template<typename T, typename... Args>
+		NodePtr<T> create(Args &&... args) {
+			void *memory = resource.allocate(sizeof(T), alignof(T));
+			T *node = ::new(memory) T(std::forward<Args>(args)...);
+			node->arenaAllocated = true;
+			return NodePtr<T>(node);
+		}
+
+		/**
+		 * @brief Create a node in the arena, or get the equal node created before (hash-consing)
+		 *
+		 * The node is shared through the node table of the context: the first call with a key
+		 * creates the node, later calls with an equal key return it without allocating. Shared
+		 * nodes keep the location they were created with, and must never be changed.
+		 *
+		 * @tparam T The node type
+		 * @param key The key of the node (see NodeKey::of()), whose children should be shared nodes
+		 * @param args Arguments forwarded to the node constructor, unused when the node exists
+		 * @return NodePtr<T> Non-owning handle to the shared node
+		 */
+		template<typename T, typename... Args>
+		NodePtr<T> createShared(const NodeKey &key, Args &&... args) {
+			return share<T>(key, [&]() { return create<T>(std::forward<Args>(args)...); });
+		}
+
+		/**
+		 * @brief Get the shared node of a key, calling make() to create it on first use
+		 *
+		 * Like createShared(), for nodes whose arguments cost something to prepare, such as a
+		 * copy of their text: the key can view a temporary, and the copy is only made by make().
+		 *
+		 * @tparam T The node type
+		 * @param key The key of the node, whose text only needs to live during the call
+		 * @param make Called without arguments to create the node in this context (a NodePtr<T>)
+		 * @return NodePtr<T> Non-owning handle to the shared node
+		 */
+		template<typename T, typename Make>
+		NodePtr<T> share(const NodeKey &key, Make &&make) {
+			if (!nodes) {
+				nodes = std::make_unique<NodeTable>();
+			}
+			ASTNode *node = nodes->intern(key, [&]() -> ASTNode * {
+				NodePtr<T> created = make();
+				created->sharedNode = true;
+				return created.release();
+			});
+			return NodePtr<T>(static_cast<T *>(node));
+		}
+
+		/**
+		 * @brief Get the number of distinct nodes created with createShared()
+		 */
+		[[nodiscard]] std::size_t sharedNodeCount() const { return nodes ? nodes->size() : 0; }
+
+		/**
+		 * @brief Create an empty child list allocating from the arena
+		 */
+		[[nodiscard]] NodeList makeList() { return NodeList(&resource); }
+
+		/**
+		 * @brief Copy a string into the arena
+		 *
+		 * @param text The text to copy
+		 * @return std::string_view View of the copy, valid as long as the context
+		 */
+		std::string_view copyString(std::string_view text);
+
+		/**
+		 * @brief Intern a name (identifier or type name) in the symbol table of the context
+		 *
+		 * Unlike copyString(), every occurrence of a name shares one copy.
+		 *
+		 * @param name The name
+		 * @return std::string_view The interned copy, valid as long as the context
+		 */
+		std::string_view intern(std::string_view name) { return getSymbols()->intern(name); }
+
+		/**
+		 * @brief Get the symbol table of the context, creating it on first use
+		 */
+		const std::shared_ptr<SymbolTable> &getSymbols() {
+			if (!symbols) {
+				symbols = std::make_shared<SymbolTable>(false, resource.upstream_resource());
+			}
+			return symbols;
+		}
+
+		/**
+		 * @brief Intern names in a given table, e.g. one shared with the contexts of other threads
+		 *
+		 * @param table The table, which must be concurrent if it is shared across threads
+		 */
+		void setSymbols(std::shared_ptr<SymbolTable> table) { symbols = std::move(table); }
+
+		/**
+		 * @brief Keep another context alive as long as this one
+		 *
+		 * Lets a tree hold nodes built in several arenas, e.g. on several threads.
+		 *
+		 * @param other The context to keep
+		 */
+		void adopt(std::shared_ptr<ASTContext> other) { adopted.push_back(std::move(other)); }
+
+		/**
+		 * @brief Release everything allocated so far and start over
+		 *
+		 * All nodes, lists, strings and interned names of the context (and of the adopted
+		 * contexts) are invalidated, and no node is shared with the nodes created afterwards.
+		 */
+		void reset() {
+			resource.release();
+			adopted.clear();
+			symbols.reset();
+			nodes.reset();
+		}
+
+		/**
+		 * @brief Get the memory resource backing the arena
+		 */
+		[[nodiscard]] std::pmr::memory_resource *getResource() { return &resource; }
+
+	private:
+		std::pmr::monotonic_buffer_resource resource;
+		std::vector<std::shared_ptr<ASTContext>> adopted;
+		std::shared_ptr<SymbolTable> symbols;
+		std::unique_ptr<NodeTable> nodes;  // Created by the first createShared()
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_CONTEXT_H
@@ -3,13 +3,18 @@
 
 #include "tinyc/lexer/Token.h"
 #include "tinyc/ast/NodeVisitor.h"
+#include "tinyc/ast/NodeKind.h"
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <ostream>
 
 namespace tinyc::ast {
 
+	class ASTContext;
+
 /**
  * @brief Base class for all AST nodes
  */
@@ -18,9 +23,10 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new AST Node
 		 *
+		 * @param kind The concrete class of the node
 		 * @param location Source code location of this node
 		 */
-		explicit ASTNode(lexer::SourceLocation location);
+		ASTNode(NodeKind kind, lexer::SourceLocation location);
 
 		/**
 		 * @brief Virtual destructor for proper inheritance
@@ -32,7 +38,25 @@ namespace tinyc::ast {
 		 *
 		 * @return Source location
 		 */
-		[[nodiscard]] lexer::SourceLocation getLocation() const;
+		[[nodiscard]] const lexer::SourceLocation &getLocation() const;
+
+		/**
+		 * @brief Move the node to another location
+		 *
+		 * Used when text before the node is edited (see parser::IncrementalParser).
+		 *
+		 * @param newLocation The new location
+		 */
+		void setLocation(const lexer::SourceLocation &newLocation) { location = newLocation; }
+
+		/**
+		 * @brief Get the concrete class of this node
+		 *
+		 * Lets a node be dispatched on without a virtual call (see StaticVisitor).
+		 *
+		 * @return Kind of the node
+		 */
+		[[nodiscard]] NodeKind getNodeKind() const { return nodeKind; }
 
 		/**
 		 * @brief Accept a visitor to this node
@@ -45,12 +69,55 @@ namespace tinyc::ast {
 		 */
 		virtual void accept(NodeVisitor &visitor) const = 0;
 
+		/**
+		 * @brief Check if this node is owned by an ASTContext arena
+		 *
+		 * @return true if the node lives in an arena, false if it was allocated with new
+		 */
+		[[nodiscard]] bool isArenaAllocated() const { return arenaAllocated; }
+
+		/**
+		 * @brief Check if this node is shared by equal subtrees (see ASTContext::createShared())
+		 *
+		 * A shared node may have several parents, and its location is that of the first of them.
+		 *
+		 * @return true if the node is in the hash-consing table of its ASTContext
+		 */
+		[[nodiscard]] bool isShared() const { return sharedNode; }
+
 	private:
-		const lexer::SourceLocation location;
+		friend class ASTContext;
+
+		lexer::SourceLocation location;
+		const NodeKind nodeKind;
+		bool arenaAllocated = false;
+		bool sharedNode = false;
 	};
 
-// Using a shared_ptr for node management
-	using ASTNodePtr = std::unique_ptr<ASTNode>;
+/**
+ * @brief Deleter for AST node handles
+ *
+ * Nodes allocated with new are deleted; nodes owned by an ASTContext arena are left alone,
+ * the arena releases them all at once.
+ */
+	struct NodeDeleter {
+		NodeDeleter() noexcept = default;
+
+		// Allows handles from std::make_unique to convert to node handles
+		template<typename T>
+		NodeDeleter(const std::default_delete<T> &) noexcept {} // NOLINT(google-explicit-constructor)
+
+		void operator()(ASTNode *node) const noexcept;
+	};
+
+// Handle to a node, owning only when the node is not in an arena
+	using ASTNodePtr = std::unique_ptr<ASTNode, NodeDeleter>;
+
+	template<typename T>
+	using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
+// List of child nodes; lists built by the parser allocate from the tree's ASTContext
+	using NodeList = std::pmr::vector<ASTNodePtr>;
 
 /* ===== Type Nodes ===== */
 
@@ -116,17 +183,17 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Named Type Node
 		 *
-		 * @param identifier The type name
+		 * @param identifier The type name, must outlive the node (intern it in the ASTContext)
 		 * @param location Source location
 		 */
-		NamedTypeNode(std::string identifier, lexer::SourceLocation location);
+		NamedTypeNode(std::string_view identifier, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the type name
 		 *
 		 * @return The type identifier
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -138,7 +205,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 	};
 
 /**
@@ -198,11 +265,11 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Literal Node
 		 *
-		 * @param value String representation of the literal value
+		 * @param value String representation of the literal value, must outlive the node (copy it into the ASTContext)
 		 * @param kind The literal kind
 		 * @param location Source location
 		 */
-		LiteralNode(std::string value, Kind kind, lexer::SourceLocation location);
+		LiteralNode(std::string_view value, Kind kind, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the literal kind
@@ -216,7 +283,7 @@ namespace tinyc::ast {
 		 *
 		 * @return String representation of the value
 		 */
-		[[nodiscard]] const std::string &getValue() const;
+		[[nodiscard]] std::string_view getValue() const;
 
 		/**
 		 * @brief Convert kind to string
@@ -236,7 +303,7 @@ namespace tinyc::ast {
 
 	private:
 		Kind kind;
-		std::string value;
+		std::string_view value;
 	};
 
 /**
@@ -249,17 +316,17 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Identifier Node
 		 *
-		 * @param identifier The identifier name
+		 * @param identifier The identifier name, must outlive the node (intern it in the ASTContext)
 		 * @param location Source location
 		 */
-		IdentifierNode(std::string identifier, lexer::SourceLocation location);
+		IdentifierNode(std::string_view identifier, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the identifier name
 		 *
 		 * @return The identifier string
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -271,7 +338,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 	};
 
 /**
@@ -502,7 +569,7 @@ namespace tinyc::ast {
 		 * @param arguments Arguments for the function call
 		 * @param location Source location
 		 */
-		CallExpressionNode(ASTNodePtr callee, std::vector<ASTNodePtr> arguments, lexer::SourceLocation location);
+		CallExpressionNode(ASTNodePtr callee, NodeList arguments, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the callee expression
@@ -516,7 +583,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The function call arguments
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getArguments() const;
+		[[nodiscard]] const NodeList &getArguments() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -529,7 +596,7 @@ namespace tinyc::ast {
 
 	private:
 		ASTNodePtr callee;
-		std::vector<ASTNodePtr> arguments;
+		NodeList arguments;
 	};
 
 /**
@@ -596,10 +663,10 @@ namespace tinyc::ast {
 		 *
 		 * @param kind Kind of member access (dot or arrow)
 		 * @param object Object to access
-		 * @param member Name of the member to access
+		 * @param member Name of the member to access, must outlive the node (intern it in the ASTContext)
 		 * @param location Source location
 		 */
-		MemberExpressionNode(Kind kind, ASTNodePtr object, std::string member, lexer::SourceLocation location);
+		MemberExpressionNode(Kind kind, ASTNodePtr object, std::string_view member, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the access kind
@@ -620,7 +687,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The name of the accessed member
 		 */
-		[[nodiscard]] const std::string &getMember() const;
+		[[nodiscard]] std::string_view getMember() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -634,7 +701,7 @@ namespace tinyc::ast {
 	private:
 		Kind kind;
 		ASTNodePtr object;
-		std::string member;
+		std::string_view member;
 	};
 
 /**
@@ -650,14 +717,14 @@ namespace tinyc::ast {
 		 * @param expressions List of expressions separated by commas
 		 * @param location Source location
 		 */
-		CommaExpressionNode(std::vector<ASTNodePtr> expressions, lexer::SourceLocation location);
+		CommaExpressionNode(NodeList expressions, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the expressions
 		 *
 		 * @return The list of expressions
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getExpressions() const;
+		[[nodiscard]] const NodeList &getExpressions() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -669,7 +736,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::vector<ASTNodePtr> expressions;
+		NodeList expressions;
 	};
 
 /* ===== Statement Nodes ===== */
@@ -687,14 +754,14 @@ namespace tinyc::ast {
 		 * @param statements List of statements in the block
 		 * @param location Source location
 		 */
-		BlockStatementNode(std::vector<ASTNodePtr> statements, lexer::SourceLocation location);
+		BlockStatementNode(NodeList statements, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the statements in the block
 		 *
 		 * @return The list of statements
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getStatements() const;
+		[[nodiscard]] const NodeList &getStatements() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -706,7 +773,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::vector<ASTNodePtr> statements;
+		NodeList statements;
 	};
 
 /**
@@ -994,11 +1061,13 @@ namespace tinyc::ast {
 		 * @brief Case in a switch statement
 		 */
 		struct Case {
-			int value;                    // Case value (for regular cases)
-			bool isDefault;               // Whether this is the default case
-			std::vector<ASTNodePtr> body; // Case body statements
+			int value;      // Case value (for regular cases)
+			bool isDefault; // Whether this is the default case
+			NodeList body;  // Case body statements
 		};
 
+		using CaseList = std::pmr::vector<Case>;
+
 		/**
 		 * @brief Construct a new Switch Statement Node
 		 *
@@ -1006,7 +1075,7 @@ namespace tinyc::ast {
 		 * @param cases List of case clauses
 		 * @param location Source location
 		 */
-		SwitchStatementNode(ASTNodePtr expression, std::vector<Case> cases, lexer::SourceLocation location);
+		SwitchStatementNode(ASTNodePtr expression, CaseList cases, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the switch expression
@@ -1020,7 +1089,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The list of case clauses
 		 */
-		[[nodiscard]] const std::vector<Case> &getCases() const;
+		[[nodiscard]] const CaseList &getCases() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -1033,7 +1102,7 @@ namespace tinyc::ast {
 
 	private:
 		ASTNodePtr expression;
-		std::vector<Case> cases;
+		CaseList cases;
 	};
 
 /**
@@ -1137,14 +1206,14 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Variable Node
 		 *
-		 * @param identifier Name of the variable
+		 * @param identifier Name of the variable, must outlive the node (intern it in the ASTContext)
 		 * @param type Type of the variable
 		 * @param location Source location
 		 * @param arraySize Size of the array (optional, null for non-array variables)
 		 * @param initializer Initial value (optional)
 		 */
 		VariableNode(
-				std::string identifier,
+				std::string_view identifier,
 				ASTNodePtr type,
 				lexer::SourceLocation location,
 				ASTNodePtr arraySize = nullptr,
@@ -1155,7 +1224,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The variable name
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Get the variable type
@@ -1202,7 +1271,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 		ASTNodePtr type;
 		ASTNodePtr arraySize;   // Optional array size expression
 		ASTNodePtr initializer; // Optional initializer expression
@@ -1221,14 +1290,14 @@ namespace tinyc::ast {
 		 * @param declarations List of variable declarations
 		 * @param location Source location
 		 */
-		MultipleDeclarationNode(std::vector<ASTNodePtr> declarations, lexer::SourceLocation location);
+		MultipleDeclarationNode(NodeList declarations, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the declarations
 		 *
 		 * @return List of variable declarations
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr>& getDeclarations() const;
+		[[nodiscard]] const NodeList& getDeclarations() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -1240,7 +1309,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::vector<ASTNodePtr> declarations;
+		NodeList declarations;
 	};
 
 /**
@@ -1253,11 +1322,11 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Parameter Node
 		 *
-		 * @param identifier Name of the parameter
+		 * @param identifier Name of the parameter, must outlive the node (intern it in the ASTContext)
 		 * @param type Type of the parameter
 		 * @param location Source location
 		 */
-		ParameterNode(std::string identifier, ASTNodePtr type, lexer::SourceLocation location);
+		ParameterNode(std::string_view identifier, ASTNodePtr type, lexer::SourceLocation location);
 
 		/**
 		 * @brief Get the parameter type
@@ -1271,7 +1340,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The parameter name
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -1283,7 +1352,7 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 		ASTNodePtr type;
 	};
 
@@ -1298,16 +1367,16 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Function Declaration Node
 		 *
-		 * @param identifier Name of the function
+		 * @param identifier Name of the function, must outlive the node (intern it in the ASTContext)
 		 * @param returnType Return type of the function
 		 * @param parameters Function parameters
 		 * @param body Function body (null for declarations, BlockStatement for definitions)
 		 * @param location Source location
 		 */
 		FunctionDeclarationNode(
-				std::string identifier,
+				std::string_view identifier,
 				ASTNodePtr returnType,
-				std::vector<ASTNodePtr> parameters,
+				NodeList parameters,
 				ASTNodePtr body, // Optional for forward declarations
 				lexer::SourceLocation location);
 
@@ -1323,14 +1392,14 @@ namespace tinyc::ast {
 		 *
 		 * @return The function name
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Get the parameters
 		 *
 		 * @return The function parameters
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getParameters() const;
+		[[nodiscard]] const NodeList &getParameters() const;
 
 		/**
 		 * @brief Check if this is a function definition (has a body)
@@ -1356,9 +1425,9 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 		ASTNodePtr returnType;
-		std::vector<ASTNodePtr> parameters;
+		NodeList parameters;
 		ASTNodePtr body; // Optional for forward declarations
 	};
 
@@ -1372,13 +1441,13 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Struct Declaration Node
 		 *
-		 * @param identifier Name of the struct
+		 * @param identifier Name of the struct, must outlive the node (intern it in the ASTContext)
 		 * @param fields Struct fields (empty for forward declarations)
 		 * @param location Source location
 		 */
 		StructDeclarationNode(
-				std::string identifier,
-				std::vector<ASTNodePtr> fields, // Empty for forward declarations
+				std::string_view identifier,
+				NodeList fields, // Empty for forward declarations
 				lexer::SourceLocation location);
 
 		/**
@@ -1386,7 +1455,7 @@ namespace tinyc::ast {
 		 *
 		 * @return The struct name
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Check if this is a struct definition (has fields)
@@ -1400,14 +1469,14 @@ namespace tinyc::ast {
 		 *
 		 * @param newFields The struct fields to set
 		 */
-		void setFields(std::vector<ASTNodePtr> newFields);
+		void setFields(NodeList newFields);
 
 		/**
 		 * @brief Get the struct fields
 		 *
 		 * @return The struct fields
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getFields() const;
+		[[nodiscard]] const NodeList &getFields() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -1419,8 +1488,8 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
-		std::vector<ASTNodePtr> fields; // Empty for forward declarations
+		std::string_view identifier;
+		NodeList fields; // Empty for forward declarations
 	};
 
 /**
@@ -1434,15 +1503,15 @@ namespace tinyc::ast {
 		/**
 		 * @brief Construct a new Function Pointer Declaration Node
 		 *
-		 * @param identifier Name of the function pointer type
+		 * @param identifier Name of the function pointer type, must outlive the node (intern it in the ASTContext)
 		 * @param returnType Return type of the function pointer
 		 * @param parameterTypes Types of the function parameters
 		 * @param location Source location
 		 */
 		FunctionPointerDeclarationNode(
-				std::string identifier,
+				std::string_view identifier,
 				ASTNodePtr returnType,
-				std::vector<ASTNodePtr> parameterTypes,
+				NodeList parameterTypes,
 				lexer::SourceLocation location);
 
 		/**
@@ -1457,14 +1526,14 @@ namespace tinyc::ast {
 		 *
 		 * @return The function pointer type name
 		 */
-		[[nodiscard]] const std::string &getIdentifier() const;
+		[[nodiscard]] std::string_view getIdentifier() const;
 
 		/**
 		 * @brief Get the parameter types
 		 *
 		 * @return The function parameter types
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getParameterTypes() const;
+		[[nodiscard]] const NodeList &getParameterTypes() const;
 
 		/**
 		 * @brief Accept a visitor
@@ -1476,9 +1545,47 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::string identifier;
+		std::string_view identifier;
 		ASTNodePtr returnType;
-		std::vector<ASTNodePtr> parameterTypes;
+		NodeList parameterTypes;
+	};
+
+/* ===== Error Nodes ===== */
+
+/**
+ * @brief Error node
+ *
+ * Stands in for a statement or declaration that failed to parse. Only produced when the
+ * parser runs in recovery mode (see ParserOptions::recover).
+ */
+	class ErrorNode : public ASTNode {
+	public:
+		/**
+		 * @brief Construct a new Error Node
+		 *
+		 * @param message The parser error, must outlive the node
+		 * @param location Where the error was detected
+		 */
+		ErrorNode(std::string_view message, lexer::SourceLocation location);
+
+		/**
+		 * @brief Get the parser error
+		 *
+		 * @return The error message
+		 */
+		[[nodiscard]] std::string_view getMessage() const;
+
+		/**
+		 * @brief Accept a visitor
+		 *
+		 * @param visitor The visitor to accept
+		 */
+		void accept(NodeVisitor &visitor) const override {
+			visitor.visit(*this);
+		}
+
+	private:
+		std::string_view message;
 	};
 
 /**
@@ -1493,8 +1600,9 @@ namespace tinyc::ast {
 		 * @brief Construct a new Program Node
 		 *
 		 * @param sourceName Name of the source file
+		 * @param context Arena owning the nodes of the program (kept alive by the program)
 		 */
-		explicit ProgramNode(std::string sourceName);
+		explicit ProgramNode(std::string_view sourceName, std::shared_ptr<ASTContext> context = nullptr);
 
 		/**
 		 * @brief Add a declaration to the program
@@ -1508,7 +1616,16 @@ namespace tinyc::ast {
 		 *
 		 * @return The list of top-level declarations
 		 */
-		[[nodiscard]] const std::vector<ASTNodePtr> &getDeclarations() const;
+		[[nodiscard]] const NodeList &getDeclarations() const;
+
+		/**
+		 * @brief Replace a range of declarations
+		 *
+		 * @param first Index of the first declaration to replace
+		 * @param count Number of declarations to replace
+		 * @param replacement The declarations taking their place
+		 */
+		void replaceDeclarations(std::size_t first, std::size_t count, NodeList replacement);
 
 		/**
 		 * @brief Accept a visitor
@@ -1520,7 +1637,8 @@ namespace tinyc::ast {
 		}
 
 	private:
-		std::vector<ASTNodePtr> declarations;
+		std::shared_ptr<ASTContext> context; // Declared first so it is released after the nodes
+		NodeList declarations;
 	};
 
 } // namespace tinyc::ast
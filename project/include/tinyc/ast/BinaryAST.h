@@ -0,0 +1,260 @@
+#ifndef TINYC_AST_BINARY_AST_H
+#define TINYC_AST_BINARY_AST_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/NodeKind.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Layout of the binary AST format written by BinaryVisitor
+	 *
+	 * A file is a Header followed by four tables, all in host byte order:
+	 *  - nodeCount NodeRecords (32 bytes each), in pre-order; node 0 is the root,
+	 *  - childCount uint32 child slots; a node's children are the childCount slots starting at
+	 *    firstChild, each holding a node index or NONE for an absent optional child,
+	 *  - stringCount + 1 uint32 offsets into the string bytes (string i is [offset i, offset i+1)),
+	 *  - stringBytes bytes of deduplicated string data.
+	 *
+	 * Child slots per kind (optional children may be NONE):
+	 *   PROGRAM: declarations...            VARIABLE: type, arraySize?, initializer?
+	 *   MULTIPLE_DECLARATION: variables...  PARAMETER: type
+	 *   FUNCTION_DECLARATION: returnType, body?, parameters...
+	 *   STRUCT_DECLARATION: fields...       FUNCTION_POINTER_DECLARATION: returnType, parameterTypes...
+	 *   POINTER_TYPE: baseType              BINARY_EXPRESSION: left, right
+	 *   UNARY_EXPRESSION: operand           CAST_EXPRESSION: targetType, expression
+	 *   CALL_EXPRESSION: callee, arguments...  INDEX_EXPRESSION: array, index
+	 *   MEMBER_EXPRESSION: object           COMMA_EXPRESSION: expressions...
+	 *   BLOCK_STATEMENT: statements...      EXPRESSION_STATEMENT: expression
+	 *   IF_STATEMENT: condition, then, else?  WHILE_STATEMENT: condition, body
+	 *   DO_WHILE_STATEMENT: body, condition   FOR_STATEMENT: init?, condition?, update?, body
+	 *   SWITCH_STATEMENT: expression, cases...  (cases are CASE_RECORD records: body statements...)
+	 *   RETURN_STATEMENT: expression?
+	 *
+	 * `detail` holds the node's enum (primitive, literal and member kind, binary and unary
+	 * operator), `text` the identifier, member name, literal value or error message, and
+	 * `value` the value of a case. Case records carry the DEFAULT_CASE flag for `default:`.
+	 */
+	namespace binary {
+
+		constexpr char MAGIC[4] = {'T', 'C', 'A', 'B'};
+		constexpr std::uint16_t VERSION = 1;
+		constexpr std::uint16_t BYTE_ORDER_MARK = 0xFEFF;
+
+		// Index used for absent children and strings
+		constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+		// Record kind of a switch case
+		constexpr std::uint8_t CASE_RECORD = CASE_KIND;
+
+		// Record flags
+		constexpr std::uint16_t DEFAULT_CASE = 1u << 0;
+
+		struct Header {
+			char magic[4];
+			std::uint16_t version;
+			std::uint16_t byteOrder;
+			std::uint32_t nodeCount;
+			std::uint32_t childCount;
+			std::uint32_t stringCount;
+			std::uint32_t stringBytes;
+			std::uint32_t totalSize;   // Size of the whole file in bytes
+			std::uint32_t reserved;
+		};
+
+		struct NodeRecord {
+			std::uint8_t kind;         // NodeKind or CASE_RECORD
+			std::uint8_t detail;
+			std::uint16_t flags;
+			std::uint32_t text;        // String id or NONE
+			std::uint32_t firstChild;  // First child slot
+			std::uint32_t childCount;
+			std::uint32_t file;        // String id of the file name
+			std::int32_t line;
+			std::int32_t column;
+			std::int32_t value;
+		};
+
+		static_assert(sizeof(Header) == 32 && std::is_trivially_copyable_v<Header>);
+		static_assert(sizeof(NodeRecord) == 32 && std::is_trivially_copyable_v<NodeRecord>);
+
+	} // namespace binary
+
+	/**
+	 * @brief Exception thrown for malformed binary ASTs
+	 */
+	class BinaryFormatError : public std::runtime_error {
+	public:
+		explicit BinaryFormatError(const std::string &message)
+				: std::runtime_error("Invalid binary AST: " + message) {}
+	};
+
+	class BinaryAST;
+
+	/**
+	 * @brief Read-only view of one record of a binary AST
+	 *
+	 * Views are cheap to copy and read the underlying bytes in place; they are valid as long
+	 * as the BinaryAST they came from.
+	 */
+	class BinaryNodeView {
+	public:
+		/**
+		 * @brief Check if this is a switch case record rather than a node
+		 */
+		[[nodiscard]] bool isCase() const { return record.kind == binary::CASE_RECORD; }
+
+		/**
+		 * @brief Get the kind of the node
+		 *
+		 * @throws BinaryFormatError for case records
+		 */
+		[[nodiscard]] NodeKind kind() const;
+
+		/**
+		 * @brief Get the kind-specific enum value (operator, literal kind, ...)
+		 */
+		[[nodiscard]] std::uint8_t detail() const { return record.detail; }
+
+		/**
+		 * @brief Check a record flag
+		 */
+		[[nodiscard]] bool hasFlag(std::uint16_t flag) const { return (record.flags & flag) != 0; }
+
+		/**
+		 * @brief Get the identifier, member name or literal value (empty if none)
+		 */
+		[[nodiscard]] std::string_view text() const;
+
+		/**
+		 * @brief Get the value of a case record
+		 */
+		[[nodiscard]] int value() const { return record.value; }
+
+		/**
+		 * @brief Get the file name of the node's location
+		 */
+		[[nodiscard]] std::string_view fileName() const;
+
+		[[nodiscard]] int line() const { return record.line; }
+
+		[[nodiscard]] int column() const { return record.column; }
+
+		/**
+		 * @brief Get the number of child slots
+		 */
+		[[nodiscard]] std::size_t childCount() const { return record.childCount; }
+
+		/**
+		 * @brief Check whether a child slot holds a node
+		 */
+		[[nodiscard]] bool hasChild(std::size_t slot) const;
+
+		/**
+		 * @brief Get the node in a child slot
+		 *
+		 * @throws BinaryFormatError if the slot is out of range or empty
+		 */
+		[[nodiscard]] BinaryNodeView child(std::size_t slot) const;
+
+		/**
+		 * @brief Get the index of the record in the node table
+		 */
+		[[nodiscard]] std::uint32_t index() const { return nodeIndex; }
+
+	private:
+		friend class BinaryAST;
+
+		BinaryNodeView(const BinaryAST &ast, std::uint32_t index);
+
+		[[nodiscard]] std::uint32_t slot(std::size_t slot) const;
+
+		const BinaryAST *ast;
+		std::uint32_t nodeIndex;
+		binary::NodeRecord record;
+	};
+
+	/**
+	 * @brief A binary AST held in memory or mapped from a file
+	 *
+	 * The header and table bounds are validated on construction; records are decoded only
+	 * when they are visited, so walking a tree never deserializes it.
+	 */
+	class BinaryAST {
+	public:
+		/**
+		 * @brief Map a binary AST file
+		 *
+		 * @throws std::runtime_error if the file cannot be read
+		 * @throws BinaryFormatError if the file is not a valid binary AST
+		 */
+		static BinaryAST fromFile(const std::string &filename);
+
+		/**
+		 * @brief Take ownership of a binary AST held in memory
+		 *
+		 * @throws BinaryFormatError if the bytes are not a valid binary AST
+		 */
+		static BinaryAST fromBytes(std::string bytes);
+
+		/**
+		 * @brief Get the number of records (nodes and cases)
+		 */
+		[[nodiscard]] std::size_t nodeCount() const { return header.nodeCount; }
+
+		/**
+		 * @brief Get the size of the binary AST in bytes
+		 */
+		[[nodiscard]] std::size_t size() const { return header.totalSize; }
+
+		/**
+		 * @brief Get the root record
+		 */
+		[[nodiscard]] BinaryNodeView root() const { return node(0); }
+
+		/**
+		 * @brief Get a record by index
+		 *
+		 * @throws BinaryFormatError if the index is out of range
+		 */
+		[[nodiscard]] BinaryNodeView node(std::uint32_t index) const;
+
+		/**
+		 * @brief Get a string by id
+		 *
+		 * @throws BinaryFormatError if the id is out of range
+		 */
+		[[nodiscard]] std::string_view string(std::uint32_t id) const;
+
+	private:
+		friend class BinaryNodeView;
+
+		explicit BinaryAST(lexer::SourceBuffer buffer);
+
+		lexer::SourceBuffer buffer;
+		binary::Header header{};
+		const char *nodes = nullptr;
+		const char *children = nullptr;
+		const char *offsets = nullptr;
+		const char *strings = nullptr;
+	};
+
+	/**
+	 * @brief Rebuild an AST from a binary AST of a program
+	 *
+	 * The nodes and strings are copied into a new ASTContext owned by the returned program,
+	 * so the result does not depend on the binary AST.
+	 *
+	 * @throws BinaryFormatError if the root is not a program or a record is malformed
+	 */
+	ASTNodePtr readTree(const BinaryAST &ast);
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_BINARY_AST_H
@@ -0,0 +1,121 @@
+#ifndef TINYC_AST_FLAT_AST_H
+#define TINYC_AST_FLAT_AST_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/ast/NodeKind.h"
+#include "tinyc/lexer/Token.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief An AST stored as parallel arrays indexed by node, in pre-order
+	 *
+	 * Node i is described by the i-th element of each array: its kind (a NodeKind, or CASE_KIND
+	 * for a switch case), a kind-specific detail byte (the operator, primitive, literal or member
+	 * kind, 1 for a default case), its parent, first child and next sibling, the slot it fills in
+	 * its parent, its text (identifier, member name, literal value or error message), the value
+	 * of a case and its location.
+	 *
+	 * Slots give the role of a child and follow the layout documented in BinaryAST.h; absent
+	 * optional children simply have no node. Siblings are in source order, so the parameters of
+	 * a function (slots 2...) come before its body (slot 1).
+	 *
+	 * Because the nodes are in pre-order, the subtree of a node is a contiguous range and a pass
+	 * that does not care about nesting is a plain loop over the arrays, e.g. over kinds().
+	 */
+	class FlatAST {
+	public:
+		// Index used for absent parents, children and siblings
+		static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+		FlatAST();
+
+		/**
+		 * @brief Flatten a tree
+		 *
+		 * @param root The root of the tree, usually a ProgramNode
+		 * @return FlatAST The flattened tree, independent of the original
+		 */
+		static FlatAST fromTree(const ASTNode &root);
+
+		/**
+		 * @brief Flatten a tree and append it as the last child of a node
+		 *
+		 * The parent must be the last node or one of its ancestors, so the nodes stay in pre-order.
+		 * Strings are copied, so the tree may be released afterwards.
+		 *
+		 * @param node The root of the subtree to add
+		 * @param parent The parent of the subtree, or NONE for the root of an empty FlatAST
+		 * @return std::uint32_t The index of the subtree's root
+		 * @throws std::invalid_argument if the parent is not on the path to the last node
+		 */
+		std::uint32_t append(const ASTNode &node, std::uint32_t parent);
+
+		/**
+		 * @brief Get the number of nodes (including case records)
+		 */
+		[[nodiscard]] std::size_t size() const { return kindBytes.size(); }
+
+		[[nodiscard]] bool isCase(std::uint32_t node) const { return kindBytes[node] == CASE_KIND; }
+
+		/**
+		 * @brief Get the kind of a node that is not a case record
+		 */
+		[[nodiscard]] NodeKind kind(std::uint32_t node) const { return static_cast<NodeKind>(kindBytes[node]); }
+
+		[[nodiscard]] std::uint8_t detail(std::uint32_t node) const { return details[node]; }
+
+		[[nodiscard]] std::uint32_t parent(std::uint32_t node) const { return parents[node]; }
+
+		[[nodiscard]] std::uint32_t firstChild(std::uint32_t node) const { return firstChildren[node]; }
+
+		[[nodiscard]] std::uint32_t nextSibling(std::uint32_t node) const { return nextSiblings[node]; }
+
+		[[nodiscard]] std::uint32_t slot(std::uint32_t node) const { return slots[node]; }
+
+		[[nodiscard]] std::string_view text(std::uint32_t node) const { return texts[node]; }
+
+		[[nodiscard]] int value(std::uint32_t node) const { return values[node]; }
+
+		[[nodiscard]] const lexer::SourceLocation &location(std::uint32_t node) const { return locations[node]; }
+
+		/**
+		 * @brief Find the child filling a slot
+		 *
+		 * @return std::uint32_t The child's index, or NONE if the slot is empty
+		 */
+		[[nodiscard]] std::uint32_t child(std::uint32_t node, std::uint32_t slot) const;
+
+		/**
+		 * @brief Get the index one past the last node of a subtree
+		 */
+		[[nodiscard]] std::uint32_t subtreeEnd(std::uint32_t node) const;
+
+		// Whole arrays, for linear scans
+		[[nodiscard]] const std::vector<std::uint8_t> &kinds() const { return kindBytes; }
+
+		[[nodiscard]] const std::vector<std::uint32_t> &parentIndices() const { return parents; }
+
+	private:
+		friend class FlatBuilder;
+
+		std::vector<std::uint8_t> kindBytes;
+		std::vector<std::uint8_t> details;
+		std::vector<std::uint32_t> parents;
+		std::vector<std::uint32_t> firstChildren;
+		std::vector<std::uint32_t> nextSiblings;
+		std::vector<std::uint32_t> slots;
+		std::vector<std::string_view> texts;
+		std::vector<std::int32_t> values;
+		std::vector<lexer::SourceLocation> locations;
+		std::unique_ptr<ASTContext> strings;  // Owns the text of the nodes
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_FLAT_AST_H
@@ -0,0 +1,66 @@
+#ifndef TINYC_AST_NODE_KIND_H
+#define TINYC_AST_NODE_KIND_H
+
+#include <cstdint>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Identifies the concrete class of an AST node
+	 *
+	 * One enumerator per node class, in the order of the NodeVisitor interface. The values
+	 * are stored in serialized ASTs, so new kinds must be added at the end.
+	 */
+	enum class NodeKind : std::uint8_t {
+		// Program nodes
+		PROGRAM,
+
+		// Declaration nodes
+		VARIABLE,
+		MULTIPLE_DECLARATION,
+		PARAMETER,
+		FUNCTION_DECLARATION,
+		STRUCT_DECLARATION,
+		FUNCTION_POINTER_DECLARATION,
+
+		// Type nodes
+		PRIMITIVE_TYPE,
+		NAMED_TYPE,
+		POINTER_TYPE,
+
+		// Expression nodes
+		LITERAL,
+		IDENTIFIER,
+		BINARY_EXPRESSION,
+		UNARY_EXPRESSION,
+		CAST_EXPRESSION,
+		CALL_EXPRESSION,
+		INDEX_EXPRESSION,
+		MEMBER_EXPRESSION,
+		COMMA_EXPRESSION,
+
+		// Statement nodes
+		BLOCK_STATEMENT,
+		EXPRESSION_STATEMENT,
+		IF_STATEMENT,
+		WHILE_STATEMENT,
+		DO_WHILE_STATEMENT,
+		FOR_STATEMENT,
+		SWITCH_STATEMENT,
+		BREAK_STATEMENT,
+		CONTINUE_STATEMENT,
+		RETURN_STATEMENT,
+
+		// Error nodes
+		ERROR_NODE  // Not ERROR, which windows.h defines as a macro
+	};
+
+	// Number of node kinds
+	constexpr int NODE_KIND_COUNT = static_cast<int>(NodeKind::ERROR_NODE) + 1;
+
+	// Kind byte of switch case records in flattened and serialized ASTs (cases are not node classes)
+	constexpr std::uint8_t CASE_KIND = 0xFF;
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_NODE_KIND_H
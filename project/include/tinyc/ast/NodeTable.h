@@ -0,0 +1,94 @@
+#ifndef TINYC_AST_NODE_TABLE_H
+#define TINYC_AST_NODE_TABLE_H
+
+#include "tinyc/ast/NodeKind.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::ast {
+
+	class ASTNode;
+
+	/**
+	 * @brief Shallow structure of a node: its kind, fields and children, but not its location
+	 *
+	 * Children are compared by identity. When they are themselves shared nodes (see NodeTable),
+	 * two keys are equal exactly when they describe equal subtrees.
+	 */
+	struct NodeKey {
+		NodeKind kind;
+		int detail;             // Primitive, literal or member kind, or the operator
+		std::string_view text;  // Name, member name or literal value
+		const ASTNode *first;   // Children in the order of the node's constructor
+		const ASTNode *second;
+
+		explicit NodeKey(NodeKind kind, int detail = 0, std::string_view text = {},
+						 const ASTNode *first = nullptr, const ASTNode *second = nullptr)
+				: kind(kind), detail(detail), text(text), first(first), second(second) {}
+
+		/**
+		 * @brief Get the key of a type node, or of an expression node without child lists
+		 *
+		 * @throws std::invalid_argument for other nodes (declarations, statements, calls, ...)
+		 */
+		static NodeKey of(const ASTNode &node);
+
+		bool operator==(const NodeKey &other) const {
+			return kind == other.kind && detail == other.detail && text == other.text &&
+				   first == other.first && second == other.second;
+		}
+	};
+
+	/**
+	 * @brief Hash-consing table holding one node per distinct key
+	 *
+	 * Generated programs spell the same types and expressions over and over. A tree built
+	 * bottom-up through this table (see ASTContext::createShared()) keeps a single node for
+	 * every distinct subtree, whose key is then found without comparing the subtrees. The
+	 * table does not own the nodes, they stay in their ASTContext.
+	 */
+	class NodeTable {
+	public:
+		/**
+		 * @brief Get the node of a key, adding the one make() creates on first use
+		 *
+		 * @param key The key
+		 * @param make Called without arguments to create the node, which must have the given key
+		 * @return ASTNode* The node of the key, the same for equal keys
+		 */
+		template<typename Make>
+		ASTNode *intern(const NodeKey &key, Make &&make) {
+			std::uint64_t keyHash = hash(key);
+			Entry &entry = find(key, keyHash);
+			if (entry.node == nullptr) {
+				entry = {keyHash, make()};
+				++used;
+			}
+			return entry.node;
+		}
+
+		/**
+		 * @brief Get the number of distinct nodes in the table
+		 */
+		[[nodiscard]] std::size_t size() const { return used; }
+
+	private:
+		struct Entry {
+			std::uint64_t hash;
+			ASTNode *node;  // Null for a free slot
+		};
+
+		std::vector<Entry> slots;  // Open addressing, a power of two in size
+		std::size_t used = 0;
+
+		static std::uint64_t hash(const NodeKey &key);
+
+		// Find the slot of a key, free if the key is new; grows the table first when half full
+		Entry &find(const NodeKey &key, std::uint64_t keyHash);
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_NODE_TABLE_H
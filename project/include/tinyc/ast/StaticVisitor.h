@@ -0,0 +1,118 @@
+#ifndef TINYC_AST_STATIC_VISITOR_H
+#define TINYC_AST_STATIC_VISITOR_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/NodeKind.h"
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Compile-time dispatched visitor base (CRTP)
+	 *
+	 * dispatch() switches on the node's kind and calls Derived::visit() with the node cast to
+	 * its concrete class, so no virtual call is made and the handlers can be inlined. Derived
+	 * must provide a visit() overload for every node class; a member template
+	 * `Result visit(const T &)` can serve as the handler for all classes without their own.
+	 * Handlers may return a value of type Result.
+	 *
+	 * A visitor can also implement NodeVisitor to stay usable with accept(). Marking it final
+	 * then lets the compiler bind dispatch()'s calls to its visit() overrides directly.
+	 *
+	 * @tparam Derived The visitor class
+	 * @tparam Result Return type of the handlers
+	 */
+	template<typename Derived, typename Result = void>
+	class StaticVisitor {
+	public:
+		/**
+		 * @brief Call the handler for the concrete class of a node
+		 */
+		Result dispatch(const ASTNode &node) {
+			Derived &self = static_cast<Derived &>(*this);
+
+			switch (node.getNodeKind()) {
+				// Program nodes
+				case NodeKind::PROGRAM:
+					return self.visit(static_cast<const ProgramNode &>(node));
+
+				// Declaration nodes
+				case NodeKind::VARIABLE:
+					return self.visit(static_cast<const VariableNode &>(node));
+				case NodeKind::MULTIPLE_DECLARATION:
+					return self.visit(static_cast<const MultipleDeclarationNode &>(node));
+				case NodeKind::PARAMETER:
+					return self.visit(static_cast<const ParameterNode &>(node));
+				case NodeKind::FUNCTION_DECLARATION:
+					return self.visit(static_cast<const FunctionDeclarationNode &>(node));
+				case NodeKind::STRUCT_DECLARATION:
+					return self.visit(static_cast<const StructDeclarationNode &>(node));
+				case NodeKind::FUNCTION_POINTER_DECLARATION:
+					return self.visit(static_cast<const FunctionPointerDeclarationNode &>(node));
+
+				// Type nodes
+				case NodeKind::PRIMITIVE_TYPE:
+					return self.visit(static_cast<const PrimitiveTypeNode &>(node));
+				case NodeKind::NAMED_TYPE:
+					return self.visit(static_cast<const NamedTypeNode &>(node));
+				case NodeKind::POINTER_TYPE:
+					return self.visit(static_cast<const PointerTypeNode &>(node));
+
+				// Expression nodes
+				case NodeKind::LITERAL:
+					return self.visit(static_cast<const LiteralNode &>(node));
+				case NodeKind::IDENTIFIER:
+					return self.visit(static_cast<const IdentifierNode &>(node));
+				case NodeKind::BINARY_EXPRESSION:
+					return self.visit(static_cast<const BinaryExpressionNode &>(node));
+				case NodeKind::UNARY_EXPRESSION:
+					return self.visit(static_cast<const UnaryExpressionNode &>(node));
+				case NodeKind::CAST_EXPRESSION:
+					return self.visit(static_cast<const CastExpressionNode &>(node));
+				case NodeKind::CALL_EXPRESSION:
+					return self.visit(static_cast<const CallExpressionNode &>(node));
+				case NodeKind::INDEX_EXPRESSION:
+					return self.visit(static_cast<const IndexExpressionNode &>(node));
+				case NodeKind::MEMBER_EXPRESSION:
+					return self.visit(static_cast<const MemberExpressionNode &>(node));
+				case NodeKind::COMMA_EXPRESSION:
+					return self.visit(static_cast<const CommaExpressionNode &>(node));
+
+				// Statement nodes
+				case NodeKind::BLOCK_STATEMENT:
+					return self.visit(static_cast<const BlockStatementNode &>(node));
+				case NodeKind::EXPRESSION_STATEMENT:
+					return self.visit(static_cast<const ExpressionStatementNode &>(node));
+				case NodeKind::IF_STATEMENT:
+					return self.visit(static_cast<const IfStatementNode &>(node));
+				case NodeKind::WHILE_STATEMENT:
+					return self.visit(static_cast<const WhileStatementNode &>(node));
+				case NodeKind::DO_WHILE_STATEMENT:
+					return self.visit(static_cast<const DoWhileStatementNode &>(node));
+				case NodeKind::FOR_STATEMENT:
+					return self.visit(static_cast<const ForStatementNode &>(node));
+				case NodeKind::SWITCH_STATEMENT:
+					return self.visit(static_cast<const SwitchStatementNode &>(node));
+				case NodeKind::BREAK_STATEMENT:
+					return self.visit(static_cast<const BreakStatementNode &>(node));
+				case NodeKind::CONTINUE_STATEMENT:
+					return self.visit(static_cast<const ContinueStatementNode &>(node));
+				case NodeKind::RETURN_STATEMENT:
+					return self.visit(static_cast<const ReturnStatementNode &>(node));
+
+				// Error nodes
+				case NodeKind::ERROR_NODE:
+					return self.visit(static_cast<const ErrorNode &>(node));
+			}
+
+			// Every kind is handled above; this keeps the compiler from warning about falling off
+#if defined(_MSC_VER) && !defined(__clang__)
+			__assume(false);
+#else
+			__builtin_unreachable();
+#endif
+		}
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_STATIC_VISITOR_H
@@ -0,0 +1,58 @@
+#ifndef TINYC_AST_STRUCTURAL_HASH_H
+#define TINYC_AST_STRUCTURAL_HASH_H
+
+#include "tinyc/ast/ASTNode.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Hashes of the structure of subtrees, for caching and diffing ASTs
+	 *
+	 * The hash of a node covers its kind, its fields (names, operators, literal values, ...)
+	 * and the hashes of its children, but not its location or the source name of a program.
+	 * Equal subtrees therefore hash the same wherever they appear, in any tree. The hash is
+	 * FNV-1a over a fixed encoding of the structure, so it does not change between runs,
+	 * builds or platforms, and can be stored.
+	 *
+	 * The hash of every node visited is cached by address, so hashing a tree once gives the
+	 * hashes of all its subtrees, and shared subtrees (see ASTContext::createShared()) are
+	 * hashed once. The cache is only valid as long as the hashed trees are neither changed
+	 * nor released.
+	 */
+	class StructuralHasher {
+	public:
+		/**
+		 * @brief Get the structural hash of a subtree
+		 *
+		 * @param node The root of the subtree
+		 * @return std::uint64_t The hash, equal for structurally equal subtrees
+		 */
+		std::uint64_t hash(const ASTNode &node);
+
+		/**
+		 * @brief Forget the cached hashes, e.g. before the hashed trees are released
+		 */
+		void clear() { hashes.clear(); }
+
+	private:
+		std::unordered_map<const ASTNode *, std::uint64_t> hashes;
+	};
+
+	/**
+	 * @brief Get the structural hash of a subtree (see StructuralHasher)
+	 */
+	std::uint64_t structuralHash(const ASTNode &node);
+
+	/**
+	 * @brief Check if two subtrees have the same structure, ignoring their locations
+	 *
+	 * Structurally equal subtrees have the same structural hash. Shared nodes compare equal
+	 * by identity, without visiting their children.
+	 */
+	bool structurallyEqual(const ASTNode &left, const ASTNode &right);
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_STRUCTURAL_HASH_H
@@ -0,0 +1,105 @@
+#ifndef TINYC_AST_SYMBOL_TABLE_H
+#define TINYC_AST_SYMBOL_TABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::ast {
+
+	// Dense id of an interned name: the names of a table are numbered from 0
+	using Symbol = std::uint32_t;
+
+	/**
+	 * @brief Table holding one copy of every distinct name of a compilation
+	 *
+	 * Programs use the same few identifiers and type names over and over; the parser interns
+	 * them here, so the nodes of a tree all view a single copy of each name. Two names
+	 * interned in the same table are equal exactly when their views point to the same
+	 * characters, and symbol() maps an interned name to its id without hashing it again, so
+	 * later passes can compare names as integers.
+	 *
+	 * The table is split into shards by hash. A concurrent table locks the shard of a name
+	 * while looking it up, so the parsers of several threads can share one table; the ids are
+	 * then numbered in no particular order.
+	 */
+	class SymbolTable {
+	public:
+		/**
+		 * @brief Construct an empty table
+		 *
+		 * @param concurrent Whether several threads intern names at the same time
+		 * @param upstream Resource the copies of the names are allocated from
+		 */
+		explicit SymbolTable(bool concurrent = false,
+							 std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+		SymbolTable(const SymbolTable &) = delete;
+
+		SymbolTable &operator=(const SymbolTable &) = delete;
+
+		/**
+		 * @brief Get the table's copy of a name, adding it on first use
+		 *
+		 * @param name The name
+		 * @return std::string_view The copy, valid as long as the table and the same for equal names
+		 */
+		std::string_view intern(std::string_view name);
+
+		/**
+		 * @brief Get the id of an interned name
+		 *
+		 * @param interned A view returned by intern(), of this or any other table
+		 * @return Symbol The id in the table the name was interned in
+		 */
+		[[nodiscard]] static Symbol symbol(std::string_view interned) {
+			// Each copy is stored right after its id
+			Symbol id;
+			std::memcpy(&id, interned.data() - sizeof(Symbol), sizeof(Symbol));
+			return id;
+		}
+
+		/**
+		 * @brief Get the number of distinct names interned
+		 */
+		[[nodiscard]] std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr std::size_t SHARD_BITS = 4;
+
+		struct Entry {
+			std::uint64_t hash;
+			const char *text;       // Null for a free slot
+			std::uint32_t length;
+		};
+
+		struct Shard {
+			explicit Shard(std::pmr::memory_resource *upstream) : storage(1024, upstream) {}
+
+			std::mutex mutex;                            // Guards the shard of a concurrent table
+			std::vector<Entry> slots;                    // Open addressing, a power of two in size
+			std::size_t used = 0;
+			std::pmr::monotonic_buffer_resource storage; // The ids and copies of the names
+		};
+
+		bool concurrent;
+		std::atomic<Symbol> count{0};
+		std::array<std::unique_ptr<Shard>, std::size_t(1) << SHARD_BITS> shards;
+
+		// Find or add a name in its shard, the shard being locked if needed
+		std::string_view insert(Shard &shard, std::uint64_t hash, std::string_view name);
+
+		// Double the slots of a shard (to 64 for an empty shard)
+		static void grow(Shard &shard);
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_SYMBOL_TABLE_H
@@ -0,0 +1,141 @@
+#ifndef TINYC_AST_BINARY_VISITOR_H
+#define TINYC_AST_BINARY_VISITOR_H
+
+#include "tinyc/ast/NodeVisitor.h"
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/BinaryAST.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Visitor serializing an AST into the binary format described in BinaryAST.h
+	 *
+	 * The visited tree is collected into the node, child and string tables, which write()
+	 * then emits in one go. The tree must stay alive until the visitor is done with it.
+	 */
+	class BinaryVisitor : public NodeVisitor {
+	public:
+		BinaryVisitor() = default;
+
+		/**
+		 * @brief Write the binary AST of the visited tree
+		 */
+		void write(OutputSink &out) const;
+
+		/**
+		 * @brief Get the binary AST of the visited tree as a string of bytes
+		 */
+		[[nodiscard]] std::string getBinary() const;
+
+		// Program nodes
+		void visit(const ProgramNode &node) override;
+
+		// Declaration nodes
+		void visit(const VariableNode &node) override;
+
+		void visit(const MultipleDeclarationNode &node) override;
+
+		void visit(const ParameterNode &node) override;
+
+		void visit(const FunctionDeclarationNode &node) override;
+
+		void visit(const StructDeclarationNode &node) override;
+
+		void visit(const FunctionPointerDeclarationNode &node) override;
+
+		// Type nodes
+		void visit(const PrimitiveTypeNode &node) override;
+
+		void visit(const NamedTypeNode &node) override;
+
+		void visit(const PointerTypeNode &node) override;
+
+		// Expression nodes
+		void visit(const LiteralNode &node) override;
+
+		void visit(const IdentifierNode &node) override;
+
+		void visit(const BinaryExpressionNode &node) override;
+
+		void visit(const UnaryExpressionNode &node) override;
+
+		void visit(const CastExpressionNode &node) override;
+
+		void visit(const CallExpressionNode &node) override;
+
+		void visit(const IndexExpressionNode &node) override;
+
+		void visit(const MemberExpressionNode &node) override;
+
+		void visit(const CommaExpressionNode &node) override;
+
+		// Statement nodes
+		void visit(const BlockStatementNode &node) override;
+
+		void visit(const ExpressionStatementNode &node) override;
+
+		void visit(const IfStatementNode &node) override;
+
+		void visit(const WhileStatementNode &node) override;
+
+		void visit(const DoWhileStatementNode &node) override;
+
+		void visit(const ForStatementNode &node) override;
+
+		void visit(const SwitchStatementNode &node) override;
+
+		void visit(const BreakStatementNode &node) override;
+
+		void visit(const ContinueStatementNode &node) override;
+
+		void visit(const ReturnStatementNode &node) override;
+
+		// Error nodes
+		void visit(const ErrorNode &node) override;
+
+	private:
+		std::vector<binary::NodeRecord> nodes;
+		std::vector<std::uint32_t> children;
+		std::vector<std::uint32_t> stringOffsets{0};
+		std::string stringData;
+		std::unordered_map<std::string_view, std::uint32_t> stringIds;  // Keys point into the tree
+
+		/**
+		 * @brief Append a record for a node
+		 *
+		 * @param kind Record kind (NodeKind or CASE_RECORD)
+		 * @param location Location of the node
+		 * @param childCount Number of child slots to reserve
+		 * @return std::uint32_t Index of the new record
+		 */
+		std::uint32_t addRecord(std::uint8_t kind, const lexer::SourceLocation &location, std::size_t childCount);
+
+		std::uint32_t addNode(NodeKind kind, const ASTNode &node, std::size_t childCount) {
+			return addRecord(static_cast<std::uint8_t>(kind), node.getLocation(), childCount);
+		}
+
+		/**
+		 * @brief Visit a child (if any) and store its index in a child slot of a record
+		 */
+		void setChild(std::uint32_t record, std::size_t slot, const ASTNodePtr &child);
+
+		/**
+		 * @brief Visit a list of children into consecutive slots starting at firstSlot
+		 */
+		void setChildren(std::uint32_t record, std::size_t firstSlot, const NodeList &list);
+
+		/**
+		 * @brief Get the id of a string, adding it to the string table if needed
+		 */
+		std::uint32_t intern(std::string_view text);
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_BINARY_VISITOR_H
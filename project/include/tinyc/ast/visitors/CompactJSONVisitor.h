@@ -0,0 +1,135 @@
+#ifndef TINYC_AST_COMPACT_JSON_VISITOR_H
+#define TINYC_AST_COMPACT_JSON_VISITOR_H
+
+#include "tinyc/ast/NodeVisitor.h"
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/StaticVisitor.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Visitor writing the compact (not pretty printed) JSON of an AST
+	 *
+	 * The output is byte for byte that of JSONVisitor without pretty printing, produced with
+	 * less work per field: the keys and punctuation between two values of a node are written
+	 * as one precomputed fragment, commas are part of those fragments instead of being decided
+	 * field by field, values are only escaped when a scan finds a character that needs it, and
+	 * the location prefix with the escaped file name is kept for as long as the file does not
+	 * change. Apart from that prefix, nothing is allocated while a tree is written.
+	 */
+	class CompactJSONVisitor final : public NodeVisitor, public StaticVisitor<CompactJSONVisitor> {
+	public:
+		/**
+		 * @brief Construct a visitor writing to a sink
+		 *
+		 * The sink is not flushed by the visitor.
+		 *
+		 * @param sink Destination of the JSON, must outlive the visitor
+		 */
+		explicit CompactJSONVisitor(OutputSink &sink) : json(sink) {}
+
+		/**
+		 * @brief Write a program, with the elements of its declarations array written by a callback
+		 *
+		 * @see JSONVisitor::writeProgram()
+		 */
+		void writeProgram(const ProgramNode &node, const std::function<void()> &declarations);
+
+		/**
+		 * @brief Write the declarations [begin, end) of a program as elements of its declarations array
+		 *
+		 * @see JSONVisitor::writeDeclarations()
+		 */
+		void writeDeclarations(const ProgramNode &node, std::size_t begin, std::size_t end);
+
+		// Program nodes
+		void visit(const ProgramNode &node) override;
+
+		// Declaration nodes
+		void visit(const VariableNode &node) override;
+
+		void visit(const MultipleDeclarationNode &node) override;
+
+		void visit(const ParameterNode &node) override;
+
+		void visit(const FunctionDeclarationNode &node) override;
+
+		void visit(const StructDeclarationNode &node) override;
+
+		void visit(const FunctionPointerDeclarationNode &node) override;
+
+		// Type nodes
+		void visit(const PrimitiveTypeNode &node) override;
+
+		void visit(const NamedTypeNode &node) override;
+
+		void visit(const PointerTypeNode &node) override;
+
+		// Expression nodes
+		void visit(const LiteralNode &node) override;
+
+		void visit(const IdentifierNode &node) override;
+
+		void visit(const BinaryExpressionNode &node) override;
+
+		void visit(const UnaryExpressionNode &node) override;
+
+		void visit(const CastExpressionNode &node) override;
+
+		void visit(const CallExpressionNode &node) override;
+
+		void visit(const IndexExpressionNode &node) override;
+
+		void visit(const MemberExpressionNode &node) override;
+
+		void visit(const CommaExpressionNode &node) override;
+
+		// Statement nodes
+		void visit(const BlockStatementNode &node) override;
+
+		void visit(const ExpressionStatementNode &node) override;
+
+		void visit(const IfStatementNode &node) override;
+
+		void visit(const WhileStatementNode &node) override;
+
+		void visit(const DoWhileStatementNode &node) override;
+
+		void visit(const ForStatementNode &node) override;
+
+		void visit(const SwitchStatementNode &node) override;
+
+		void visit(const BreakStatementNode &node) override;
+
+		void visit(const ContinueStatementNode &node) override;
+
+		void visit(const ReturnStatementNode &node) override;
+
+		// Error nodes
+		void visit(const ErrorNode &node) override;
+
+	private:
+		OutputSink &json;
+		std::uint32_t locationFile = UINT32_MAX; // File whose prefix is in locationPrefix, if any
+		std::string locationPrefix;              // "location": {"filename": "<file>","line":<space>
+
+		/**
+		 * @brief Write the elements of an array, separated by commas (without the brackets)
+		 */
+		void writeList(const NodeList &nodes);
+
+		/**
+		 * @brief Write the location field and close the object of a node
+		 */
+		void endNode(const lexer::SourceLocation &location);
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_COMPACT_JSON_VISITOR_H
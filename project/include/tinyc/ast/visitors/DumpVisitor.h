@@ -3,6 +3,7 @@
 
 #include "tinyc/ast/NodeVisitor.h"
 #include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/StaticVisitor.h"
 #include <ostream>
 #include <string>
 
@@ -12,8 +13,9 @@ namespace tinyc::ast {
  * @brief Visitor for dumping AST nodes to an output stream
  * 
  * This visitor implements the dump (into console) functionality for all node types.
+ * Children are visited through StaticVisitor::dispatch() rather than accept().
  */
-	class DumpVisitor : public NodeVisitor {
+	class DumpVisitor final : public NodeVisitor, public StaticVisitor<DumpVisitor> {
 	public:
 		/**
 		 * @brief Construct a new Dump Visitor
@@ -85,6 +87,9 @@ namespace tinyc::ast {
 
 		void visit(const ReturnStatementNode &node) override;
 
+		// Error nodes
+		void visit(const ErrorNode &node) override;
+
 	private:
 		std::ostream &os;
 		int indentLevel = 0;
@@ -3,23 +3,74 @@
 
 #include "tinyc/ast/NodeVisitor.h"
 #include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/StaticVisitor.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
-#include <sstream>
+#include <string_view>
 
 namespace tinyc::ast {
 
+	/**
+	 * @brief Check whether a string contains characters that writeJSONEscaped() escapes
+	 */
+	bool needsJSONEscape(std::string_view text);
+
+	/**
+	 * @brief Write a string escaped for JSON (without the quotes)
+	 *
+	 * @param out Destination of the escaped string
+	 * @param text The string
+	 */
+	void writeJSONEscaped(OutputSink &out, std::string_view text);
+
 	/**
 	 * @brief Visitor for converting AST nodes to JSON
+	 *
+	 * The JSON is either collected in memory (see getJSON()) or streamed into an OutputSink
+	 * while the tree is walked. Children are visited through StaticVisitor::dispatch(), so
+	 * only the root is reached through accept().
 	 */
-	class JSONVisitor : public NodeVisitor {
+	class JSONVisitor final : public NodeVisitor, public StaticVisitor<JSONVisitor> {
 	public:
 		explicit JSONVisitor(bool prettyPrint);
 
+		/**
+		 * @brief Construct a visitor writing to a sink
+		 *
+		 * The sink is not flushed by the visitor.
+		 *
+		 * @param sink Destination of the JSON, must outlive the visitor
+		 * @param prettyPrint Pretty print the JSON
+		 */
+		JSONVisitor(OutputSink &sink, bool prettyPrint);
+
 		/**
 		 * @brief Get the resulting JSON string
+		 *
+		 * @return std::string The JSON, or an empty string when writing to a sink
 		 */
 		std::string getJSON() const;
 
+		/**
+		 * @brief Write a program, with the elements of its declarations array written by a callback
+		 *
+		 * @param node The program, the root of the tree
+		 * @param declarations Writes what writeDeclarations() writes for all declarations of the
+		 *                     program, e.g. the outputs for consecutive ranges one after another
+		 */
+		void writeProgram(const ProgramNode &node, const std::function<void()> &declarations);
+
+		/**
+		 * @brief Write the declarations [begin, end) of a program as elements of its declarations array
+		 *
+		 * The output, separators and indentation included, is the part visiting the program
+		 * writes for them, so consecutive ranges can be written by separate visitors.
+		 */
+		void writeDeclarations(const ProgramNode &node, std::size_t begin, std::size_t end);
+
 		// Program nodes
 		void visit(const ProgramNode &node) override;
 
@@ -83,15 +134,20 @@ namespace tinyc::ast {
 
 		void visit(const ReturnStatementNode &node) override;
 
+		// Error nodes
+		void visit(const ErrorNode &node) override;
+
 	private:
-		std::ostringstream json;
+		std::unique_ptr<StringSink> ownSink;  // Only used when no sink was given
+		OutputSink &json;
 		int indentLevel = 0;
 		bool prettyPrint = true;
+		mutable std::string indentation;       // Spaces backing getIndent()
 
 		/**
 		 * @brief Add a field to the JSON object
 		 */
-		void addField(const std::string &name, const std::string &value);
+		void addField(const std::string &name, std::string_view value);
 
 		/**
 		* @brief Add a boolean field to the JSON object
@@ -130,8 +186,10 @@ namespace tinyc::ast {
 
 		/**
 		 * @brief Get indentation string
+		 *
+		 * The view is valid until the next call.
 		 */
-		std::string getIndent() const;
+		std::string_view getIndent() const;
 
 		/**
 		 * @brief Increase indentation level
@@ -149,9 +207,9 @@ namespace tinyc::ast {
 		void addNodeField(const std::string &name, const ASTNode &node);
 
 		/**
-		 * @brief Escape a string for JSON
+		 * @brief Write a string escaped for JSON (without the quotes)
 		 */
-		static std::string escapeString(const std::string &s);
+		void writeEscaped(std::string_view s);
 
 		/**
 		 * @brief Add a source location field to the JSON object
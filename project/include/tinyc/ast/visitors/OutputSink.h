@@ -0,0 +1,148 @@
+#ifndef TINYC_AST_OUTPUT_SINK_H
+#define TINYC_AST_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Buffered byte sink the AST writers emit into
+	 *
+	 * Text is collected in a fixed-size buffer and handed to the destination in large blocks,
+	 * so output is produced while a tree is being walked without building the whole document
+	 * in memory. Numbers are formatted without iostreams, matching the default std::ostream
+	 * formatting ("%g" with 6 significant digits for doubles).
+	 */
+	class OutputSink {
+	public:
+		static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+		OutputSink();
+
+		OutputSink(const OutputSink &) = delete;
+
+		OutputSink &operator=(const OutputSink &) = delete;
+
+		virtual ~OutputSink() = default;
+
+		OutputSink &operator<<(std::string_view text);
+
+		OutputSink &operator<<(char c);
+
+		OutputSink &operator<<(int value);
+
+		OutputSink &operator<<(double value);
+
+		/**
+		 * @brief Write n copies of a character
+		 */
+		void fill(char c, std::size_t n);
+
+		/**
+		 * @brief Pass everything buffered so far on to the destination
+		 */
+		void flush();
+
+		/**
+		 * @brief Get the number of bytes written so far, including those still buffered
+		 */
+		[[nodiscard]] std::size_t bytesWritten() const { return delivered + used; }
+
+	protected:
+		/**
+		 * @brief Deliver a block of output to the destination
+		 *
+		 * Sinks must call flush() in their destructors, the base class cannot.
+		 */
+		virtual void write(const char *data, std::size_t size) = 0;
+
+	private:
+		std::unique_ptr<char[]> buffer;
+		std::size_t used = 0;
+		std::size_t delivered = 0;
+	};
+
+	/**
+	 * @brief Sink collecting the output in a string
+	 */
+	class StringSink final : public OutputSink {
+	public:
+		~StringSink() override = default;
+
+		/**
+		 * @brief Get everything written so far
+		 */
+		const std::string &str();
+
+		/**
+		 * @brief Discard everything written so far, keeping the string's capacity
+		 */
+		void clear();
+
+	protected:
+		void write(const char *data, std::size_t size) override;
+
+	private:
+		std::string text;
+	};
+
+	/**
+	 * @brief Sink writing to a std::ostream
+	 */
+	class StreamSink final : public OutputSink {
+	public:
+		explicit StreamSink(std::ostream &stream) : stream(stream) {}
+
+		~StreamSink() override { flush(); }
+
+	protected:
+		void write(const char *data, std::size_t size) override;
+
+	private:
+		std::ostream &stream;
+	};
+
+	/**
+	 * @brief Sink writing to a C stdio stream
+	 *
+	 * @throws std::runtime_error from flush() if the stream reports a write error
+	 */
+	class FileSink final : public OutputSink {
+	public:
+		explicit FileSink(std::FILE *file) : file(file) {}
+
+		~FileSink() override;
+
+	protected:
+		void write(const char *data, std::size_t size) override;
+
+	private:
+		std::FILE *file;
+	};
+
+	/**
+	 * @brief Sink writing to a POSIX file descriptor
+	 *
+	 * @throws std::runtime_error from flush() if the descriptor reports a write error
+	 */
+	class FdSink final : public OutputSink {
+	public:
+		explicit FdSink(int fd) : fd(fd) {}
+
+		~FdSink() override;
+
+	protected:
+		void write(const char *data, std::size_t size) override;
+
+	private:
+		int fd;
+	};
+
+} // namespace tinyc::ast
+
+#endif // TINYC_AST_OUTPUT_SINK_H
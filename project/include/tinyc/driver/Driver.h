@@ -0,0 +1,194 @@
+#ifndef TINYC_DRIVER_H
+#define TINYC_DRIVER_H
+
+#include "tinyc/driver/Stats.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::driver {
+
+	class OutputCache;
+
+	/**
+	 * @brief Process exit codes, shared by single-file and batch runs
+	 *
+	 * A batch exits with the highest code of its files.
+	 */
+	enum ExitCode {
+		EXIT_OK = 0,
+		EXIT_LEXER_ERROR = 1,
+		EXIT_PARSER_ERROR = 2,
+		EXIT_OTHER_ERROR = 3
+	};
+
+	/**
+	 * @brief Serialization of the AST
+	 */
+	enum class OutputFormat {
+		JSON,    // JSON text
+		BINARY   // Binary AST (see ast/BinaryAST.h)
+	};
+
+	/**
+	 * @brief What to do with each input
+	 */
+	struct CompileOptions {
+		bool lexOnly = false;      // Output tokens instead of the AST
+		bool prettyPrint = false;  // Pretty print the JSON AST
+		OutputFormat format = OutputFormat::JSON;
+		bool recover = false;      // Keep parsing after syntax errors (see parser::ParserOptions)
+		std::size_t maxErrors = 20;  // Errors reported before a recovering parse stops, 0 for no limit
+		std::size_t parseJobs = 1;   // Threads parsing one input (see ParallelParser), 0 for one per hardware thread
+		std::size_t serializeJobs = 1;  // Threads writing the JSON of one input (see writeJSON()), 0 for one per hardware thread
+		StatsFormat stats = StatsFormat::NONE;  // Collect CompileStats, and how batches report them
+		std::shared_ptr<OutputCache> cache;     // Reuse the outputs of unchanged inputs, if set (see OutputCache)
+	};
+
+	/**
+	 * @brief Outcome of compiling one input
+	 */
+	struct CompileResult {
+		std::string output;        // Token listing or AST, empty on error unless recovering
+		std::string diagnostics;   // Error message lines, empty on success
+		int exitCode = EXIT_OK;
+		CompileStats stats;        // Phase times and output size; counts and AST bytes only when options.stats is set
+	};
+
+	/**
+	 * @brief Options of a batch run
+	 */
+	struct BatchOptions {
+		std::size_t jobs = 0;      // Worker threads, 0 for one per hardware thread
+		std::string outputDir;     // Write one file per input here instead of to the stream
+	};
+
+	/**
+	 * @brief Lex or parse a source buffer
+	 *
+	 * Lexer, parser and other errors are caught and reported in the result, so this can be
+	 * called concurrently from several threads.
+	 *
+	 * @param source The source to compile
+	 * @param options What to produce
+	 * @return CompileResult The output or diagnostics and the exit code
+	 */
+	CompileResult compileSource(const lexer::SourceBuffer &source, const CompileOptions &options);
+
+	/**
+	 * @brief Compile a source buffer into a sink, building the AST in a given arena
+	 *
+	 * Writes what compileSource() would return as output; the output field of the result stays
+	 * empty. The arena is only used when parsing on one thread, and must be reset by the caller;
+	 * its blocks are not counted in the statistics (astBytes stays 0).
+	 *
+	 * @param source The source to compile
+	 * @param options What to produce
+	 * @param out Sink receiving the output (not flushed)
+	 * @param arena Context the AST is built in
+	 * @return CompileResult The diagnostics and the exit code
+	 */
+	CompileResult compileSource(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+								const std::shared_ptr<ast::ASTContext> &arena);
+
+	/**
+	 * @brief Load a file and compile it as compileSource() does
+	 */
+	CompileResult compileFile(const std::string &filename, const CompileOptions &options);
+
+	/**
+	 * @brief Load a file and stream the output into a sink
+	 *
+	 * Nothing is written for inputs with errors, except for the AST of a recovering parse,
+	 * whose errors are reported in the result as well. The output field of the result stays
+	 * empty. The sink is flushed whenever output was written.
+	 */
+	CompileResult compileFile(const std::string &filename, const CompileOptions &options, ast::OutputSink &out);
+
+	/**
+	 * @brief Compile a stream, such as the standard input, into a sink
+	 *
+	 * In lexer mode the stream is lexed in chunks and each token is written as soon as it is
+	 * lexed, so memory does not grow with the input and output starts before the stream
+	 * ends. A lexer error ends the listing after the tokens before it. The cache is not used
+	 * in lexer mode, since the key needs the whole input.
+	 *
+	 * The parser needs the whole input, so in parser mode the stream is read to its end and
+	 * compiled as compileSource() does.
+	 *
+	 * @param input The stream to read
+	 * @param name Name of the input in the listing and the diagnostics
+	 * @param options What to produce
+	 * @param out Sink receiving the output, flushed at the end
+	 * @return CompileResult The diagnostics and the exit code; the output field stays empty
+	 */
+	CompileResult compileStream(std::istream &input, const std::string &name, const CompileOptions &options,
+								ast::OutputSink &out);
+
+	/**
+	 * @brief Compile many files on a thread pool
+	 *
+	 * Each file gets its own lexer and parser on a worker thread. Outputs are written to out
+	 * (or to outputDir, see outputPathFor()) and diagnostics to err strictly in input order, whatever the order
+	 * the workers finish in. When options.stats is set, the statistics of each file follow its
+	 * diagnostics. Each result is released once written, and workers run at most two files
+	 * each ahead of the file being written, so about 2 * jobs outputs are held at a time.
+	 *
+	 * @param files The input files
+	 * @param options What to produce for each file
+	 * @param batch Thread count and output location
+	 * @param out Stream receiving the outputs when no output directory is set
+	 * @param err Stream receiving the diagnostics
+	 * @return int The highest exit code of all files, or EXIT_OTHER_ERROR without compiling
+	 *         anything if two files would be written to the same output file
+	 */
+	int compileBatch(const std::vector<std::string> &files, const CompileOptions &options,
+					 const BatchOptions &batch, std::ostream &out, std::ostream &err);
+
+	/**
+	 * @brief Path of the output file written for an input in batch mode
+	 *
+	 * The input's file name with its extension replaced by ".json" (".tcast" for binary ASTs,
+	 * ".tokens" when lexing), in outputDir under the input's relative directory, so
+	 * "src/a/main.tc" and "src/b/main.tc" get outputDir/src/a/main.json and
+	 * outputDir/src/b/main.json. Inputs given by an absolute path, or by a relative path
+	 * leaving the working directory, are placed directly in outputDir.
+	 */
+	std::string outputPathFor(const std::string &input, const std::string &outputDir, const CompileOptions &options);
+
+	/**
+	 * @brief Replace each "@file" argument with the arguments listed in that file
+	 *
+	 * Response files hold whitespace-separated arguments; they are not expanded recursively.
+	 *
+	 * @throws std::runtime_error if a response file cannot be read
+	 */
+	std::vector<std::string> expandResponseFiles(const std::vector<std::string> &args);
+
+	/**
+	 * @brief Parse a whole string as a decimal count, such as the value of --jobs
+	 *
+	 * @return bool False, leaving value unchanged, if the string is empty, has other characters
+	 *         than digits or does not fit in a std::size_t
+	 */
+	bool parseCount(std::string_view text, std::size_t &value);
+
+	/**
+	 * @brief Parse a size such as 4096, 64K, 256M or 2G, such as the value of --cache-size
+	 *
+	 * @return bool False, leaving size unchanged, if the string is not a count with an optional
+	 *         K, M or G suffix or the size does not fit in a std::uintmax_t
+	 */
+	bool parseSize(std::string_view text, std::uintmax_t &size);
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_H
@@ -0,0 +1,130 @@
+#ifndef TINYC_DRIVER_OUTPUT_CACHE_H
+#define TINYC_DRIVER_OUTPUT_CACHE_H
+
+#include "tinyc/driver/Driver.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Hash a byte string (MurmurHash3, x64 128-bit variant)
+	 *
+	 * Reads 16 bytes per step, so hashing is much faster than reading the input from disk.
+	 * Not a cryptographic hash.
+	 *
+	 * @param data The bytes to hash
+	 * @param seed Seed of the hash
+	 * @return std::array<std::uint64_t, 2> The two halves of the hash
+	 */
+	std::array<std::uint64_t, 2> hashBytes(std::string_view data, std::uint64_t seed = 0);
+
+	/**
+	 * @brief On-disk cache of compiler outputs, keyed by the input and the options
+	 *
+	 * Each entry is one file in the cache directory holding the output of a successful run
+	 * (token listing, JSON or binary AST). The key covers the source bytes and name, the
+	 * frontend version and build (a hash of its sources) and the options that change the
+	 * output, so an entry can be returned in place of lexing and parsing.
+	 *
+	 * Several threads and processes may share a directory: entries are written to a
+	 * private temporary file and renamed into place, so readers only ever see complete
+	 * entries. Reading an entry refreshes its modification time, and whenever the entries
+	 * written by this process take the directory past its size bound, the least recently
+	 * used ones are removed until it is at three quarters of the bound. Concurrent writers
+	 * can therefore keep the directory slightly above the bound for a while.
+	 *
+	 * The cache never fails a compilation: entries that cannot be read or written are
+	 * treated as misses.
+	 */
+	class OutputCache {
+	public:
+		// Default size bound of the directory in bytes
+		static constexpr std::uintmax_t DEFAULT_MAX_BYTES = 256 * 1024 * 1024;
+
+		/**
+		 * @brief Open a cache directory, creating it if needed
+		 *
+		 * @param directory The cache directory
+		 * @param maxBytes Size bound of the entries in bytes
+		 * @throws std::runtime_error if the directory cannot be created
+		 */
+		explicit OutputCache(std::string directory, std::uintmax_t maxBytes = DEFAULT_MAX_BYTES);
+
+		OutputCache(const OutputCache &) = delete;
+
+		OutputCache &operator=(const OutputCache &) = delete;
+
+		/**
+		 * @brief Compute the key of an input
+		 *
+		 * Covers the source text and name, the frontend version and build, the mode, the output
+		 * format and pretty printing. Recovery and thread options are left out, since only outputs
+		 * of runs without errors are stored and those do not depend on them.
+		 *
+		 * @return std::string 32 hexadecimal digits
+		 */
+		[[nodiscard]] std::string key(const lexer::SourceBuffer &source, const CompileOptions &options) const;
+
+		/**
+		 * @brief Fetch the output stored under a key
+		 *
+		 * @param key A key from key()
+		 * @param output Receives the output on a hit
+		 * @return bool Whether the entry was found
+		 */
+		bool lookup(const std::string &key, std::string &output);
+
+		/**
+		 * @brief Store an output under a key, replacing any previous entry
+		 */
+		void store(const std::string &key, std::string_view output);
+
+		/**
+		 * @brief Remove the least recently used entries until the directory is within the bound
+		 *
+		 * Also removes temporary files left behind by writers that did not finish.
+		 */
+		void evict();
+
+		/**
+		 * @brief Get the cache directory
+		 */
+		[[nodiscard]] const std::string &getDirectory() const { return directory; }
+
+		/**
+		 * @brief Get the number of lookups that found an entry
+		 */
+		[[nodiscard]] std::size_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the number of lookups that found no entry
+		 */
+		[[nodiscard]] std::size_t misses() const { return missCount.load(std::memory_order_relaxed); }
+
+	private:
+		std::string directory;
+		std::uintmax_t maxBytes;
+		std::atomic<std::size_t> hitCount{0};
+		std::atomic<std::size_t> missCount{0};
+		std::atomic<std::uint64_t> temporaryCount{0};
+
+		std::mutex mutex;            // Guards the fields below
+		bool sized = false;          // Whether the directory was scanned yet
+		std::uintmax_t bytes = 0;    // Size of the entries as last scanned, plus those stored since
+
+		[[nodiscard]] std::string pathFor(const std::string &key) const;
+
+		// Scan the directory, removing entries (oldest first) while it is above target bytes
+		std::uintmax_t trim(std::uintmax_t target);
+	};
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_OUTPUT_CACHE_H
@@ -0,0 +1,29 @@
+#ifndef TINYC_DRIVER_PARALLEL_JSON_H
+#define TINYC_DRIVER_PARALLEL_JSON_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstddef>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Write the JSON of an AST, serializing its top-level declarations on several threads
+	 *
+	 * The declarations of a program are independent subtrees. They are split into consecutive
+	 * ranges, each written into a buffer of its own by a worker thread with
+	 * JSONVisitor::writeDeclarations() (CompactJSONVisitor's without pretty printing), and the
+	 * buffers are written between the rest of the program in order as they complete. The
+	 * output is byte for byte that of visiting the tree on one thread, which is what happens
+	 * for one job or fewer than two declarations.
+	 *
+	 * @param ast The root of the tree
+	 * @param out Sink receiving the JSON, written from the calling thread only (not flushed)
+	 * @param prettyPrint Pretty print the JSON
+	 * @param jobs Maximum number of worker threads, 0 for one per hardware thread
+	 */
+	void writeJSON(const ast::ASTNode &ast, ast::OutputSink &out, bool prettyPrint, std::size_t jobs = 1);
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_PARALLEL_JSON_H
@@ -0,0 +1,129 @@
+#ifndef TINYC_DRIVER_PARALLEL_MAP_H
+#define TINYC_DRIVER_PARALLEL_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Number of hardware threads, or 1 if it cannot be determined
+	 */
+	std::size_t defaultThreadCount();
+
+	/**
+	 * @brief Compute task(0) ... task(count - 1) on a set of worker threads
+	 *
+	 * Workers claim indices in increasing order, so results become available roughly in
+	 * index order and can be consumed with get() while later ones are still being computed.
+	 * With a window, workers only start a task once it is less than window indices past the
+	 * last result taken, which bounds the number of results held when the consumer is slower
+	 * than the workers. Exceptions thrown by a task are rethrown from get() for that index. The destructor
+	 * stops workers from claiming new indices and joins them.
+	 *
+	 * @tparam T The result type of a task
+	 */
+	template<typename T>
+	class ParallelMap {
+	public:
+		/**
+		 * @brief Start computing
+		 *
+		 * @param count Number of tasks
+		 * @param jobs Maximum number of worker threads, 0 for defaultThreadCount()
+		 * @param task Function computing the result for an index; called concurrently
+		 * @param window Maximum number of tasks started ahead of the results taken, 0 for no limit
+		 */
+		ParallelMap(std::size_t count, std::size_t jobs, std::function<T(std::size_t)> task, std::size_t window = 0)
+				: task(std::move(task)), results(count), window(window) {
+			futures.reserve(count);
+			for (auto &result: results) {
+				futures.push_back(result.get_future());
+			}
+
+			std::size_t threads = std::min(jobs == 0 ? defaultThreadCount() : jobs, count);
+			workers.reserve(threads);
+			for (std::size_t i = 0; i < threads; ++i) {
+				workers.emplace_back([this]() { work(); });
+			}
+		}
+
+		ParallelMap(const ParallelMap &) = delete;
+
+		ParallelMap &operator=(const ParallelMap &) = delete;
+
+		~ParallelMap() {
+			next.store(results.size());
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopped = true;
+			}
+			taken.notify_all();
+			for (auto &worker: workers) {
+				worker.join();
+			}
+		}
+
+		/**
+		 * @brief Wait for the result of a task and take it
+		 *
+		 * May be called once per index.
+		 */
+		T get(std::size_t index) {
+			T result = futures[index].get();
+			if (window != 0) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					takenCount = std::max(takenCount, index + 1);
+				}
+				taken.notify_all();
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Get the number of worker threads started
+		 */
+		[[nodiscard]] std::size_t threadCount() const { return workers.size(); }
+
+	private:
+		void work() {
+			for (std::size_t index = next++; index < results.size(); index = next++) {
+				if (window != 0) {
+					std::unique_lock<std::mutex> lock(mutex);
+					taken.wait(lock, [&]() { return stopped || index < takenCount + window; });
+					if (stopped) {
+						return;
+					}
+				}
+				try {
+					results[index].set_value(task(index));
+				} catch (...) {
+					results[index].set_exception(std::current_exception());
+				}
+			}
+		}
+
+		std::function<T(std::size_t)> task;
+		std::vector<std::promise<T>> results;
+		std::vector<std::future<T>> futures;
+		std::atomic<std::size_t> next{0};
+		std::size_t window;
+		std::mutex mutex;                  // Guards takenCount and stopped
+		std::condition_variable taken;     // Signalled when a result is taken or on destruction
+		std::size_t takenCount = 0;        // One past the highest index taken with get()
+		bool stopped = false;
+		std::vector<std::thread> workers;
+	};
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_PARALLEL_MAP_H
@@ -0,0 +1,100 @@
+#ifndef TINYC_DRIVER_PARALLEL_PARSER_H
+#define TINYC_DRIVER_PARALLEL_PARSER_H
+
+#include "tinyc/lexer/SourceBuffer.h"
+#include "tinyc/parser/Parser.h"
+#include "tinyc/ast/ASTNode.h"
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Parser splitting one source across threads at top-level declarations
+	 *
+	 * A byte-level pre-scan proposes chunk boundaries after a ';' or '}' at brace depth 0,
+	 * skipping comments and literals. Each chunk is lexed and parsed on a worker thread into
+	 * its own arena, and the declarations are spliced into one ProgramNode in source order.
+	 *
+	 * A chunk is only used if it parsed without errors and its last declaration ended exactly
+	 * at the first token of the next chunk, at the line and column the pre-scan assumed. The
+	 * chunks before it then prove that parsing sequentially would reach that token in the same
+	 * state. From the first chunk failing this check, the rest of the source is parsed
+	 * sequentially, so the AST and the diagnostics are always those of Parser::parseProgram().
+	 */
+	class ParallelParser {
+	public:
+		// Smallest chunk worth a task of its own
+		static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+		/**
+		 * @brief Prepare to parse a source
+		 *
+		 * @param source The source, which must outlive the parser and the AST
+		 * @param options Parser options
+		 * @param jobs Maximum number of worker threads, 0 for one per hardware thread
+		 * @param chunkSize Minimal chunk size in bytes
+		 * @param upstream Resource the arenas of the AST allocate their blocks from, used from
+		 *                 several threads at once
+		 */
+		explicit ParallelParser(const lexer::SourceBuffer &source, parser::ParserOptions options = parser::ParserOptions(),
+								std::size_t jobs = 0, std::size_t chunkSize = DEFAULT_CHUNK_SIZE,
+								std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+		/**
+		 * @brief Parse the entire program
+		 *
+		 * @return ast::ASTNodePtr The root node of the AST (a ProgramNode)
+		 * @throws parser::ParserError, lexer::LexerError as Parser::parseProgram() would
+		 */
+		ast::ASTNodePtr parseProgram();
+
+		/**
+		 * @brief Get the errors recorded in recovery mode, in source order
+		 */
+		[[nodiscard]] const std::vector<parser::ParserError> &getDiagnostics() const { return diagnostics; }
+
+		/**
+		 * @brief Get the number of chunks the last parse used from the worker threads
+		 */
+		[[nodiscard]] std::size_t getParallelChunks() const { return parallelChunks; }
+
+		/**
+		 * @brief Get the number of tokens the last parse consumed, as Parser::getConsumedTokens()
+		 */
+		[[nodiscard]] std::size_t getConsumedTokens() const { return consumedTokens; }
+
+		/**
+		 * @brief A position where parsing can start
+		 */
+		struct Boundary {
+			std::size_t offset;
+			int line;
+			int column;
+		};
+
+		/**
+		 * @brief Find candidate chunk boundaries
+		 *
+		 * @param text The source text
+		 * @param chunkSize Minimal distance between boundaries in bytes
+		 * @return std::vector<Boundary> The start of each chunk in order, the first at offset 0
+		 */
+		static std::vector<Boundary> findBoundaries(std::string_view text, std::size_t chunkSize);
+
+	private:
+		const lexer::SourceBuffer &source;
+		parser::ParserOptions options;
+		std::size_t jobs;
+		std::size_t chunkSize;
+		std::pmr::memory_resource *upstream;
+		std::vector<parser::ParserError> diagnostics;
+		std::size_t parallelChunks = 0;
+		std::size_t consumedTokens = 0;
+	};
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_PARALLEL_PARSER_H
@@ -0,0 +1,132 @@
+#ifndef TINYC_DRIVER_SERVER_H
+#define TINYC_DRIVER_SERVER_H
+
+#include "tinyc/driver/Driver.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Memory resource keeping freed blocks for reuse
+	 *
+	 * An arena that is reset asks for the same sequence of block sizes again, so a block of
+	 * the requested size and alignment is handed out from the cache when there is one.
+	 * Everything is returned upstream when the resource is destroyed. Not thread-safe.
+	 */
+	class BlockCache final : public std::pmr::memory_resource {
+	public:
+		explicit BlockCache(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+				: upstream(upstream) {}
+
+		BlockCache(const BlockCache &) = delete;
+
+		BlockCache &operator=(const BlockCache &) = delete;
+
+		~BlockCache() override;
+
+		/**
+		 * @brief Get the number of bytes held in the cache
+		 */
+		[[nodiscard]] std::size_t cachedBytes() const { return cached; }
+
+	protected:
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+		void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		std::pmr::memory_resource *upstream;
+		std::multimap<std::pair<std::size_t, std::size_t>, void *> blocks;  // (size, alignment) -> block
+		std::size_t cached = 0;
+	};
+
+	/**
+	 * @brief Long-running compiler answering requests over a byte stream
+	 *
+	 * Saves the process start and the temporary file of one compiler run per input. Requests
+	 * are handled one at a time; the parser's arena and the output buffer are kept between
+	 * them, so a warm server allocates (almost) nothing per request.
+	 *
+	 * Each request is a header line followed by the source:
+	 *
+	 *     <mode> <length> [<flag>...]\n<length bytes of source>
+	 *
+	 * where mode is "lex" or "parse" and the flags are "pretty", "bin", "recover",
+	 * "max-errors=N", "parse-jobs=N", "serialize-jobs=N" and "name=NAME" (the source name used
+	 * in locations).
+	 * Flags are applied on top of the server's default options. The header "quit" ends the
+	 * stream, "shutdown" stops the server as well. Each response is
+	 *
+	 *     <exit code> <output length> <diagnostics length>\n<output><diagnostics>
+	 *
+	 * with the same output, diagnostics and exit code as a compiler run on the source.
+	 */
+	class Server {
+	public:
+		/// Largest source a request may have; longer requests are refused before reading them
+		static constexpr std::size_t MAX_REQUEST_SIZE = 256 * 1024 * 1024;
+
+		/**
+		 * @brief Create a server
+		 *
+		 * @param defaults Options of each request before its flags are applied
+		 */
+		explicit Server(CompileOptions defaults = CompileOptions());
+
+		Server(const Server &) = delete;
+
+		Server &operator=(const Server &) = delete;
+
+		/**
+		 * @brief Answer the requests of a stream until its end, "quit" or "shutdown"
+		 *
+		 * A malformed header is answered with exit code 3; if its length cannot be read, is
+		 * above MAX_REQUEST_SIZE or cannot be allocated, the rest of the stream cannot be
+		 * framed and serving stops.
+		 *
+		 * @param in Stream the requests are read from
+		 * @param out Stream the responses are written to, flushed after each one
+		 * @return bool Whether "shutdown" was requested
+		 */
+		bool serve(std::istream &in, std::ostream &out);
+
+		/**
+		 * @brief Listen on a Unix domain socket and serve its connections one after the other
+		 *
+		 * Returns once a connection requests "shutdown". A file already at the path is replaced.
+		 *
+		 * @param path Path of the socket
+		 * @throws std::runtime_error if the socket cannot be set up (or on Windows)
+		 */
+		void serveSocket(const std::string &path);
+
+		/**
+		 * @brief Get the number of requests answered so far
+		 */
+		[[nodiscard]] std::size_t requestCount() const { return requests; }
+
+	private:
+		CompileOptions defaults;
+		BlockCache cache;
+		std::shared_ptr<ast::ASTContext> arena;
+		ast::StringSink output;
+		std::string source;
+		std::size_t requests = 0;
+	};
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_SERVER_H
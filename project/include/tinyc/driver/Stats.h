@@ -0,0 +1,153 @@
+#ifndef TINYC_DRIVER_STATS_H
+#define TINYC_DRIVER_STATS_H
+
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/NodeKind.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace tinyc::driver {
+
+	/**
+	 * @brief Adds the time spent in a scope to a counter
+	 *
+	 * Reads a monotonic clock on construction and destruction only, so it can stay in hot
+	 * paths. Timers for the same counter add up, e.g. over the iterations of a loop.
+	 */
+	class ScopedTimer {
+	public:
+		/**
+		 * @brief Start timing
+		 *
+		 * @param seconds Counter receiving the elapsed wall time in seconds; must outlive the timer
+		 */
+		explicit ScopedTimer(double &seconds) : seconds(seconds), start(std::chrono::steady_clock::now()) {}
+
+		ScopedTimer(const ScopedTimer &) = delete;
+
+		ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+		~ScopedTimer() {
+			seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		double &seconds;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/**
+	 * @brief Memory resource counting the bytes allocated through it
+	 *
+	 * Forwards to an upstream resource and tracks the bytes currently allocated and their
+	 * highest value. Thread-safe when the upstream resource is.
+	 */
+	class AllocationCounter final : public std::pmr::memory_resource {
+	public:
+		explicit AllocationCounter(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+				: upstream(upstream) {}
+
+		AllocationCounter(const AllocationCounter &) = delete;
+
+		AllocationCounter &operator=(const AllocationCounter &) = delete;
+
+		/**
+		 * @brief Get the number of bytes allocated and not yet deallocated
+		 */
+		[[nodiscard]] std::size_t currentBytes() const { return current.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the highest number of bytes allocated at once
+		 */
+		[[nodiscard]] std::size_t peakBytes() const { return peak.load(std::memory_order_relaxed); }
+
+	protected:
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+		void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		std::pmr::memory_resource *upstream;
+		std::atomic<std::size_t> current{0};
+		std::atomic<std::size_t> peak{0};
+	};
+
+	/**
+	 * @brief How compile statistics are reported
+	 */
+	enum class StatsFormat {
+		NONE,   // Not collected
+		TEXT,   // Human-readable lines
+		JSON    // One JSON object per input, on one line
+	};
+
+	/**
+	 * @brief Where the time and memory of compiling one input went
+	 *
+	 * The parser pulls its tokens from the lexer one at a time, so when parsing, lexing is
+	 * part of parseSeconds and lexSeconds stays 0; it is only timed on its own in lexer mode.
+	 */
+	struct CompileStats {
+		std::string name;               // Source name
+		double readSeconds = 0;         // Loading (or mapping) the file
+		double lexSeconds = 0;          // Lexing the whole source, in lexer mode
+		double parseSeconds = 0;        // Parsing, including the lexing it drives
+		double serializeSeconds = 0;    // Writing the tokens or the AST
+		std::size_t tokens = 0;         // Tokens listed, or consumed by the parser, before the end of file or an error
+		std::array<std::size_t, ast::NODE_KIND_COUNT> nodesByKind{};  // AST nodes indexed by NodeKind
+		std::size_t astBytes = 0;       // Peak bytes of arena blocks holding the AST
+		std::size_t outputBytes = 0;    // Bytes of output written
+		bool cacheHit = false;          // Output taken from the cache, so nothing was lexed or parsed
+
+		/**
+		 * @brief Get the total number of AST nodes
+		 */
+		[[nodiscard]] std::size_t nodes() const;
+
+		/**
+		 * @brief Add the nodes of a tree to nodesByKind
+		 *
+		 * @param root The root of the tree
+		 */
+		void countNodes(const ast::ASTNode &root);
+
+		/**
+		 * @brief Format the statistics as indented lines, ending with a newline
+		 *
+		 * Phases that did not run (a time of 0) and node kinds that do not occur are left out;
+		 * a cache hit is reported on a line of its own.
+		 */
+		[[nodiscard]] std::string toText() const;
+
+		/**
+		 * @brief Format the statistics as a one-line JSON object, ending with a newline
+		 *
+		 * Times are in seconds; "nodes" maps each occurring node kind to its count and
+		 * "cacheHit" tells if the output came from the cache.
+		 */
+		[[nodiscard]] std::string toJSON() const;
+
+		/**
+		 * @brief Format the statistics as toText() or toJSON() does
+		 *
+		 * @return std::string The formatted statistics, empty for StatsFormat::NONE
+		 */
+		[[nodiscard]] std::string format(StatsFormat format) const;
+	};
+
+	/**
+	 * @brief Get the name of a node kind, as used for nodeType in the JSON AST
+	 */
+	const char *nodeKindName(ast::NodeKind kind);
+
+} // namespace tinyc::driver
+
+#endif // TINYC_DRIVER_STATS_H
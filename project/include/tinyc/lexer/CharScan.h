@@ -0,0 +1,46 @@
+#ifndef TINYC_CHAR_SCAN_H
+#define TINYC_CHAR_SCAN_H
+
+#include <cstddef>
+
+namespace tinyc::lexer::scan {
+
+	/**
+	 * @brief Character-run scanners used by the lexer's hot loops
+	 *
+	 * Each function looks at the bytes [text, text + length) and processes a whole SIMD block
+	 * per step (32 bytes with AVX2, 16 with SSE2 or NEON), finishing the tail one byte at a
+	 * time. Builds without a supported instruction set, or configured with TINYC_NO_SIMD, use
+	 * the scalar loop only. All functions classify bytes as in the "C" locale.
+	 */
+
+	/**
+	 * @brief Name of the code path selected at compile time ("avx2", "sse2", "neon" or "scalar")
+	 */
+	const char *implementation();
+
+	/**
+	 * @brief Length of the run of whitespace (space, \\t, \\n, \\v, \\f, \\r) at the start of text
+	 */
+	std::size_t whitespaceRun(const char *text, std::size_t length);
+
+	/**
+	 * @brief Length of the run of identifier characters ([A-Za-z0-9_]) at the start of text
+	 */
+	std::size_t identifierRun(const char *text, std::size_t length);
+
+	/**
+	 * @brief Number of '\\n' bytes in text
+	 */
+	std::size_t countNewlines(const char *text, std::size_t length);
+
+	/**
+	 * @brief Offset of the first "*\/" in text
+	 *
+	 * @return std::size_t The offset of the '*', or length if text contains no "*\/"
+	 */
+	std::size_t findCommentClose(const char *text, std::size_t length);
+
+} // namespace tinyc::lexer::scan
+
+#endif // TINYC_CHAR_SCAN_H
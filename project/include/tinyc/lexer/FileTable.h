@@ -0,0 +1,56 @@
+#ifndef TINYC_FILE_TABLE_H
+#define TINYC_FILE_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace tinyc::lexer {
+
+	/**
+	 * @brief Process-wide table of source file names
+	 *
+	 * Source locations refer to files by a small integer id instead of carrying the name
+	 * around; the name is looked up only when a location is printed. Id 0 is reserved for
+	 * the empty name used by default-constructed locations. The table is safe to use from
+	 * several threads and names stay valid for the lifetime of the program.
+	 */
+	class FileTable {
+	public:
+		/**
+		 * @brief Get the table shared by the whole process
+		 */
+		static FileTable &global();
+
+		/**
+		 * @brief Get the id of a file name, adding it to the table if needed
+		 *
+		 * @param name The file name
+		 * @return std::uint32_t The id of the name
+		 */
+		std::uint32_t intern(std::string_view name);
+
+		/**
+		 * @brief Get the file name with the given id
+		 *
+		 * @param id An id returned by intern()
+		 * @return const std::string& The file name
+		 * @throws std::out_of_range if the id is unknown
+		 */
+		[[nodiscard]] const std::string &getName(std::uint32_t id) const;
+
+	private:
+		FileTable();
+
+		mutable std::mutex mutex;
+		std::deque<std::string> names;  // Deque keeps references stable as the table grows
+		std::unordered_map<std::string_view, std::uint32_t> ids;
+	};
+
+} // namespace tinyc::lexer
+
+
+#endif // TINYC_FILE_TABLE_H
@@ -2,10 +2,14 @@
 #define TINYC_LEXER_H
 
 #include "tinyc/lexer/Token.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include <array>
+#include <cstddef>
+#include <istream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <unordered_map>
 
 
 namespace tinyc::lexer {
@@ -16,7 +20,7 @@ namespace tinyc::lexer {
 	class LexerError : public std::runtime_error {
 	public:
 		LexerError(const std::string &message, const SourceLocation &location) : std::runtime_error(
-				location.filename + ":" +
+				location.getFilename() + ":" +
 				std::to_string(location.line) + ":" +
 				std::to_string(location.column) + ": " + message),
 																				 location(location) {}
@@ -32,6 +36,12 @@ namespace tinyc::lexer {
 	 */
 	class Lexer {
 	public:
+		// Number of tokens peek() can look ahead
+		static constexpr std::size_t MAX_LOOKAHEAD = 4;
+
+		// Bytes a streaming lexer reads from its input at a time
+		static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
 		/**
 		 * @brief Construct a new Lexer object from source code
 		 *
@@ -40,6 +50,127 @@ namespace tinyc::lexer {
 		 */
 		explicit Lexer(std::string source, std::string filename = "<input>");
 
+		/**
+		 * @brief Construct a new Lexer object reading directly from a source buffer
+		 *
+		 * The lexer does not copy the text, the buffer must outlive the lexer.
+		 *
+		 * @param buffer The buffer holding the source code
+		 */
+		explicit Lexer(const SourceBuffer &buffer);
+
+		/**
+		 * @brief Construct a new Lexer object reading a stream in chunks
+		 *
+		 * Only a window of the input is held in memory: the lexer reads another chunk when
+		 * a token (or the whitespace and comments before it) reaches the end of the window,
+		 * and lexes that token again on the longer text. Memory stays bounded by the chunk
+		 * size and the longest token or comment, however long the stream is.
+		 *
+		 * Token offsets and text() refer to the window, so the text of a token is only
+		 * valid until the next call to next() or peek() that has to lex (peeked tokens are
+		 * kept). seek() is not supported on streams.
+		 *
+		 * @param input The stream to read, which must outlive the lexer
+		 * @param filename The name of the input (for error reporting)
+		 * @param chunkSize Bytes to read at a time
+		 */
+		Lexer(std::istream &input, std::string filename = "<stdin>", std::size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+		// The source view may point into ownedSource, so lexers are not copied
+		Lexer(const Lexer &) = delete;
+
+		Lexer &operator=(const Lexer &) = delete;
+
+		/**
+		 * @brief Continue lexing from another position
+		 *
+		 * The position must not be inside a token, comment or literal, e.g. the start of a
+		 * token returned earlier. Peeked tokens are discarded.
+		 *
+		 * @param offset Byte offset in the source
+		 * @param line Line number of that offset (1-based)
+		 * @param column Column number of that offset (1-based)
+		 * @throws std::out_of_range if the offset is past the end of the source
+		 */
+		void seek(std::size_t offset, int line, int column);
+
+		/**
+		 * @brief Get the next token from the source without allocating
+		 *
+		 * @return TokenRef The next token
+		 */
+		TokenRef next() {
+			if (buffered == 0) {
+				return scan();
+			}
+			TokenRef token = lookahead[head];
+			head = (head + 1) % MAX_LOOKAHEAD;
+			--buffered;
+			return token;
+		}
+
+		/**
+		 * @brief Peek at a token ahead without consuming it
+		 *
+		 * Peeked tokens are kept in a ring buffer and handed out by next(), so every byte of
+		 * the source is lexed once however far the caller looks ahead.
+		 *
+		 * @param n Number of tokens to look past, 0 for the token next() returns
+		 * @return TokenRef The token
+		 * @throws std::out_of_range if n is not below MAX_LOOKAHEAD
+		 */
+		TokenRef peek(std::size_t n = 0);
+
+		/**
+		 * @brief Get the lexeme of a token
+		 *
+		 * @param token A token produced by this lexer
+		 * @return std::string_view The lexeme, pointing into the source
+		 */
+		[[nodiscard]] std::string_view text(const TokenRef &token) const {
+			return source.substr(token.offset, token.length);
+		}
+
+		/**
+		 * @brief Get the source location of a token
+		 *
+		 * @param token A token produced by this lexer
+		 * @return SourceLocation The location where the token starts
+		 */
+		[[nodiscard]] SourceLocation location(const TokenRef &token) const {
+			return {fileId, token.line, token.column};
+		}
+
+		/**
+		 * @brief Decode the value of an integer literal token
+		 *
+		 * Numeric tokens only carry their source span. The lexer checks that the value fits
+		 * when it produces the token, so decoding a token of this lexer cannot fail.
+		 *
+		 * @param token An INTEGER_LITERAL token produced by this lexer
+		 * @return int The value of the literal
+		 */
+		[[nodiscard]] int intValue(const TokenRef &token) const;
+
+		/**
+		 * @brief Decode the value of a double literal token, as intValue() does
+		 *
+		 * @param token A DOUBLE_LITERAL token produced by this lexer
+		 * @return double The value of the literal, correctly rounded
+		 */
+		[[nodiscard]] double doubleValue(const TokenRef &token) const;
+
+		/**
+		 * @brief Append the description of a token, as the Token stream operator writes it
+		 *
+		 * Produces the lines of a token listing without materializing the tokens.
+		 *
+		 * @param token A token produced by this lexer
+		 * @param out String the description is appended to
+		 */
+		void describe(const TokenRef &token, std::string &out) const;
+
 		/**
 		 * @brief Get the next token from the source
 		 *
@@ -73,18 +204,35 @@ namespace tinyc::lexer {
 		/**
 		 * @brief Get the current source location
 		 *
-		 * @return SourceLocation The current location in the source
+		 * @return SourceLocation The location the lexer has scanned up to, past any peeked tokens
 		 */
 		[[nodiscard]] SourceLocation getCurrentLocation() const;
 
 	private:
 		// Source code and position tracking
-		std::string source;
+		std::string ownedSource;   // Only used when the lexer was given a string, or the window of a stream
+		std::string_view source;
 		std::string filename;
+		std::uint32_t fileId;      // Id of the filename in the global file table
 		int position;
 		int line;
 		int column;
 
+		// Start of the token being lexed
+		int tokenStart;
+		int tokenLine;
+		int tokenColumn;
+
+		// Peeked tokens, lookahead[head] being the oldest
+		std::array<TokenRef, MAX_LOOKAHEAD> lookahead{};
+		std::size_t head = 0;
+		std::size_t buffered = 0;
+
+		// Stream the window is read from, if any
+		std::istream *input = nullptr;
+		std::size_t chunkSize = 0;
+		bool exhausted = true;      // Whether the whole input is in the window
+
 		/**
 		 * @brief Get the current character
 		 * Used to read the character at the current position
@@ -97,28 +245,48 @@ namespace tinyc::lexer {
 		// Advance to the next character
 		void advance();
 
+		// Advance over the next count characters, updating line and column in bulk
+		void advanceBy(std::size_t count);
+
 		// Check if we've reached the end of the source
 		[[nodiscard]] bool isAtEnd() const;
 
 		// Skip whitespace and comments
 		void skipWhitespace();
 
+		// Lex the next token, reading more of a stream as needed
+		TokenRef scan() {
+			return input == nullptr ? scanToken() : scanStream();
+		}
+
+		// Lex the token at the current position
+		TokenRef scanToken();
+
+		// Lex the next token of a stream, extending the window until the token ends inside it
+		TokenRef scanStream();
+
+		// Drop the bytes before the token being lexed and any peeked tokens, and read a chunk
+		void refill();
+
 		// Lexing methods for different token types
-		TokenPtr lexIdentifierOrKeyword();
+		TokenRef lexIdentifierOrKeyword();
+
+		TokenRef lexNumber();
 
-		TokenPtr lexNumber();
+		TokenRef lexCharLiteral();
 
-		TokenPtr lexCharLiteral();
+		TokenRef lexStringLiteral();
 
-		TokenPtr lexStringLiteral();
+		TokenRef lexOperatorOrPunctuation();
 
-		TokenPtr lexOperatorOrPunctuation();
+		// Helper for creating a token spanning from the token start to the current position
+		[[nodiscard]] TokenRef createToken(TokenType type) const;
 
-		// Helper for creating tokens
-		[[nodiscard]] TokenPtr createToken(TokenType type, const std::string &lexeme) const;
+		// Location where the current token starts
+		[[nodiscard]] SourceLocation tokenLocation() const;
 
-		// Keyword lookup map
-		static const std::unordered_map<std::string, TokenType> keywords;
+		// Build an owning Token from a token reference
+		[[nodiscard]] TokenPtr materialize(const TokenRef &token) const;
 	};
 
 } // namespace tinyc::lexer
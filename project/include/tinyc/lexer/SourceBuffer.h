@@ -0,0 +1,94 @@
+#ifndef TINYC_SOURCE_BUFFER_H
+#define TINYC_SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tinyc::lexer {
+
+	/**
+	 * @brief Read-only view of a source text together with the storage backing it
+	 *
+	 * Regular files are memory-mapped once and scanned in place; anything that
+	 * cannot be mapped (pipes, empty files, in-memory strings) is kept in an owned
+	 * std::string, unless the caller keeps the text alive itself (see view()). The
+	 * buffer is move-only, the text it hands out stays valid for the lifetime of the
+	 * buffer.
+	 */
+	class SourceBuffer {
+	public:
+		/**
+		 * @brief Create a buffer from a file on disk
+		 *
+		 * Regular files are memory-mapped, other file types are read into memory.
+		 *
+		 * @param filename Path of the file to load (also used as the buffer name)
+		 * @return SourceBuffer The loaded buffer
+		 * @throws std::runtime_error if the file cannot be opened or read
+		 */
+		static SourceBuffer fromFile(const std::string &filename);
+
+		/**
+		 * @brief Create a buffer that owns a copy of the given source
+		 *
+		 * @param source The source code
+		 * @param name The name of the source (for error reporting)
+		 * @return SourceBuffer The buffer owning the source
+		 */
+		static SourceBuffer fromString(std::string source, std::string name = "<input>");
+
+		/**
+		 * @brief Create a buffer referring to text owned by the caller
+		 *
+		 * Nothing is copied; the text must outlive the buffer.
+		 *
+		 * @param text The source code
+		 * @param name The name of the source (for error reporting)
+		 * @return SourceBuffer The buffer viewing the text
+		 */
+		static SourceBuffer view(std::string_view text, std::string name = "<input>");
+
+		SourceBuffer(SourceBuffer &&other) noexcept;
+
+		SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+
+		SourceBuffer(const SourceBuffer &) = delete;
+
+		SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+		~SourceBuffer();
+
+		/**
+		 * @brief Get the source text
+		 */
+		[[nodiscard]] std::string_view getText() const { return {data, size}; }
+
+		/**
+		 * @brief Get the name of the source (usually the file name)
+		 */
+		[[nodiscard]] const std::string &getName() const { return name; }
+
+		/**
+		 * @brief Check if the text is backed by a memory mapping
+		 */
+		[[nodiscard]] bool isMapped() const { return mapped; }
+
+	private:
+		SourceBuffer() = default;
+
+		// Release the mapping (if any) and reset to an empty buffer
+		void release() noexcept;
+
+		std::string name;
+		std::string storage;       // Used when the text is not mapped
+		const char *data = nullptr;
+		std::size_t size = 0;
+		bool mapped = false;
+		bool borrowed = false;     // The text belongs to the caller (see view())
+	};
+
+} // namespace tinyc::lexer
+
+
+#endif // TINYC_SOURCE_BUFFER_H
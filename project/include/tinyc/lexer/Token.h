@@ -1,8 +1,11 @@
 #ifndef TINYC_TOKEN_H
 #define TINYC_TOKEN_H
 
+#include "tinyc/lexer/FileTable.h"
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <type_traits>
 #include <ostream>
 #include <utility>
 
@@ -10,22 +13,35 @@ namespace tinyc::lexer {
 
 	/**
 	 * @brief SourceLocation represents a position in the source code
+	 *
+	 * The file is stored as an id into FileTable::global(), so locations are small and
+	 * trivially copyable; the name is only looked up when it is needed.
 	 */
 	struct SourceLocation {
-		std::string filename; // Source file name
+		std::uint32_t fileId; // Source file id in the global file table
 		int line;             // Line number (1-based)
 		int column;           // Column number (1-based)
 
-		SourceLocation() : line(1), column(1) {}
+		SourceLocation() : fileId(0), line(1), column(1) {}
 
-		SourceLocation(std::string file, int l, int c) : filename(std::move(file)), line(l), column(c) {}
+		SourceLocation(std::uint32_t file, int l, int c) : fileId(file), line(l), column(c) {}
+
+		SourceLocation(std::string_view file, int l, int c)
+				: fileId(FileTable::global().intern(file)), line(l), column(c) {}
+
+		/**
+		 * @brief Get the name of the source file
+		 */
+		[[nodiscard]] const std::string &getFilename() const { return FileTable::global().getName(fileId); }
 
 		friend std::ostream &operator<<(std::ostream &os, const SourceLocation &loc) {
-			os << loc.filename << ":" << loc.line << ":" << loc.column;
+			os << loc.getFilename() << ":" << loc.line << ":" << loc.column;
 			return os;
 		}
 	};
 
+	static_assert(std::is_trivially_copyable_v<SourceLocation>, "SourceLocation must stay cheap to copy");
+
 	/**
 	 * @brief TokenType enumeration of all possible token types
 	 */
@@ -195,6 +211,31 @@ namespace tinyc::lexer {
 	// Using a shared_ptr for token management
 	using TokenPtr = std::shared_ptr<Token>;
 
+	/**
+	 * @brief Compact token produced by the lexer's streaming interface
+	 *
+	 * Unlike Token it owns nothing: the lexeme is a span of the lexer's source buffer and the
+	 * location is just a line and column (the file name is the same for every token of a lexer).
+	 * Use Lexer::text() and Lexer::location() to resolve them.
+	 */
+	struct TokenRef {
+		TokenType type;
+		std::uint32_t offset;   // Byte offset of the lexeme in the source
+		std::uint32_t length;   // Length of the lexeme in bytes
+		int line;               // Line number (1-based)
+		int column;             // Column number (1-based)
+
+		// Value of a character literal; numbers are decoded from their text on demand
+		// (see Lexer::intValue() and Lexer::doubleValue())
+		char charValue;
+
+		[[nodiscard]] TokenType getType() const { return type; }
+
+		[[nodiscard]] char getCharValue() const { return charValue; }
+	};
+
+	static_assert(std::is_trivially_copyable_v<TokenRef>, "TokenRef must stay cheap to copy");
+
 } // namespace tinyc::lexer
 
 
@@ -0,0 +1,124 @@
+#ifndef TINYC_PARSER_INCREMENTAL_PARSER_H
+#define TINYC_PARSER_INCREMENTAL_PARSER_H
+
+#include "tinyc/parser/Parser.h"
+#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/ASTContext.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tinyc::parser {
+
+	/**
+	 * @brief A source text whose AST is kept up to date across edits
+	 *
+	 * Top-level declarations do not depend on each other syntactically, so an edit only needs
+	 * the declarations around it parsed again. Parsing restarts at the declaration holding the
+	 * character before the edit and stops as soon as it reaches, past the edit, the start of a
+	 * declaration of the previous version; from there on the old declarations are reused. Each
+	 * edit thus lexes and parses the edited declarations only.
+	 *
+	 * The reused declarations are moved by the lines (and, on the line where the edit ends, the
+	 * columns) the edit added or removed. For an edit within a line this touches the nodes of
+	 * at most the declarations on that line; an edit adding or removing lines rewrites the
+	 * locations of every later node, which is still far cheaper than lexing them again.
+	 *
+	 * Replaced declarations stay in the arena until the garbage outgrows the source, at which
+	 * point the whole text is parsed again into a fresh arena.
+	 */
+	class IncrementalParser {
+	public:
+		/**
+		 * @brief Parse a source text
+		 *
+		 * @param source The source code
+		 * @param filename The name of the source (for locations and errors)
+		 * @param options Parser options; in recovery mode the error limit is not applied, and
+		 * nodes are never shared
+		 * @throws ParserError, lexer::LexerError on invalid input (unless recovering from errors)
+		 */
+		explicit IncrementalParser(std::string source, std::string filename = "<input>",
+								   ParserOptions options = ParserOptions());
+
+		IncrementalParser(const IncrementalParser &) = delete;
+
+		IncrementalParser &operator=(const IncrementalParser &) = delete;
+
+		/**
+		 * @brief Replace part of the source and update the AST
+		 *
+		 * If parsing the new text fails, the source and the AST are left as they were.
+		 *
+		 * @param offset Byte offset of the replaced range
+		 * @param length Length of the replaced range in bytes
+		 * @param text The text replacing the range
+		 * @return std::size_t The number of declarations that were parsed again
+		 * @throws std::out_of_range if the range is not inside the source
+		 * @throws ParserError, lexer::LexerError on invalid input (unless recovering from errors)
+		 */
+		std::size_t applyEdit(std::size_t offset, std::size_t length, const std::string &text);
+
+		/**
+		 * @brief Get the AST of the current source
+		 */
+		[[nodiscard]] const ast::ProgramNode &getProgram() const { return *program; }
+
+		/**
+		 * @brief Get the current source
+		 */
+		[[nodiscard]] const std::string &getSource() const { return source; }
+
+		/**
+		 * @brief Get the errors of the current source in recovery mode, in source order
+		 */
+		[[nodiscard]] std::vector<ParserError> getDiagnostics() const;
+
+	private:
+		// A position in the source
+		struct Position {
+			std::size_t offset;
+			int line;
+			int column;
+		};
+
+		// A top-level declaration: where its first token starts and the errors recovered in it
+		struct Item {
+			Position start;
+			std::vector<ParserError> errors;
+		};
+
+		// Declarations parsed from a position, and where parsing stopped
+		struct Parsed {
+			ast::NodeList declarations;
+			std::vector<Item> items;
+			std::size_t end = 0;   // Offset of the token parsing stopped at
+			std::size_t sync = 0;  // Index of the first old item to reuse
+		};
+
+		std::string source;
+		std::string filename;
+		ParserOptions options;
+		std::shared_ptr<ast::ASTContext> context;
+		std::unique_ptr<ast::ProgramNode> program;
+		std::vector<Item> items;
+		std::size_t garbage = 0;   // Bytes of source parsed again since the arena was created
+
+		/**
+		 * @brief Parse the declarations of a text from a position
+		 *
+		 * Parsing stops at the end of the text, or before a token starting where an old item
+		 * (from index syncFrom on) starts once moved by shift bytes; Parsed::sync is then that
+		 * item's index, otherwise items.size().
+		 */
+		Parsed parseFrom(const std::shared_ptr<ast::ASTContext> &arena, const std::string &text,
+						 const Position &start, std::size_t syncFrom, std::ptrdiff_t shift) const;
+
+		// Parse the whole source into a fresh arena
+		void parseAll();
+	};
+
+} // namespace tinyc::parser
+
+#endif // TINYC_PARSER_INCREMENTAL_PARSER_H
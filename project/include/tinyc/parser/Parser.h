@@ -3,10 +3,12 @@
 
 #include "tinyc/lexer/Lexer.h"
 #include "tinyc/ast/ASTNode.h"
-#include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/ast/FlatAST.h"
 #include <stdexcept>
 #include <string>
 #include <memory>
+#include <utility>
 #include <vector>
 
 
@@ -18,17 +20,74 @@ namespace tinyc::parser {
 	class ParserError : public std::runtime_error {
 	public:
 		ParserError(const std::string &message, const lexer::SourceLocation &location)
-				: std::runtime_error(location.filename + ":" +
+				: std::runtime_error(location.getFilename() + ":" +
 									 std::to_string(location.line) + ":" +
 									 std::to_string(location.column) + ": " + message),
-				  location(location) {}
+				  message(message), location(location) {}
+
+		// The message without the location prefix of what()
+		[[nodiscard]] const std::string &getMessage() const { return message; }
 
 		[[nodiscard]] const lexer::SourceLocation &getLocation() const { return location; }
 
 	private:
+		std::string message;
 		lexer::SourceLocation location;
 	};
 
+	/**
+	 * @brief Subtrees the parser shares between equal occurrences (hash-consing)
+	 */
+	enum class NodeSharing {
+		NONE,        // Every occurrence gets nodes of its own
+		TYPES,       // Equal types share their nodes
+		EXPRESSIONS  // Equal types and equal pure expressions share their nodes
+	};
+
+	/**
+	 * @brief Tunable limits of the parser
+	 */
+	struct ParserOptions {
+		/**
+		 * @brief Maximum nesting depth of statements and expressions
+		 *
+		 * Nested blocks, statement bodies, parenthesised and unary expressions are parsed
+		 * recursively; a program nesting deeper than this is rejected with a ParserError
+		 * instead of overflowing the stack.
+		 */
+		int maxNestingDepth = 1024;
+
+		/**
+		 * @brief Keep parsing after syntax errors
+		 *
+		 * Errors are recorded (see Parser::getDiagnostics()) and the statement or declaration
+		 * containing them is replaced by an ast::ErrorNode. Parsing resumes after the next ';'
+		 * or block, before the next '}', or at the next top-level type keyword. Every skipped
+		 * token is consumed once, so recovery stays linear in the input.
+		 */
+		bool recover = false;
+
+		/**
+		 * @brief Stop a recovering parse once this many errors have been recorded (0 for no limit)
+		 *
+		 * The next error is then replaced by a note that parsing stopped, and the AST built so
+		 * far is returned.
+		 */
+		std::size_t maxErrors = 20;
+
+		/**
+		 * @brief Build equal subtrees once and share them (see ast::ASTContext::createShared())
+		 *
+		 * Types and, with EXPRESSIONS, expressions made of literals, identifiers, casts, indexing,
+		 * member accesses and operators other than assignments, increments and decrements are
+		 * looked up in the node table of the AST context, and a repeated one reuses the nodes
+		 * of its first occurrence, locations included. This saves memory on generated code and
+		 * makes equal subtrees pointer-equal. The nodes of a tree may then have several parents,
+		 * so trees that are changed after parsing (see IncrementalParser) must not share them.
+		 */
+		NodeSharing sharing = NodeSharing::NONE;
+	};
+
 	/**
 	 * @brief Parser for the TinyC language
 	 *
@@ -40,20 +99,103 @@ namespace tinyc::parser {
 		 * @brief Construct a new Parser
 		 *
 		 * @param lexer The lexer to get tokens from
+		 * @param options Parser limits
 		 */
-		explicit Parser(lexer::Lexer &lexer);
+		explicit Parser(lexer::Lexer &lexer, ParserOptions options = {});
+
+		/**
+		 * @brief Construct a new Parser allocating nodes from the given context
+		 *
+		 * @param lexer The lexer to get tokens from
+		 * @param context The arena the AST is built in
+		 * @param options Parser limits
+		 */
+		Parser(lexer::Lexer &lexer, std::shared_ptr<ast::ASTContext> context, ParserOptions options = {});
 
 		/**
 		 * @brief Parse a TinyC program
 		 *
+		 * The nodes are allocated from the parser's ASTContext, which the returned
+		 * program keeps alive.
+		 *
 		 * @return The AST for the program
 		 * @throws ParserError if there is a syntax error
 		 */
 		ast::ASTNodePtr parseProgram();
 
+		/**
+		 * @brief Parse a TinyC program into a flat AST
+		 *
+		 * Each top-level declaration is parsed into a scratch arena, appended to the flat AST
+		 * and released again, so the pointer tree of the whole program never exists at once.
+		 * The parser's own ASTContext is not touched.
+		 *
+		 * @return ast::FlatAST The program, with the PROGRAM node at index 0
+		 * @throws ParserError if there is a syntax error
+		 */
+		ast::FlatAST parseProgramFlat();
+
+		/**
+		 * @brief Parse the top-level declaration at the current token
+		 *
+		 * Lets a program be parsed one declaration at a time (see IncrementalParser).
+		 *
+		 * @return ast::ASTNodePtr The declaration, or null at the end of the input or when a
+		 * recovering parse reached the error limit
+		 */
+		ast::ASTNodePtr parseNextDeclaration();
+
+		/**
+		 * @brief Get the token the parser is about to consume
+		 */
+		[[nodiscard]] const lexer::TokenRef &getCurrentToken() const { return currentToken; }
+
+		/**
+		 * @brief Get the number of tokens consumed so far, all but the end of file after a full parse
+		 */
+		[[nodiscard]] std::size_t getConsumedTokens() const { return consumedTokens; }
+
+		/**
+		 * @brief Get the errors recorded in recovery mode, in source order
+		 */
+		[[nodiscard]] const std::vector<ParserError> &getDiagnostics() const { return diagnostics; }
+
+		// Precedence of the loosest binary operator (||), i.e. a full E9 expression
+		static constexpr int LOWEST_PRECEDENCE = 1;
+
 	private:
 		lexer::Lexer &lexer;
-		lexer::TokenPtr currentToken;
+		lexer::TokenRef currentToken;
+		std::shared_ptr<ast::ASTContext> context;
+		ParserOptions options;
+		int nestingDepth = 0;
+
+		// Error recovery state
+		std::vector<ParserError> diagnostics;
+		std::size_t consumedTokens = 0;
+		std::size_t lastErrorToken = static_cast<std::size_t>(-1);
+
+		// Thrown to abandon a recovering parse (error limit reached)
+		struct StopParsing {};
+
+		/**
+		 * @brief Scope guard tracking the depth of recursive constructs
+		 *
+		 * Throws a ParserError when entering a construct would exceed options.maxNestingDepth.
+		 */
+		class NestingGuard {
+		public:
+			explicit NestingGuard(Parser &parser);
+
+			~NestingGuard() { --parser.nestingDepth; }
+
+			NestingGuard(const NestingGuard &) = delete;
+
+			NestingGuard &operator=(const NestingGuard &) = delete;
+
+		private:
+			Parser &parser;
+		};
 
 		// Helper methods
 
@@ -62,7 +204,7 @@ namespace tinyc::parser {
 		 *
 		 * @return The consumed token
 		 */
-		lexer::TokenPtr consume();
+		lexer::TokenRef consume();
 
 		/**
 		 * @brief Check if the current token matches the given type
@@ -90,7 +232,93 @@ namespace tinyc::parser {
 		 * @return The consumed token
 		 * @throws ParserError if the token doesn't match
 		 */
-		lexer::TokenPtr expect(lexer::TokenType type, const std::string &message);
+		lexer::TokenRef expect(lexer::TokenType type, const std::string &message);
+
+		/**
+		 * @brief Get the name an identifier token spells, interned in the AST context
+		 *
+		 * @param token The identifier token
+		 * @return The interned name, shared by every occurrence and valid as long as the AST
+		 */
+		[[nodiscard]] std::string_view name(const lexer::TokenRef &token) const {
+			return context->intern(lexer.text(token));
+		}
+
+		/**
+		 * @brief Get the source location of a token
+		 *
+		 * @param token The token
+		 * @return The location where the token starts
+		 */
+		[[nodiscard]] lexer::SourceLocation location(const lexer::TokenRef &token) const {
+			return lexer.location(token);
+		}
+
+		/**
+		 * @brief Create a type node, shared with an equal type when options.sharing allows
+		 *
+		 * @param key The key of the node, whose children are the arguments' nodes
+		 * @param args Arguments forwarded to the node constructor
+		 */
+		template<typename T, typename... Args>
+		ast::ASTNodePtr createType(const ast::NodeKey &key, Args &&... args) {
+			if (options.sharing == NodeSharing::NONE) {
+				return context->create<T>(std::forward<Args>(args)...);
+			}
+			return context->createShared<T>(key, std::forward<Args>(args)...);
+		}
+
+		/**
+		 * @brief Create a primitive type node, shared when options.sharing allows
+		 */
+		ast::ASTNodePtr primitiveType(ast::PrimitiveTypeNode::Kind kind, const lexer::SourceLocation &location) {
+			return createType<ast::PrimitiveTypeNode>(
+					ast::NodeKey{ast::NodeKind::PRIMITIVE_TYPE, static_cast<int>(kind)}, kind, location);
+		}
+
+		/**
+		 * @brief Create a pure expression node, shared with an equal expression when
+		 * options.sharing allows and its children are shared
+		 *
+		 * @param key The key of the node, whose children are the arguments' nodes
+		 * @param args Arguments forwarded to the node constructor
+		 */
+		template<typename T, typename... Args>
+		ast::ASTNodePtr createExpression(const ast::NodeKey &key, Args &&... args) {
+			if (!sharesExpression(key)) {
+				return context->create<T>(std::forward<Args>(args)...);
+			}
+			return context->createShared<T>(key, std::forward<Args>(args)...);
+		}
+
+		// Whether an expression node with a key is shared under options.sharing
+		[[nodiscard]] bool sharesExpression(const ast::NodeKey &key) const {
+			// A child that is not shared contains a call or a side effect, so its parent is not pure
+			return options.sharing == NodeSharing::EXPRESSIONS &&
+				   (key.first == nullptr || key.first->isShared()) &&
+				   (key.second == nullptr || key.second->isShared());
+		}
+
+		/**
+		 * @brief Create a literal node, shared when options.sharing allows
+		 *
+		 * @param text The spelling of the literal, e.g. a view of the source; it is copied into
+		 *             the AST context only when a new node is created
+		 */
+		ast::ASTNodePtr literal(ast::LiteralNode::Kind kind, std::string_view text,
+								const lexer::SourceLocation &location) {
+			auto make = [&]() { return context->create<ast::LiteralNode>(context->copyString(text), kind, location); };
+			ast::NodeKey key{ast::NodeKind::LITERAL, static_cast<int>(kind), text};
+			if (!sharesExpression(key)) {
+				return make();
+			}
+			return context->share<ast::LiteralNode>(key, make);
+		}
+
+		// Key of a unary expression
+		static ast::NodeKey unaryKey(ast::UnaryExpressionNode::Operator op, const ast::ASTNodePtr &operand) {
+			return ast::NodeKey{ast::NodeKind::UNARY_EXPRESSION, static_cast<int>(op), {}, operand.get()};
+		}
 
 		/**
 		 * @brief Report a parsing error
@@ -105,6 +333,42 @@ namespace tinyc::parser {
 		// Program
 		ast::ASTNodePtr parseProgramItem();
 
+		// Error recovery
+
+		/**
+		 * @brief Parse a program item, recovering from errors in it
+		 */
+		ast::ASTNodePtr parseProgramItemOrError();
+
+		/**
+		 * @brief Parse a statement, recovering from errors in it
+		 */
+		ast::ASTNodePtr parseStatementOrError();
+
+		/**
+		 * @brief Record an error and skip to where parsing can resume
+		 *
+		 * An error at the same token as the previous one is a consequence of it and is not
+		 * recorded again.
+		 *
+		 * @param error The error
+		 * @param startToken Value of consumedTokens when the failed construct started
+		 * @param topLevel Resynchronize at declarations rather than statements
+		 * @return ast::ASTNodePtr The error node replacing the failed construct
+		 * @throws StopParsing when the error limit is exceeded
+		 */
+		ast::ASTNodePtr recover(const ParserError &error, std::size_t startToken, bool topLevel);
+
+		/**
+		 * @brief Skip tokens up to the next statement boundary
+		 */
+		void skipStatement();
+
+		/**
+		 * @brief Skip tokens up to the next top-level declaration
+		 */
+		void skipDeclaration();
+
 		// Types
 		ast::ASTNodePtr parseType();
 
@@ -129,46 +393,46 @@ namespace tinyc::parser {
 		// Function and variable declarations
 		ast::ASTNodePtr parseNotVoidFunctionOrVariable(
 				ast::ASTNodePtr type,
-				const std::string &identifier,
+				std::string_view identifier,
 				const lexer::SourceLocation &location);
 
 		ast::ASTNodePtr parseVoidDeclTail(const lexer::SourceLocation &voidLocation);
 
 		ast::ASTNodePtr parseFuncOrVarTail(
 				ast::ASTNodePtr type,
-				const std::string &identifier,
+				std::string_view identifier,
 				const lexer::SourceLocation &location);
 
 		ast::ASTNodePtr parseVariableTail(
 				ast::ASTNodePtr type,
-				const std::string &identifier,
+				std::string_view identifier,
 				const lexer::SourceLocation &location);
 
 		ast::ASTNodePtr parseFunctionDeclarationTail(
 				ast::ASTNodePtr returnType,
-				const std::string &identifier,
+				std::string_view identifier,
 				const lexer::SourceLocation &location);
 
 		ast::ASTNodePtr parseFuncTail();
 
-		std::vector<ast::ASTNodePtr> parseOptFunArgs();
+		ast::NodeList parseOptFunArgs();
 
-		std::vector<ast::ASTNodePtr> parseFunArgTail(std::vector<ast::ASTNodePtr> args);
+		void parseFunArgTail(ast::NodeList &args);
 
 		ast::ASTNodePtr parseFunArg();
 
-		std::vector<ast::ASTNodePtr> parseOptFunPtrArgs();
+		ast::NodeList parseOptFunPtrArgs();
 
-		std::vector<ast::ASTNodePtr> parseFunPtrArgs();
+		ast::NodeList parseFunPtrArgs();
 
-		std::vector<ast::ASTNodePtr> parseFunPtrArgsTail(std::vector<ast::ASTNodePtr> types);
+		void parseFunPtrArgsTail(ast::NodeList &types);
 
 		// Statements
 		ast::ASTNodePtr parseStatement();
 
 		ast::ASTNodePtr parseBlockStmt();
 
-		std::vector<ast::ASTNodePtr> parseStatementStar();
+		ast::NodeList parseStatementStar();
 
 		ast::ASTNodePtr parseIfStmt();
 
@@ -176,14 +440,13 @@ namespace tinyc::parser {
 
 		ast::ASTNodePtr parseSwitchStmt();
 
-		std::vector<ast::SwitchStatementNode::Case> parseCaseWithDefaultStmtStar();
+		ast::SwitchStatementNode::CaseList parseCaseWithDefaultStmtStar();
 
-		std::vector<ast::SwitchStatementNode::Case> parseCaseStmtStar(
-				std::vector<ast::SwitchStatementNode::Case> cases);
+		void parseCaseStmtStar(ast::SwitchStatementNode::CaseList &cases);
 
 		ast::SwitchStatementNode::Case parseCaseStmt();
 
-		std::vector<ast::ASTNodePtr> parseCaseBody();
+		ast::NodeList parseCaseBody();
 
 		ast::SwitchStatementNode::Case parseDefaultCase();
 
@@ -210,7 +473,7 @@ namespace tinyc::parser {
 		// Variable declarations
 		ast::ASTNodePtr parseVarDecls();
 
-		std::vector<ast::ASTNodePtr> parseVarDeclsTail(std::vector<ast::ASTNodePtr> declarations);
+		void parseVarDeclsTail(ast::NodeList &declarations);
 
 		ast::ASTNodePtr parseVarDecl();
 
@@ -221,47 +484,19 @@ namespace tinyc::parser {
 		// Expressions
 		ast::ASTNodePtr parseExprs();
 
-		std::vector<ast::ASTNodePtr> parseExprsTail(std::vector<ast::ASTNodePtr> expressions);
+		void parseExprsTail(ast::NodeList &expressions);
 
 		ast::ASTNodePtr parseExpr();
 
 		ast::ASTNodePtr parseExprTail(ast::ASTNodePtr left);
 
-		ast::ASTNodePtr parseE9();
-
-		ast::ASTNodePtr parseE9Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE8();
-
-		ast::ASTNodePtr parseE8Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE7();
-
-		ast::ASTNodePtr parseE7Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE6();
-
-		ast::ASTNodePtr parseE6Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE5();
-
-		ast::ASTNodePtr parseE5Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE4();
-
-		ast::ASTNodePtr parseE4Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE3();
-
-		ast::ASTNodePtr parseE3Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE2();
-
-		ast::ASTNodePtr parseE2Prime(ast::ASTNodePtr left);
-
-		ast::ASTNodePtr parseE1();
-
-		ast::ASTNodePtr parseE1Prime(ast::ASTNodePtr left);
+		/**
+		 * @brief Parse a binary expression by precedence climbing (E9 .. E1)
+		 *
+		 * @param minPrecedence Only operators binding at least this tightly are consumed
+		 * @return The expression
+		 */
+		ast::ASTNodePtr parseBinaryExpression(int minPrecedence);
 
 		ast::ASTNodePtr parseEUnaryPre();
 
@@ -271,9 +506,9 @@ namespace tinyc::parser {
 
 		ast::ASTNodePtr parseECall(ast::ASTNodePtr callee);
 
-		std::vector<ast::ASTNodePtr> parseOptExprList();
+		ast::NodeList parseOptExprList();
 
-		std::vector<ast::ASTNodePtr> parseExprTailList(std::vector<ast::ASTNodePtr> expressions);
+		void parseExprTailList(ast::NodeList &expressions);
 
 		ast::ASTNodePtr parseEIndex(ast::ASTNodePtr array);
 
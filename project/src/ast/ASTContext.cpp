@@ -0,0 +1,19 @@
+#include "tinyc/ast/ASTContext.h"
+#include <cstring>
+
+namespace tinyc::ast {
+
+	ASTContext::ASTContext(std::size_t initialSize, std::pmr::memory_resource *upstream)
+			: resource(initialSize, upstream) {}
+
+	std::string_view ASTContext::copyString(std::string_view text) {
+		if (text.empty()) {
+			return {};
+		}
+
+		auto *copy = static_cast<char *>(resource.allocate(text.size(), alignof(char)));
+		std::memcpy(copy, text.data(), text.size());
+		return {copy, text.size()};
+	}
+
+} // namespace tinyc::ast
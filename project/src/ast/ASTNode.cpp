@@ -1,21 +1,31 @@
+#include <iterator>
 #include <utility>
 
 #include "tinyc/ast/ASTNode.h"
+#include "tinyc/ast/ASTContext.h"
 
 namespace tinyc::ast {
 
 // ASTNode implementation
-	ASTNode::ASTNode(lexer::SourceLocation location) : location(std::move(location)) {}
+	ASTNode::ASTNode(NodeKind kind, lexer::SourceLocation location) : location(location), nodeKind(kind) {}
 
-	[[nodiscard]] lexer::SourceLocation ASTNode::getLocation() const {
+	[[nodiscard]] const lexer::SourceLocation &ASTNode::getLocation() const {
 		return location;
 	}
 
+// NodeDeleter implementation
+	void NodeDeleter::operator()(ASTNode *node) const noexcept {
+		// Arena nodes are released together with their ASTContext
+		if (node != nullptr && !node->isArenaAllocated()) {
+			delete node;
+		}
+	}
+
 /* ===== Type Nodes ===== */
 
 // PrimitiveTypeNode implementation
 	PrimitiveTypeNode::PrimitiveTypeNode(Kind kind, lexer::SourceLocation location)
-			: ASTNode(std::move(location)), kind(kind) {
+			: ASTNode(NodeKind::PRIMITIVE_TYPE, std::move(location)), kind(kind) {
 	}
 
 	[[nodiscard]] PrimitiveTypeNode::Kind PrimitiveTypeNode::getKind() const {
@@ -38,17 +48,17 @@ namespace tinyc::ast {
 	}
 
 // NamedTypeNode implementation
-	NamedTypeNode::NamedTypeNode(std::string identifier, lexer::SourceLocation location)
-			: ASTNode(std::move(location)), identifier(std::move(identifier)) {
+	NamedTypeNode::NamedTypeNode(std::string_view identifier, lexer::SourceLocation location)
+			: ASTNode(NodeKind::NAMED_TYPE, std::move(location)), identifier(identifier) {
 	}
 
-	[[nodiscard]] const std::string &NamedTypeNode::getIdentifier() const {
+	[[nodiscard]] std::string_view NamedTypeNode::getIdentifier() const {
 		return identifier;
 	}
 
 // PointerTypeNode implementation
 	PointerTypeNode::PointerTypeNode(ASTNodePtr baseType, lexer::SourceLocation location)
-			: ASTNode(std::move(location)), baseType(std::move(baseType)) {
+			: ASTNode(NodeKind::POINTER_TYPE, std::move(location)), baseType(std::move(baseType)) {
 	}
 
 	[[nodiscard]] const ASTNodePtr &PointerTypeNode::getBaseType() const {
@@ -58,15 +68,15 @@ namespace tinyc::ast {
 /* ===== Expression Nodes ===== */
 
 // LiteralNode implementation
-	LiteralNode::LiteralNode(std::string value, Kind kind, lexer::SourceLocation location)
-			: ASTNode(std::move(location)), kind(kind), value(std::move(value)) {
+	LiteralNode::LiteralNode(std::string_view value, Kind kind, lexer::SourceLocation location)
+			: ASTNode(NodeKind::LITERAL, std::move(location)), kind(kind), value(value) {
 	}
 
 	[[nodiscard]] LiteralNode::Kind LiteralNode::getKind() const {
 		return kind;
 	}
 
-	[[nodiscard]] const std::string &LiteralNode::getValue() const {
+	[[nodiscard]] std::string_view LiteralNode::getValue() const {
 		return value;
 	}
 
@@ -86,11 +96,11 @@ namespace tinyc::ast {
 	}
 
 // IdentifierNode implementation
-	IdentifierNode::IdentifierNode(std::string identifier, lexer::SourceLocation location)
-			: ASTNode(std::move(location)), identifier(std::move(identifier)) {
+	IdentifierNode::IdentifierNode(std::string_view identifier, lexer::SourceLocation location)
+			: ASTNode(NodeKind::IDENTIFIER, std::move(location)), identifier(identifier) {
 	}
 
-	[[nodiscard]] const std::string &IdentifierNode::getIdentifier() const {
+	[[nodiscard]] std::string_view IdentifierNode::getIdentifier() const {
 		return identifier;
 	}
 
@@ -100,7 +110,7 @@ namespace tinyc::ast {
 			ASTNodePtr left,
 			ASTNodePtr right,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), op(op), left(std::move(left)), right(std::move(right)) {
+	) : ASTNode(NodeKind::BINARY_EXPRESSION, std::move(location)), op(op), left(std::move(left)), right(std::move(right)) {
 	}
 
 	[[nodiscard]] BinaryExpressionNode::Operator BinaryExpressionNode::getOperator() const {
@@ -163,7 +173,7 @@ namespace tinyc::ast {
 			Operator op,
 			ASTNodePtr operand,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), op(op), operand(std::move(operand)) {
+	) : ASTNode(NodeKind::UNARY_EXPRESSION, std::move(location)), op(op), operand(std::move(operand)) {
 	}
 
 	[[nodiscard]] UnaryExpressionNode::Operator UnaryExpressionNode::getOperator() const {
@@ -225,7 +235,7 @@ namespace tinyc::ast {
 			ASTNodePtr targetType,
 			ASTNodePtr expression,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), targetType(std::move(targetType)), expression(std::move(expression)) {
+	) : ASTNode(NodeKind::CAST_EXPRESSION, std::move(location)), targetType(std::move(targetType)), expression(std::move(expression)) {
 	}
 
 	[[nodiscard]] const ASTNodePtr &CastExpressionNode::getTargetType() const {
@@ -239,16 +249,16 @@ namespace tinyc::ast {
 // CallExpressionNode implementation
 	CallExpressionNode::CallExpressionNode(
 			ASTNodePtr callee,
-			std::vector<ASTNodePtr> arguments,
+			NodeList arguments,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), callee(std::move(callee)), arguments(std::move(arguments)) {
+	) : ASTNode(NodeKind::CALL_EXPRESSION, std::move(location)), callee(std::move(callee)), arguments(std::move(arguments)) {
 	}
 
 	const ASTNodePtr &CallExpressionNode::getCallee() const {
 		return callee;
 	}
 
-	const std::vector<ASTNodePtr> &CallExpressionNode::getArguments() const {
+	const NodeList &CallExpressionNode::getArguments() const {
 		return arguments;
 	}
 
@@ -257,7 +267,7 @@ namespace tinyc::ast {
 			ASTNodePtr array,
 			ASTNodePtr index,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), array(std::move(array)), index(std::move(index)) {
+	) : ASTNode(NodeKind::INDEX_EXPRESSION, std::move(location)), array(std::move(array)), index(std::move(index)) {
 	}
 
 	const ASTNodePtr &IndexExpressionNode::getArray() const {
@@ -272,9 +282,9 @@ namespace tinyc::ast {
 	MemberExpressionNode::MemberExpressionNode(
 			Kind kind,
 			ASTNodePtr object,
-			std::string member,
+			std::string_view member,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), kind(kind), object(std::move(object)), member(std::move(member)) {
+	) : ASTNode(NodeKind::MEMBER_EXPRESSION, std::move(location)), kind(kind), object(std::move(object)), member(member) {
 	}
 
 	MemberExpressionNode::Kind MemberExpressionNode::getKind() const {
@@ -285,18 +295,18 @@ namespace tinyc::ast {
 		return object;
 	}
 
-	const std::string &MemberExpressionNode::getMember() const {
+	std::string_view MemberExpressionNode::getMember() const {
 		return member;
 	}
 
 // CommaExpressionNode implementation
 	CommaExpressionNode::CommaExpressionNode(
-			std::vector<ASTNodePtr> expressions,
+			NodeList expressions,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), expressions(std::move(expressions)) {
+	) : ASTNode(NodeKind::COMMA_EXPRESSION, std::move(location)), expressions(std::move(expressions)) {
 	}
 
-	const std::vector<ASTNodePtr> &CommaExpressionNode::getExpressions() const {
+	const NodeList &CommaExpressionNode::getExpressions() const {
 		return expressions;
 	}
 
@@ -304,12 +314,12 @@ namespace tinyc::ast {
 
 // BlockStatementNode implementation
 	BlockStatementNode::BlockStatementNode(
-			std::vector<ASTNodePtr> statements,
+			NodeList statements,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), statements(std::move(statements)) {
+	) : ASTNode(NodeKind::BLOCK_STATEMENT, std::move(location)), statements(std::move(statements)) {
 	}
 
-	const std::vector<ASTNodePtr> &BlockStatementNode::getStatements() const {
+	const NodeList &BlockStatementNode::getStatements() const {
 		return statements;
 	}
 
@@ -317,7 +327,7 @@ namespace tinyc::ast {
 	ExpressionStatementNode::ExpressionStatementNode(
 			ASTNodePtr expression,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), expression(std::move(expression)) {
+	) : ASTNode(NodeKind::EXPRESSION_STATEMENT, std::move(location)), expression(std::move(expression)) {
 	}
 
 	const ASTNodePtr &ExpressionStatementNode::getExpression() const {
@@ -330,7 +340,7 @@ namespace tinyc::ast {
 			ASTNodePtr thenBranch,
 			ASTNodePtr elseBranch,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)),
+	) : ASTNode(NodeKind::IF_STATEMENT, std::move(location)),
 		condition(std::move(condition)),
 		thenBranch(std::move(thenBranch)),
 		elseBranch(std::move(elseBranch)) {
@@ -357,7 +367,7 @@ namespace tinyc::ast {
 			ASTNodePtr condition,
 			ASTNodePtr body,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), condition(std::move(condition)), body(std::move(body)) {
+	) : ASTNode(NodeKind::WHILE_STATEMENT, std::move(location)), condition(std::move(condition)), body(std::move(body)) {
 	}
 
 	const ASTNodePtr &WhileStatementNode::getCondition() const {
@@ -373,7 +383,7 @@ namespace tinyc::ast {
 			ASTNodePtr body,
 			ASTNodePtr condition,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), body(std::move(body)), condition(std::move(condition)) {
+	) : ASTNode(NodeKind::DO_WHILE_STATEMENT, std::move(location)), body(std::move(body)), condition(std::move(condition)) {
 	}
 
 	const ASTNodePtr &DoWhileStatementNode::getBody() const {
@@ -391,7 +401,7 @@ namespace tinyc::ast {
 			ASTNodePtr update,
 			ASTNodePtr body,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)),
+	) : ASTNode(NodeKind::FOR_STATEMENT, std::move(location)),
 		initialization(std::move(initialization)),
 		condition(std::move(condition)),
 		update(std::move(update)),
@@ -429,34 +439,34 @@ namespace tinyc::ast {
 // SwitchStatementNode implementation
 	SwitchStatementNode::SwitchStatementNode(
 			ASTNodePtr expression,
-			std::vector<Case> cases,
+			CaseList cases,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), expression(std::move(expression)), cases(std::move(cases)) {
+	) : ASTNode(NodeKind::SWITCH_STATEMENT, std::move(location)), expression(std::move(expression)), cases(std::move(cases)) {
 	}
 
 	const ASTNodePtr &SwitchStatementNode::getExpression() const {
 		return expression;
 	}
 
-	const std::vector<SwitchStatementNode::Case> &SwitchStatementNode::getCases() const {
+	const SwitchStatementNode::CaseList &SwitchStatementNode::getCases() const {
 		return cases;
 	}
 
 // BreakStatementNode implementation
 	BreakStatementNode::BreakStatementNode(lexer::SourceLocation location)
-			: ASTNode(std::move(location)) {
+			: ASTNode(NodeKind::BREAK_STATEMENT, std::move(location)) {
 	}
 
 // ContinueStatementNode implementation
 	ContinueStatementNode::ContinueStatementNode(lexer::SourceLocation location)
-			: ASTNode(std::move(location)) {
+			: ASTNode(NodeKind::CONTINUE_STATEMENT, std::move(location)) {
 	}
 
 // ReturnStatementNode implementation
 	ReturnStatementNode::ReturnStatementNode(
 			ASTNodePtr expression,
 			lexer::SourceLocation location
-	) : ASTNode(std::move(location)), expression(std::move(expression)) {
+	) : ASTNode(NodeKind::RETURN_STATEMENT, std::move(location)), expression(std::move(expression)) {
 	}
 
 	bool ReturnStatementNode::hasValue() const {
@@ -471,19 +481,19 @@ namespace tinyc::ast {
 
 // VariableNode implementation
 	VariableNode::VariableNode(
-			std::string identifier,
+			std::string_view identifier,
 			ASTNodePtr type,
 			lexer::SourceLocation location,
 			ASTNodePtr arraySize,
 			ASTNodePtr initializer)
-			: ASTNode(std::move(location)),
-			  identifier(std::move(identifier)),
+			: ASTNode(NodeKind::VARIABLE, std::move(location)),
+			  identifier(identifier),
 			  type(std::move(type)),
 			  arraySize(std::move(arraySize)),
 			  initializer(std::move(initializer)) {
 	}
 
-	const std::string &VariableNode::getIdentifier() const {
+	std::string_view VariableNode::getIdentifier() const {
 		return identifier;
 	}
 
@@ -509,22 +519,22 @@ namespace tinyc::ast {
 
 // MultipleDeclarationNode implementation
 	MultipleDeclarationNode::MultipleDeclarationNode(
-			std::vector<ASTNodePtr> declarations,
+			NodeList declarations,
 			lexer::SourceLocation location)
-			: ASTNode(std::move(location)), declarations(std::move(declarations)) {
+			: ASTNode(NodeKind::MULTIPLE_DECLARATION, std::move(location)), declarations(std::move(declarations)) {
 	}
 
-	const std::vector<ASTNodePtr> &MultipleDeclarationNode::getDeclarations() const {
+	const NodeList &MultipleDeclarationNode::getDeclarations() const {
 		return declarations;
 	}
 
 // ParameterNode implementation
 	ParameterNode::ParameterNode(
-			std::string identifier,
+			std::string_view identifier,
 			ASTNodePtr type,
 			lexer::SourceLocation location)
-			: ASTNode(std::move(location)),
-			  identifier(std::move(identifier)),
+			: ASTNode(NodeKind::PARAMETER, std::move(location)),
+			  identifier(identifier),
 			  type(std::move(type)) {
 	}
 
@@ -532,19 +542,19 @@ namespace tinyc::ast {
 		return type;
 	}
 
-	const std::string &ParameterNode::getIdentifier() const {
+	std::string_view ParameterNode::getIdentifier() const {
 		return identifier;
 	}
 
 // FunctionDeclarationNode implementation
 	FunctionDeclarationNode::FunctionDeclarationNode(
-			std::string identifier,
+			std::string_view identifier,
 			ASTNodePtr returnType,
-			std::vector<ASTNodePtr> parameters,
+			NodeList parameters,
 			ASTNodePtr body,
 			lexer::SourceLocation location)
-			: ASTNode(std::move(location)),
-			  identifier(std::move(identifier)),
+			: ASTNode(NodeKind::FUNCTION_DECLARATION, std::move(location)),
+			  identifier(identifier),
 			  returnType(std::move(returnType)),
 			  parameters(std::move(parameters)),
 			  body(std::move(body)) {
@@ -554,11 +564,11 @@ namespace tinyc::ast {
 		return returnType;
 	}
 
-	const std::string &FunctionDeclarationNode::getIdentifier() const {
+	std::string_view FunctionDeclarationNode::getIdentifier() const {
 		return identifier;
 	}
 
-	const std::vector<ASTNodePtr> &FunctionDeclarationNode::getParameters() const {
+	const NodeList &FunctionDeclarationNode::getParameters() const {
 		return parameters;
 	}
 
@@ -572,13 +582,13 @@ namespace tinyc::ast {
 
 // StructDeclarationNode implementation
 	StructDeclarationNode::StructDeclarationNode(
-			std::string identifier,
-			std::vector<ASTNodePtr> fields,
+			std::string_view identifier,
+			NodeList fields,
 			lexer::SourceLocation location)
-			: ASTNode(std::move(location)), identifier(std::move(identifier)), fields(std::move(fields)) {
+			: ASTNode(NodeKind::STRUCT_DECLARATION, std::move(location)), identifier(identifier), fields(std::move(fields)) {
 	}
 
-	const std::string &StructDeclarationNode::getIdentifier() const {
+	std::string_view StructDeclarationNode::getIdentifier() const {
 		return identifier;
 	}
 
@@ -586,22 +596,22 @@ namespace tinyc::ast {
 		return !fields.empty();
 	}
 
-	void StructDeclarationNode::setFields(std::vector<ASTNodePtr> newFields) {
+	void StructDeclarationNode::setFields(NodeList newFields) {
 		fields = std::move(newFields);
 	}
 
-	const std::vector<ASTNodePtr> &StructDeclarationNode::getFields() const {
+	const NodeList &StructDeclarationNode::getFields() const {
 		return fields;
 	}
 
 // FunctionPointerDeclarationNode implementation
 	FunctionPointerDeclarationNode::FunctionPointerDeclarationNode(
-			std::string identifier,
+			std::string_view identifier,
 			ASTNodePtr returnType,
-			std::vector<ASTNodePtr> parameterTypes,
+			NodeList parameterTypes,
 			lexer::SourceLocation location)
-			: ASTNode(std::move(location)),
-			  identifier(std::move(identifier)),
+			: ASTNode(NodeKind::FUNCTION_POINTER_DECLARATION, std::move(location)),
+			  identifier(identifier),
 			  returnType(std::move(returnType)),
 			  parameterTypes(std::move(parameterTypes)) {
 	}
@@ -610,25 +620,43 @@ namespace tinyc::ast {
 		return returnType;
 	}
 
-	const std::string &FunctionPointerDeclarationNode::getIdentifier() const {
+	std::string_view FunctionPointerDeclarationNode::getIdentifier() const {
 		return identifier;
 	}
 
-	const std::vector<ASTNodePtr> &FunctionPointerDeclarationNode::getParameterTypes() const {
+	const NodeList &FunctionPointerDeclarationNode::getParameterTypes() const {
 		return parameterTypes;
 	}
 
+// ErrorNode implementation
+	ErrorNode::ErrorNode(std::string_view message, lexer::SourceLocation location)
+			: ASTNode(NodeKind::ERROR_NODE, std::move(location)), message(message) {
+	}
+
+	std::string_view ErrorNode::getMessage() const {
+		return message;
+	}
+
 // ProgramNode implementation
-	ProgramNode::ProgramNode(std::string sourceName)
-			: ASTNode(lexer::SourceLocation(std::move(sourceName), 0, 0)) {
+	ProgramNode::ProgramNode(std::string_view sourceName, std::shared_ptr<ASTContext> context)
+			: ASTNode(NodeKind::PROGRAM, lexer::SourceLocation(sourceName, 0, 0)),
+			  context(std::move(context)),
+			  declarations(this->context ? this->context->makeList() : NodeList()) {
 	}
 
 	void ProgramNode::addDeclaration(ASTNodePtr declaration) {
 		declarations.push_back(std::move(declaration));
 	}
 
-	const std::vector<ASTNodePtr> &ProgramNode::getDeclarations() const {
+	const NodeList &ProgramNode::getDeclarations() const {
 		return declarations;
 	}
 
+	void ProgramNode::replaceDeclarations(std::size_t first, std::size_t count, NodeList replacement) {
+		auto begin = declarations.begin() + static_cast<std::ptrdiff_t>(first);
+		begin = declarations.erase(begin, begin + static_cast<std::ptrdiff_t>(count));
+		declarations.insert(begin, std::make_move_iterator(replacement.begin()),
+							std::make_move_iterator(replacement.end()));
+	}
+
 } // namespace tinyc::ast
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "tinyc/ast/BinaryAST.h"
+#include "tinyc/ast/ASTContext.h"
+#include <cstring>
+#include <memory>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		template<typename T>
+		T load(const char *at) {
+			// The tables need not be aligned in memory (e.g. when read from a pipe)
+			T value;
+			std::memcpy(&value, at, sizeof(T));
+			return value;
+		}
+
+	} // namespace
+
+	/* ===== BinaryNodeView ===== */
+
+	BinaryNodeView::BinaryNodeView(const BinaryAST &ast, std::uint32_t index)
+			: ast(&ast), nodeIndex(index),
+			  record(load<binary::NodeRecord>(ast.nodes + std::size_t{index} * sizeof(binary::NodeRecord))) {
+		if (std::uint64_t{record.firstChild} + record.childCount > ast.header.childCount) {
+			throw BinaryFormatError("children of node " + std::to_string(index) + " out of range");
+		}
+	}
+
+	NodeKind BinaryNodeView::kind() const {
+		if (record.kind >= NODE_KIND_COUNT) {
+			throw BinaryFormatError("record " + std::to_string(nodeIndex) + " is not a node");
+		}
+		return static_cast<NodeKind>(record.kind);
+	}
+
+	std::string_view BinaryNodeView::text() const {
+		return record.text == binary::NONE ? std::string_view() : ast->string(record.text);
+	}
+
+	std::string_view BinaryNodeView::fileName() const {
+		return ast->string(record.file);
+	}
+
+	std::uint32_t BinaryNodeView::slot(std::size_t slot) const {
+		if (slot >= record.childCount) {
+			throw BinaryFormatError("node " + std::to_string(nodeIndex) + " has no child slot " +
+									std::to_string(slot));
+		}
+		return load<std::uint32_t>(ast->children + (record.firstChild + slot) * sizeof(std::uint32_t));
+	}
+
+	bool BinaryNodeView::hasChild(std::size_t slot) const {
+		return slot < record.childCount && this->slot(slot) != binary::NONE;
+	}
+
+	BinaryNodeView BinaryNodeView::child(std::size_t slot) const {
+		std::uint32_t index = this->slot(slot);
+		// Pre-order: children always come after their parent, which also rules out cycles
+		if (index == binary::NONE || index <= nodeIndex) {
+			throw BinaryFormatError("invalid child " + std::to_string(slot) + " of node " + std::to_string(nodeIndex));
+		}
+		return ast->node(index);
+	}
+
+	/* ===== BinaryAST ===== */
+
+	BinaryAST BinaryAST::fromFile(const std::string &filename) {
+		return BinaryAST(lexer::SourceBuffer::fromFile(filename));
+	}
+
+	BinaryAST BinaryAST::fromBytes(std::string bytes) {
+		return BinaryAST(lexer::SourceBuffer::fromString(std::move(bytes), "<binary>"));
+	}
+
+	BinaryAST::BinaryAST(lexer::SourceBuffer source) : buffer(std::move(source)) {
+		std::string_view bytes = buffer.getText();
+		if (bytes.size() < sizeof(binary::Header)) {
+			throw BinaryFormatError("file too short");
+		}
+
+		header = load<binary::Header>(bytes.data());
+		if (std::memcmp(header.magic, binary::MAGIC, sizeof(header.magic)) != 0) {
+			throw BinaryFormatError("bad magic");
+		}
+		if (header.byteOrder != binary::BYTE_ORDER_MARK) {
+			throw BinaryFormatError("written with a different byte order");
+		}
+		if (header.version != binary::VERSION) {
+			throw BinaryFormatError("unsupported version " + std::to_string(header.version));
+		}
+
+		// Table sizes are checked in 64 bits so corrupt counts cannot wrap around
+		std::uint64_t expected = sizeof(binary::Header) +
+								 std::uint64_t{header.nodeCount} * sizeof(binary::NodeRecord) +
+								 (std::uint64_t{header.childCount} + header.stringCount + 1) * sizeof(std::uint32_t) +
+								 header.stringBytes;
+		if (header.nodeCount == 0 || expected != header.totalSize || header.totalSize > bytes.size()) {
+			throw BinaryFormatError("table sizes do not match the file size");
+		}
+
+		nodes = bytes.data() + sizeof(binary::Header);
+		children = nodes + std::size_t{header.nodeCount} * sizeof(binary::NodeRecord);
+		offsets = children + std::size_t{header.childCount} * sizeof(std::uint32_t);
+		strings = offsets + (std::size_t{header.stringCount} + 1) * sizeof(std::uint32_t);
+	}
+
+	BinaryNodeView BinaryAST::node(std::uint32_t index) const {
+		if (index >= header.nodeCount) {
+			throw BinaryFormatError("node index " + std::to_string(index) + " out of range");
+		}
+		return BinaryNodeView(*this, index);
+	}
+
+	std::string_view BinaryAST::string(std::uint32_t id) const {
+		if (id >= header.stringCount) {
+			throw BinaryFormatError("string id " + std::to_string(id) + " out of range");
+		}
+		auto begin = load<std::uint32_t>(offsets + std::size_t{id} * sizeof(std::uint32_t));
+		auto end = load<std::uint32_t>(offsets + (std::size_t{id} + 1) * sizeof(std::uint32_t));
+		if (begin > end || end > header.stringBytes) {
+			throw BinaryFormatError("string " + std::to_string(id) + " out of range");
+		}
+		return {strings + begin, end - begin};
+	}
+
+	/* ===== readTree ===== */
+
+	namespace {
+
+		class TreeBuilder {
+		public:
+			explicit TreeBuilder(ASTContext &context) : context(context) {}
+
+			ASTNodePtr build(const BinaryNodeView &view) {
+				lexer::SourceLocation location(view.fileName(), view.line(), view.column());
+
+				switch (view.kind()) {
+					case NodeKind::VARIABLE:
+						return context.create<VariableNode>(text(view), optional(view, 0), location,
+															optional(view, 1), optional(view, 2));
+					case NodeKind::MULTIPLE_DECLARATION:
+						return context.create<MultipleDeclarationNode>(list(view, 0), location);
+					case NodeKind::PARAMETER:
+						return context.create<ParameterNode>(text(view), required(view, 0), location);
+					case NodeKind::FUNCTION_DECLARATION: {
+						// Parameters are stored after the body but precede it in the tree
+						ASTNodePtr returnType = required(view, 0);
+						NodeList parameters = list(view, 2);
+						return context.create<FunctionDeclarationNode>(text(view), std::move(returnType),
+																	   std::move(parameters), optional(view, 1),
+																	   location);
+					}
+					case NodeKind::STRUCT_DECLARATION:
+						return context.create<StructDeclarationNode>(text(view), list(view, 0), location);
+					case NodeKind::FUNCTION_POINTER_DECLARATION: {
+						ASTNodePtr returnType = required(view, 0);
+						return context.create<FunctionPointerDeclarationNode>(text(view), std::move(returnType),
+																			  list(view, 1), location);
+					}
+					case NodeKind::PRIMITIVE_TYPE:
+						return context.create<PrimitiveTypeNode>(detail(view, PrimitiveTypeNode::Kind::VOID), location);
+					case NodeKind::NAMED_TYPE:
+						return context.create<NamedTypeNode>(text(view), location);
+					case NodeKind::POINTER_TYPE:
+						return context.create<PointerTypeNode>(required(view, 0), location);
+					case NodeKind::LITERAL:
+						return context.create<LiteralNode>(text(view), detail(view, LiteralNode::Kind::STRING), location);
+					case NodeKind::IDENTIFIER:
+						return context.create<IdentifierNode>(text(view), location);
+					case NodeKind::BINARY_EXPRESSION: {
+						ASTNodePtr left = required(view, 0);
+						return context.create<BinaryExpressionNode>(
+								detail(view, BinaryExpressionNode::Operator::ASSIGN), std::move(left),
+								required(view, 1), location);
+					}
+					case NodeKind::UNARY_EXPRESSION:
+						return context.create<UnaryExpressionNode>(detail(view, UnaryExpressionNode::Operator::POST_DECREMENT),
+																   required(view, 0), location);
+					case NodeKind::CAST_EXPRESSION: {
+						ASTNodePtr targetType = required(view, 0);
+						return context.create<CastExpressionNode>(std::move(targetType), required(view, 1), location);
+					}
+					case NodeKind::CALL_EXPRESSION: {
+						ASTNodePtr callee = required(view, 0);
+						return context.create<CallExpressionNode>(std::move(callee), list(view, 1), location);
+					}
+					case NodeKind::INDEX_EXPRESSION: {
+						ASTNodePtr array = required(view, 0);
+						return context.create<IndexExpressionNode>(std::move(array), required(view, 1), location);
+					}
+					case NodeKind::MEMBER_EXPRESSION:
+						return context.create<MemberExpressionNode>(detail(view, MemberExpressionNode::Kind::ARROW),
+																	required(view, 0), text(view), location);
+					case NodeKind::COMMA_EXPRESSION:
+						return context.create<CommaExpressionNode>(list(view, 0), location);
+					case NodeKind::BLOCK_STATEMENT:
+						return context.create<BlockStatementNode>(list(view, 0), location);
+					case NodeKind::EXPRESSION_STATEMENT:
+						return context.create<ExpressionStatementNode>(required(view, 0), location);
+					case NodeKind::IF_STATEMENT: {
+						ASTNodePtr condition = required(view, 0);
+						ASTNodePtr thenBranch = required(view, 1);
+						return context.create<IfStatementNode>(std::move(condition), std::move(thenBranch),
+															   optional(view, 2), location);
+					}
+					case NodeKind::WHILE_STATEMENT: {
+						ASTNodePtr condition = required(view, 0);
+						return context.create<WhileStatementNode>(std::move(condition), required(view, 1), location);
+					}
+					case NodeKind::DO_WHILE_STATEMENT: {
+						ASTNodePtr body = required(view, 0);
+						return context.create<DoWhileStatementNode>(std::move(body), required(view, 1), location);
+					}
+					case NodeKind::FOR_STATEMENT: {
+						ASTNodePtr initialization = optional(view, 0);
+						ASTNodePtr condition = optional(view, 1);
+						ASTNodePtr update = optional(view, 2);
+						return context.create<ForStatementNode>(std::move(initialization), std::move(condition),
+																std::move(update), required(view, 3), location);
+					}
+					case NodeKind::SWITCH_STATEMENT: {
+						ASTNodePtr expression = required(view, 0);
+						SwitchStatementNode::CaseList cases(context.getResource());
+						for (std::size_t i = 1; i < view.childCount(); ++i) {
+							BinaryNodeView caseView = view.child(i);
+							if (!caseView.isCase()) {
+								throw BinaryFormatError("switch child is not a case");
+							}
+							cases.push_back({caseView.value(), caseView.hasFlag(binary::DEFAULT_CASE),
+											 list(caseView, 0)});
+						}
+						return context.create<SwitchStatementNode>(std::move(expression), std::move(cases), location);
+					}
+					case NodeKind::BREAK_STATEMENT:
+						return context.create<BreakStatementNode>(location);
+					case NodeKind::CONTINUE_STATEMENT:
+						return context.create<ContinueStatementNode>(location);
+					case NodeKind::RETURN_STATEMENT:
+						return context.create<ReturnStatementNode>(optional(view, 0), location);
+					case NodeKind::ERROR_NODE:
+						return context.create<ErrorNode>(text(view), location);
+					case NodeKind::PROGRAM:
+						break;
+				}
+				throw BinaryFormatError("unexpected node kind in a program");
+			}
+
+			NodeList list(const BinaryNodeView &view, std::size_t firstSlot) {
+				NodeList nodes = context.makeList();
+				for (std::size_t i = firstSlot; i < view.childCount(); ++i) {
+					nodes.push_back(required(view, i));
+				}
+				return nodes;
+			}
+
+		private:
+			ASTContext &context;
+
+			std::string_view text(const BinaryNodeView &view) {
+				return context.copyString(view.text());
+			}
+
+			ASTNodePtr required(const BinaryNodeView &view, std::size_t slot) {
+				return build(view.child(slot));
+			}
+
+			ASTNodePtr optional(const BinaryNodeView &view, std::size_t slot) {
+				return view.hasChild(slot) ? build(view.child(slot)) : nullptr;
+			}
+
+			// Decode the detail byte, rejecting values past the last enumerator
+			template<typename Enum>
+			Enum detail(const BinaryNodeView &view, Enum last) {
+				if (view.detail() > static_cast<int>(last)) {
+					throw BinaryFormatError("invalid detail of node " + std::to_string(view.index()));
+				}
+				return static_cast<Enum>(view.detail());
+			}
+		};
+
+	} // namespace
+
+	ASTNodePtr readTree(const BinaryAST &ast) {
+		BinaryNodeView root = ast.root();
+		if (root.isCase() || root.kind() != NodeKind::PROGRAM) {
+			throw BinaryFormatError("root is not a program");
+		}
+
+		auto context = std::make_shared<ASTContext>();
+		auto program = std::make_unique<ProgramNode>(root.fileName(), context);
+		TreeBuilder builder(*context);
+		for (auto &declaration: builder.list(root, 0)) {
+			program->addDeclaration(std::move(declaration));
+		}
+		return program;
+	}
+
+} // namespace tinyc::ast
@@ -0,0 +1,316 @@
+#include "tinyc/ast/FlatAST.h"
+#include "tinyc/ast/NodeVisitor.h"
+#include <stdexcept>
+
+namespace tinyc::ast {
+
+	/**
+	 * @brief Visitor appending the nodes of a tree to a FlatAST
+	 *
+	 * Each visit adds its node as a child of `parent`, after `previous`, in slot `slot`, and
+	 * then visits its own children with those set accordingly.
+	 */
+	class FlatBuilder : public NodeVisitor {
+	public:
+		FlatBuilder(FlatAST &flat, std::uint32_t parent, std::uint32_t previous, std::uint32_t slot)
+				: flat(flat), parent(parent), previous(previous), slot(slot) {}
+
+		// Program nodes
+		void visit(const ProgramNode &node) override {
+			Frame self = add(NodeKind::PROGRAM, node);
+			children(self, 0, node.getDeclarations());
+		}
+
+		// Declaration nodes
+		void visit(const VariableNode &node) override {
+			Frame self = add(NodeKind::VARIABLE, node, node.getIdentifier());
+			child(self, 0, node.getType());
+			child(self, 1, node.getArraySize());
+			child(self, 2, node.getInitializer());
+		}
+
+		void visit(const MultipleDeclarationNode &node) override {
+			Frame self = add(NodeKind::MULTIPLE_DECLARATION, node);
+			children(self, 0, node.getDeclarations());
+		}
+
+		void visit(const ParameterNode &node) override {
+			Frame self = add(NodeKind::PARAMETER, node, node.getIdentifier());
+			child(self, 0, node.getType());
+		}
+
+		void visit(const FunctionDeclarationNode &node) override {
+			Frame self = add(NodeKind::FUNCTION_DECLARATION, node, node.getIdentifier());
+			child(self, 0, node.getReturnType());
+			children(self, 2, node.getParameters());
+			child(self, 1, node.getBody());
+		}
+
+		void visit(const StructDeclarationNode &node) override {
+			Frame self = add(NodeKind::STRUCT_DECLARATION, node, node.getIdentifier());
+			children(self, 0, node.getFields());
+		}
+
+		void visit(const FunctionPointerDeclarationNode &node) override {
+			Frame self = add(NodeKind::FUNCTION_POINTER_DECLARATION, node, node.getIdentifier());
+			child(self, 0, node.getReturnType());
+			children(self, 1, node.getParameterTypes());
+		}
+
+		// Type nodes
+		void visit(const PrimitiveTypeNode &node) override {
+			add(NodeKind::PRIMITIVE_TYPE, node, {}, node.getKind());
+		}
+
+		void visit(const NamedTypeNode &node) override {
+			add(NodeKind::NAMED_TYPE, node, node.getIdentifier());
+		}
+
+		void visit(const PointerTypeNode &node) override {
+			Frame self = add(NodeKind::POINTER_TYPE, node);
+			child(self, 0, node.getBaseType());
+		}
+
+		// Expression nodes
+		void visit(const LiteralNode &node) override {
+			add(NodeKind::LITERAL, node, node.getValue(), node.getKind());
+		}
+
+		void visit(const IdentifierNode &node) override {
+			add(NodeKind::IDENTIFIER, node, node.getIdentifier());
+		}
+
+		void visit(const BinaryExpressionNode &node) override {
+			Frame self = add(NodeKind::BINARY_EXPRESSION, node, {}, node.getOperator());
+			child(self, 0, node.getLeft());
+			child(self, 1, node.getRight());
+		}
+
+		void visit(const UnaryExpressionNode &node) override {
+			Frame self = add(NodeKind::UNARY_EXPRESSION, node, {}, node.getOperator());
+			child(self, 0, node.getOperand());
+		}
+
+		void visit(const CastExpressionNode &node) override {
+			Frame self = add(NodeKind::CAST_EXPRESSION, node);
+			child(self, 0, node.getTargetType());
+			child(self, 1, node.getExpression());
+		}
+
+		void visit(const CallExpressionNode &node) override {
+			Frame self = add(NodeKind::CALL_EXPRESSION, node);
+			child(self, 0, node.getCallee());
+			children(self, 1, node.getArguments());
+		}
+
+		void visit(const IndexExpressionNode &node) override {
+			Frame self = add(NodeKind::INDEX_EXPRESSION, node);
+			child(self, 0, node.getArray());
+			child(self, 1, node.getIndex());
+		}
+
+		void visit(const MemberExpressionNode &node) override {
+			Frame self = add(NodeKind::MEMBER_EXPRESSION, node, node.getMember(), node.getKind());
+			child(self, 0, node.getObject());
+		}
+
+		void visit(const CommaExpressionNode &node) override {
+			Frame self = add(NodeKind::COMMA_EXPRESSION, node);
+			children(self, 0, node.getExpressions());
+		}
+
+		// Statement nodes
+		void visit(const BlockStatementNode &node) override {
+			Frame self = add(NodeKind::BLOCK_STATEMENT, node);
+			children(self, 0, node.getStatements());
+		}
+
+		void visit(const ExpressionStatementNode &node) override {
+			Frame self = add(NodeKind::EXPRESSION_STATEMENT, node);
+			child(self, 0, node.getExpression());
+		}
+
+		void visit(const IfStatementNode &node) override {
+			Frame self = add(NodeKind::IF_STATEMENT, node);
+			child(self, 0, node.getCondition());
+			child(self, 1, node.getThenBranch());
+			child(self, 2, node.getElseBranch());
+		}
+
+		void visit(const WhileStatementNode &node) override {
+			Frame self = add(NodeKind::WHILE_STATEMENT, node);
+			child(self, 0, node.getCondition());
+			child(self, 1, node.getBody());
+		}
+
+		void visit(const DoWhileStatementNode &node) override {
+			Frame self = add(NodeKind::DO_WHILE_STATEMENT, node);
+			child(self, 0, node.getBody());
+			child(self, 1, node.getCondition());
+		}
+
+		void visit(const ForStatementNode &node) override {
+			Frame self = add(NodeKind::FOR_STATEMENT, node);
+			child(self, 0, node.getInitialization());
+			child(self, 1, node.getCondition());
+			child(self, 2, node.getUpdate());
+			child(self, 3, node.getBody());
+		}
+
+		void visit(const SwitchStatementNode &node) override {
+			Frame self = add(NodeKind::SWITCH_STATEMENT, node);
+			child(self, 0, node.getExpression());
+
+			const auto &cases = node.getCases();
+			for (std::size_t i = 0; i < cases.size(); ++i) {
+				// Cases have no location of their own, they use the switch's
+				enter(self, static_cast<std::uint32_t>(1 + i));
+				Frame caseFrame = addRecord(CASE_KIND, node.getLocation(), {}, cases[i].isDefault ? 1 : 0);
+				flat.values[caseFrame.node] = cases[i].value;
+				children(caseFrame, 0, cases[i].body);
+				self.last = caseFrame.node;
+			}
+		}
+
+		void visit(const BreakStatementNode &node) override {
+			add(NodeKind::BREAK_STATEMENT, node);
+		}
+
+		void visit(const ContinueStatementNode &node) override {
+			add(NodeKind::CONTINUE_STATEMENT, node);
+		}
+
+		void visit(const ReturnStatementNode &node) override {
+			Frame self = add(NodeKind::RETURN_STATEMENT, node);
+			child(self, 0, node.getExpression());
+		}
+
+		// Error nodes
+		void visit(const ErrorNode &node) override {
+			add(NodeKind::ERROR_NODE, node, node.getMessage());
+		}
+
+	private:
+		// A node whose children are being added, and its last child so far
+		struct Frame {
+			std::uint32_t node;
+			std::uint32_t last;
+		};
+
+		FlatAST &flat;
+		std::uint32_t parent;
+		std::uint32_t previous;
+		std::uint32_t slot;
+
+		Frame addRecord(std::uint8_t kind, const lexer::SourceLocation &location, std::string_view text,
+						std::uint8_t detail) {
+			auto index = static_cast<std::uint32_t>(flat.size());
+			if (index == FlatAST::NONE) {
+				throw std::length_error("AST too large to flatten");
+			}
+
+			flat.kindBytes.push_back(kind);
+			flat.details.push_back(detail);
+			flat.parents.push_back(parent);
+			flat.firstChildren.push_back(FlatAST::NONE);
+			flat.nextSiblings.push_back(FlatAST::NONE);
+			flat.slots.push_back(slot);
+			flat.texts.push_back(flat.strings->copyString(text));
+			flat.values.push_back(0);
+			flat.locations.push_back(location);
+
+			if (previous != FlatAST::NONE) {
+				flat.nextSiblings[previous] = index;
+			} else if (parent != FlatAST::NONE) {
+				flat.firstChildren[parent] = index;
+			}
+			return {index, FlatAST::NONE};
+		}
+
+		template<typename Detail = std::uint8_t>
+		Frame add(NodeKind kind, const ASTNode &node, std::string_view text = {}, Detail detail = {}) {
+			return addRecord(static_cast<std::uint8_t>(kind), node.getLocation(), text,
+							 static_cast<std::uint8_t>(detail));
+		}
+
+		// Make the next node added a child of frame in the given slot
+		void enter(const Frame &frame, std::uint32_t childSlot) {
+			parent = frame.node;
+			previous = frame.last;
+			slot = childSlot;
+		}
+
+		void child(Frame &frame, std::uint32_t childSlot, const ASTNodePtr &node) {
+			if (!node) {
+				return;
+			}
+			enter(frame, childSlot);
+			// The child's node is the next one appended
+			auto index = static_cast<std::uint32_t>(flat.size());
+			node->accept(*this);
+			frame.last = index;
+		}
+
+		void children(Frame &frame, std::uint32_t firstSlot, const NodeList &list) {
+			for (std::size_t i = 0; i < list.size(); ++i) {
+				child(frame, firstSlot + static_cast<std::uint32_t>(i), list[i]);
+			}
+		}
+	};
+
+	FlatAST::FlatAST() : strings(std::make_unique<ASTContext>()) {}
+
+	FlatAST FlatAST::fromTree(const ASTNode &root) {
+		FlatAST flat;
+		flat.append(root, NONE);
+		return flat;
+	}
+
+	std::uint32_t FlatAST::append(const ASTNode &node, std::uint32_t parent) {
+		// Walk up from the last node to the parent; the node below it is its last child
+		std::uint32_t previous = NONE;
+		std::uint32_t slot = 0;
+		if (parent == NONE) {
+			if (size() != 0) {
+				throw std::invalid_argument("FlatAST already has a root");
+			}
+		} else {
+			std::uint32_t current = size() == 0 ? NONE : static_cast<std::uint32_t>(size() - 1);
+			while (current != NONE && current != parent && parents[current] != parent) {
+				current = parents[current];
+			}
+			if (current == NONE) {
+				throw std::invalid_argument("Appending to a node that is not on the last path");
+			}
+			if (current != parent) {
+				previous = current;
+				slot = slots[current] + 1;
+			}
+		}
+
+		auto index = static_cast<std::uint32_t>(size());
+		FlatBuilder builder(*this, parent, previous, slot);
+		node.accept(builder);
+		return index;
+	}
+
+	std::uint32_t FlatAST::child(std::uint32_t node, std::uint32_t slot) const {
+		for (std::uint32_t current = firstChildren[node]; current != NONE; current = nextSiblings[current]) {
+			if (slots[current] == slot) {
+				return current;
+			}
+		}
+		return NONE;
+	}
+
+	std::uint32_t FlatAST::subtreeEnd(std::uint32_t node) const {
+		// The subtree ends where the next sibling of the node or of its nearest ancestor starts
+		for (std::uint32_t current = node; current != NONE; current = parents[current]) {
+			if (nextSiblings[current] != NONE) {
+				return nextSiblings[current];
+			}
+		}
+		return static_cast<std::uint32_t>(size());
+	}
+
+} // namespace tinyc::ast
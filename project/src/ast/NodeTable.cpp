@@ -0,0 +1,120 @@
+#include "tinyc/ast/NodeTable.h"
+#include "tinyc/ast/ASTNode.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		// Finalizer of splitmix64, spreading every input bit over the low bits used as index
+		std::uint64_t mix(std::uint64_t value) {
+			value ^= value >> 30;
+			value *= 0xbf58476d1ce4e5b9ULL;
+			value ^= value >> 27;
+			value *= 0x94d049bb133111ebULL;
+			value ^= value >> 31;
+			return value;
+		}
+
+	} // namespace
+
+	NodeKey NodeKey::of(const ASTNode &node) {
+		NodeKey key{node.getNodeKind()};
+		switch (node.getNodeKind()) {
+			case NodeKind::PRIMITIVE_TYPE:
+				key.detail = static_cast<int>(static_cast<const PrimitiveTypeNode &>(node).getKind());
+				break;
+			case NodeKind::NAMED_TYPE:
+				key.text = static_cast<const NamedTypeNode &>(node).getIdentifier();
+				break;
+			case NodeKind::POINTER_TYPE:
+				key.first = static_cast<const PointerTypeNode &>(node).getBaseType().get();
+				break;
+			case NodeKind::LITERAL: {
+				const auto &literal = static_cast<const LiteralNode &>(node);
+				key.detail = static_cast<int>(literal.getKind());
+				key.text = literal.getValue();
+				break;
+			}
+			case NodeKind::IDENTIFIER:
+				key.text = static_cast<const IdentifierNode &>(node).getIdentifier();
+				break;
+			case NodeKind::BINARY_EXPRESSION: {
+				const auto &binary = static_cast<const BinaryExpressionNode &>(node);
+				key.detail = static_cast<int>(binary.getOperator());
+				key.first = binary.getLeft().get();
+				key.second = binary.getRight().get();
+				break;
+			}
+			case NodeKind::UNARY_EXPRESSION: {
+				const auto &unary = static_cast<const UnaryExpressionNode &>(node);
+				key.detail = static_cast<int>(unary.getOperator());
+				key.first = unary.getOperand().get();
+				break;
+			}
+			case NodeKind::CAST_EXPRESSION: {
+				const auto &cast = static_cast<const CastExpressionNode &>(node);
+				key.first = cast.getTargetType().get();
+				key.second = cast.getExpression().get();
+				break;
+			}
+			case NodeKind::INDEX_EXPRESSION: {
+				const auto &index = static_cast<const IndexExpressionNode &>(node);
+				key.first = index.getArray().get();
+				key.second = index.getIndex().get();
+				break;
+			}
+			case NodeKind::MEMBER_EXPRESSION: {
+				const auto &member = static_cast<const MemberExpressionNode &>(node);
+				key.detail = static_cast<int>(member.getKind());
+				key.text = member.getMember();
+				key.first = member.getObject().get();
+				break;
+			}
+			default:
+				throw std::invalid_argument("Node kind " + std::to_string(static_cast<int>(node.getNodeKind())) +
+											" cannot be shared");
+		}
+		return key;
+	}
+
+	std::uint64_t NodeTable::hash(const NodeKey &key) {
+		// FNV-1a over the text, then the fields and the identities of the children
+		std::uint64_t result = 0xcbf29ce484222325ULL;
+		for (char c: key.text) {
+			result ^= static_cast<unsigned char>(c);
+			result *= 0x100000001b3ULL;
+		}
+		result = mix(result ^ (static_cast<std::uint64_t>(key.kind) << 32 | static_cast<std::uint32_t>(key.detail)));
+		result = mix(result ^ reinterpret_cast<std::uintptr_t>(key.first));
+		return mix(result ^ reinterpret_cast<std::uintptr_t>(key.second));
+	}
+
+	NodeTable::Entry &NodeTable::find(const NodeKey &key, std::uint64_t keyHash) {
+		if (used * 2 >= slots.size()) {
+			std::vector<Entry> grown(std::max<std::size_t>(64, slots.size() * 2), Entry{0, nullptr});
+			std::size_t mask = grown.size() - 1;
+			for (const Entry &entry: slots) {
+				if (entry.node != nullptr) {
+					std::size_t i = entry.hash & mask;
+					while (grown[i].node != nullptr) {
+						i = (i + 1) & mask;
+					}
+					grown[i] = entry;
+				}
+			}
+			slots = std::move(grown);
+		}
+
+		std::size_t mask = slots.size() - 1;
+		for (std::size_t i = keyHash & mask;; i = (i + 1) & mask) {
+			Entry &entry = slots[i];
+			if (entry.node == nullptr || (entry.hash == keyHash && NodeKey::of(*entry.node) == key)) {
+				return entry;
+			}
+		}
+	}
+
+} // namespace tinyc::ast
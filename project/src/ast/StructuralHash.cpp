@@ -0,0 +1,273 @@
+#include "tinyc/ast/StructuralHash.h"
+#include "tinyc/ast/StaticVisitor.h"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		/**
+		 * @brief Visitor reporting the structure of one node to a sink
+		 *
+		 * The sink receives the fields of the node as value() and text() calls and its children
+		 * as child() calls (null for an absent optional child), in constructor order. Lists and
+		 * switch cases are preceded by their length, so the calls of two nodes of the same kind
+		 * line up exactly when their values do.
+		 */
+		template<typename Sink>
+		class ShapeVisitor final : public StaticVisitor<ShapeVisitor<Sink>> {
+		public:
+			explicit ShapeVisitor(Sink &sink) : sink(sink) {}
+
+			// Program nodes
+			void visit(const ProgramNode &node) { children(node.getDeclarations()); }
+
+			// Declaration nodes
+			void visit(const VariableNode &node) {
+				sink.text(node.getIdentifier());
+				sink.child(node.getType().get());
+				sink.child(node.getArraySize().get());
+				sink.child(node.getInitializer().get());
+			}
+
+			void visit(const MultipleDeclarationNode &node) { children(node.getDeclarations()); }
+
+			void visit(const ParameterNode &node) {
+				sink.child(node.getType().get());
+				sink.text(node.getIdentifier());
+			}
+
+			void visit(const FunctionDeclarationNode &node) {
+				sink.child(node.getReturnType().get());
+				sink.text(node.getIdentifier());
+				children(node.getParameters());
+				sink.child(node.getBody().get());
+			}
+
+			void visit(const StructDeclarationNode &node) {
+				sink.text(node.getIdentifier());
+				children(node.getFields());
+			}
+
+			void visit(const FunctionPointerDeclarationNode &node) {
+				sink.text(node.getIdentifier());
+				sink.child(node.getReturnType().get());
+				children(node.getParameterTypes());
+			}
+
+			// Type nodes
+			void visit(const PrimitiveTypeNode &node) { sink.value(static_cast<std::int64_t>(node.getKind())); }
+
+			void visit(const NamedTypeNode &node) { sink.text(node.getIdentifier()); }
+
+			void visit(const PointerTypeNode &node) { sink.child(node.getBaseType().get()); }
+
+			// Expression nodes
+			void visit(const LiteralNode &node) {
+				sink.value(static_cast<std::int64_t>(node.getKind()));
+				sink.text(node.getValue());
+			}
+
+			void visit(const IdentifierNode &node) { sink.text(node.getIdentifier()); }
+
+			void visit(const BinaryExpressionNode &node) {
+				sink.value(static_cast<std::int64_t>(node.getOperator()));
+				sink.child(node.getLeft().get());
+				sink.child(node.getRight().get());
+			}
+
+			void visit(const UnaryExpressionNode &node) {
+				sink.value(static_cast<std::int64_t>(node.getOperator()));
+				sink.child(node.getOperand().get());
+			}
+
+			void visit(const CastExpressionNode &node) {
+				sink.child(node.getTargetType().get());
+				sink.child(node.getExpression().get());
+			}
+
+			void visit(const CallExpressionNode &node) {
+				sink.child(node.getCallee().get());
+				children(node.getArguments());
+			}
+
+			void visit(const IndexExpressionNode &node) {
+				sink.child(node.getArray().get());
+				sink.child(node.getIndex().get());
+			}
+
+			void visit(const MemberExpressionNode &node) {
+				sink.value(static_cast<std::int64_t>(node.getKind()));
+				sink.child(node.getObject().get());
+				sink.text(node.getMember());
+			}
+
+			void visit(const CommaExpressionNode &node) { children(node.getExpressions()); }
+
+			// Statement nodes
+			void visit(const BlockStatementNode &node) { children(node.getStatements()); }
+
+			void visit(const ExpressionStatementNode &node) { sink.child(node.getExpression().get()); }
+
+			void visit(const IfStatementNode &node) {
+				sink.child(node.getCondition().get());
+				sink.child(node.getThenBranch().get());
+				sink.child(node.getElseBranch().get());
+			}
+
+			void visit(const WhileStatementNode &node) {
+				sink.child(node.getCondition().get());
+				sink.child(node.getBody().get());
+			}
+
+			void visit(const DoWhileStatementNode &node) {
+				sink.child(node.getBody().get());
+				sink.child(node.getCondition().get());
+			}
+
+			void visit(const ForStatementNode &node) {
+				sink.child(node.getInitialization().get());
+				sink.child(node.getCondition().get());
+				sink.child(node.getUpdate().get());
+				sink.child(node.getBody().get());
+			}
+
+			void visit(const SwitchStatementNode &node) {
+				sink.child(node.getExpression().get());
+				sink.value(static_cast<std::int64_t>(node.getCases().size()));
+				for (const auto &switchCase: node.getCases()) {
+					sink.value(switchCase.isDefault ? 1 : 0);
+					sink.value(switchCase.isDefault ? 0 : switchCase.value);
+					children(switchCase.body);
+				}
+			}
+
+			void visit(const BreakStatementNode &) {}
+
+			void visit(const ContinueStatementNode &) {}
+
+			void visit(const ReturnStatementNode &node) { sink.child(node.getExpression().get()); }
+
+			// Error nodes
+			void visit(const ErrorNode &node) { sink.text(node.getMessage()); }
+
+		private:
+			Sink &sink;
+
+			void children(const NodeList &nodes) {
+				sink.value(static_cast<std::int64_t>(nodes.size()));
+				for (const auto &node: nodes) {
+					sink.child(node.get());
+				}
+			}
+		};
+
+		// FNV-1a over the encoded structure; integers are encoded as 8 little-endian bytes
+		class HashSink {
+		public:
+			explicit HashSink(StructuralHasher &hasher) : hasher(hasher) {}
+
+			void byte(unsigned char b) {
+				state ^= b;
+				state *= 0x100000001b3ULL;
+			}
+
+			void value(std::int64_t v) {
+				auto bits = static_cast<std::uint64_t>(v);
+				for (int shift = 0; shift < 64; shift += 8) {
+					byte(static_cast<unsigned char>(bits >> shift));
+				}
+			}
+
+			void text(std::string_view t) {
+				value(static_cast<std::int64_t>(t.size()));
+				for (char c: t) {
+					byte(static_cast<unsigned char>(c));
+				}
+			}
+
+			void child(const ASTNode *node) {
+				if (node == nullptr) {
+					byte(0);
+					return;
+				}
+				byte(1);
+				value(static_cast<std::int64_t>(hasher.hash(*node)));
+			}
+
+			[[nodiscard]] std::uint64_t result() const { return state; }
+
+		private:
+			StructuralHasher &hasher;
+			std::uint64_t state = 0xcbf29ce484222325ULL;
+		};
+
+		// Records the structure of a node to compare it with another one
+		struct RecordSink {
+			std::vector<std::int64_t> values;
+			std::vector<std::string_view> texts;
+			std::vector<const ASTNode *> children;
+
+			void value(std::int64_t v) { values.push_back(v); }
+
+			void text(std::string_view t) { texts.push_back(t); }
+
+			void child(const ASTNode *node) { children.push_back(node); }
+		};
+
+	} // namespace
+
+	std::uint64_t StructuralHasher::hash(const ASTNode &node) {
+		auto cached = hashes.find(&node);
+		if (cached != hashes.end()) {
+			return cached->second;
+		}
+
+		HashSink sink(*this);
+		sink.byte(static_cast<unsigned char>(node.getNodeKind()));
+		ShapeVisitor<HashSink>(sink).dispatch(node);
+
+		std::uint64_t result = sink.result();
+		hashes.emplace(&node, result);
+		return result;
+	}
+
+	std::uint64_t structuralHash(const ASTNode &node) {
+		StructuralHasher hasher;
+		return hasher.hash(node);
+	}
+
+	bool structurallyEqual(const ASTNode &left, const ASTNode &right) {
+		if (&left == &right) {
+			return true;
+		}
+		if (left.getNodeKind() != right.getNodeKind()) {
+			return false;
+		}
+
+		RecordSink leftShape;
+		RecordSink rightShape;
+		ShapeVisitor<RecordSink>(leftShape).dispatch(left);
+		ShapeVisitor<RecordSink>(rightShape).dispatch(right);
+		if (leftShape.values != rightShape.values || leftShape.texts != rightShape.texts) {
+			return false;
+		}
+
+		// Equal values include the lengths of the lists, so the children line up
+		for (std::size_t i = 0; i < leftShape.children.size(); ++i) {
+			const ASTNode *leftChild = leftShape.children[i];
+			const ASTNode *rightChild = rightShape.children[i];
+			if (leftChild == nullptr || rightChild == nullptr) {
+				if (leftChild != rightChild) {
+					return false;
+				}
+			} else if (!structurallyEqual(*leftChild, *rightChild)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+} // namespace tinyc::ast
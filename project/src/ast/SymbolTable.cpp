@@ -0,0 +1,78 @@
+#include "tinyc/ast/SymbolTable.h"
+#include <algorithm>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		// FNV-1a; names are short, so a byte at a time is as fast as anything
+		std::uint64_t hashName(std::string_view name) {
+			std::uint64_t hash = 0xcbf29ce484222325ULL;
+			for (char c: name) {
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 0x100000001b3ULL;
+			}
+			return hash;
+		}
+
+	} // namespace
+
+	SymbolTable::SymbolTable(bool concurrent, std::pmr::memory_resource *upstream) : concurrent(concurrent) {
+		for (auto &shard: shards) {
+			shard = std::make_unique<Shard>(upstream);
+		}
+	}
+
+	std::string_view SymbolTable::intern(std::string_view name) {
+		std::uint64_t hash = hashName(name);
+		Shard &shard = *shards[hash >> (64 - SHARD_BITS)];
+
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		if (concurrent) {
+			lock.lock();
+		}
+		return insert(shard, hash, name);
+	}
+
+	std::string_view SymbolTable::insert(Shard &shard, std::uint64_t hash, std::string_view name) {
+		if (shard.used * 2 >= shard.slots.size()) {
+			grow(shard);
+		}
+
+		std::size_t mask = shard.slots.size() - 1;
+		for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+			Entry &entry = shard.slots[i];
+			if (entry.text == nullptr) {
+				auto *memory = static_cast<char *>(shard.storage.allocate(sizeof(Symbol) + name.size(),
+																			alignof(Symbol)));
+				Symbol id = count.fetch_add(1, std::memory_order_relaxed);
+				std::memcpy(memory, &id, sizeof(Symbol));
+				std::memcpy(memory + sizeof(Symbol), name.data(), name.size());
+
+				entry = {hash, memory + sizeof(Symbol), static_cast<std::uint32_t>(name.size())};
+				++shard.used;
+				return {entry.text, entry.length};
+			}
+			if (entry.hash == hash && entry.length == name.size() &&
+				std::memcmp(entry.text, name.data(), name.size()) == 0) {
+				return {entry.text, entry.length};
+			}
+		}
+	}
+
+	void SymbolTable::grow(Shard &shard) {
+		std::vector<Entry> slots(std::max<std::size_t>(64, shard.slots.size() * 2), Entry{0, nullptr, 0});
+		std::size_t mask = slots.size() - 1;
+		for (const Entry &entry: shard.slots) {
+			if (entry.text != nullptr) {
+				std::size_t i = entry.hash & mask;
+				while (slots[i].text != nullptr) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = entry;
+			}
+		}
+		shard.slots = std::move(slots);
+	}
+
+} // namespace tinyc::ast
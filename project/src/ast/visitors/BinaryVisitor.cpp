@@ -0,0 +1,299 @@
+#include "tinyc/ast/visitors/BinaryVisitor.h"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		template<typename T>
+		void writeTable(OutputSink &out, const std::vector<T> &table) {
+			out << std::string_view(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(T));
+		}
+
+		template<typename Enum>
+		std::uint8_t detailOf(Enum value) {
+			return static_cast<std::uint8_t>(value);
+		}
+
+	} // namespace
+
+	void BinaryVisitor::write(OutputSink &out) const {
+		std::size_t totalSize = sizeof(binary::Header) +
+								nodes.size() * sizeof(binary::NodeRecord) +
+								(children.size() + stringOffsets.size()) * sizeof(std::uint32_t) +
+								stringData.size();
+		if (totalSize > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::length_error("AST too large for the binary format");
+		}
+
+		binary::Header header{};
+		std::memcpy(header.magic, binary::MAGIC, sizeof(header.magic));
+		header.version = binary::VERSION;
+		header.byteOrder = binary::BYTE_ORDER_MARK;
+		header.nodeCount = static_cast<std::uint32_t>(nodes.size());
+		header.childCount = static_cast<std::uint32_t>(children.size());
+		header.stringCount = static_cast<std::uint32_t>(stringOffsets.size() - 1);
+		header.stringBytes = static_cast<std::uint32_t>(stringData.size());
+		header.totalSize = static_cast<std::uint32_t>(totalSize);
+
+		out << std::string_view(reinterpret_cast<const char *>(&header), sizeof(header));
+		writeTable(out, nodes);
+		writeTable(out, children);
+		writeTable(out, stringOffsets);
+		out << stringData;
+	}
+
+	std::string BinaryVisitor::getBinary() const {
+		StringSink sink;
+		write(sink);
+		return sink.str();
+	}
+
+	std::uint32_t BinaryVisitor::addRecord(std::uint8_t kind, const lexer::SourceLocation &location,
+										   std::size_t childCount) {
+		binary::NodeRecord record{};
+		record.kind = kind;
+		record.text = binary::NONE;
+		record.firstChild = static_cast<std::uint32_t>(children.size());
+		record.childCount = static_cast<std::uint32_t>(childCount);
+		record.file = intern(location.getFilename());
+		record.line = location.line;
+		record.column = location.column;
+
+		children.resize(children.size() + childCount, binary::NONE);
+		nodes.push_back(record);
+		return static_cast<std::uint32_t>(nodes.size() - 1);
+	}
+
+	void BinaryVisitor::setChild(std::uint32_t record, std::size_t slot, const ASTNodePtr &child) {
+		if (!child) {
+			return;
+		}
+		// The child's record is the next one appended
+		auto index = static_cast<std::uint32_t>(nodes.size());
+		child->accept(*this);
+		children[nodes[record].firstChild + slot] = index;
+	}
+
+	void BinaryVisitor::setChildren(std::uint32_t record, std::size_t firstSlot, const NodeList &list) {
+		for (std::size_t i = 0; i < list.size(); ++i) {
+			setChild(record, firstSlot + i, list[i]);
+		}
+	}
+
+	std::uint32_t BinaryVisitor::intern(std::string_view text) {
+		auto it = stringIds.find(text);
+		if (it != stringIds.end()) {
+			return it->second;
+		}
+
+		auto id = static_cast<std::uint32_t>(stringOffsets.size() - 1);
+		stringData += text;
+		stringOffsets.push_back(static_cast<std::uint32_t>(stringData.size()));
+		stringIds.emplace(text, id);
+		return id;
+	}
+
+	// Program node
+	void BinaryVisitor::visit(const ProgramNode &node) {
+		const auto &declarations = node.getDeclarations();
+		std::uint32_t self = addNode(NodeKind::PROGRAM, node, declarations.size());
+		setChildren(self, 0, declarations);
+	}
+
+	// Declaration nodes
+	void BinaryVisitor::visit(const VariableNode &node) {
+		std::uint32_t self = addNode(NodeKind::VARIABLE, node, 3);
+		nodes[self].text = intern(node.getIdentifier());
+		setChild(self, 0, node.getType());
+		setChild(self, 1, node.getArraySize());
+		setChild(self, 2, node.getInitializer());
+	}
+
+	void BinaryVisitor::visit(const MultipleDeclarationNode &node) {
+		const auto &declarations = node.getDeclarations();
+		std::uint32_t self = addNode(NodeKind::MULTIPLE_DECLARATION, node, declarations.size());
+		setChildren(self, 0, declarations);
+	}
+
+	void BinaryVisitor::visit(const ParameterNode &node) {
+		std::uint32_t self = addNode(NodeKind::PARAMETER, node, 1);
+		nodes[self].text = intern(node.getIdentifier());
+		setChild(self, 0, node.getType());
+	}
+
+	void BinaryVisitor::visit(const FunctionDeclarationNode &node) {
+		const auto &parameters = node.getParameters();
+		std::uint32_t self = addNode(NodeKind::FUNCTION_DECLARATION, node, 2 + parameters.size());
+		nodes[self].text = intern(node.getIdentifier());
+		setChild(self, 0, node.getReturnType());
+		// Parameters come before the body in the source, so visit them first to keep pre-order
+		setChildren(self, 2, parameters);
+		setChild(self, 1, node.getBody());
+	}
+
+	void BinaryVisitor::visit(const StructDeclarationNode &node) {
+		const auto &fields = node.getFields();
+		std::uint32_t self = addNode(NodeKind::STRUCT_DECLARATION, node, fields.size());
+		nodes[self].text = intern(node.getIdentifier());
+		setChildren(self, 0, fields);
+	}
+
+	void BinaryVisitor::visit(const FunctionPointerDeclarationNode &node) {
+		const auto &parameterTypes = node.getParameterTypes();
+		std::uint32_t self = addNode(NodeKind::FUNCTION_POINTER_DECLARATION, node, 1 + parameterTypes.size());
+		nodes[self].text = intern(node.getIdentifier());
+		setChild(self, 0, node.getReturnType());
+		setChildren(self, 1, parameterTypes);
+	}
+
+	// Type nodes
+	void BinaryVisitor::visit(const PrimitiveTypeNode &node) {
+		std::uint32_t self = addNode(NodeKind::PRIMITIVE_TYPE, node, 0);
+		nodes[self].detail = detailOf(node.getKind());
+	}
+
+	void BinaryVisitor::visit(const NamedTypeNode &node) {
+		std::uint32_t self = addNode(NodeKind::NAMED_TYPE, node, 0);
+		nodes[self].text = intern(node.getIdentifier());
+	}
+
+	void BinaryVisitor::visit(const PointerTypeNode &node) {
+		std::uint32_t self = addNode(NodeKind::POINTER_TYPE, node, 1);
+		setChild(self, 0, node.getBaseType());
+	}
+
+	// Expression nodes
+	void BinaryVisitor::visit(const LiteralNode &node) {
+		std::uint32_t self = addNode(NodeKind::LITERAL, node, 0);
+		nodes[self].detail = detailOf(node.getKind());
+		nodes[self].text = intern(node.getValue());
+	}
+
+	void BinaryVisitor::visit(const IdentifierNode &node) {
+		std::uint32_t self = addNode(NodeKind::IDENTIFIER, node, 0);
+		nodes[self].text = intern(node.getIdentifier());
+	}
+
+	void BinaryVisitor::visit(const BinaryExpressionNode &node) {
+		std::uint32_t self = addNode(NodeKind::BINARY_EXPRESSION, node, 2);
+		nodes[self].detail = detailOf(node.getOperator());
+		setChild(self, 0, node.getLeft());
+		setChild(self, 1, node.getRight());
+	}
+
+	void BinaryVisitor::visit(const UnaryExpressionNode &node) {
+		std::uint32_t self = addNode(NodeKind::UNARY_EXPRESSION, node, 1);
+		nodes[self].detail = detailOf(node.getOperator());
+		setChild(self, 0, node.getOperand());
+	}
+
+	void BinaryVisitor::visit(const CastExpressionNode &node) {
+		std::uint32_t self = addNode(NodeKind::CAST_EXPRESSION, node, 2);
+		setChild(self, 0, node.getTargetType());
+		setChild(self, 1, node.getExpression());
+	}
+
+	void BinaryVisitor::visit(const CallExpressionNode &node) {
+		const auto &arguments = node.getArguments();
+		std::uint32_t self = addNode(NodeKind::CALL_EXPRESSION, node, 1 + arguments.size());
+		setChild(self, 0, node.getCallee());
+		setChildren(self, 1, arguments);
+	}
+
+	void BinaryVisitor::visit(const IndexExpressionNode &node) {
+		std::uint32_t self = addNode(NodeKind::INDEX_EXPRESSION, node, 2);
+		setChild(self, 0, node.getArray());
+		setChild(self, 1, node.getIndex());
+	}
+
+	void BinaryVisitor::visit(const MemberExpressionNode &node) {
+		std::uint32_t self = addNode(NodeKind::MEMBER_EXPRESSION, node, 1);
+		nodes[self].detail = detailOf(node.getKind());
+		nodes[self].text = intern(node.getMember());
+		setChild(self, 0, node.getObject());
+	}
+
+	void BinaryVisitor::visit(const CommaExpressionNode &node) {
+		const auto &expressions = node.getExpressions();
+		std::uint32_t self = addNode(NodeKind::COMMA_EXPRESSION, node, expressions.size());
+		setChildren(self, 0, expressions);
+	}
+
+	// Statement nodes
+	void BinaryVisitor::visit(const BlockStatementNode &node) {
+		const auto &statements = node.getStatements();
+		std::uint32_t self = addNode(NodeKind::BLOCK_STATEMENT, node, statements.size());
+		setChildren(self, 0, statements);
+	}
+
+	void BinaryVisitor::visit(const ExpressionStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::EXPRESSION_STATEMENT, node, 1);
+		setChild(self, 0, node.getExpression());
+	}
+
+	void BinaryVisitor::visit(const IfStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::IF_STATEMENT, node, 3);
+		setChild(self, 0, node.getCondition());
+		setChild(self, 1, node.getThenBranch());
+		setChild(self, 2, node.getElseBranch());
+	}
+
+	void BinaryVisitor::visit(const WhileStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::WHILE_STATEMENT, node, 2);
+		setChild(self, 0, node.getCondition());
+		setChild(self, 1, node.getBody());
+	}
+
+	void BinaryVisitor::visit(const DoWhileStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::DO_WHILE_STATEMENT, node, 2);
+		setChild(self, 0, node.getBody());
+		setChild(self, 1, node.getCondition());
+	}
+
+	void BinaryVisitor::visit(const ForStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::FOR_STATEMENT, node, 4);
+		setChild(self, 0, node.getInitialization());
+		setChild(self, 1, node.getCondition());
+		setChild(self, 2, node.getUpdate());
+		setChild(self, 3, node.getBody());
+	}
+
+	void BinaryVisitor::visit(const SwitchStatementNode &node) {
+		const auto &cases = node.getCases();
+		std::uint32_t self = addNode(NodeKind::SWITCH_STATEMENT, node, 1 + cases.size());
+		setChild(self, 0, node.getExpression());
+
+		for (std::size_t i = 0; i < cases.size(); ++i) {
+			const auto &caseItem = cases[i];
+			// Cases have no location of their own, they use the switch's
+			std::uint32_t record = addRecord(binary::CASE_RECORD, node.getLocation(), caseItem.body.size());
+			nodes[record].value = caseItem.value;
+			nodes[record].flags = caseItem.isDefault ? binary::DEFAULT_CASE : 0;
+			children[nodes[self].firstChild + 1 + i] = record;
+			setChildren(record, 0, caseItem.body);
+		}
+	}
+
+	void BinaryVisitor::visit(const BreakStatementNode &node) {
+		addNode(NodeKind::BREAK_STATEMENT, node, 0);
+	}
+
+	void BinaryVisitor::visit(const ContinueStatementNode &node) {
+		addNode(NodeKind::CONTINUE_STATEMENT, node, 0);
+	}
+
+	void BinaryVisitor::visit(const ReturnStatementNode &node) {
+		std::uint32_t self = addNode(NodeKind::RETURN_STATEMENT, node, 1);
+		setChild(self, 0, node.getExpression());
+	}
+
+	// Error nodes
+	void BinaryVisitor::visit(const ErrorNode &node) {
+		std::uint32_t self = addNode(NodeKind::ERROR_NODE, node, 0);
+		nodes[self].text = intern(node.getMessage());
+	}
+
+} // namespace tinyc::ast
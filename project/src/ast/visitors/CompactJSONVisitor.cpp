@@ -0,0 +1,481 @@
+#include "tinyc/ast/visitors/CompactJSONVisitor.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include <charconv>
+
+namespace tinyc::ast {
+
+	namespace {
+
+		// Fragments between the values of the nodes, in the order JSONVisitor writes the fields;
+		// every field but the location is followed by a comma
+		constexpr std::string_view PROGRAM = R"({"nodeType": "Program","declarations": [)";
+		constexpr std::string_view VARIABLE = R"({"nodeType": "VariableDeclaration","identifier": ")";
+		constexpr std::string_view MULTIPLE_DECLARATION = R"({"nodeType": "MultipleDeclaration","declarations": [)";
+		constexpr std::string_view PARAMETER = R"({"nodeType": "Parameter","identifier": ")";
+		constexpr std::string_view FUNCTION_DEFINITION = R"({"nodeType": "FunctionDefinition","identifier": ")";
+		constexpr std::string_view FUNCTION_DECLARATION = R"({"nodeType": "FunctionDeclaration","identifier": ")";
+		constexpr std::string_view STRUCT_DEFINITION = R"({"nodeType": "StructDefinition","identifier": ")";
+		constexpr std::string_view STRUCT_DECLARATION = R"({"nodeType": "StructDeclaration","identifier": ")";
+		constexpr std::string_view FUNCTION_POINTER = R"({"nodeType": "FunctionPointerDeclaration","identifier": ")";
+		constexpr std::string_view PRIMITIVE_TYPE = R"({"nodeType": "PrimitiveType","kind": ")";
+		constexpr std::string_view NAMED_TYPE = R"({"nodeType": "NamedType","identifier": ")";
+		constexpr std::string_view POINTER_TYPE = R"({"nodeType": "PointerType","baseType": )";
+		constexpr std::string_view LITERAL = R"({"nodeType": "Literal","kind": ")";
+		constexpr std::string_view IDENTIFIER = R"({"nodeType": "Identifier","identifier": ")";
+		constexpr std::string_view BINARY = R"({"nodeType": "BinaryExpression","operator": ")";
+		constexpr std::string_view UNARY = R"({"nodeType": "UnaryExpression","operator": ")";
+		constexpr std::string_view CAST = R"({"nodeType": "CastExpression","targetType": )";
+		constexpr std::string_view CALL = R"({"nodeType": "CallExpression","callee": )";
+		constexpr std::string_view INDEX = R"({"nodeType": "IndexExpression","array": )";
+		constexpr std::string_view MEMBER_DOT = R"({"nodeType": "MemberExpression","kind": "dot","object": )";
+		constexpr std::string_view MEMBER_ARROW = R"({"nodeType": "MemberExpression","kind": "arrow","object": )";
+		constexpr std::string_view COMMA = R"({"nodeType": "CommaExpression","expressions": [)";
+		constexpr std::string_view BLOCK = R"({"nodeType": "BlockStatement","statements": [)";
+		constexpr std::string_view EXPRESSION_STATEMENT = R"({"nodeType": "ExpressionStatement","expression": )";
+		constexpr std::string_view IF = R"({"nodeType": "IfStatement","condition": )";
+		constexpr std::string_view WHILE = R"({"nodeType": "WhileStatement","condition": )";
+		constexpr std::string_view DO_WHILE = R"({"nodeType": "DoWhileStatement","body": )";
+		constexpr std::string_view FOR = R"({"nodeType": "ForStatement",)";
+		constexpr std::string_view SWITCH = R"({"nodeType": "SwitchStatement","expression": )";
+		constexpr std::string_view BREAK = R"({"nodeType": "BreakStatement",)";
+		constexpr std::string_view CONTINUE = R"({"nodeType": "ContinueStatement",)";
+		constexpr std::string_view RETURN = R"({"nodeType": "ReturnStatement",)";
+		constexpr std::string_view ERROR_NODE = R"({"nodeType": "Error","message": ")";
+
+		// Fragments closing an array or a string value and opening the next field
+		constexpr std::string_view END_ARRAY = "],";
+		constexpr std::string_view END_STRING = "\",";
+		constexpr std::string_view TYPE = R"(","type": )";
+		constexpr std::string_view RETURN_TYPE = R"(","returnType": )";
+		constexpr std::string_view PARAMETERS = R"(,"parameters": [)";
+		constexpr std::string_view PARAMETER_TYPES = R"(,"parameterTypes": [)";
+		constexpr std::string_view FIELDS = R"(","fields": [)";
+		constexpr std::string_view VALUE = R"(","value": )";
+		constexpr std::string_view LEFT = R"(","left": )";
+		constexpr std::string_view RIGHT = R"(,"right": )";
+		constexpr std::string_view PREFIX = R"(","prefix": )";
+		constexpr std::string_view OPERAND = R"(,"operand": )";
+		constexpr std::string_view EXPRESSION = R"(,"expression": )";
+		constexpr std::string_view ARGUMENTS = R"(,"arguments": [)";
+		constexpr std::string_view INDEX_FIELD = R"(,"index": )";
+		constexpr std::string_view MEMBER = R"(,"member": ")";
+		constexpr std::string_view THEN_BRANCH = R"(,"thenBranch": )";
+		constexpr std::string_view BODY = R"(,"body": )";
+		constexpr std::string_view CONDITION = R"(,"condition": )";
+		constexpr std::string_view CASES = R"(,"cases": [)";
+
+		// Optional fields, written after the comma of the previous one
+		constexpr std::string_view ARRAY_SIZE = R"("arraySize": )";
+		constexpr std::string_view INITIALIZER = R"("initializer": )";
+		constexpr std::string_view BODY_FIELD = R"("body": )";
+		constexpr std::string_view ELSE_BRANCH = R"("elseBranch": )";
+		constexpr std::string_view INITIALIZATION = R"("initialization": )";
+		constexpr std::string_view CONDITION_FIELD = R"("condition": )";
+		constexpr std::string_view UPDATE = R"("update": )";
+		constexpr std::string_view EXPRESSION_FIELD = R"("expression": )";
+
+		// Switch cases
+		constexpr std::string_view DEFAULT_CASE = R"({"isDefault": true,"body": [)";
+		constexpr std::string_view VALUE_CASE = R"({"isDefault": false,"value": )";
+		constexpr std::string_view CASE_BODY = R"(,"body": [)";
+		constexpr std::string_view END_CASE = "]}";
+
+		// Location, always the last field
+		constexpr std::string_view LOCATION = R"("location": {"filename": ")";
+		constexpr std::string_view LINE = R"(","line": )";
+		constexpr std::string_view COLUMN = R"(,"column": )";
+		constexpr std::string_view END_LOCATION = "}}";
+
+	} // namespace
+
+	void CompactJSONVisitor::writeList(const NodeList &nodes) {
+		for (std::size_t i = 0; i < nodes.size(); ++i) {
+			if (i > 0) {
+				json << ',';
+			}
+			dispatch(*nodes[i]);
+		}
+	}
+
+	void CompactJSONVisitor::endNode(const lexer::SourceLocation &location) {
+		// The file name is looked up and escaped again only when it changes
+		if (location.fileId != locationFile) {
+			StringSink prefix;
+			prefix << LOCATION;
+			writeJSONEscaped(prefix, location.getFilename());
+			prefix << LINE;
+			locationPrefix = prefix.str();
+			locationFile = location.fileId;
+		}
+
+		json << locationPrefix << location.line << COLUMN << location.column << END_LOCATION;
+	}
+
+	// Program node
+	void CompactJSONVisitor::visit(const ProgramNode &node) {
+		writeProgram(node, [&]() { writeDeclarations(node, 0, node.getDeclarations().size()); });
+	}
+
+	void CompactJSONVisitor::writeProgram(const ProgramNode &node, const std::function<void()> &declarations) {
+		json << PROGRAM;
+		declarations();
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::writeDeclarations(const ProgramNode &node, std::size_t begin, std::size_t end) {
+		const auto &declarations = node.getDeclarations();
+		for (std::size_t i = begin; i < end; ++i) {
+			if (i > 0) {
+				json << ',';
+			}
+			dispatch(*declarations[i]);
+		}
+	}
+
+	// Declaration nodes
+	void CompactJSONVisitor::visit(const VariableNode &node) {
+		json << VARIABLE;
+		writeJSONEscaped(json, node.getIdentifier());
+		json << TYPE;
+		dispatch(*node.getType());
+		json << ',';
+
+		if (node.isArray()) {
+			json << ARRAY_SIZE;
+			dispatch(*node.getArraySize());
+			json << ',';
+		}
+
+		if (node.hasInitializer()) {
+			json << INITIALIZER;
+			dispatch(*node.getInitializer());
+			json << ',';
+		}
+
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const MultipleDeclarationNode &node) {
+		json << MULTIPLE_DECLARATION;
+		writeList(node.getDeclarations());
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const ParameterNode &node) {
+		json << PARAMETER;
+		writeJSONEscaped(json, node.getIdentifier());
+		json << TYPE;
+		dispatch(*node.getType());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const FunctionDeclarationNode &node) {
+		json << (node.isDefinition() ? FUNCTION_DEFINITION : FUNCTION_DECLARATION);
+		writeJSONEscaped(json, node.getIdentifier());
+		json << RETURN_TYPE;
+		dispatch(*node.getReturnType());
+		json << PARAMETERS;
+		writeList(node.getParameters());
+		json << END_ARRAY;
+
+		if (node.isDefinition()) {
+			json << BODY_FIELD;
+			dispatch(*node.getBody());
+			json << ',';
+		}
+
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const StructDeclarationNode &node) {
+		json << (node.isDefinition() ? STRUCT_DEFINITION : STRUCT_DECLARATION);
+		writeJSONEscaped(json, node.getIdentifier());
+		json << FIELDS;
+		if (node.isDefinition()) {
+			writeList(node.getFields());
+		}
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const FunctionPointerDeclarationNode &node) {
+		json << FUNCTION_POINTER;
+		writeJSONEscaped(json, node.getIdentifier());
+		json << RETURN_TYPE;
+		dispatch(*node.getReturnType());
+		json << PARAMETER_TYPES;
+		writeList(node.getParameterTypes());
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	// Type nodes
+	void CompactJSONVisitor::visit(const PrimitiveTypeNode &node) {
+		// Kind and operator names are short enough for std::string's inline buffer and
+		// never need escaping
+		json << PRIMITIVE_TYPE << node.getKindString() << END_STRING;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const NamedTypeNode &node) {
+		json << NAMED_TYPE;
+		writeJSONEscaped(json, node.getIdentifier());
+		json << END_STRING;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const PointerTypeNode &node) {
+		json << POINTER_TYPE;
+		dispatch(*node.getBaseType());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	// Expression nodes
+	void CompactJSONVisitor::visit(const LiteralNode &node) {
+		json << LITERAL << node.getKindString() << VALUE;
+
+		// Numbers are decoded as in JSONVisitor, falling back to the spelling as a string
+		std::string_view value = node.getValue();
+		const char *end = value.data() + value.size();
+		bool written = false;
+		if (node.getKind() == LiteralNode::Kind::INTEGER) {
+			int intValue = 0;
+			auto [last, error] = std::from_chars(value.data(), end, intValue);
+			if (error == std::errc() && last == end) {
+				json << intValue;
+				written = true;
+			}
+		} else if (node.getKind() == LiteralNode::Kind::DOUBLE) {
+			double doubleValue = 0;
+			auto [last, error] = std::from_chars(value.data(), end, doubleValue);
+			if (error == std::errc() && last == end) {
+				json << doubleValue;
+				written = true;
+			}
+		}
+
+		if (written) {
+			json << ',';
+		} else {
+			json << '"';
+			writeJSONEscaped(json, value);
+			json << END_STRING;
+		}
+
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const IdentifierNode &node) {
+		json << IDENTIFIER;
+		writeJSONEscaped(json, node.getIdentifier());
+		json << END_STRING;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const BinaryExpressionNode &node) {
+		json << BINARY << node.getOperatorString() << LEFT;
+		dispatch(*node.getLeft());
+		json << RIGHT;
+		dispatch(*node.getRight());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const UnaryExpressionNode &node) {
+		json << UNARY;
+		switch (node.getOperator()) {
+			case UnaryExpressionNode::Operator::PRE_INCREMENT:
+			case UnaryExpressionNode::Operator::POST_INCREMENT:
+				json << "++";
+				break;
+			case UnaryExpressionNode::Operator::PRE_DECREMENT:
+			case UnaryExpressionNode::Operator::POST_DECREMENT:
+				json << "--";
+				break;
+			default:
+				json << node.getOperatorString();
+				break;
+		}
+		json << PREFIX << (node.isPrefix() ? "true" : "false") << OPERAND;
+		dispatch(*node.getOperand());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const CastExpressionNode &node) {
+		json << CAST;
+		dispatch(*node.getTargetType());
+		json << EXPRESSION;
+		dispatch(*node.getExpression());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const CallExpressionNode &node) {
+		json << CALL;
+		dispatch(*node.getCallee());
+		json << ARGUMENTS;
+		writeList(node.getArguments());
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const IndexExpressionNode &node) {
+		json << INDEX;
+		dispatch(*node.getArray());
+		json << INDEX_FIELD;
+		dispatch(*node.getIndex());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const MemberExpressionNode &node) {
+		json << (node.getKind() == MemberExpressionNode::Kind::DOT ? MEMBER_DOT : MEMBER_ARROW);
+		dispatch(*node.getObject());
+		json << MEMBER;
+		writeJSONEscaped(json, node.getMember());
+		json << END_STRING;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const CommaExpressionNode &node) {
+		json << COMMA;
+		writeList(node.getExpressions());
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	// Statement nodes
+	void CompactJSONVisitor::visit(const BlockStatementNode &node) {
+		json << BLOCK;
+		writeList(node.getStatements());
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const ExpressionStatementNode &node) {
+		json << EXPRESSION_STATEMENT;
+		dispatch(*node.getExpression());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const IfStatementNode &node) {
+		json << IF;
+		dispatch(*node.getCondition());
+		json << THEN_BRANCH;
+		dispatch(*node.getThenBranch());
+		json << ',';
+
+		if (node.hasElseBranch()) {
+			json << ELSE_BRANCH;
+			dispatch(*node.getElseBranch());
+			json << ',';
+		}
+
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const WhileStatementNode &node) {
+		json << WHILE;
+		dispatch(*node.getCondition());
+		json << BODY;
+		dispatch(*node.getBody());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const DoWhileStatementNode &node) {
+		json << DO_WHILE;
+		dispatch(*node.getBody());
+		json << CONDITION;
+		dispatch(*node.getCondition());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const ForStatementNode &node) {
+		json << FOR;
+
+		if (node.hasInitialization()) {
+			json << INITIALIZATION;
+			dispatch(*node.getInitialization());
+			json << ',';
+		}
+
+		if (node.hasCondition()) {
+			json << CONDITION_FIELD;
+			dispatch(*node.getCondition());
+			json << ',';
+		}
+
+		if (node.hasUpdate()) {
+			json << UPDATE;
+			dispatch(*node.getUpdate());
+			json << ',';
+		}
+
+		json << BODY_FIELD;
+		dispatch(*node.getBody());
+		json << ',';
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const SwitchStatementNode &node) {
+		json << SWITCH;
+		dispatch(*node.getExpression());
+		json << CASES;
+
+		const auto &cases = node.getCases();
+		for (std::size_t i = 0; i < cases.size(); ++i) {
+			if (i > 0) {
+				json << ',';
+			}
+			if (cases[i].isDefault) {
+				json << DEFAULT_CASE;
+			} else {
+				json << VALUE_CASE << cases[i].value << CASE_BODY;
+			}
+			writeList(cases[i].body);
+			json << END_CASE;
+		}
+
+		json << END_ARRAY;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const BreakStatementNode &node) {
+		json << BREAK;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const ContinueStatementNode &node) {
+		json << CONTINUE;
+		endNode(node.getLocation());
+	}
+
+	void CompactJSONVisitor::visit(const ReturnStatementNode &node) {
+		json << RETURN;
+
+		if (node.hasValue()) {
+			json << EXPRESSION_FIELD;
+			dispatch(*node.getExpression());
+			json << ',';
+		}
+
+		endNode(node.getLocation());
+	}
+
+	// Error nodes
+	void CompactJSONVisitor::visit(const ErrorNode &node) {
+		json << ERROR_NODE;
+		writeJSONEscaped(json, node.getMessage());
+		json << END_STRING;
+		endNode(node.getLocation());
+	}
+
+} // namespace tinyc::ast
@@ -21,7 +21,7 @@ namespace tinyc::ast {
 
 	void DumpVisitor::dumpChild(const ASTNode &node) {
 		increaseIndent();
-		node.accept(*this);
+		dispatch(node);
 		decreaseIndent();
 	}
 
@@ -290,7 +290,7 @@ namespace tinyc::ast {
 			increaseIndent();
 			increaseIndent();
 			for (const auto &stmt: caseItem.body) {
-				stmt->accept(*this);
+				dispatch(*stmt);
 			}
 			decreaseIndent();
 			decreaseIndent();
@@ -315,4 +315,9 @@ namespace tinyc::ast {
 		}
 	}
 
+	// Error nodes
+	void DumpVisitor::visit(const ErrorNode &node) {
+		os << getIndent() << "Error: " << node.getMessage() << std::endl;
+	}
+
 } // namespace tinyc::ast
\ No newline at end of file
@@ -1,21 +1,109 @@
 #include "tinyc/ast/visitors/JSONVisitor.h"
 #include "tinyc/ast/ASTNode.h"
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <utility>
 
 namespace tinyc::ast {
 
-	JSONVisitor::JSONVisitor(bool prettyPrint) : indentLevel(0), prettyPrint(prettyPrint) {}
+	namespace {
+
+		// Characters writeJSONEscaped() replaces: quotes, backslashes and everything below a
+		// space, which for a signed char includes all bytes from 0x80 up
+		constexpr std::array<bool, 256> ESCAPED = [] {
+			std::array<bool, 256> escaped{};
+			for (std::size_t i = 0; i < escaped.size(); ++i) {
+				char c = static_cast<char>(i);
+				escaped[i] = c == '"' || c == '\\' || c < 32;
+			}
+			return escaped;
+		}();
+
+	} // namespace
+
+	bool needsJSONEscape(std::string_view text) {
+		for (char c: text) {
+			if (ESCAPED[static_cast<unsigned char>(c)]) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void writeJSONEscaped(OutputSink &out, std::string_view s) {
+		if (!needsJSONEscape(s)) {
+			out << s;
+			return;
+		}
+
+		// Runs of characters that need no escaping are written in one piece
+		std::size_t runStart = 0;
+
+		for (std::size_t i = 0; i < s.size(); ++i) {
+			char c = s[i];
+			std::string_view escaped;
+			char buffer[7];
+
+			switch (c) {
+				case '\"':
+					escaped = "\\\"";
+					break;
+				case '\\':
+					escaped = "\\\\";
+					break;
+				case '\b':
+					escaped = "\\b";
+					break;
+				case '\f':
+					escaped = "\\f";
+					break;
+				case '\n':
+					escaped = "\\n";
+					break;
+				case '\r':
+					escaped = "\\r";
+					break;
+				case '\t':
+					escaped = "\\t";
+					break;
+				default:
+					if (c < 32) {
+						int length = snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+						escaped = std::string_view(buffer, std::min<std::size_t>(length, sizeof(buffer) - 1));
+						break;
+					}
+					continue;
+			}
+
+			out << s.substr(runStart, i - runStart) << escaped;
+			runStart = i + 1;
+		}
+
+		out << s.substr(runStart);
+	}
+
+	JSONVisitor::JSONVisitor(bool prettyPrint)
+			: ownSink(std::make_unique<StringSink>()), json(*ownSink), indentLevel(0), prettyPrint(prettyPrint) {}
+
+	JSONVisitor::JSONVisitor(OutputSink &sink, bool prettyPrint)
+			: json(sink), indentLevel(0), prettyPrint(prettyPrint) {}
 
 	std::string JSONVisitor::getJSON() const {
-		return json.str();
+		return ownSink ? ownSink->str() : std::string();
 	}
 
-	std::string JSONVisitor::getIndent() const {
+	std::string_view JSONVisitor::getIndent() const {
 		if (!prettyPrint) {
-			return "";
+			return {};
 		}
 		// 2 spaces per indent level
-		return std::string(indentLevel * 2, ' ');
+		std::size_t width = static_cast<std::size_t>(indentLevel) * 2;
+		if (indentation.size() < width) {
+			indentation.assign(width * 2, ' ');
+		}
+		return std::string_view(indentation).substr(0, width);
 	}
 
 	void JSONVisitor::increaseIndent() {
@@ -58,8 +146,10 @@ namespace tinyc::ast {
 		if (prettyPrint) json << "\n";
 	}
 
-	void JSONVisitor::addField(const std::string &name, const std::string &value) {
-		json << getIndent() << "\"" << name << "\": \"" << escapeString(value) << "\"";
+	void JSONVisitor::addField(const std::string &name, std::string_view value) {
+		json << getIndent() << "\"" << name << "\": \"";
+		writeEscaped(value);
+		json << "\"";
 		json << ",";
 		if (prettyPrint) json << "\n";
 	}
@@ -84,51 +174,13 @@ namespace tinyc::ast {
 
 	void JSONVisitor::addNodeField(const std::string &name, const ASTNode &node) {
 		json << getIndent() << "\"" << name << "\": ";
-		node.accept(*this);
+		dispatch(node);
 		json << ",";
 		if (prettyPrint) json << "\n";
 	}
 
-	std::string JSONVisitor::escapeString(const std::string &s) {
-		std::string result;
-		result.reserve(s.length());
-
-		for (char c: s) {
-			switch (c) {
-				case '\"':
-					result += "\\\"";
-					break;
-				case '\\':
-					result += "\\\\";
-					break;
-				case '\b':
-					result += "\\b";
-					break;
-				case '\f':
-					result += "\\f";
-					break;
-				case '\n':
-					result += "\\n";
-					break;
-				case '\r':
-					result += "\\r";
-					break;
-				case '\t':
-					result += "\\t";
-					break;
-				default:
-					if (c < 32) {
-						char buffer[7];
-						snprintf(buffer, sizeof(buffer), "\\u%04x", c);
-						result += buffer;
-					} else {
-						result += c;
-					}
-					break;
-			}
-		}
-
-		return result;
+	void JSONVisitor::writeEscaped(std::string_view s) {
+		writeJSONEscaped(json, s);
 	}
 
 	void JSONVisitor::addLocationField(const lexer::SourceLocation &location) {
@@ -137,7 +189,9 @@ namespace tinyc::ast {
 		increaseIndent();
 
 		// Printing location as an JSON object
-		json << getIndent() << R"("filename": ")" << escapeString(location.filename) << "\",";
+		json << getIndent() << R"("filename": ")";
+		writeEscaped(location.getFilename());
+		json << "\",";
 		if (prettyPrint) json << "\n";
 
 		json << getIndent() << "\"line\": " << location.line << ",";
@@ -152,6 +206,10 @@ namespace tinyc::ast {
 
 	// Program node
 	void JSONVisitor::visit(const ProgramNode &node) {
+		writeProgram(node, [&]() { writeDeclarations(node, 0, node.getDeclarations().size()); });
+	}
+
+	void JSONVisitor::writeProgram(const ProgramNode &node, const std::function<void()> &declarations) {
 		startObject();
 
 		addField("nodeType", "Program");
@@ -159,20 +217,7 @@ namespace tinyc::ast {
 
 		// Process declarations
 		startArray("declarations");
-		if (!node.getDeclarations().empty()) {
-			for (size_t i = 0; i < node.getDeclarations().size(); ++i) {
-				if (prettyPrint) {
-					json << getIndent();
-				}
-				node.getDeclarations()[i]->accept(*this);
-				if (i < node.getDeclarations().size() - 1) {
-					json << ",";
-				}
-				if (prettyPrint) {
-					json << "\n";
-				}
-			}
-		}
+		declarations();
 		endArray();
 
 		// Location
@@ -181,6 +226,27 @@ namespace tinyc::ast {
 		endObject();
 	}
 
+	void JSONVisitor::writeDeclarations(const ProgramNode &node, std::size_t begin, std::size_t end) {
+		// The program is the root, so its declarations are two levels in
+		int savedLevel = std::exchange(indentLevel, 2);
+
+		const auto &declarations = node.getDeclarations();
+		for (size_t i = begin; i < end; ++i) {
+			if (prettyPrint) {
+				json << getIndent();
+			}
+			dispatch(*declarations[i]);
+			if (i < declarations.size() - 1) {
+				json << ",";
+			}
+			if (prettyPrint) {
+				json << "\n";
+			}
+		}
+
+		indentLevel = savedLevel;
+	}
+
 	// Declaration nodes
 	void JSONVisitor::visit(const VariableNode &node) {
 		startObject();
@@ -218,7 +284,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getDeclarations()[i]->accept(*this);
+				dispatch(*node.getDeclarations()[i]);
 				if (i < node.getDeclarations().size() - 1) {
 					json << ",";
 				}
@@ -262,7 +328,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getParameters()[i]->accept(*this);
+				dispatch(*node.getParameters()[i]);
 				if (i < node.getParameters().size() - 1) {
 					json << ",";
 				}
@@ -297,7 +363,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getFields()[i]->accept(*this);
+				dispatch(*node.getFields()[i]);
 				if (i < node.getFields().size() - 1) {
 					json << ",";
 				}
@@ -330,7 +396,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getParameterTypes()[i]->accept(*this);
+				dispatch(*node.getParameterTypes()[i]);
 				if (i < node.getParameterTypes().size() - 1) {
 					json << ",";
 				}
@@ -384,21 +450,25 @@ namespace tinyc::ast {
 		addField("nodeType", "Literal");
 		addField("kind", node.getKindString());
 
+		// Numbers are decoded from their spelling without allocating; if that fails, the
+		// value falls back to the string representation
+		std::string_view value = node.getValue();
+		const char *end = value.data() + value.size();
 		if (node.getKind() == LiteralNode::Kind::INTEGER) {
-			try {
-				int intValue = std::stoi(node.getValue());
+			int intValue = 0;
+			auto [last, error] = std::from_chars(value.data(), end, intValue);
+			if (error == std::errc() && last == end) {
 				addNumberField("value", intValue);
-			} catch (const std::exception&) {
-				// If conversion fails, fall back to string representation
-				addField("value", node.getValue());
+			} else {
+				addField("value", value);
 			}
 		} else if (node.getKind() == LiteralNode::Kind::DOUBLE) {
-			try {
-				double doubleValue = std::stod(node.getValue());
+			double doubleValue = 0;
+			auto [last, error] = std::from_chars(value.data(), end, doubleValue);
+			if (error == std::errc() && last == end) {
 				addNumberField("value", doubleValue);
-			} catch (const std::exception&) {
-				// If conversion fails, fall back to string representation
-				addField("value", node.getValue());
+			} else {
+				addField("value", value);
 			}
 		} else {
 			// For character and string literals, keep as strings
@@ -485,7 +555,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getArguments()[i]->accept(*this);
+				dispatch(*node.getArguments()[i]);
 				if (i < node.getArguments().size() - 1) {
 					json << ",";
 				}
@@ -537,7 +607,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getExpressions()[i]->accept(*this);
+				dispatch(*node.getExpressions()[i]);
 				if (i < node.getExpressions().size() - 1) {
 					json << ",";
 				}
@@ -567,7 +637,7 @@ namespace tinyc::ast {
 				if (prettyPrint) {
 					json << getIndent();
 				}
-				node.getStatements()[i]->accept(*this);
+				dispatch(*node.getStatements()[i]);
 				if (i < node.getStatements().size() - 1) {
 					json << ",";
 				}
@@ -699,7 +769,7 @@ namespace tinyc::ast {
 						if (prettyPrint) {
 							json << getIndent();
 						}
-						caseItem.body[j]->accept(*this);
+						dispatch(*caseItem.body[j]);
 						if (j < caseItem.body.size() - 1) {
 							json << ",";
 						}
@@ -767,4 +837,15 @@ namespace tinyc::ast {
 		endObject();
 	}
 
+	// Error nodes
+	void JSONVisitor::visit(const ErrorNode &node) {
+		startObject();
+
+		addField("nodeType", "Error");
+		addField("message", node.getMessage());
+		addLocationField(node.getLocation());
+
+		endObject();
+	}
+
 } // namespace tinyc::ast
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "tinyc/ast/visitors/OutputSink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace tinyc::ast {
+
+	OutputSink::OutputSink() : buffer(new char[BUFFER_SIZE]) {}
+
+	OutputSink &OutputSink::operator<<(std::string_view text) {
+		if (text.size() > BUFFER_SIZE - used) {
+			flush();
+			// Large blocks bypass the buffer
+			if (text.size() >= BUFFER_SIZE) {
+				write(text.data(), text.size());
+				delivered += text.size();
+				return *this;
+			}
+		}
+		std::memcpy(buffer.get() + used, text.data(), text.size());
+		used += text.size();
+		return *this;
+	}
+
+	OutputSink &OutputSink::operator<<(char c) {
+		if (used == BUFFER_SIZE) {
+			flush();
+		}
+		buffer[used++] = c;
+		return *this;
+	}
+
+	OutputSink &OutputSink::operator<<(int value) {
+		// Digits are produced backwards into a scratch buffer
+		char digits[16];
+		char *end = digits + sizeof(digits);
+		char *begin = end;
+
+		// Work on the unsigned magnitude so INT_MIN does not overflow
+		unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+		do {
+			*--begin = static_cast<char>('0' + magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0);
+
+		if (value < 0) {
+			*--begin = '-';
+		}
+		return *this << std::string_view(begin, end - begin);
+	}
+
+	OutputSink &OutputSink::operator<<(double value) {
+		char text[32];
+		int length = std::snprintf(text, sizeof(text), "%g", value);
+		return *this << std::string_view(text, length);
+	}
+
+	void OutputSink::fill(char c, std::size_t n) {
+		while (n > 0) {
+			if (used == BUFFER_SIZE) {
+				flush();
+			}
+			std::size_t chunk = std::min(n, BUFFER_SIZE - used);
+			std::memset(buffer.get() + used, c, chunk);
+			used += chunk;
+			n -= chunk;
+		}
+	}
+
+	void OutputSink::flush() {
+		if (used > 0) {
+			// Reset first so a throwing write does not deliver the block twice
+			std::size_t size = used;
+			used = 0;
+			delivered += size;
+			write(buffer.get(), size);
+		}
+	}
+
+	const std::string &StringSink::str() {
+		flush();
+		return text;
+	}
+
+	void StringSink::clear() {
+		flush();
+		text.clear();
+	}
+
+	void StringSink::write(const char *data, std::size_t size) {
+		text.append(data, size);
+	}
+
+	void StreamSink::write(const char *data, std::size_t size) {
+		stream.write(data, static_cast<std::streamsize>(size));
+	}
+
+	FileSink::~FileSink() {
+		try {
+			flush();
+		} catch (const std::runtime_error &) {
+			// Errors can only be reported by an explicit flush()
+		}
+	}
+
+	void FileSink::write(const char *data, std::size_t size) {
+		if (std::fwrite(data, 1, size, file) != size) {
+			throw std::runtime_error("Could not write output");
+		}
+	}
+
+	FdSink::~FdSink() {
+		try {
+			flush();
+		} catch (const std::runtime_error &) {
+			// Errors can only be reported by an explicit flush()
+		}
+	}
+
+	void FdSink::write(const char *data, std::size_t size) {
+		while (size > 0) {
+#ifdef _WIN32
+			int written = ::_write(fd, data, static_cast<unsigned>(size));
+#else
+			ssize_t written = ::write(fd, data, size);
+#endif
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::runtime_error(std::string("Could not write output: ") + std::strerror(errno));
+			}
+			data += written;
+			size -= static_cast<std::size_t>(written);
+		}
+	}
+
+} // namespace tinyc::ast
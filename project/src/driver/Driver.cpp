@@ -0,0 +1,383 @@
+#include "tinyc/driver/Driver.h"
+#include "tinyc/driver/OutputCache.h"
+#include "tinyc/driver/ParallelJSON.h"
+#include "tinyc/driver/ParallelMap.h"
+#include "tinyc/driver/ParallelParser.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include "tinyc/ast/visitors/BinaryVisitor.h"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Write the token listing of a lexer, one token at a time without keeping the tokens
+		void listTokens(lexer::Lexer &lexer, const std::string &name, ast::OutputSink &out, CompileResult &result) {
+			ScopedTimer timer(result.stats.lexSeconds);
+			out << "Tokens from " << name << ":\n";
+
+			// Counted as they are listed, so a lexer error keeps the count of the tokens before it
+			std::string line;
+			for (lexer::TokenRef token = lexer.next();; token = lexer.next()) {
+				line.clear();
+				lexer.describe(token, line);
+				line += '\n';
+				out << line;
+				if (token.type == lexer::TokenType::END_OF_FILE) {
+					break;
+				}
+				++result.stats.tokens;
+			}
+		}
+
+		void writeTokens(const lexer::SourceBuffer &source, ast::OutputSink &out, CompileResult &result) {
+			// A lexer error must not leave a partial listing, so it is only written once complete
+			lexer::Lexer lexer(source);
+			ast::StringSink listing;
+			listTokens(lexer, source.getName(), listing, result);
+
+			ScopedTimer timer(result.stats.serializeSeconds);
+			out << listing.str();
+		}
+
+		// Report the errors a recovering parse got past
+		void reportRecovered(const std::vector<parser::ParserError> &diagnostics, CompileResult &result) {
+			for (const auto &error: diagnostics) {
+				result.diagnostics += std::string("Parser error: ") + error.what() + "\n";
+				result.exitCode = std::max<int>(result.exitCode, EXIT_PARSER_ERROR);
+			}
+		}
+
+		// Parse with a Parser or a ParallelParser, counting the tokens it consumed
+		template<typename ProgramParser>
+		ast::ASTNodePtr parseReporting(ProgramParser &parser, CompileResult &result) {
+			ast::ASTNodePtr ast;
+			try {
+				ast = parser.parseProgram();
+			} catch (...) {
+				// A fatal error still reports the errors recovered from before it
+				result.stats.tokens = parser.getConsumedTokens();
+				reportRecovered(parser.getDiagnostics(), result);
+				throw;
+			}
+			result.stats.tokens = parser.getConsumedTokens();
+			reportRecovered(parser.getDiagnostics(), result);
+			return ast;
+		}
+
+		void writeAST(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+					  CompileResult &result, const std::shared_ptr<ast::ASTContext> &arena) {
+			parser::ParserOptions parserOptions;
+			parserOptions.recover = options.recover;
+			parserOptions.maxErrors = options.maxErrors;
+
+			bool collect = options.stats != StatsFormat::NONE;
+			CompileStats &stats = result.stats;
+
+			// The counter is declared first so it outlives the arenas of the AST
+			AllocationCounter counter;
+			std::pmr::memory_resource *upstream = collect ? &counter : std::pmr::get_default_resource();
+			ast::ASTNodePtr ast;
+			{
+				ScopedTimer timer(stats.parseSeconds);
+				if (options.parseJobs == 1) {
+					lexer::Lexer lexer(source);
+					parser::Parser parser(lexer, arena ? arena : std::make_shared<ast::ASTContext>(64 * 1024, upstream),
+										  parserOptions);
+					ast = parseReporting(parser, result);
+				} else {
+					ParallelParser parser(source, parserOptions, options.parseJobs,
+										  ParallelParser::DEFAULT_CHUNK_SIZE, upstream);
+					ast = parseReporting(parser, result);
+				}
+			}
+			if (collect) {
+				stats.astBytes = counter.peakBytes();
+				stats.countNodes(*ast);
+			}
+
+			ScopedTimer timer(stats.serializeSeconds);
+
+			// Parsing is complete before the first byte is written, so fatal errors never leave
+			// partial output; with recovery the AST is written even if it contains errors
+			if (options.format == OutputFormat::BINARY) {
+				ast::BinaryVisitor binaryVisitor;
+				ast->accept(binaryVisitor);
+				binaryVisitor.write(out);
+				return;
+			}
+
+			writeJSON(*ast, out, options.prettyPrint, options.serializeJobs);
+			out << '\n';
+		}
+
+		void produce(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+					 CompileResult &result, const std::shared_ptr<ast::ASTContext> &arena) {
+			if (options.lexOnly) {
+				writeTokens(source, out, result);
+			} else {
+				writeAST(source, options, out, result, arena);
+			}
+		}
+
+		// Return the stored output of an unchanged input, or produce and store it
+		void produceCached(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+						   CompileResult &result, const std::shared_ptr<ast::ASTContext> &arena) {
+			OutputCache &cache = *options.cache;
+			std::string key = cache.key(source, options);
+			std::string output;
+			if (cache.lookup(key, output)) {
+				result.stats.cacheHit = true;
+				out << output;
+				return;
+			}
+
+			ast::StringSink buffer;
+			produce(source, options, buffer, result, arena);
+			// Outputs with errors (of a recovering parse) are not stored, their diagnostics would be lost
+			if (result.exitCode == EXIT_OK && result.diagnostics.empty()) {
+				cache.store(key, buffer.str());
+			}
+			out << buffer.str();
+		}
+
+		void compile(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+					 CompileResult &result, const std::shared_ptr<ast::ASTContext> &arena = nullptr) {
+			std::size_t written = out.bytesWritten();
+			result.stats.name = source.getName();
+			if (options.cache) {
+				produceCached(source, options, out, result, arena);
+			} else {
+				produce(source, options, out, result, arena);
+			}
+			result.stats.outputBytes = out.bytesWritten() - written;
+		}
+
+		void fail(CompileResult &result, const std::string &kind, const std::exception &error, int exitCode) {
+			result.diagnostics += kind + ": " + error.what() + "\n";
+			result.exitCode = std::max(result.exitCode, exitCode);
+		}
+
+		// Run a compile step writing into out, turning its exceptions into diagnostics
+		template<typename Step>
+		CompileResult guarded(Step &&step) {
+			CompileResult result;
+			try {
+				step(result);
+			} catch (const lexer::LexerError &e) {
+				fail(result, "Lexer error", e, EXIT_LEXER_ERROR);
+			} catch (const parser::ParserError &e) {
+				fail(result, "Parser error", e, EXIT_PARSER_ERROR);
+			} catch (const std::exception &e) {
+				fail(result, "Error", e, EXIT_OTHER_ERROR);
+			}
+			return result;
+		}
+
+	} // namespace
+
+	CompileResult compileSource(const lexer::SourceBuffer &source, const CompileOptions &options) {
+		ast::StringSink out;
+		CompileResult result = guarded([&](CompileResult &partial) { compile(source, options, out, partial); });
+		result.output = out.str();
+		return result;
+	}
+
+	CompileResult compileSource(const lexer::SourceBuffer &source, const CompileOptions &options, ast::OutputSink &out,
+								const std::shared_ptr<ast::ASTContext> &arena) {
+		return guarded([&](CompileResult &result) { compile(source, options, out, result, arena); });
+	}
+
+	CompileResult compileFile(const std::string &filename, const CompileOptions &options) {
+		ast::StringSink out;
+		CompileResult result = compileFile(filename, options, out);
+		result.output = out.str();
+		return result;
+	}
+
+	CompileResult compileFile(const std::string &filename, const CompileOptions &options, ast::OutputSink &out) {
+		return guarded([&](CompileResult &result) {
+			// Load the source file (memory-mapped when it is a regular file)
+			double readSeconds = 0;
+			auto source = [&] {
+				ScopedTimer timer(readSeconds);
+				return lexer::SourceBuffer::fromFile(filename);
+			}();
+			result.stats.readSeconds = readSeconds;
+			compile(source, options, out, result);
+			out.flush();
+		});
+	}
+
+	CompileResult compileStream(std::istream &input, const std::string &name, const CompileOptions &options,
+								ast::OutputSink &out) {
+		return guarded([&](CompileResult &result) {
+			result.stats.name = name;
+			if (options.lexOnly) {
+				// Tokens are written as they are lexed, only a window of the input is kept
+				lexer::Lexer lexer(input, name);
+				std::size_t written = out.bytesWritten();
+				try {
+					listTokens(lexer, name, out, result);
+				} catch (...) {
+					// The tokens before the error have been written already
+					out.flush();
+					throw;
+				}
+				result.stats.outputBytes = out.bytesWritten() - written;
+				out.flush();
+				return;
+			}
+
+			// The parser works on the whole input
+			std::ostringstream text;
+			{
+				ScopedTimer timer(result.stats.readSeconds);
+				text << input.rdbuf();
+			}
+			compile(lexer::SourceBuffer::fromString(text.str(), name), options, out, result);
+			out.flush();
+		});
+	}
+
+	int compileBatch(const std::vector<std::string> &files, const CompileOptions &options,
+					 const BatchOptions &batch, std::ostream &out, std::ostream &err) {
+		// Workers stay at most two files each ahead of the writer, so a slow output (or a batch
+		// of large files) does not keep every finished output in memory
+		// Two inputs writing the same output file would lose one of the results
+		if (!batch.outputDir.empty()) {
+			std::unordered_map<std::string, std::size_t> writers;
+			for (std::size_t i = 0; i < files.size(); ++i) {
+				auto [writer, added] = writers.emplace(outputPathFor(files[i], batch.outputDir, options), i);
+				if (!added) {
+					err << "Error: " << files[writer->second] << " and " << files[i]
+						<< " would both be written to " << writer->first << "\n";
+					return EXIT_OTHER_ERROR;
+				}
+			}
+		}
+
+		std::size_t jobs = batch.jobs == 0 ? defaultThreadCount() : batch.jobs;
+		ParallelMap<CompileResult> results(files.size(), jobs, [&](std::size_t i) {
+			return compileFile(files[i], options);
+		}, 2 * jobs);
+
+		// Collect in input order and release each result once written; later files keep
+		// compiling while earlier ones are written
+		int exitCode = EXIT_OK;
+		for (std::size_t i = 0; i < files.size(); ++i) {
+			CompileResult result = results.get(i);
+
+			// Files with errors have no output, unless a recovering parse produced one
+			if (!batch.outputDir.empty() && (result.exitCode == EXIT_OK || !result.output.empty())) {
+				std::string path = outputPathFor(files[i], batch.outputDir, options);
+				std::error_code error;
+				std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+				std::ofstream file(path, std::ios::binary);
+				file << result.output;
+				if (!file) {
+					result.diagnostics += "Error: Could not write file: " + path + "\n";
+					result.exitCode = EXIT_OTHER_ERROR;
+				}
+			} else {
+				out << result.output;
+			}
+
+			err << result.diagnostics << result.stats.format(options.stats);
+			exitCode = std::max(exitCode, result.exitCode);
+		}
+
+		out.flush();
+		return exitCode;
+	}
+
+	std::string outputPathFor(const std::string &input, const std::string &outputDir, const CompileOptions &options) {
+		namespace fs = std::filesystem;
+		fs::path path = fs::path(input).lexically_normal();
+
+		// Inputs given by an absolute path or one leaving the working directory keep only their name
+		fs::path directory = path.parent_path();
+		if (path.is_absolute() || (!directory.empty() && *directory.begin() == "..")) {
+			directory.clear();
+		}
+
+		std::string name = path.filename().string();
+		std::size_t dot = name.find_last_of('.');
+		if (dot != std::string::npos && dot != 0) {
+			name.erase(dot);
+		}
+		if (options.lexOnly) {
+			name += ".tokens";
+		} else {
+			name += options.format == OutputFormat::BINARY ? ".tcast" : ".json";
+		}
+
+		return (fs::path(outputDir) / directory / name).string();
+	}
+
+	std::vector<std::string> expandResponseFiles(const std::vector<std::string> &args) {
+		std::vector<std::string> expanded;
+
+		for (const auto &arg: args) {
+			if (arg.size() < 2 || arg[0] != '@') {
+				expanded.push_back(arg);
+				continue;
+			}
+
+			std::ifstream file(arg.substr(1));
+			if (!file) {
+				throw std::runtime_error("Could not open response file: " + arg.substr(1));
+			}
+			std::string word;
+			while (file >> word) {
+				expanded.push_back(word);
+			}
+		}
+
+		return expanded;
+	}
+
+	bool parseCount(std::string_view text, std::size_t &value) {
+		const char *end = text.data() + text.size();
+		std::size_t parsed = 0;
+		auto [last, error] = std::from_chars(text.data(), end, parsed);
+		if (text.empty() || error != std::errc() || last != end) {
+			return false;
+		}
+		value = parsed;
+		return true;
+	}
+
+	bool parseSize(std::string_view text, std::uintmax_t &size) {
+		std::size_t digits = text.find_first_not_of("0123456789");
+		std::string_view suffix = digits == std::string_view::npos ? std::string_view() : text.substr(digits);
+		std::uintmax_t multiplier = 1;
+		if (suffix == "K" || suffix == "k") {
+			multiplier = std::uintmax_t(1) << 10;
+		} else if (suffix == "M" || suffix == "m") {
+			multiplier = std::uintmax_t(1) << 20;
+		} else if (suffix == "G" || suffix == "g") {
+			multiplier = std::uintmax_t(1) << 30;
+		} else if (!suffix.empty()) {
+			return false;
+		}
+
+		std::string_view count = text.substr(0, digits);
+		std::uintmax_t parsed = 0;
+		auto [last, error] = std::from_chars(count.data(), count.data() + count.size(), parsed);
+		if (count.empty() || error != std::errc() || last != count.data() + count.size() ||
+			parsed > UINTMAX_MAX / multiplier) {
+			return false;
+		}
+		size = parsed * multiplier;
+		return true;
+	}
+
+} // namespace tinyc::driver
@@ -0,0 +1,295 @@
+#include "tinyc/driver/OutputCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Hash of the frontend sources, generated by the build (see cmake/BuildId.cmake)
+#if __has_include("tinyc/BuildId.h")
+#include "tinyc/BuildId.h"
+#endif
+
+#ifndef TINYC_VERSION
+#define TINYC_VERSION "unknown"
+#endif
+
+#ifndef TINYC_BUILD_ID
+#define TINYC_BUILD_ID "unknown"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Bumped when the entry layout or the output of any mode changes (e.g. the JSON writer
+		// or the formatting of literals), so old entries are never read. Builds from the CMake
+		// project also key entries by a hash of the sources, which builds without it lack.
+		constexpr std::uint64_t CACHE_FORMAT = 2;
+
+		constexpr const char *ENTRY_MAGIC = "tinyc-cache";
+		constexpr const char *ENTRY_EXTENSION = ".entry";
+		constexpr const char *TEMPORARY_EXTENSION = ".tmp";
+
+		// Temporary files older than this belong to writers that did not finish
+		constexpr auto STALE_TEMPORARY_AGE = std::chrono::hours(1);
+
+		inline std::uint64_t rotateLeft(std::uint64_t x, int r) {
+			return (x << r) | (x >> (64 - r));
+		}
+
+		inline std::uint64_t finalMix(std::uint64_t k) {
+			k ^= k >> 33;
+			k *= 0xff51afd7ed558ccdULL;
+			k ^= k >> 33;
+			k *= 0xc4ceb9fe1a85ec53ULL;
+			k ^= k >> 33;
+			return k;
+		}
+
+		std::string toHex(const std::array<std::uint64_t, 2> &hash) {
+			static const char DIGITS[] = "0123456789abcdef";
+			std::string hex(32, '0');
+			for (int half = 0; half < 2; ++half) {
+				for (int digit = 0; digit < 16; ++digit) {
+					hex[half * 16 + digit] = DIGITS[(hash[half] >> (60 - 4 * digit)) & 0xF];
+				}
+			}
+			return hex;
+		}
+
+		int processId() {
+#ifdef _WIN32
+			return _getpid();
+#else
+			return static_cast<int>(::getpid());
+#endif
+		}
+
+		bool hasExtension(const fs::path &path, const char *extension) {
+			return path.extension() == extension;
+		}
+
+	} // anonymous namespace
+
+	std::array<std::uint64_t, 2> hashBytes(std::string_view data, std::uint64_t seed) {
+		constexpr std::uint64_t C1 = 0x87c37b91114253d5ULL;
+		constexpr std::uint64_t C2 = 0x4cf5ad432745937fULL;
+
+		const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+		std::size_t length = data.size();
+		std::size_t blocks = length / 16;
+		std::uint64_t h1 = seed;
+		std::uint64_t h2 = seed;
+
+		for (std::size_t i = 0; i < blocks; ++i) {
+			std::uint64_t k1, k2;
+			std::memcpy(&k1, bytes + i * 16, 8);
+			std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+			k1 *= C1;
+			k1 = rotateLeft(k1, 31);
+			k1 *= C2;
+			h1 ^= k1;
+			h1 = rotateLeft(h1, 27);
+			h1 += h2;
+			h1 = h1 * 5 + 0x52dce729;
+
+			k2 *= C2;
+			k2 = rotateLeft(k2, 33);
+			k2 *= C1;
+			h2 ^= k2;
+			h2 = rotateLeft(h2, 31);
+			h2 += h1;
+			h2 = h2 * 5 + 0x38495ab5;
+		}
+
+		// The last 0 to 15 bytes, little-endian
+		const unsigned char *tail = bytes + blocks * 16;
+		std::size_t rest = length & 15;
+		std::uint64_t k1 = 0, k2 = 0;
+		for (std::size_t i = rest; i > 8; --i) {
+			k2 ^= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 9));
+		}
+		for (std::size_t i = std::min<std::size_t>(rest, 8); i > 0; --i) {
+			k1 ^= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 1));
+		}
+		if (rest > 8) {
+			k2 *= C2;
+			k2 = rotateLeft(k2, 33);
+			k2 *= C1;
+			h2 ^= k2;
+		}
+		if (rest > 0) {
+			k1 *= C1;
+			k1 = rotateLeft(k1, 31);
+			k1 *= C2;
+			h1 ^= k1;
+		}
+
+		h1 ^= length;
+		h2 ^= length;
+		h1 += h2;
+		h2 += h1;
+		h1 = finalMix(h1);
+		h2 = finalMix(h2);
+		h1 += h2;
+		h2 += h1;
+		return {h1, h2};
+	}
+
+	OutputCache::OutputCache(std::string directory, std::uintmax_t maxBytes)
+			: directory(std::move(directory)), maxBytes(maxBytes) {
+		std::error_code error;
+		fs::create_directories(this->directory, error);
+		if (error || !fs::is_directory(this->directory, error)) {
+			throw std::runtime_error("Could not create cache directory: " + this->directory);
+		}
+	}
+
+	std::string OutputCache::key(const lexer::SourceBuffer &source, const CompileOptions &options) const {
+		// Options that do not change the output of a mode are left out, so they share entries
+		std::string salt = "tinyc " TINYC_VERSION " " TINYC_BUILD_ID "\n";
+		if (options.lexOnly) {
+			salt += "lex\n";
+		} else if (options.format == OutputFormat::BINARY) {
+			salt += "parse bin\n";
+		} else {
+			salt += options.prettyPrint ? "parse json pretty\n" : "parse json\n";
+		}
+		salt += source.getName();
+		salt += '\n';
+		salt += toHex(hashBytes(source.getText()));
+		return toHex(hashBytes(salt, CACHE_FORMAT));
+	}
+
+	bool OutputCache::lookup(const std::string &key, std::string &output) {
+		std::string path = pathFor(key);
+		std::ifstream file(path, std::ios::binary);
+
+		// An entry is the magic line, the key and the output size, then the output
+		std::string magic, storedKey;
+		std::size_t size = 0;
+		bool found = file && std::getline(file, magic) && magic == ENTRY_MAGIC && file >> storedKey >> size &&
+					 storedKey == key && file.get() == '\n';
+		if (found) {
+			output.resize(size);
+			found = file.read(output.data(), static_cast<std::streamsize>(size)) &&
+					file.peek() == std::ifstream::traits_type::eof();
+		}
+		if (!found) {
+			missCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// Reading an entry makes it the most recently used one
+		std::error_code error;
+		fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+		hitCount.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void OutputCache::store(const std::string &key, std::string_view output) {
+		std::string path = pathFor(key);
+		std::string temporary = directory + "/" + key + "." + std::to_string(processId()) + "-" +
+								std::to_string(temporaryCount.fetch_add(1, std::memory_order_relaxed)) +
+								TEMPORARY_EXTENSION;
+		std::error_code error;
+		{
+			std::ofstream file(temporary, std::ios::binary);
+			file << ENTRY_MAGIC << '\n' << key << ' ' << output.size() << '\n';
+			file.write(output.data(), static_cast<std::streamsize>(output.size()));
+			file.close();
+			if (!file) {
+				fs::remove(temporary, error);
+				return;
+			}
+		}
+		// Readers see either the previous entry or the complete new one
+		fs::rename(temporary, path, error);
+		if (error) {
+			fs::remove(temporary, error);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!sized) {
+			bytes = trim(maxBytes);
+			sized = true;
+		} else {
+			bytes += output.size();
+		}
+		if (bytes > maxBytes) {
+			bytes = trim(maxBytes / 4 * 3);
+		}
+	}
+
+	void OutputCache::evict() {
+		std::lock_guard<std::mutex> lock(mutex);
+		bytes = trim(maxBytes);
+		sized = true;
+	}
+
+	std::string OutputCache::pathFor(const std::string &key) const {
+		return directory + "/" + key + ENTRY_EXTENSION;
+	}
+
+	std::uintmax_t OutputCache::trim(std::uintmax_t target) {
+		struct Entry {
+			fs::path path;
+			fs::file_time_type used;
+			std::uintmax_t size;
+		};
+		std::vector<Entry> entries;
+		std::uintmax_t total = 0;
+		auto now = fs::file_time_type::clock::now();
+
+		std::error_code error;
+		for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+			std::error_code entryError;
+			if (!it->is_regular_file(entryError)) {
+				continue;
+			}
+			fs::file_time_type used = it->last_write_time(entryError);
+			std::uintmax_t size = it->file_size(entryError);
+			if (entryError) {
+				// Removed by another process in the meantime
+				continue;
+			}
+			if (hasExtension(it->path(), TEMPORARY_EXTENSION)) {
+				if (now - used > STALE_TEMPORARY_AGE) {
+					fs::remove(it->path(), entryError);
+				}
+			} else if (hasExtension(it->path(), ENTRY_EXTENSION)) {
+				entries.push_back({it->path(), used, size});
+				total += size;
+			}
+		}
+
+		if (total > target) {
+			std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+			for (const auto &entry: entries) {
+				if (total <= target) {
+					break;
+				}
+				std::error_code removeError;
+				if (fs::remove(entry.path, removeError) || !removeError) {
+					total -= entry.size;
+				}
+			}
+		}
+		return total;
+	}
+
+} // namespace tinyc::driver
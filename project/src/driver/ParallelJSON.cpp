@@ -0,0 +1,58 @@
+#include "tinyc/driver/ParallelJSON.h"
+#include "tinyc/driver/ParallelMap.h"
+#include "tinyc/ast/visitors/CompactJSONVisitor.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include <algorithm>
+#include <memory>
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Ranges per worker thread, so a thread finishing a cheap range early takes another
+		constexpr std::size_t RANGES_PER_JOB = 4;
+
+		// Write a tree with a visitor constructed as Visitor(sink, args...)
+		template<typename Visitor, typename... Args>
+		void write(const ast::ASTNode &ast, ast::OutputSink &out, std::size_t jobs, Args... args) {
+			Visitor visitor(out, args...);
+
+			std::size_t count = ast.getNodeKind() == ast::NodeKind::PROGRAM
+								? static_cast<const ast::ProgramNode &>(ast).getDeclarations().size() : 0;
+			if (jobs <= 1 || count < 2) {
+				ast.accept(visitor);
+				return;
+			}
+
+			const auto &program = static_cast<const ast::ProgramNode &>(ast);
+			std::size_t ranges = std::min(count, jobs * RANGES_PER_JOB);
+
+			// Range i holds the declarations [first(i), first(i + 1))
+			auto first = [&](std::size_t i) { return count * i / ranges; };
+
+			ParallelMap<std::unique_ptr<ast::StringSink>> buffers(ranges, jobs, [&](std::size_t i) {
+				auto buffer = std::make_unique<ast::StringSink>();
+				Visitor rangeVisitor(*buffer, args...);
+				rangeVisitor.writeDeclarations(program, first(i), first(i + 1));
+				return buffer;
+			});
+
+			visitor.writeProgram(program, [&]() {
+				for (std::size_t i = 0; i < ranges; ++i) {
+					out << buffers.get(i)->str();
+				}
+			});
+		}
+
+	} // anonymous namespace
+
+	void writeJSON(const ast::ASTNode &ast, ast::OutputSink &out, bool prettyPrint, std::size_t jobs) {
+		jobs = jobs == 0 ? defaultThreadCount() : jobs;
+		if (prettyPrint) {
+			write<ast::JSONVisitor>(ast, out, jobs, true);
+		} else {
+			write<ast::CompactJSONVisitor>(ast, out, jobs);
+		}
+	}
+
+} // namespace tinyc::driver
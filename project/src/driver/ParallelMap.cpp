@@ -0,0 +1,10 @@
+#include "tinyc/driver/ParallelMap.h"
+
+namespace tinyc::driver {
+
+	std::size_t defaultThreadCount() {
+		unsigned count = std::thread::hardware_concurrency();
+		return count == 0 ? 1 : count;
+	}
+
+} // namespace tinyc::driver
@@ -0,0 +1,207 @@
+#include "tinyc/driver/ParallelParser.h"
+#include "tinyc/driver/ParallelMap.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/lexer/Lexer.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Declarations parsed from one chunk, and whether they can be spliced in
+		struct Chunk {
+			std::shared_ptr<ast::ASTContext> arena;
+			ast::NodeList declarations;
+			std::size_t tokens = 0;  // Consumed by the declarations of the chunk
+			bool clean = false;
+		};
+
+	} // anonymous namespace
+
+	ParallelParser::ParallelParser(const lexer::SourceBuffer &source, parser::ParserOptions options, std::size_t jobs,
+								   std::size_t chunkSize, std::pmr::memory_resource *upstream)
+			: source(source), options(options), jobs(jobs == 0 ? defaultThreadCount() : jobs),
+			  chunkSize(std::max<std::size_t>(chunkSize, 1)), upstream(upstream) {
+	}
+
+	std::vector<ParallelParser::Boundary> ParallelParser::findBoundaries(std::string_view text, std::size_t chunkSize) {
+		std::vector<Boundary> boundaries{{0, 1, 1}};
+		std::size_t depth = 0;
+		int line = 1;
+		std::size_t lineStart = 0;
+		bool ended = false;        // A declaration ended before the next token
+		bool endedByBrace = false; // ... with a '}', which a ';' may still follow
+
+		// Count the newlines of a skipped range
+		auto skipTo = [&](std::size_t from, std::size_t to) {
+			for (const char *p = text.data() + from, *end = text.data() + to;
+				 (p = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)))) != nullptr; ++p) {
+				++line;
+				lineStart = static_cast<std::size_t>(p - text.data()) + 1;
+			}
+			return to;
+		};
+
+		std::size_t i = 0;
+		while (i < text.size()) {
+			char c = text[i];
+			switch (c) {
+				case '\n':
+					++line;
+					lineStart = ++i;
+					continue;
+				case ' ':
+				case '\t':
+				case '\r':
+				case '\v':
+				case '\f':
+					++i;
+					continue;
+				case '/':
+					if (i + 1 < text.size() && text[i + 1] == '/') {
+						std::size_t newline = text.find('\n', i + 2);
+						i = newline == std::string_view::npos ? text.size() : newline;
+						continue;
+					}
+					if (i + 1 < text.size() && text[i + 1] == '*') {
+						std::size_t close = text.find("*/", i + 2);
+						i = skipTo(i, close == std::string_view::npos ? text.size() : close + 2);
+						continue;
+					}
+					break;
+				default:
+					break;
+			}
+
+			// c starts a token: the first one after a top-level declaration may start a chunk
+			if (ended && !(endedByBrace && c == ';') && i - boundaries.back().offset >= chunkSize) {
+				boundaries.push_back({i, line, static_cast<int>(i - lineStart) + 1});
+			}
+			ended = false;
+
+			switch (c) {
+				case '"':
+				case '\'': {
+					std::size_t j = i + 1;
+					while (j < text.size() && text[j] != c && text[j] != '\n') {
+						j += text[j] == '\\' ? 2 : 1;
+					}
+					i = std::min(j + 1, text.size());
+					continue;
+				}
+				case '{':
+					++depth;
+					break;
+				case '}':
+					if (depth > 0) {
+						--depth;
+					}
+					ended = endedByBrace = depth == 0;
+					break;
+				case ';':
+					ended = depth == 0;
+					endedByBrace = false;
+					break;
+				default:
+					break;
+			}
+			++i;
+		}
+
+		return boundaries;
+	}
+
+	ast::ASTNodePtr ParallelParser::parseProgram() {
+		diagnostics.clear();
+		parallelChunks = 0;
+		consumedTokens = 0;
+
+		std::string_view text = source.getText();
+		std::vector<Boundary> boundaries = findBoundaries(text, std::max(chunkSize, text.size() / (jobs * 4)));
+
+		auto context = std::make_shared<ast::ASTContext>(64 * 1024, upstream);
+		auto program = std::make_unique<ast::ProgramNode>(source.getName(), context);
+
+		if (jobs > 1 && boundaries.size() > 1) {
+			// All chunks intern their names in one table, so equal names share one copy
+			context->setSymbols(std::make_shared<ast::SymbolTable>(true, upstream));
+
+			ParallelMap<Chunk> chunks(boundaries.size(), jobs, [&](std::size_t i) {
+				Chunk chunk;
+				chunk.arena = std::make_shared<ast::ASTContext>(64 * 1024, upstream);
+				chunk.arena->setSymbols(context->getSymbols());
+				chunk.declarations = chunk.arena->makeList();
+
+				bool last = i + 1 == boundaries.size();
+				const Boundary &start = boundaries[i];
+				try {
+					lexer::Lexer lexer(source);
+					lexer.seek(start.offset, start.line, start.column);
+					parser::Parser parser(lexer, chunk.arena, options);
+
+					for (;;) {
+						const lexer::TokenRef &token = parser.getCurrentToken();
+						if (token.getType() == lexer::TokenType::END_OF_FILE) {
+							chunk.clean = last;
+							break;
+						}
+						if (!last && token.offset >= boundaries[i + 1].offset) {
+							// The next chunk must start exactly where this one stopped
+							const Boundary &next = boundaries[i + 1];
+							chunk.clean = token.offset == next.offset && token.line == next.line &&
+										  token.column == next.column;
+							break;
+						}
+
+						chunk.declarations.push_back(parser.parseNextDeclaration());
+						if (!parser.getDiagnostics().empty()) {
+							break;
+						}
+					}
+					chunk.tokens = parser.getConsumedTokens();
+				} catch (const std::exception &) {
+					// The sequential parse reports the error
+				}
+				return chunk;
+			});
+
+			for (; parallelChunks < boundaries.size(); ++parallelChunks) {
+				Chunk chunk = chunks.get(parallelChunks);
+				if (!chunk.clean) {
+					break;
+				}
+				for (auto &declaration: chunk.declarations) {
+					program->addDeclaration(std::move(declaration));
+				}
+				context->adopt(std::move(chunk.arena));
+				consumedTokens += chunk.tokens;
+			}
+		}
+
+		// Parse the rest sequentially, from the start of the first chunk that could not be used
+		if (parallelChunks < boundaries.size()) {
+			const Boundary &start = boundaries[parallelChunks];
+			lexer::Lexer lexer(source);
+			lexer.seek(start.offset, start.line, start.column);
+			parser::Parser parser(lexer, context, options);
+
+			try {
+				while (auto declaration = parser.parseNextDeclaration()) {
+					program->addDeclaration(std::move(declaration));
+				}
+			} catch (...) {
+				consumedTokens += parser.getConsumedTokens();
+				throw;
+			}
+			consumedTokens += parser.getConsumedTokens();
+			diagnostics = parser.getDiagnostics();
+		}
+
+		return program;
+	}
+
+} // namespace tinyc::driver
@@ -0,0 +1,277 @@
+#include "tinyc/driver/Server.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Apply the mode and flags of a request header, returning an error message if they are invalid
+		std::string applyHeader(std::istringstream &fields, const std::string &mode, CompileOptions &options,
+								std::string &name) {
+			if (mode == "lex") {
+				options.lexOnly = true;
+			} else if (mode == "parse") {
+				options.lexOnly = false;
+			} else {
+				return "Unknown request mode: " + mode;
+			}
+
+			std::string flag;
+			while (fields >> flag) {
+				std::size_t equals = flag.find('=');
+				std::string key = flag.substr(0, equals);
+				std::string value = equals == std::string::npos ? "" : flag.substr(equals + 1);
+
+				if (flag == "pretty") {
+					options.prettyPrint = true;
+				} else if (flag == "bin") {
+					options.format = OutputFormat::BINARY;
+				} else if (flag == "json") {
+					options.format = OutputFormat::JSON;
+				} else if (flag == "recover") {
+					options.recover = true;
+				} else if (key == "max-errors" && parseCount(value, options.maxErrors)) {
+					continue;
+				} else if (key == "parse-jobs" && parseCount(value, options.parseJobs)) {
+					continue;
+				} else if (key == "serialize-jobs" && parseCount(value, options.serializeJobs)) {
+					continue;
+				} else if (key == "name" && !value.empty()) {
+					name = value;
+				} else {
+					return "Unknown request flag: " + flag;
+				}
+			}
+			return "";
+		}
+
+		void respond(std::ostream &out, const CompileResult &result, const std::string &output) {
+			out << result.exitCode << ' ' << output.size() << ' ' << result.diagnostics.size() << '\n';
+			out.write(output.data(), static_cast<std::streamsize>(output.size()));
+			out << result.diagnostics;
+			out.flush();
+		}
+
+		CompileResult requestError(const std::string &message) {
+			CompileResult result;
+			result.diagnostics = "Error: " + message + "\n";
+			result.exitCode = EXIT_OTHER_ERROR;
+			return result;
+		}
+
+#ifndef _WIN32
+		// Closes the descriptor when leaving the scope
+		struct FileDescriptor {
+			int fd;
+
+			~FileDescriptor() {
+				if (fd >= 0) {
+					::close(fd);
+				}
+			}
+		};
+
+		// Buffered stream over a connected socket
+		class SocketBuffer final : public std::streambuf {
+		public:
+			explicit SocketBuffer(int fd) : fd(fd) {
+				setg(input, input, input);
+				setp(output, output + sizeof(output));
+			}
+
+			~SocketBuffer() override { sync(); }
+
+		protected:
+			int_type underflow() override {
+				ssize_t received;
+				do {
+					received = ::recv(fd, input, sizeof(input), 0);
+				} while (received < 0 && errno == EINTR);
+				if (received <= 0) {
+					return traits_type::eof();
+				}
+				setg(input, input, input + received);
+				return traits_type::to_int_type(*gptr());
+			}
+
+			int_type overflow(int_type c) override {
+				if (sync() != 0) {
+					return traits_type::eof();
+				}
+				if (!traits_type::eq_int_type(c, traits_type::eof())) {
+					*pptr() = traits_type::to_char_type(c);
+					pbump(1);
+				}
+				return traits_type::not_eof(c);
+			}
+
+			int sync() override {
+				for (char *data = pbase(); data < pptr();) {
+					// A client hanging up must not kill the server with SIGPIPE
+#ifdef MSG_NOSIGNAL
+					ssize_t sent = ::send(fd, data, static_cast<std::size_t>(pptr() - data), MSG_NOSIGNAL);
+#else
+					ssize_t sent = ::send(fd, data, static_cast<std::size_t>(pptr() - data), 0);
+#endif
+					if (sent < 0 && errno == EINTR) {
+						continue;
+					}
+					if (sent <= 0) {
+						setp(output, output + sizeof(output));
+						return -1;
+					}
+					data += sent;
+				}
+				setp(output, output + sizeof(output));
+				return 0;
+			}
+
+		private:
+			int fd;
+			char input[64 * 1024];
+			char output[64 * 1024];
+		};
+
+		[[noreturn]] void throwSystemError(const std::string &what, const std::string &path) {
+			throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+		}
+#endif
+
+	} // anonymous namespace
+
+	BlockCache::~BlockCache() {
+		for (const auto &[key, block]: blocks) {
+			upstream->deallocate(block, key.first, key.second);
+		}
+	}
+
+	void *BlockCache::do_allocate(std::size_t bytes, std::size_t alignment) {
+		auto cachedBlock = blocks.find({bytes, alignment});
+		if (cachedBlock == blocks.end()) {
+			return upstream->allocate(bytes, alignment);
+		}
+		void *block = cachedBlock->second;
+		blocks.erase(cachedBlock);
+		cached -= bytes;
+		return block;
+	}
+
+	void BlockCache::do_deallocate(void *block, std::size_t bytes, std::size_t alignment) {
+		blocks.emplace(std::make_pair(bytes, alignment), block);
+		cached += bytes;
+	}
+
+	Server::Server(CompileOptions defaults)
+			: defaults(defaults), arena(std::make_shared<ast::ASTContext>(64 * 1024, &cache)) {
+	}
+
+	bool Server::serve(std::istream &in, std::ostream &out) {
+		std::string header;
+		while (std::getline(in, header)) {
+			if (!header.empty() && header.back() == '\r') {
+				header.pop_back();
+			}
+			if (header == "quit") {
+				return false;
+			}
+			if (header == "shutdown") {
+				return true;
+			}
+
+			// Without a length the next request cannot be found
+			std::istringstream fields(header);
+			std::string mode, length;
+			fields >> mode >> length;
+			std::size_t size = 0;
+			if (!parseCount(length, size)) {
+				respond(out, requestError("Malformed request header: " + header), "");
+				return false;
+			}
+			if (size > MAX_REQUEST_SIZE) {
+				respond(out, requestError("Request of " + length + " bytes exceeds the limit of " +
+										  std::to_string(MAX_REQUEST_SIZE) + " bytes"), "");
+				return false;
+			}
+			try {
+				source.resize(size);
+			} catch (const std::bad_alloc &) {
+				source = std::string();
+				respond(out, requestError("Out of memory for a request of " + length + " bytes"), "");
+				return false;
+			}
+			if (!in.read(source.data(), static_cast<std::streamsize>(size))) {
+				respond(out, requestError("Request ended before its " + length + " bytes of source"), "");
+				return false;
+			}
+
+			CompileOptions options = defaults;
+			std::string name = "<input>";
+			std::string error = applyHeader(fields, mode, options, name);
+
+			++requests;
+			output.clear();
+			if (!error.empty()) {
+				respond(out, requestError(error), "");
+				continue;
+			}
+
+			CompileResult result = compileSource(lexer::SourceBuffer::view(source, name), options, output, arena);
+			// The blocks go back to the cache for the next request
+			arena->reset();
+			respond(out, result, output.str());
+		}
+		return false;
+	}
+
+	void Server::serveSocket(const std::string &path) {
+#ifdef _WIN32
+		throw std::runtime_error("Unix domain sockets are not supported on this platform: " + path);
+#else
+		sockaddr_un address{};
+		if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+			throw std::runtime_error("Invalid socket path: " + path);
+		}
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+		FileDescriptor listener{::socket(AF_UNIX, SOCK_STREAM, 0)};
+		if (listener.fd < 0) {
+			throwSystemError("Could not create socket", path);
+		}
+		::unlink(path.c_str());
+		if (::bind(listener.fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+			throwSystemError("Could not bind socket", path);
+		}
+		if (::listen(listener.fd, 16) != 0) {
+			throwSystemError("Could not listen on socket", path);
+		}
+
+		for (bool stop = false; !stop;) {
+			FileDescriptor connection{::accept(listener.fd, nullptr, nullptr)};
+			if (connection.fd < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throwSystemError("Could not accept a connection on socket", path);
+			}
+
+			SocketBuffer buffer(connection.fd);
+			std::iostream stream(&buffer);
+			stop = serve(stream, stream);
+		}
+		::unlink(path.c_str());
+#endif
+	}
+
+} // namespace tinyc::driver
@@ -0,0 +1,170 @@
+#include "tinyc/driver/Stats.h"
+#include "tinyc/ast/FlatAST.h"
+#include <cstdio>
+#include <numeric>
+
+namespace tinyc::driver {
+
+	namespace {
+
+		// Indexed by NodeKind
+		const char *const NODE_KIND_NAMES[ast::NODE_KIND_COUNT] = {
+				"Program",
+				"VariableDeclaration", "MultipleDeclaration", "Parameter", "FunctionDeclaration",
+				"StructDeclaration", "FunctionPointerDeclaration",
+				"PrimitiveType", "NamedType", "PointerType",
+				"Literal", "Identifier", "BinaryExpression", "UnaryExpression", "CastExpression",
+				"CallExpression", "IndexExpression", "MemberExpression", "CommaExpression",
+				"BlockStatement", "ExpressionStatement", "IfStatement", "WhileStatement", "DoWhileStatement",
+				"ForStatement", "SwitchStatement", "BreakStatement", "ContinueStatement", "ReturnStatement",
+				"Error"
+		};
+
+		void appendLine(std::string &text, const char *label, const char *format, double value) {
+			char line[96];
+			int length = std::snprintf(line, sizeof(line), "  %-30s", label);
+			text.append(line, length);
+			length = std::snprintf(line, sizeof(line), format, value);
+			text.append(line, length);
+			text += '\n';
+		}
+
+		void appendCount(std::string &text, const char *label, std::size_t count) {
+			char line[96];
+			int length = std::snprintf(line, sizeof(line), "  %-30s%zu\n", label, count);
+			text.append(line, length);
+		}
+
+		void appendEscaped(std::string &json, const std::string &text) {
+			for (char c: text) {
+				if (c == '"' || c == '\\') {
+					json += '\\';
+					json += c;
+				} else if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+					json += escaped;
+				} else {
+					json += c;
+				}
+			}
+		}
+
+		void appendField(std::string &json, const char *key, double seconds) {
+			char field[64];
+			int length = std::snprintf(field, sizeof(field), ",\"%s\":%.9g", key, seconds);
+			json.append(field, length);
+		}
+
+		void appendField(std::string &json, const char *key, std::size_t count) {
+			char field[64];
+			int length = std::snprintf(field, sizeof(field), ",\"%s\":%zu", key, count);
+			json.append(field, length);
+		}
+
+	} // anonymous namespace
+
+	void *AllocationCounter::do_allocate(std::size_t bytes, std::size_t alignment) {
+		void *block = upstream->allocate(bytes, alignment);
+		std::size_t now = current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		std::size_t highest = peak.load(std::memory_order_relaxed);
+		while (now > highest && !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+		}
+		return block;
+	}
+
+	void AllocationCounter::do_deallocate(void *block, std::size_t bytes, std::size_t alignment) {
+		upstream->deallocate(block, bytes, alignment);
+		current.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	std::size_t CompileStats::nodes() const {
+		return std::accumulate(nodesByKind.begin(), nodesByKind.end(), std::size_t(0));
+	}
+
+	void CompileStats::countNodes(const ast::ASTNode &root) {
+		// Switch cases are records of their switch statement, not nodes
+		ast::FlatAST flat = ast::FlatAST::fromTree(root);
+		for (std::uint8_t kind: flat.kinds()) {
+			if (kind != ast::CASE_KIND) {
+				++nodesByKind[kind];
+			}
+		}
+	}
+
+	std::string CompileStats::toText() const {
+		std::string text = "Statistics for " + name + ":\n";
+		if (cacheHit) {
+			char line[96];
+			int length = std::snprintf(line, sizeof(line), "  %-30s%s\n", "cache:", "hit, not lexed or parsed");
+			text.append(line, length);
+		}
+		if (readSeconds != 0) {
+			appendLine(text, "read:", "%.3f ms", readSeconds * 1e3);
+		}
+		if (lexSeconds != 0) {
+			appendLine(text, "lex:", "%.3f ms", lexSeconds * 1e3);
+		}
+		if (parseSeconds != 0) {
+			appendLine(text, "parse:", "%.3f ms (including lexing)", parseSeconds * 1e3);
+		}
+		if (serializeSeconds != 0) {
+			appendLine(text, "serialize:", "%.3f ms", serializeSeconds * 1e3);
+		}
+		appendCount(text, "tokens:", tokens);
+		appendCount(text, "AST nodes:", nodes());
+		for (int kind = 0; kind < ast::NODE_KIND_COUNT; ++kind) {
+			if (nodesByKind[kind] != 0) {
+				std::string label = std::string("  ") + NODE_KIND_NAMES[kind] + ":";
+				appendCount(text, label.c_str(), nodesByKind[kind]);
+			}
+		}
+		appendCount(text, "AST bytes (peak):", astBytes);
+		appendCount(text, "output bytes:", outputBytes);
+		return text;
+	}
+
+	std::string CompileStats::toJSON() const {
+		std::string json = "{\"name\":\"";
+		appendEscaped(json, name);
+		json += '"';
+		appendField(json, "readSeconds", readSeconds);
+		appendField(json, "lexSeconds", lexSeconds);
+		appendField(json, "parseSeconds", parseSeconds);
+		appendField(json, "serializeSeconds", serializeSeconds);
+		appendField(json, "tokens", tokens);
+		json += ",\"nodes\":{";
+		bool first = true;
+		for (int kind = 0; kind < ast::NODE_KIND_COUNT; ++kind) {
+			if (nodesByKind[kind] != 0) {
+				json += first ? "\"" : ",\"";
+				json += NODE_KIND_NAMES[kind];
+				json += "\":" + std::to_string(nodesByKind[kind]);
+				first = false;
+			}
+		}
+		json += '}';
+		appendField(json, "nodeCount", nodes());
+		appendField(json, "astBytes", astBytes);
+		appendField(json, "outputBytes", outputBytes);
+		json += cacheHit ? ",\"cacheHit\":true" : ",\"cacheHit\":false";
+		json += "}\n";
+		return json;
+	}
+
+	std::string CompileStats::format(StatsFormat format) const {
+		switch (format) {
+			case StatsFormat::TEXT:
+				return toText();
+			case StatsFormat::JSON:
+				return toJSON();
+			default:
+				return "";
+		}
+	}
+
+	const char *nodeKindName(ast::NodeKind kind) {
+		return NODE_KIND_NAMES[static_cast<int>(kind)];
+	}
+
+} // namespace tinyc::driver
@@ -0,0 +1,250 @@
+#include "tinyc/lexer/CharScan.h"
+#include <cstdint>
+
+#if !defined(TINYC_NO_SIMD)
+#if defined(__AVX2__)
+#define TINYC_SCAN_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINYC_SCAN_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define TINYC_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(TINYC_SCAN_AVX2) || defined(TINYC_SCAN_SSE2) || defined(TINYC_SCAN_NEON)
+#define TINYC_SCAN_SIMD 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tinyc::lexer::scan {
+
+	namespace {
+
+		// Scalar classification, also used for the tail of every vector loop
+		inline bool isSpace(unsigned char c) {
+			return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+		}
+
+		inline bool isIdentifierChar(unsigned char c) {
+			return static_cast<unsigned char>((c | 0x20) - 'a') <= 'z' - 'a' ||
+				   static_cast<unsigned char>(c - '0') <= 9 || c == '_';
+		}
+
+		inline unsigned countTrailingZeros(std::uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward64(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+		}
+
+		inline unsigned popCount(std::uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			return static_cast<unsigned>(__popcnt64(mask));
+#else
+			return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+		}
+
+		/*
+		 * Each back end provides BLOCK (bytes per step), BITS (mask bits per byte) and three
+		 * mask builders over one block. A set bit group means the byte matches.
+		 */
+#if defined(TINYC_SCAN_AVX2)
+		constexpr std::size_t BLOCK = 32;
+		constexpr unsigned BITS = 1;
+		constexpr std::uint64_t FULL = 0xFFFFFFFFu;
+
+		inline __m256i load(const char *p) {
+			return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+		}
+
+		// Unsigned v <= limit for every byte
+		inline __m256i lessEqual(__m256i v, char limit) {
+			return _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(limit)), v);
+		}
+
+		inline std::uint64_t toMask(__m256i v) {
+			return static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+		}
+
+		inline std::uint64_t equalMask(const char *p, char c) {
+			return toMask(_mm256_cmpeq_epi8(load(p), _mm256_set1_epi8(c)));
+		}
+
+		inline std::uint64_t spaceMask(const char *p) {
+			__m256i v = load(p);
+			__m256i blank = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+			__m256i control = lessEqual(_mm256_sub_epi8(v, _mm256_set1_epi8('\t')), '\r' - '\t');
+			return toMask(_mm256_or_si256(blank, control));
+		}
+
+		inline std::uint64_t identifierMask(const char *p) {
+			__m256i v = load(p);
+			__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+			__m256i alpha = lessEqual(_mm256_sub_epi8(lower, _mm256_set1_epi8('a')), 'z' - 'a');
+			__m256i digit = lessEqual(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+			__m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+			return toMask(_mm256_or_si256(_mm256_or_si256(alpha, digit), underscore));
+		}
+
+		constexpr const char *NAME = "avx2";
+#elif defined(TINYC_SCAN_SSE2)
+		constexpr std::size_t BLOCK = 16;
+		constexpr unsigned BITS = 1;
+		constexpr std::uint64_t FULL = 0xFFFFu;
+
+		inline __m128i load(const char *p) {
+			return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+		}
+
+		// Unsigned v <= limit for every byte
+		inline __m128i lessEqual(__m128i v, char limit) {
+			return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(limit)), v);
+		}
+
+		inline std::uint64_t toMask(__m128i v) {
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+		}
+
+		inline std::uint64_t equalMask(const char *p, char c) {
+			return toMask(_mm_cmpeq_epi8(load(p), _mm_set1_epi8(c)));
+		}
+
+		inline std::uint64_t spaceMask(const char *p) {
+			__m128i v = load(p);
+			__m128i blank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+			__m128i control = lessEqual(_mm_sub_epi8(v, _mm_set1_epi8('\t')), '\r' - '\t');
+			return toMask(_mm_or_si128(blank, control));
+		}
+
+		inline std::uint64_t identifierMask(const char *p) {
+			__m128i v = load(p);
+			__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+			__m128i alpha = lessEqual(_mm_sub_epi8(lower, _mm_set1_epi8('a')), 'z' - 'a');
+			__m128i digit = lessEqual(_mm_sub_epi8(v, _mm_set1_epi8('0')), 9);
+			__m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+			return toMask(_mm_or_si128(_mm_or_si128(alpha, digit), underscore));
+		}
+
+		constexpr const char *NAME = "sse2";
+#elif defined(TINYC_SCAN_NEON)
+		// NEON has no movemask; narrowing shifts pack each byte into 4 bits of a 64-bit mask
+		constexpr std::size_t BLOCK = 16;
+		constexpr unsigned BITS = 4;
+		constexpr std::uint64_t FULL = ~std::uint64_t{0};
+
+		inline uint8x16_t load(const char *p) {
+			return vld1q_u8(reinterpret_cast<const std::uint8_t *>(p));
+		}
+
+		inline std::uint64_t toMask(uint8x16_t v) {
+			uint8x8_t packed = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+			return vget_lane_u64(vreinterpret_u64_u8(packed), 0);
+		}
+
+		inline std::uint64_t equalMask(const char *p, char c) {
+			return toMask(vceqq_u8(load(p), vdupq_n_u8(static_cast<std::uint8_t>(c))));
+		}
+
+		inline std::uint64_t spaceMask(const char *p) {
+			uint8x16_t v = load(p);
+			uint8x16_t blank = vceqq_u8(v, vdupq_n_u8(' '));
+			uint8x16_t control = vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t'));
+			return toMask(vorrq_u8(blank, control));
+		}
+
+		inline std::uint64_t identifierMask(const char *p) {
+			uint8x16_t v = load(p);
+			uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+			uint8x16_t alpha = vcleq_u8(vsubq_u8(lower, vdupq_n_u8('a')), vdupq_n_u8('z' - 'a'));
+			uint8x16_t digit = vcleq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(9));
+			uint8x16_t underscore = vceqq_u8(v, vdupq_n_u8('_'));
+			return toMask(vorrq_u8(vorrq_u8(alpha, digit), underscore));
+		}
+
+		constexpr const char *NAME = "neon";
+#else
+		constexpr const char *NAME = "scalar";
+#endif
+
+	} // namespace
+
+	const char *implementation() {
+		return NAME;
+	}
+
+	std::size_t whitespaceRun(const char *text, std::size_t length) {
+		std::size_t i = 0;
+#if defined(TINYC_SCAN_SIMD)
+		for (; i + BLOCK <= length; i += BLOCK) {
+			std::uint64_t others = ~spaceMask(text + i) & FULL;
+			if (others != 0) {
+				return i + countTrailingZeros(others) / BITS;
+			}
+		}
+#endif
+		while (i < length && isSpace(static_cast<unsigned char>(text[i]))) {
+			++i;
+		}
+		return i;
+	}
+
+	std::size_t identifierRun(const char *text, std::size_t length) {
+		std::size_t i = 0;
+#if defined(TINYC_SCAN_SIMD)
+		for (; i + BLOCK <= length; i += BLOCK) {
+			std::uint64_t others = ~identifierMask(text + i) & FULL;
+			if (others != 0) {
+				return i + countTrailingZeros(others) / BITS;
+			}
+		}
+#endif
+		while (i < length && isIdentifierChar(static_cast<unsigned char>(text[i]))) {
+			++i;
+		}
+		return i;
+	}
+
+	std::size_t countNewlines(const char *text, std::size_t length) {
+		std::size_t i = 0;
+		std::size_t count = 0;
+#if defined(TINYC_SCAN_SIMD)
+		for (; i + BLOCK <= length; i += BLOCK) {
+			count += popCount(equalMask(text + i, '\n')) / BITS;
+		}
+#endif
+		for (; i < length; ++i) {
+			count += text[i] == '\n';
+		}
+		return count;
+	}
+
+	std::size_t findCommentClose(const char *text, std::size_t length) {
+		std::size_t i = 0;
+#if defined(TINYC_SCAN_SIMD)
+		// The '/' mask is loaded one byte ahead, so a block needs one extra byte of input
+		for (; i + BLOCK < length; i += BLOCK) {
+			std::uint64_t closes = equalMask(text + i, '*') & equalMask(text + i + 1, '/');
+			if (closes != 0) {
+				return i + countTrailingZeros(closes) / BITS;
+			}
+		}
+#endif
+		for (; i + 1 < length; ++i) {
+			if (text[i] == '*' && text[i + 1] == '/') {
+				return i;
+			}
+		}
+		return length;
+	}
+
+} // namespace tinyc::lexer::scan
@@ -0,0 +1,40 @@
+#include "tinyc/lexer/FileTable.h"
+#include <stdexcept>
+
+namespace tinyc::lexer {
+
+	FileTable &FileTable::global() {
+		static FileTable table;
+		return table;
+	}
+
+	FileTable::FileTable() {
+		// Reserve id 0 for the empty name
+		names.emplace_back();
+		ids.emplace(names.back(), 0);
+	}
+
+	std::uint32_t FileTable::intern(std::string_view name) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = ids.find(name);
+		if (it != ids.end()) {
+			return it->second;
+		}
+
+		auto id = static_cast<std::uint32_t>(names.size());
+		names.emplace_back(name);
+		ids.emplace(names.back(), id);
+		return id;
+	}
+
+	const std::string &FileTable::getName(std::uint32_t id) const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (id >= names.size()) {
+			throw std::out_of_range("Unknown file id: " + std::to_string(id));
+		}
+		return names[id];
+	}
+
+} // namespace tinyc::lexer
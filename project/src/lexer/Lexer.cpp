@@ -1,43 +1,171 @@
 #include "tinyc/lexer/Lexer.h"
+#include "tinyc/lexer/CharScan.h"
 #include <cctype>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 
 namespace tinyc::lexer {
 
-	// Initialize the keywords map
-	const std::unordered_map<std::string, TokenType> Lexer::keywords = {
-			{"if",       TokenType::KW_IF},
-			{"else",     TokenType::KW_ELSE},
-			{"while",    TokenType::KW_WHILE},
-			{"do",       TokenType::KW_DO},
-			{"for",      TokenType::KW_FOR},
-			{"switch",   TokenType::KW_SWITCH},
-			{"case",     TokenType::KW_CASE},
-			{"default",  TokenType::KW_DEFAULT},
-			{"break",    TokenType::KW_BREAK},
-			{"continue", TokenType::KW_CONTINUE},
-			{"return",   TokenType::KW_RETURN},
-			{"int",      TokenType::KW_INT},
-			{"double",   TokenType::KW_DOUBLE},
-			{"char",     TokenType::KW_CHAR},
-			{"void",     TokenType::KW_VOID},
-			{"struct",   TokenType::KW_STRUCT},
-			{"typedef",  TokenType::KW_TYPEDEF},
-			{"cast",     TokenType::KW_CAST}
-	};
+	namespace {
+
+		/**
+		 * @brief Map an identifier spelling to its keyword token type
+		 *
+		 * Dispatches on length and first character, so an identifier is rejected after at most
+		 * one comparison against a keyword of the same length, without hashing or allocating.
+		 *
+		 * @return The keyword type, or TokenType::IDENTIFIER if the text is not a keyword
+		 */
+		constexpr TokenType lookupKeyword(std::string_view text) {
+			auto is = [text](std::string_view keyword, TokenType type) {
+				return text == keyword ? type : TokenType::IDENTIFIER;
+			};
+
+			switch (text.size()) {
+				case 2:
+					switch (text[0]) {
+						case 'i': return is("if", TokenType::KW_IF);
+						case 'd': return is("do", TokenType::KW_DO);
+						default: break;
+					}
+					break;
+				case 3:
+					switch (text[0]) {
+						case 'f': return is("for", TokenType::KW_FOR);
+						case 'i': return is("int", TokenType::KW_INT);
+						default: break;
+					}
+					break;
+				case 4:
+					switch (text[0]) {
+						case 'e': return is("else", TokenType::KW_ELSE);
+						case 'c':
+							// case, cast and char
+							if (text[1] == 'h') return is("char", TokenType::KW_CHAR);
+							return text[3] == 'e' ? is("case", TokenType::KW_CASE)
+												  : is("cast", TokenType::KW_CAST);
+						case 'v': return is("void", TokenType::KW_VOID);
+						default: break;
+					}
+					break;
+				case 5:
+					switch (text[0]) {
+						case 'w': return is("while", TokenType::KW_WHILE);
+						case 'b': return is("break", TokenType::KW_BREAK);
+						default: break;
+					}
+					break;
+				case 6:
+					switch (text[0]) {
+						case 's':
+							return text[1] == 'w' ? is("switch", TokenType::KW_SWITCH)
+												  : is("struct", TokenType::KW_STRUCT);
+						case 'r': return is("return", TokenType::KW_RETURN);
+						case 'd': return is("double", TokenType::KW_DOUBLE);
+						default: break;
+					}
+					break;
+				case 7:
+					switch (text[0]) {
+						case 'd': return is("default", TokenType::KW_DEFAULT);
+						case 't': return is("typedef", TokenType::KW_TYPEDEF);
+						default: break;
+					}
+					break;
+				case 8:
+					return is("continue", TokenType::KW_CONTINUE);
+				default:
+					break;
+			}
+			return TokenType::IDENTIFIER;
+		}
+
+		static_assert(lookupKeyword("if") == TokenType::KW_IF);
+		static_assert(lookupKeyword("cast") == TokenType::KW_CAST);
+		static_assert(lookupKeyword("cash") == TokenType::IDENTIFIER);
+		static_assert(lookupKeyword("continue") == TokenType::KW_CONTINUE);
+		static_assert(lookupKeyword("include") == TokenType::IDENTIFIER);
+
+		/**
+		 * @brief Check that the digits of an integer literal fit in an int
+		 *
+		 * Compares the spelling against INT_MAX, so the value is never computed.
+		 */
+		bool fitsInt(std::string_view digits) {
+			std::size_t first = digits.find_first_not_of('0');
+			if (first == std::string_view::npos) {
+				return true;
+			}
+			std::string_view significant = digits.substr(first);
+			constexpr std::string_view INT_MAX_DIGITS = "2147483647";
+			return significant.size() < INT_MAX_DIGITS.size() ||
+				   (significant.size() == INT_MAX_DIGITS.size() && significant <= INT_MAX_DIGITS);
+		}
+
+		/**
+		 * @brief Check that a double literal neither overflows nor underflows
+		 *
+		 * A mantissa of at most 200 characters with an exponent of at most two digits stays
+		 * well within 1e-300 and 1e300, so only longer literals are actually converted.
+		 */
+		bool fitsDouble(std::string_view text, std::size_t mantissaLength, std::size_t exponentDigits) {
+			if (mantissaLength <= 200 && exponentDigits <= 2) {
+				return true;
+			}
+			double value;
+			return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+		}
+
+	} // namespace
+
 
 	Lexer::Lexer(std::string source, std::string filename)
-			: source(std::move(source)), filename(std::move(filename)), position(0), line(1), column(1) {
+			: ownedSource(std::move(source)), source(ownedSource), filename(std::move(filename)),
+			  fileId(FileTable::global().intern(this->filename)), position(0), line(1), column(1), tokenStart(0), tokenLine(1), tokenColumn(1) {
 	}
 
-	TokenPtr Lexer::nextToken() {
+	Lexer::Lexer(const SourceBuffer &buffer)
+			: source(buffer.getText()), filename(buffer.getName()),
+			  fileId(FileTable::global().intern(filename)), position(0), line(1), column(1),
+			  tokenStart(0), tokenLine(1), tokenColumn(1) {
+	}
+
+	Lexer::Lexer(std::istream &input, std::string filename, std::size_t chunkSize)
+			: source(ownedSource), filename(std::move(filename)), fileId(FileTable::global().intern(this->filename)),
+			  position(0), line(1), column(1), tokenStart(0), tokenLine(1), tokenColumn(1), input(&input),
+			  chunkSize(std::max<std::size_t>(chunkSize, 1)), exhausted(false) {
+		refill();
+	}
+
+	void Lexer::seek(std::size_t offset, int line, int column) {
+		if (input != nullptr) {
+			throw std::logic_error("Cannot seek in a streamed input");
+		}
+		if (offset > source.size()) {
+			throw std::out_of_range("Lexer position past the end of the source");
+		}
+		position = static_cast<int>(offset);
+		this->line = line;
+		this->column = column;
+		buffered = 0;
+	}
+
+	TokenRef Lexer::scanToken() {
 		// Skip whitespace and comments
 		skipWhitespace();
 
+		tokenStart = position;
+		tokenLine = line;
+		tokenColumn = column;
+
 		// Check if we've reached the end of the source
 		if (isAtEnd()) {
-			return createToken(TokenType::END_OF_FILE, "");
+			return createToken(TokenType::END_OF_FILE);
 		}
 
 		// Get current character
@@ -64,21 +192,76 @@ namespace tinyc::lexer {
 		return lexOperatorOrPunctuation();
 	}
 
-	TokenPtr Lexer::peekNextToken() {
-		// Save current position
-		int savedPosition = position;
-		int savedLine = line;
-		int savedColumn = column;
+	TokenRef Lexer::scanStream() {
+		while (true) {
+			int startPosition = position;
+			int startLine = line;
+			int startColumn = column;
 
-		// Get the next token
-		auto peekedToken = nextToken();
+			// Scanning only ever reads the character at the position, so a token (or error)
+			// that stopped short of the end of the window does not depend on what follows
+			try {
+				TokenRef token = scanToken();
+				if (exhausted || !isAtEnd()) {
+					return token;
+				}
+			} catch (const LexerError &) {
+				if (exhausted || !isAtEnd()) {
+					throw;
+				}
+			}
 
-		// Restore position
-		position = savedPosition;
-		line = savedLine;
-		column = savedColumn;
+			// The token may go on in the next chunk, lex it again with more of the input
+			position = startPosition;
+			line = startLine;
+			column = startColumn;
+			refill();
+		}
+	}
 
-		return peekedToken;
+	void Lexer::refill() {
+		std::size_t keep = static_cast<std::size_t>(position);
+		for (std::size_t i = 0; i < buffered; ++i) {
+			keep = std::min<std::size_t>(keep, lookahead[(head + i) % MAX_LOOKAHEAD].offset);
+		}
+		ownedSource.erase(0, keep);
+		position -= static_cast<int>(keep);
+		for (std::size_t i = 0; i < buffered; ++i) {
+			lookahead[(head + i) % MAX_LOOKAHEAD].offset -= static_cast<std::uint32_t>(keep);
+		}
+
+		// Read at least as much as is kept: the window doubles while a long token is lexed
+		// again, so that stays linear in its length
+		std::size_t kept = ownedSource.size();
+		std::size_t wanted = std::max(chunkSize, kept);
+		ownedSource.resize(kept + wanted);
+		input->read(ownedSource.data() + kept, static_cast<std::streamsize>(wanted));
+		auto count = static_cast<std::size_t>(input->gcount());
+		ownedSource.resize(kept + count);
+		source = ownedSource;
+
+		// A read only stops short at the end of the stream (or on an error, which ends it too)
+		exhausted = count < wanted;
+	}
+
+	TokenRef Lexer::peek(std::size_t n) {
+		if (n >= MAX_LOOKAHEAD) {
+			throw std::out_of_range("Lexer lookahead is limited to " + std::to_string(MAX_LOOKAHEAD) + " tokens");
+		}
+		// Lex up to the requested token; at the end of the source scan() keeps returning END_OF_FILE
+		while (buffered <= n) {
+			lookahead[(head + buffered) % MAX_LOOKAHEAD] = scan();
+			++buffered;
+		}
+		return lookahead[(head + n) % MAX_LOOKAHEAD];
+	}
+
+	TokenPtr Lexer::nextToken() {
+		return materialize(next());
+	}
+
+	TokenPtr Lexer::peekNextToken() {
+		return materialize(peek());
 	}
 
 	std::vector<TokenPtr> Lexer::tokenize() {
@@ -98,7 +281,7 @@ namespace tinyc::lexer {
 	}
 
 	SourceLocation Lexer::getCurrentLocation() const {
-		return {filename, line, column};
+		return {fileId, line, column};
 	}
 
 	char Lexer::current() const {
@@ -121,46 +304,51 @@ namespace tinyc::lexer {
 		}
 	}
 
+	void Lexer::advanceBy(std::size_t count) {
+		const char *begin = source.data() + position;
+		std::size_t newlines = scan::countNewlines(begin, count);
+
+		if (newlines == 0) {
+			column += static_cast<int>(count);
+		} else {
+			// The column restarts after the last newline of the span
+			std::size_t last = count - 1;
+			while (begin[last] != '\n') {
+				--last;
+			}
+			line += static_cast<int>(newlines);
+			column = static_cast<int>(count - last);
+		}
+		position += static_cast<int>(count);
+	}
+
 	bool Lexer::isAtEnd() const {
 		return position >= static_cast<int>(source.length());
 	}
 
 	void Lexer::skipWhitespace() {
 		while (!isAtEnd()) {
-			char c = current();
+			const char *text = source.data() + position;
+			std::size_t remaining = source.length() - position;
+			char c = text[0];
 
-			if (std::isspace(c)) {
-				advance();
-			} else if (c == '/' && position + 1 < static_cast<int>(source.length())) {
+			if (std::isspace(static_cast<unsigned char>(c))) {
+				advanceBy(scan::whitespaceRun(text, remaining));
+			} else if (c == '/' && remaining > 1) {
 				// Check for C-style comments
-				if (source[position + 1] == '/') {
+				if (text[1] == '/') {
 					// Single-line comment, skip until end of line
-					advance(); // Skip '/'
-					advance(); // Skip '/'
-
-					while (!isAtEnd() && current() != '\n') {
-						advance();
-					}
-				} else if (source[position + 1] == '*') {
+					const void *newline = std::memchr(text + 2, '\n', remaining - 2);
+					advanceBy(newline ? static_cast<const char *>(newline) - text : remaining);
+				} else if (text[1] == '*') {
 					// Multi-line comment, skip until closing */
-					advance(); // Skip '/'
-					advance(); // Skip '*'
-
-					bool commentClosed = false;
-					while (!isAtEnd() && !commentClosed) {
-						if (current() == '*' && position + 1 < static_cast<int>(source.length()) &&
-							source[position + 1] == '/') {
-							advance(); // Skip '*'
-							advance(); // Skip '/'
-							commentClosed = true;
-						} else {
-							advance();
-						}
-					}
+					std::size_t close = scan::findCommentClose(text + 2, remaining - 2);
 
-					if (!commentClosed) {
+					if (close == remaining - 2) {
+						advanceBy(remaining);
 						throw LexerError("Unclosed multi-line comment", getCurrentLocation());
 					}
+					advanceBy(close + 4); // Skip "/*", the body and "*/"
 				} else {
 					// Not a comment, just a division operator
 					break;
@@ -171,58 +359,44 @@ namespace tinyc::lexer {
 		}
 	}
 
-	TokenPtr Lexer::lexIdentifierOrKeyword() {
-		SourceLocation start = getCurrentLocation();
-		std::string lexeme;
-
-		while (!isAtEnd() && (std::isalnum(current()) || current() == '_')) {
-			lexeme += current();
-			advance();
-		}
+	TokenRef Lexer::lexIdentifierOrKeyword() {
+		// Identifiers never span lines, so only the column moves
+		auto length = scan::identifierRun(source.data() + position, source.length() - position);
+		position += static_cast<int>(length);
+		column += static_cast<int>(length);
 
-		// Check if it's a keyword
-		auto it = keywords.find(lexeme);
-		if (it != keywords.end()) {
-			return std::make_shared<Token>(it->second, lexeme, start);
-		}
-
-		// It's an identifier
-		return std::make_shared<Token>(TokenType::IDENTIFIER, lexeme, start);
+		// Keywords are recognised directly on the source span; anything else is an identifier
+		return createToken(lookupKeyword(source.substr(tokenStart, position - tokenStart)));
 	}
 
-	TokenPtr Lexer::lexNumber() {
-		SourceLocation start = getCurrentLocation();
-		std::string lexeme;
+	TokenRef Lexer::lexNumber() {
 		bool isDouble = false;
 
 		// Process integer part
 		while (!isAtEnd() && std::isdigit(current())) {
-			lexeme += current();
 			advance();
 		}
 
 		// Check for decimal point
 		if (!isAtEnd() && current() == '.') {
 			isDouble = true;
-			lexeme += current();
 			advance();
 
 			// Process fractional part
 			while (!isAtEnd() && std::isdigit(current())) {
-				lexeme += current();
 				advance();
 			}
 		}
 
 		// Check for scientific notation
+		std::size_t mantissaLength = position - tokenStart;
+		std::size_t exponentDigits = 0;
 		if (!isAtEnd() && (current() == 'e' || current() == 'E')) {
 			isDouble = true;
-			lexeme += current();
 			advance();
 
 			// Optional sign
 			if (!isAtEnd() && (current() == '+' || current() == '-')) {
-				lexeme += current();
 				advance();
 			}
 
@@ -233,49 +407,41 @@ namespace tinyc::lexer {
 
 			// Process exponent
 			while (!isAtEnd() && std::isdigit(current())) {
-				lexeme += current();
 				advance();
+				++exponentDigits;
 			}
 		}
 
-		// Create token with the appropriate type and value
+		// The token only records its span, the value is decoded when asked for; literals out
+		// of range are still rejected here
+		std::string_view lexeme = source.substr(tokenStart, position - tokenStart);
 		if (isDouble) {
-			try {
-				double value = std::stod(lexeme);
-				return std::make_shared<Token>(TokenType::DOUBLE_LITERAL, value, lexeme, start);
-			}
-			catch (const std::exception &e) {
-				throw LexerError("Invalid double literal: " + lexeme, start);
-			}
-		} else {
-			try {
-				int value = std::stoi(lexeme);
-				return std::make_shared<Token>(TokenType::INTEGER_LITERAL, value, lexeme, start);
-			}
-			catch (const std::exception &e) {
-				throw LexerError("Invalid integer literal: " + lexeme, start);
+			if (!fitsDouble(lexeme, mantissaLength, exponentDigits)) {
+				throw LexerError("Invalid double literal: " + std::string(lexeme), tokenLocation());
 			}
+			return createToken(TokenType::DOUBLE_LITERAL);
+		}
+		if (!fitsInt(lexeme)) {
+			throw LexerError("Invalid integer literal: " + std::string(lexeme), tokenLocation());
 		}
+		return createToken(TokenType::INTEGER_LITERAL);
 	}
 
-	TokenPtr Lexer::lexCharLiteral() {
-		SourceLocation start = getCurrentLocation();
+	TokenRef Lexer::lexCharLiteral() {
 		advance(); // Skip opening quote
 
 		if (isAtEnd()) {
-			throw LexerError("Unterminated character literal", start);
+			throw LexerError("Unterminated character literal", tokenLocation());
 		}
 
 		char value;
-		std::string lexeme = "'";
 
 		if (current() == '\\') {
 			// Handle escape sequence
-			lexeme += current();
 			advance();
 
 			if (isAtEnd()) {
-				throw LexerError("Unterminated character literal", start);
+				throw LexerError("Unterminated character literal", tokenLocation());
 			}
 
 			switch (current()) {
@@ -304,197 +470,237 @@ namespace tinyc::lexer {
 					throw LexerError(std::string("Invalid escape sequence: \\") + current(), getCurrentLocation());
 			}
 
-			lexeme += current();
 			advance();
 		} else {
 			value = current();
-			lexeme += current();
 			advance();
 		}
 
 		if (isAtEnd() || current() != '\'') {
-			throw LexerError("Unterminated character literal", start);
+			throw LexerError("Unterminated character literal", tokenLocation());
 		}
 
-		lexeme += current(); // Add closing quote
-		advance();           // Skip closing quote
+		advance(); // Skip closing quote
 
-		return std::make_shared<Token>(TokenType::CHAR_LITERAL, value, lexeme, start);
+		TokenRef token = createToken(TokenType::CHAR_LITERAL);
+		token.charValue = value;
+		return token;
 	}
 
-	TokenPtr Lexer::lexStringLiteral() {
-		SourceLocation start = getCurrentLocation();
+	TokenRef Lexer::lexStringLiteral() {
 		advance(); // Skip opening quote
 
-		std::string lexeme = "\"";
-		std::string value;
-
 		while (!isAtEnd() && current() != '"') {
 			if (current() == '\\') {
 				// Handle escape sequence
-				lexeme += current();
 				advance();
 
 				if (isAtEnd()) {
-					throw LexerError("Unterminated string literal", start);
+					throw LexerError("Unterminated string literal", tokenLocation());
 				}
 
-				char escapedChar;
 				switch (current()) {
 					case 'n':
-						escapedChar = '\n';
-						break;
 					case 't':
-						escapedChar = '\t';
-						break;
 					case 'r':
-						escapedChar = '\r';
-						break;
 					case '0':
-						escapedChar = '\0';
-						break;
 					case '\\':
-						escapedChar = '\\';
-						break;
 					case '\'':
-						escapedChar = '\'';
-						break;
 					case '"':
-						escapedChar = '"';
 						break;
 					default:
 						throw LexerError(std::string("Invalid escape sequence: \\") + current(), getCurrentLocation());
 				}
-
-				value += escapedChar;
-				lexeme += current();
-				advance();
-			} else {
-				value += current();
-				lexeme += current();
-				advance();
 			}
+			advance();
 		}
 
 		if (isAtEnd()) {
-			throw LexerError("Unterminated string literal", start);
+			throw LexerError("Unterminated string literal", tokenLocation());
 		}
 
-		lexeme += current(); // Add closing quote
-		advance();           // Skip closing quote
+		advance(); // Skip closing quote
 
-		return std::make_shared<Token>(TokenType::STRING_LITERAL, lexeme, start);
+		return createToken(TokenType::STRING_LITERAL);
 	}
 
-	TokenPtr Lexer::lexOperatorOrPunctuation() {
-		SourceLocation start = getCurrentLocation();
+	TokenRef Lexer::lexOperatorOrPunctuation() {
 		char c = current();
 		advance();
 
 		switch (c) {
 			// Single-character operators and punctuation
 			case '(':
-				return createToken(TokenType::LPAREN, "(");
+				return createToken(TokenType::LPAREN);
 			case ')':
-				return createToken(TokenType::RPAREN, ")");
+				return createToken(TokenType::RPAREN);
 			case '{':
-				return createToken(TokenType::LBRACE, "{");
+				return createToken(TokenType::LBRACE);
 			case '}':
-				return createToken(TokenType::RBRACE, "}");
+				return createToken(TokenType::RBRACE);
 			case '[':
-				return createToken(TokenType::LBRACKET, "[");
+				return createToken(TokenType::LBRACKET);
 			case ']':
-				return createToken(TokenType::RBRACKET, "]");
+				return createToken(TokenType::RBRACKET);
 			case ';':
-				return createToken(TokenType::SEMICOLON, ";");
+				return createToken(TokenType::SEMICOLON);
 			case ':':
-				return createToken(TokenType::COLON, ":");
+				return createToken(TokenType::COLON);
 			case ',':
-				return createToken(TokenType::COMMA, ",");
+				return createToken(TokenType::COMMA);
 			case '.':
-				return createToken(TokenType::OP_DOT, ".");
+				return createToken(TokenType::OP_DOT);
 			case '+':
 				if (!isAtEnd() && current() == '+') {
 					advance();
-					return createToken(TokenType::OP_INCREMENT, "++");
+					return createToken(TokenType::OP_INCREMENT);
 				}
-				return createToken(TokenType::OP_PLUS, "+");
+				return createToken(TokenType::OP_PLUS);
 			case '-':
 				if (!isAtEnd()) {
 					if (current() == '-') {
 						advance();
-						return createToken(TokenType::OP_DECREMENT, "--");
+						return createToken(TokenType::OP_DECREMENT);
 					} else if (current() == '>') {
 						advance();
-						return createToken(TokenType::OP_ARROW, "->");
+						return createToken(TokenType::OP_ARROW);
 					}
 				}
-				return createToken(TokenType::OP_MINUS, "-");
+				return createToken(TokenType::OP_MINUS);
 			case '*':
-				return createToken(TokenType::OP_MULTIPLY, "*");
+				return createToken(TokenType::OP_MULTIPLY);
 			case '/':
-				return createToken(TokenType::OP_DIVIDE, "/");
+				return createToken(TokenType::OP_DIVIDE);
 			case '%':
-				return createToken(TokenType::OP_MODULO, "%");
+				return createToken(TokenType::OP_MODULO);
 			case '=':
 				if (!isAtEnd() && current() == '=') {
 					advance();
-					return createToken(TokenType::OP_EQUAL, "==");
+					return createToken(TokenType::OP_EQUAL);
 				}
-				return createToken(TokenType::OP_ASSIGN, "=");
+				return createToken(TokenType::OP_ASSIGN);
 			case '!':
 				if (!isAtEnd() && current() == '=') {
 					advance();
-					return createToken(TokenType::OP_NOT_EQUAL, "!=");
+					return createToken(TokenType::OP_NOT_EQUAL);
 				}
-				return createToken(TokenType::OP_NOT, "!");
+				return createToken(TokenType::OP_NOT);
 			case '<':
 				if (!isAtEnd()) {
 					if (current() == '=') {
 						advance();
-						return createToken(TokenType::OP_LESS_EQUAL, "<=");
+						return createToken(TokenType::OP_LESS_EQUAL);
 					} else if (current() == '<') {
 						advance();
-						return createToken(TokenType::OP_LEFT_SHIFT, "<<");
+						return createToken(TokenType::OP_LEFT_SHIFT);
 					}
 				}
-				return createToken(TokenType::OP_LESS, "<");
+				return createToken(TokenType::OP_LESS);
 			case '>':
 				if (!isAtEnd()) {
 					if (current() == '=') {
 						advance();
-						return createToken(TokenType::OP_GREATER_EQUAL, ">=");
+						return createToken(TokenType::OP_GREATER_EQUAL);
 					} else if (current() == '>') {
 						advance();
-						return createToken(TokenType::OP_RIGHT_SHIFT, ">>");
+						return createToken(TokenType::OP_RIGHT_SHIFT);
 					}
 				}
-				return createToken(TokenType::OP_GREATER, ">");
+				return createToken(TokenType::OP_GREATER);
 			case '&':
 				if (!isAtEnd() && current() == '&') {
 					advance();
-					return createToken(TokenType::OP_LOGICAL_AND, "&&");
+					return createToken(TokenType::OP_LOGICAL_AND);
 				}
-				return createToken(TokenType::OP_AND, "&");
+				return createToken(TokenType::OP_AND);
 			case '|':
 				if (!isAtEnd() && current() == '|') {
 					advance();
-					return createToken(TokenType::OP_LOGICAL_OR, "||");
+					return createToken(TokenType::OP_LOGICAL_OR);
 				}
-				return createToken(TokenType::OP_OR, "|");
+				return createToken(TokenType::OP_OR);
 			case '~':
-				return createToken(TokenType::OP_BITWISE_NOT, "~");
+				return createToken(TokenType::OP_BITWISE_NOT);
 			default:
 				// Unknown character
 				std::stringstream ss;
 				ss << "Unexpected character: '" << c << "' (ASCII: " << static_cast<int>(c) << ")";
-				throw LexerError(ss.str(), start);
+				throw LexerError(ss.str(), tokenLocation());
 		}
 	}
 
-	TokenPtr Lexer::createToken(TokenType type, const std::string &lexeme) const {
-		SourceLocation location = {filename, line, column - static_cast<int>(lexeme.length())};
-		return std::make_shared<Token>(type, lexeme, location);
+	TokenRef Lexer::createToken(TokenType type) const {
+		TokenRef token{};
+		token.type = type;
+		token.offset = static_cast<std::uint32_t>(tokenStart);
+		token.length = static_cast<std::uint32_t>(position - tokenStart);
+		token.line = tokenLine;
+		token.column = tokenColumn;
+		return token;
+	}
+
+	int Lexer::intValue(const TokenRef &token) const {
+		std::string_view digits = text(token);
+		int value = 0;
+		std::from_chars(digits.data(), digits.data() + digits.size(), value);
+		return value;
+	}
+
+	double Lexer::doubleValue(const TokenRef &token) const {
+		std::string_view literal = text(token);
+		double value = 0;
+		std::from_chars(literal.data(), literal.data() + literal.size(), value);
+		return value;
+	}
+
+	void Lexer::describe(const TokenRef &token, std::string &out) const {
+		out += Token::typeToString(token.type);
+		out += " '";
+		out += text(token);
+		out += "' at ";
+		out += filename;
+		out += ':';
+		out += std::to_string(token.line);
+		out += ':';
+		out += std::to_string(token.column);
+
+		switch (token.type) {
+			case TokenType::INTEGER_LITERAL:
+				out += " (value: " + std::to_string(intValue(token)) + ")";
+				break;
+			case TokenType::DOUBLE_LITERAL: {
+				// %g is the default formatting of a double on a stream
+				char value[32];
+				int length = std::snprintf(value, sizeof(value), " (value: %g)", doubleValue(token));
+				out.append(value, length);
+				break;
+			}
+			case TokenType::CHAR_LITERAL:
+				out += " (value: '";
+				out += token.charValue;
+				out += "')";
+				break;
+			default:
+				break;
+		}
+	}
+
+	SourceLocation Lexer::tokenLocation() const {
+		return {fileId, tokenLine, tokenColumn};
+	}
+
+	TokenPtr Lexer::materialize(const TokenRef &token) const {
+		std::string lexeme(text(token));
+		switch (token.type) {
+			case TokenType::INTEGER_LITERAL:
+				return std::make_shared<Token>(token.type, intValue(token), std::move(lexeme), location(token));
+			case TokenType::DOUBLE_LITERAL:
+				return std::make_shared<Token>(token.type, doubleValue(token), std::move(lexeme), location(token));
+			case TokenType::CHAR_LITERAL:
+				return std::make_shared<Token>(token.type, token.charValue, std::move(lexeme), location(token));
+			default:
+				return std::make_shared<Token>(token.type, std::move(lexeme), location(token));
+		}
 	}
 
 } // namespace tinyc::lexer
\ No newline at end of file
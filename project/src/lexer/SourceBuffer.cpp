@@ -0,0 +1,154 @@
+#include "tinyc/lexer/SourceBuffer.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tinyc::lexer {
+
+#ifndef _WIN32
+	namespace {
+
+		// Closes the descriptor when leaving the scope, the mapping stays valid after close
+		struct FileDescriptor {
+			int fd;
+
+			~FileDescriptor() {
+				if (fd >= 0) {
+					::close(fd);
+				}
+			}
+		};
+
+	} // anonymous namespace
+#endif
+
+	SourceBuffer SourceBuffer::fromFile(const std::string &filename) {
+		SourceBuffer buffer;
+		buffer.name = filename;
+
+#ifdef _WIN32
+		std::ifstream file(filename, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		std::stringstream contents;
+		contents << file.rdbuf();
+		buffer.storage = contents.str();
+#else
+		FileDescriptor file{::open(filename.c_str(), O_RDONLY)};
+		if (file.fd < 0) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		struct stat info{};
+		if (::fstat(file.fd, &info) != 0) {
+			throw std::runtime_error("Could not read file: " + filename);
+		}
+
+		// Regular, non-empty files are mapped and scanned in place
+		if (S_ISREG(info.st_mode) && info.st_size > 0) {
+			auto length = static_cast<std::size_t>(info.st_size);
+			void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.fd, 0);
+			if (address != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+				::madvise(address, length, MADV_SEQUENTIAL);
+#endif
+				buffer.data = static_cast<const char *>(address);
+				buffer.size = length;
+				buffer.mapped = true;
+				return buffer;
+			}
+		}
+
+		// Pipes, character devices and files that could not be mapped are read into memory
+		char chunk[65536];
+		for (;;) {
+			ssize_t count = ::read(file.fd, chunk, sizeof(chunk));
+			if (count < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::runtime_error("Could not read file: " + filename);
+			}
+			if (count == 0) {
+				break;
+			}
+			buffer.storage.append(chunk, static_cast<std::size_t>(count));
+		}
+#endif
+
+		buffer.data = buffer.storage.data();
+		buffer.size = buffer.storage.size();
+		return buffer;
+	}
+
+	SourceBuffer SourceBuffer::fromString(std::string source, std::string name) {
+		SourceBuffer buffer;
+		buffer.name = std::move(name);
+		buffer.storage = std::move(source);
+		buffer.data = buffer.storage.data();
+		buffer.size = buffer.storage.size();
+		return buffer;
+	}
+
+	SourceBuffer SourceBuffer::view(std::string_view text, std::string name) {
+		SourceBuffer buffer;
+		buffer.name = std::move(name);
+		buffer.data = text.data();
+		buffer.size = text.size();
+		buffer.borrowed = true;
+		return buffer;
+	}
+
+	SourceBuffer::SourceBuffer(SourceBuffer &&other) noexcept {
+		*this = std::move(other);
+	}
+
+	SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept {
+		if (this != &other) {
+			release();
+
+			name = std::move(other.name);
+			storage = std::move(other.storage);
+			mapped = other.mapped;
+			borrowed = other.borrowed;
+			size = other.size;
+			// Owned text may live in the small-string buffer, so re-point at our own copy
+			data = mapped || borrowed ? other.data : storage.data();
+
+			other.data = nullptr;
+			other.size = 0;
+			other.mapped = false;
+			other.borrowed = false;
+		}
+		return *this;
+	}
+
+	SourceBuffer::~SourceBuffer() {
+		release();
+	}
+
+	void SourceBuffer::release() noexcept {
+#ifndef _WIN32
+		if (mapped) {
+			::munmap(const_cast<char *>(data), size);
+		}
+#endif
+		data = nullptr;
+		size = 0;
+		mapped = false;
+		borrowed = false;
+	}
+
+} // namespace tinyc::lexer
@@ -1,28 +1,20 @@
 #include "tinyc/lexer/Lexer.h"
+#include "tinyc/lexer/SourceBuffer.h"
 #include "tinyc/parser/Parser.h"
-#include "tinyc/ast/visitors/DumpVisitor.h"
-#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/driver/Driver.h"
+#include "tinyc/driver/OutputCache.h"
+#include "tinyc/driver/Server.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <stdexcept>
 
 using namespace tinyc::lexer;
 using namespace tinyc::parser;
-using namespace tinyc::ast;
-
-std::string readFile(const std::string &filename) {
-	std::ifstream file(filename);
-	if (!file) {
-		throw std::runtime_error("Could not open file: " + filename);
-	}
-
-	std::stringstream buffer;
-	buffer << file.rdbuf();
-	return buffer.str();
-}
+using namespace tinyc::driver;
 
 void printTokens(const std::vector<TokenPtr> &tokens) {
 	for (const auto &token: tokens) {
@@ -30,29 +22,14 @@ void printTokens(const std::vector<TokenPtr> &tokens) {
 	}
 }
 
-void runLexerMode(const std::string &source, const std::string &filename) {
-	// Create lexer and tokenize
-	Lexer lexer(source, filename);
-	auto tokens = lexer.tokenize();
-
-	// Print tokens
-	std::cout << "Tokens from " << filename << ":" << std::endl;
-	printTokens(tokens);
-}
-
-void runParserMode(const std::string &source, const std::string &filename, bool prettyPrint) {
-	// Create lexer
-	Lexer lexer(source, filename);
-
-	// Create parser and parse
-	Parser parser(lexer);
-	auto ast = parser.parseProgram();
-
-	// Create JSON visitor with pretty print option
-	JSONVisitor jsonVisitor(prettyPrint);
-	ast->accept(jsonVisitor);
-	std::string json = jsonVisitor.getJSON();
-	std::cout << json << std::endl;
+int runSingleFile(const std::string &filename, const CompileOptions &options) {
+	// The output is streamed to stdout as it is produced
+	tinyc::ast::FileSink out(stdout);
+	CompileResult result = filename == "-" ? compileStream(std::cin, "<stdin>", options, out)
+										   : compileFile(filename, options, out);
+	std::fflush(stdout);
+	std::cerr << result.diagnostics << result.stats.format(options.stats);
+	return result.exitCode;
 }
 
 void runInteractiveMode() {
@@ -118,27 +95,48 @@ void runInteractiveMode() {
 
 	// In parser mode, we process the entire input at once
 	if (parserMode && !source.empty()) {
-		try {
-			runParserMode(source, "<interactive>", prettyPrint);
-		}
-		catch (const LexerError &e) {
-			std::cerr << "Lexer error: " << e.what() << std::endl;
-		}
-		catch (const ParserError &e) {
-			std::cerr << "Parser error: " << e.what() << std::endl;
-		}
+		CompileOptions options;
+		options.prettyPrint = prettyPrint;
+		CompileResult result = compileSource(SourceBuffer::fromString(source, "<interactive>"), options);
+		std::cout << result.output;
+		std::cerr << result.diagnostics;
 	}
 
 	std::cout << "Exiting interactive mode." << std::endl;
 }
 
 void printUsage(const char* programName) {
-	std::cerr << "Usage: " << programName << " [--lex|-l|--parse|-p] [--pretty|-pp] <source_file>" << std::endl;
+	std::cerr << "Usage: " << programName << " [--lex|-l|--parse|-p] [--pretty|-pp] [--emit=json|bin] [--recover] <source_file>" << std::endl;
+	std::cerr << "       " << programName << " [options] [--jobs N] [--output-dir DIR] <source_file|@response_file>..." << std::endl;
+	std::cerr << "       " << programName << " [options] --server[=SOCKET]" << std::endl;
+	std::cerr << "       Use - as the source file to read the standard input (lexed as it arrives with --lex)." << std::endl;
 	std::cerr << "       Run without arguments for interactive mode." << std::endl;
 	std::cerr << "Options:" << std::endl;
 	std::cerr << "  --lex, -l       Run in lexer mode (output tokens)" << std::endl;
 	std::cerr << "  --parse, -p     Run in parser mode (output AST as JSON)" << std::endl;
 	std::cerr << "  --pretty, -pp   Pretty print JSON output (only with parser mode)" << std::endl;
+	std::cerr << "  --emit=FORMAT   AST output format: json (default) or bin (binary AST)" << std::endl;
+	std::cerr << "  --recover       Report every syntax error and output the AST with Error nodes" << std::endl;
+	std::cerr << "  --max-errors N  Stop a recovering parse after N errors (default: 20, 0 for no limit)" << std::endl;
+	std::cerr << "  --parse-jobs N  Parse each input on N threads (default: 1, 0 for one per hardware thread)" << std::endl;
+	std::cerr << "  --serialize-jobs N" << std::endl;
+	std::cerr << "                  Write the JSON of each input on N threads (default: 1, 0 for one per hardware thread)" << std::endl;
+	std::cerr << "  --stats[=text|json]" << std::endl;
+	std::cerr << "                  Report phase times, token and node counts, AST memory and output size" << std::endl;
+	std::cerr << "                  of each input on the standard error" << std::endl;
+	std::cerr << "  --cache-dir DIR Reuse the outputs of unchanged inputs stored in DIR" << std::endl;
+	std::cerr << "  --cache-size SIZE" << std::endl;
+	std::cerr << "                  Size bound of the cache, with an optional K, M or G suffix (default: 256M)" << std::endl;
+	std::cerr << "Batch mode (several files, a response file or any of these options):" << std::endl;
+	std::cerr << "  --jobs, -j N    Number of worker threads (default: one per hardware thread)" << std::endl;
+	std::cerr << "  --output-dir, -o DIR" << std::endl;
+	std::cerr << "                  Write each result to DIR/<name>.json (.tcast for binary ASTs," << std::endl;
+	std::cerr << "                  .tokens in lexer mode) instead of to the standard output," << std::endl;
+	std::cerr << "                  under the directory of relative inputs" << std::endl;
+	std::cerr << "  @file           Read further arguments from file" << std::endl;
+	std::cerr << "Server mode (answers length-prefixed requests, see include/tinyc/driver/Server.h):" << std::endl;
+	std::cerr << "  --server        Read requests from the standard input, answer on the standard output" << std::endl;
+	std::cerr << "  --server=SOCKET Listen on a Unix domain socket instead" << std::endl;
 }
 
 int main(int argc, char *argv[]) {
@@ -150,12 +148,33 @@ int main(int argc, char *argv[]) {
 		} else {
 			// Parse command line arguments
 			std::string mode;
-			std::string filename;
+			std::vector<std::string> filenames;
 			bool prettyPrint = false;
+			OutputFormat format = OutputFormat::JSON;
+			bool recover = false;
+			std::size_t maxErrors = CompileOptions().maxErrors;
+			bool maxErrorsSet = false;
+			std::size_t parseJobs = CompileOptions().parseJobs;
+			std::size_t serializeJobs = CompileOptions().serializeJobs;
+			StatsFormat stats = StatsFormat::NONE;
+			std::string cacheDir;
+			std::uintmax_t cacheSize = OutputCache::DEFAULT_MAX_BYTES;
+			bool cacheSizeSet = false;
+			bool batchMode = false;
+			bool serverMode = false;
+			std::string socketPath;
+			BatchOptions batch;
+
+			std::vector<std::string> args = expandResponseFiles(std::vector<std::string>(argv + 1, argv + argc));
+			for (int i = 1; i < argc; i++) {
+				if (argv[i][0] == '@') {
+					batchMode = true;
+				}
+			}
 
 			// Process all arguments
-			for (int i = 1; i < argc; i++) {
-				std::string arg = argv[i];
+			for (std::size_t i = 0; i < args.size(); i++) {
+				const std::string &arg = args[i];
 
 				if (arg == "--lex" || arg == "-l") {
 					if (!mode.empty()) {
@@ -173,59 +192,181 @@ int main(int argc, char *argv[]) {
 					mode = "--parse";
 				} else if (arg == "--pretty" || arg == "-pp") {
 					prettyPrint = true;
+				} else if (arg.rfind("--emit=", 0) == 0) {
+					std::string name = arg.substr(7);
+					if (name == "json") {
+						format = OutputFormat::JSON;
+					} else if (name == "bin") {
+						format = OutputFormat::BINARY;
+					} else {
+						std::cerr << "Error: Unknown output format: " << name << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+				} else if (arg == "--recover") {
+					recover = true;
+				} else if (arg == "--max-errors") {
+					if (i + 1 == args.size() || !parseCount(args[i + 1], maxErrors)) {
+						std::cerr << "Error: " << arg << " expects a number of errors" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					++i;
+					maxErrorsSet = true;
+				} else if (arg == "--parse-jobs") {
+					if (i + 1 == args.size() || !parseCount(args[i + 1], parseJobs)) {
+						std::cerr << "Error: " << arg << " expects a number of threads" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					++i;
+				} else if (arg == "--serialize-jobs") {
+					if (i + 1 == args.size() || !parseCount(args[i + 1], serializeJobs)) {
+						std::cerr << "Error: " << arg << " expects a number of threads" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					++i;
+				} else if (arg == "--stats" || arg == "--stats=text") {
+					stats = StatsFormat::TEXT;
+				} else if (arg == "--stats=json") {
+					stats = StatsFormat::JSON;
+				} else if (arg == "--cache-dir") {
+					if (i + 1 == args.size() || args[i + 1].empty()) {
+						std::cerr << "Error: " << arg << " expects a directory" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					cacheDir = args[++i];
+				} else if (arg == "--cache-size") {
+					if (i + 1 == args.size() || !parseSize(args[i + 1], cacheSize)) {
+						std::cerr << "Error: " << arg << " expects a size" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					++i;
+					cacheSizeSet = true;
+				} else if (arg == "--jobs" || arg == "-j") {
+					if (i + 1 == args.size() || !parseCount(args[i + 1], batch.jobs)) {
+						std::cerr << "Error: " << arg << " expects a number of threads" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					++i;
+					batchMode = true;
+				} else if (arg == "--output-dir" || arg == "-o") {
+					if (i + 1 == args.size()) {
+						std::cerr << "Error: " << arg << " expects a directory" << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					batch.outputDir = args[++i];
+					batchMode = true;
+				} else if (arg == "--server") {
+					serverMode = true;
+				} else if (arg.rfind("--server=", 0) == 0) {
+					socketPath = arg.substr(9);
+					if (socketPath.empty()) {
+						std::cerr << "Error: Invalid socket path: " << arg << std::endl;
+						printUsage(argv[0]);
+						return 1;
+					}
+					serverMode = true;
+				} else if (arg == "-") {
+					filenames.push_back(arg);
 				} else if (arg[0] == '-') {
 					std::cerr << "Unknown option: " << arg << std::endl;
 					printUsage(argv[0]);
 					return 1;
 				} else {
-					// Must be the filename
-					if (!filename.empty()) {
-						std::cerr << "Error: Multiple filenames specified" << std::endl;
-						printUsage(argv[0]);
-						return 1;
-					}
-					filename = arg;
+					filenames.push_back(arg);
 				}
 			}
 
+			if (serverMode && (!filenames.empty() || batchMode)) {
+				std::cerr << "Error: Server mode takes no source files or batch options" << std::endl;
+				printUsage(argv[0]);
+				return 1;
+			}
+
 			// Check if we have a filename
-			if (filename.empty()) {
+			if (filenames.empty() && !serverMode) {
 				std::cerr << "Error: No source file specified" << std::endl;
 				printUsage(argv[0]);
 				return 1;
 			}
 
+			bool readsStdin = std::find(filenames.begin(), filenames.end(), "-") != filenames.end();
+			if (readsStdin && (batchMode || filenames.size() > 1)) {
+				std::cerr << "Error: The standard input can only be compiled on its own" << std::endl;
+				printUsage(argv[0]);
+				return 1;
+			}
+
 			// Default to parser mode if not specified
 			if (mode.empty()) {
 				mode = "--parse";
 			}
 
-			// Read the source file
-			std::string source = readFile(filename);
+			CompileOptions options;
+			options.lexOnly = mode == "--lex";
+			options.prettyPrint = prettyPrint;
+			options.format = format;
+			options.recover = recover;
+			options.maxErrors = maxErrors;
+			options.parseJobs = parseJobs;
+			options.serializeJobs = serializeJobs;
+			options.stats = serverMode ? StatsFormat::NONE : stats;
+			if (options.lexOnly && prettyPrint) {
+				std::cerr << "Warning: Pretty print option is ignored in lexer mode" << std::endl;
+			}
+			if (options.lexOnly && format == OutputFormat::BINARY) {
+				std::cerr << "Warning: Output format option is ignored in lexer mode" << std::endl;
+			} else if (prettyPrint && format == OutputFormat::BINARY) {
+				std::cerr << "Warning: Pretty print option is ignored for binary output" << std::endl;
+			}
+			if (options.lexOnly && recover) {
+				std::cerr << "Warning: Recover option is ignored in lexer mode" << std::endl;
+			} else if (maxErrorsSet && !recover && !serverMode) {
+				std::cerr << "Warning: Max errors option is ignored without --recover" << std::endl;
+			}
+			if (options.lexOnly && parseJobs != 1) {
+				std::cerr << "Warning: Parse jobs option is ignored in lexer mode" << std::endl;
+			}
+			if ((options.lexOnly || format == OutputFormat::BINARY) && serializeJobs != 1) {
+				std::cerr << "Warning: Serialize jobs option is ignored without JSON output" << std::endl;
+			}
+			if (cacheSizeSet && cacheDir.empty()) {
+				std::cerr << "Warning: Cache size option is ignored without --cache-dir" << std::endl;
+			}
+			if (!cacheDir.empty()) {
+				options.cache = std::make_shared<OutputCache>(cacheDir, cacheSize);
+			}
+			if (serverMode && stats != StatsFormat::NONE) {
+				std::cerr << "Warning: Stats option is ignored in server mode" << std::endl;
+			}
 
-			// Run in the selected mode
-			if (mode == "--lex") {
-				if (prettyPrint) {
-					std::cerr << "Warning: Pretty print option is ignored in lexer mode" << std::endl;
+			// Requests choose lexer or parser mode themselves, the other options are their defaults
+			if (serverMode) {
+				Server server(options);
+				if (socketPath.empty()) {
+					server.serve(std::cin, std::cout);
+				} else {
+					server.serveSocket(socketPath);
 				}
-				runLexerMode(source, filename);
-			} else if (mode == "--parse") {
-				runParserMode(source, filename, prettyPrint);
+				return 0;
 			}
 
-			return 0;
+			// Several inputs (or batch options) go through the thread pool
+			if (batchMode || filenames.size() > 1) {
+				return compileBatch(filenames, options, batch, std::cout, std::cerr);
+			}
+
+			return runSingleFile(filenames.front(), options);
 		}
 	}
-	catch (const LexerError &e) {
-		std::cerr << "Lexer error: " << e.what() << std::endl;
-		return 1;
-	}
-	catch (const ParserError &e) {
-		std::cerr << "Parser error: " << e.what() << std::endl;
-		return 2;
-	}
 	catch (const std::exception &e) {
 		std::cerr << "Error: " << e.what() << std::endl;
 		return 3;
 	}
-}
\ No newline at end of file
+}
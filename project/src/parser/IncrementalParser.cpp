@@ -0,0 +1,336 @@
+#include "tinyc/parser/IncrementalParser.h"
+#include "tinyc/ast/NodeVisitor.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace tinyc::parser {
+
+	namespace {
+
+		// Minimum garbage before the arena is rebuilt, so small sources are not reparsed on every edit
+		constexpr std::size_t MIN_GARBAGE = 64 * 1024;
+
+		/**
+		 * @brief Visitor moving the locations of a subtree past an edit
+		 *
+		 * Every line is shifted by lineDelta; on the line where the edit ended, the columns are
+		 * shifted by columnDelta as well.
+		 */
+		class Relocator : public ast::NodeVisitor {
+		public:
+			Relocator(int editLine, int lineDelta, int columnDelta)
+					: editLine(editLine), lineDelta(lineDelta), columnDelta(columnDelta) {}
+
+			[[nodiscard]] lexer::SourceLocation moved(lexer::SourceLocation location) const {
+				if (location.line == editLine) {
+					location.column += columnDelta;
+				}
+				location.line += lineDelta;
+				return location;
+			}
+
+			void move(const ast::ASTNodePtr &node) {
+				if (!node) {
+					return;
+				}
+				node->setLocation(moved(node->getLocation()));
+				node->accept(*this);
+			}
+
+			void move(const ast::NodeList &nodes) {
+				for (const auto &node: nodes) {
+					move(node);
+				}
+			}
+
+			// Program nodes
+			void visit(const ast::ProgramNode &node) override {
+				move(node.getDeclarations());
+			}
+
+			// Declaration nodes
+			void visit(const ast::VariableNode &node) override {
+				move(node.getType());
+				move(node.getArraySize());
+				move(node.getInitializer());
+			}
+
+			void visit(const ast::MultipleDeclarationNode &node) override {
+				move(node.getDeclarations());
+			}
+
+			void visit(const ast::ParameterNode &node) override {
+				move(node.getType());
+			}
+
+			void visit(const ast::FunctionDeclarationNode &node) override {
+				move(node.getReturnType());
+				move(node.getParameters());
+				move(node.getBody());
+			}
+
+			void visit(const ast::StructDeclarationNode &node) override {
+				move(node.getFields());
+			}
+
+			void visit(const ast::FunctionPointerDeclarationNode &node) override {
+				move(node.getReturnType());
+				move(node.getParameterTypes());
+			}
+
+			// Type nodes
+			void visit(const ast::PrimitiveTypeNode &) override {}
+
+			void visit(const ast::NamedTypeNode &) override {}
+
+			void visit(const ast::PointerTypeNode &node) override {
+				move(node.getBaseType());
+			}
+
+			// Expression nodes
+			void visit(const ast::LiteralNode &) override {}
+
+			void visit(const ast::IdentifierNode &) override {}
+
+			void visit(const ast::BinaryExpressionNode &node) override {
+				move(node.getLeft());
+				move(node.getRight());
+			}
+
+			void visit(const ast::UnaryExpressionNode &node) override {
+				move(node.getOperand());
+			}
+
+			void visit(const ast::CastExpressionNode &node) override {
+				move(node.getTargetType());
+				move(node.getExpression());
+			}
+
+			void visit(const ast::CallExpressionNode &node) override {
+				move(node.getCallee());
+				move(node.getArguments());
+			}
+
+			void visit(const ast::IndexExpressionNode &node) override {
+				move(node.getArray());
+				move(node.getIndex());
+			}
+
+			void visit(const ast::MemberExpressionNode &node) override {
+				move(node.getObject());
+			}
+
+			void visit(const ast::CommaExpressionNode &node) override {
+				move(node.getExpressions());
+			}
+
+			// Statement nodes
+			void visit(const ast::BlockStatementNode &node) override {
+				move(node.getStatements());
+			}
+
+			void visit(const ast::ExpressionStatementNode &node) override {
+				move(node.getExpression());
+			}
+
+			void visit(const ast::IfStatementNode &node) override {
+				move(node.getCondition());
+				move(node.getThenBranch());
+				move(node.getElseBranch());
+			}
+
+			void visit(const ast::WhileStatementNode &node) override {
+				move(node.getCondition());
+				move(node.getBody());
+			}
+
+			void visit(const ast::DoWhileStatementNode &node) override {
+				move(node.getBody());
+				move(node.getCondition());
+			}
+
+			void visit(const ast::ForStatementNode &node) override {
+				move(node.getInitialization());
+				move(node.getCondition());
+				move(node.getUpdate());
+				move(node.getBody());
+			}
+
+			void visit(const ast::SwitchStatementNode &node) override {
+				move(node.getExpression());
+				for (const auto &switchCase: node.getCases()) {
+					move(switchCase.body);
+				}
+			}
+
+			void visit(const ast::BreakStatementNode &) override {}
+
+			void visit(const ast::ContinueStatementNode &) override {}
+
+			void visit(const ast::ReturnStatementNode &node) override {
+				move(node.getExpression());
+			}
+
+		private:
+			int editLine;
+			int lineDelta;
+			int columnDelta;
+		};
+
+		// Line and column reached by advancing over a text, as the lexer counts them
+		void advance(int &line, int &column, std::string_view text) {
+			for (char c: text) {
+				if (c == '\n') {
+					++line;
+					column = 1;
+				} else {
+					++column;
+				}
+			}
+		}
+
+	} // anonymous namespace
+
+	IncrementalParser::IncrementalParser(std::string source, std::string filename, ParserOptions options)
+			: source(std::move(source)), filename(std::move(filename)), options(options) {
+		// Errors are kept per declaration, so a limit over the whole text cannot be applied
+		this->options.maxErrors = 0;
+		// Edits move the nodes of the kept declarations, which must therefore have a single parent
+		this->options.sharing = NodeSharing::NONE;
+		parseAll();
+	}
+
+	std::size_t IncrementalParser::applyEdit(std::size_t offset, std::size_t length, const std::string &text) {
+		if (offset > source.size() || length > source.size() - offset) {
+			throw std::out_of_range("Edit outside the source");
+		}
+
+		// Restart at the declaration holding the character before the edit, or at the top
+		auto byOffset = [](std::size_t limit) {
+			return [limit](const Item &item) { return item.start.offset < limit; };
+		};
+		auto firstAfter = std::partition_point(items.begin(), items.end(), byOffset(offset));
+		std::size_t first = firstAfter == items.begin() ? 0 : static_cast<std::size_t>(firstAfter - items.begin()) - 1;
+		if (options.recover && first > 0) {
+			// Recovery stops before a type keyword, so the previous declaration may depend on our first token
+			--first;
+		}
+		Position restart = first == 0 ? Position{0, 1, 1} : items[first].start;
+
+		// Where the edit ends in the old and in the new text
+		int oldLine = restart.line, oldColumn = restart.column;
+		advance(oldLine, oldColumn, std::string_view(source).substr(restart.offset, offset + length - restart.offset));
+		int newLine = restart.line, newColumn = restart.column;
+		advance(newLine, newColumn, std::string_view(source).substr(restart.offset, offset - restart.offset));
+		advance(newLine, newColumn, text);
+
+		std::string edited;
+		edited.reserve(source.size() - length + text.size());
+		edited.append(source, 0, offset).append(text).append(source, offset + length, std::string::npos);
+
+		// Old declarations starting past the edit can be reused once parsing reaches them
+		auto reusable = std::partition_point(items.begin(), items.end(), byOffset(offset + length));
+		auto shift = static_cast<std::ptrdiff_t>(text.size()) - static_cast<std::ptrdiff_t>(length);
+		Parsed parsed = parseFrom(context, edited, restart, static_cast<std::size_t>(reusable - items.begin()), shift);
+
+		// Move the reused declarations
+		Relocator relocator(oldLine, newLine - oldLine, newColumn - oldColumn);
+		for (std::size_t i = parsed.sync; i < items.size(); ++i) {
+			Item &item = items[i];
+			item.start.offset = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(item.start.offset) + shift);
+			if (newLine == oldLine && item.start.line != oldLine) {
+				// Only the offsets change for declarations after the edited line
+				continue;
+			}
+
+			relocator.move(program->getDeclarations()[i]);
+			lexer::SourceLocation start = relocator.moved(lexer::SourceLocation(0u, item.start.line, item.start.column));
+			item.start.line = start.line;
+			item.start.column = start.column;
+			for (auto &error: item.errors) {
+				error = ParserError(error.getMessage(), relocator.moved(error.getLocation()));
+			}
+		}
+
+		// Splice in the parsed declarations
+		std::size_t reparsed = parsed.items.size();
+		program->replaceDeclarations(first, parsed.sync - first, std::move(parsed.declarations));
+		items.erase(items.begin() + static_cast<std::ptrdiff_t>(first), items.begin() + static_cast<std::ptrdiff_t>(parsed.sync));
+		items.insert(items.begin() + static_cast<std::ptrdiff_t>(first), std::make_move_iterator(parsed.items.begin()),
+					 std::make_move_iterator(parsed.items.end()));
+		source = std::move(edited);
+
+		// The replaced declarations are still in the arena; start over once they outweigh the source
+		garbage += parsed.end - restart.offset;
+		if (garbage > std::max(source.size(), MIN_GARBAGE)) {
+			parseAll();
+		}
+
+		return reparsed;
+	}
+
+	std::vector<ParserError> IncrementalParser::getDiagnostics() const {
+		std::vector<ParserError> diagnostics;
+		for (const auto &item: items) {
+			diagnostics.insert(diagnostics.end(), item.errors.begin(), item.errors.end());
+		}
+		return diagnostics;
+	}
+
+	IncrementalParser::Parsed IncrementalParser::parseFrom(const std::shared_ptr<ast::ASTContext> &arena,
+															 const std::string &text, const Position &start,
+															 std::size_t syncFrom, std::ptrdiff_t shift) const {
+		auto buffer = lexer::SourceBuffer::view(text, filename);
+		lexer::Lexer lexer(buffer);
+		lexer.seek(start.offset, start.line, start.column);
+		Parser parser(lexer, arena, options);
+
+		Parsed parsed;
+		parsed.declarations = arena->makeList();
+		parsed.sync = syncFrom;
+		for (;;) {
+			const lexer::TokenRef &token = parser.getCurrentToken();
+			parsed.end = token.offset;
+			if (token.getType() == lexer::TokenType::END_OF_FILE) {
+				parsed.sync = items.size();
+				break;
+			}
+
+			// Stop where an old declaration starts: the text from there on is unchanged
+			auto position = static_cast<std::ptrdiff_t>(token.offset);
+			while (parsed.sync < items.size() &&
+				   static_cast<std::ptrdiff_t>(items[parsed.sync].start.offset) + shift < position) {
+				++parsed.sync;
+			}
+			if (parsed.sync < items.size() &&
+				static_cast<std::ptrdiff_t>(items[parsed.sync].start.offset) + shift == position) {
+				break;
+			}
+
+			Item item{{token.offset, token.line, token.column}, {}};
+			std::size_t errorCount = parser.getDiagnostics().size();
+			ast::ASTNodePtr declaration = parser.parseNextDeclaration();
+			item.errors.assign(parser.getDiagnostics().begin() + static_cast<std::ptrdiff_t>(errorCount),
+							   parser.getDiagnostics().end());
+			parsed.declarations.push_back(std::move(declaration));
+			parsed.items.push_back(std::move(item));
+		}
+
+		return parsed;
+	}
+
+	void IncrementalParser::parseAll() {
+		auto arena = std::make_shared<ast::ASTContext>();
+		Parsed parsed = parseFrom(arena, source, {0, 1, 1}, items.size(), 0);
+
+		auto fresh = std::make_unique<ast::ProgramNode>(filename, arena);
+		fresh->replaceDeclarations(0, 0, std::move(parsed.declarations));
+		program = std::move(fresh);
+		context = std::move(arena);
+		items = std::move(parsed.items);
+		garbage = 0;
+	}
+
+} // namespace tinyc::parser
@@ -1,22 +1,38 @@
 #include "tinyc/parser/Parser.h"
 #include <sstream>
+#include <utility>
 
 namespace tinyc::parser {
 
-	Parser::Parser(lexer::Lexer &lexer) : lexer(lexer) {
+	Parser::Parser(lexer::Lexer &lexer, ParserOptions options)
+			: Parser(lexer, std::make_shared<ast::ASTContext>(), options) {
+	}
+
+	Parser::Parser(lexer::Lexer &lexer, std::shared_ptr<ast::ASTContext> context, ParserOptions options)
+			: lexer(lexer), context(std::move(context)), options(options) {
 		// Initialize by reading the first token
-		currentToken = lexer.nextToken();
+		currentToken = lexer.next();
+	}
+
+	Parser::NestingGuard::NestingGuard(Parser &parser) : parser(parser) {
+		// The depth is decremented by the destructor, which does not run if we throw here
+		if (parser.nestingDepth >= parser.options.maxNestingDepth) {
+			parser.error("Maximum nesting depth of " + std::to_string(parser.options.maxNestingDepth) +
+						 " exceeded");
+		}
+		++parser.nestingDepth;
 	}
 
-	lexer::TokenPtr Parser::consume() {
-		lexer::TokenPtr oldToken = currentToken;
-		currentToken = lexer.nextToken();
+	lexer::TokenRef Parser::consume() {
+		lexer::TokenRef oldToken = currentToken;
+		currentToken = lexer.next();
+		++consumedTokens;
 
 		return oldToken;
 	}
 
 	bool Parser::check(lexer::TokenType type) const {
-		return currentToken->getType() == type;
+		return currentToken.getType() == type;
 	}
 
 	bool Parser::match(lexer::TokenType type) {
@@ -27,7 +43,7 @@ namespace tinyc::parser {
 		return false;
 	}
 
-	lexer::TokenPtr Parser::expect(lexer::TokenType type, const std::string &message) {
+	lexer::TokenRef Parser::expect(lexer::TokenType type, const std::string &message) {
 		if (check(type)) {
 			return consume();
 		}
@@ -35,24 +51,71 @@ namespace tinyc::parser {
 	}
 
 	void Parser::error(const std::string &message) const {
-		throw ParserError(message, currentToken->getLocation());
+		throw ParserError(message, location(currentToken));
 	}
 
 	ast::ASTNodePtr Parser::parseProgram() {
 		auto sourceName = lexer.getSourceName();
-		auto program = std::make_unique<ast::ProgramNode>(sourceName);
+		// The program itself is heap-allocated and keeps the arena with its nodes alive
+		auto program = std::make_unique<ast::ProgramNode>(sourceName, context);
 
 		// Parse declarations until EOF
-		while (!check(lexer::TokenType::END_OF_FILE)) {
-			auto item = parseProgramItem();
-			program->addDeclaration(std::move(item));
+		try {
+			while (!check(lexer::TokenType::END_OF_FILE)) {
+				auto item = options.recover ? parseProgramItemOrError() : parseProgramItem();
+				program->addDeclaration(std::move(item));
+			}
+		} catch (const StopParsing &) {
+			// Too many errors: return what was parsed so far
 		}
 
 		return program;
 	}
 
+	ast::FlatAST Parser::parseProgramFlat() {
+		ast::FlatAST flat;
+		flat.append(ast::ProgramNode(lexer.getSourceName()), ast::FlatAST::NONE);
+
+		// Declarations are built in a scratch arena that is reset after each one; the names
+		// interned so far are kept for the next declarations
+		auto saved = std::exchange(context, std::make_shared<ast::ASTContext>());
+		std::shared_ptr<ast::SymbolTable> symbols = context->getSymbols();
+		try {
+			while (!check(lexer::TokenType::END_OF_FILE)) {
+				auto item = options.recover ? parseProgramItemOrError() : parseProgramItem();
+				flat.append(*item, 0);
+				item.reset();
+				context->reset();
+				context->setSymbols(symbols);
+			}
+		} catch (const StopParsing &) {
+			// Too many errors: return what was parsed so far
+		} catch (...) {
+			context = std::move(saved);
+			throw;
+		}
+
+		context = std::move(saved);
+		return flat;
+	}
+
+	ast::ASTNodePtr Parser::parseNextDeclaration() {
+		if (check(lexer::TokenType::END_OF_FILE)) {
+			return nullptr;
+		}
+		if (!options.recover) {
+			return parseProgramItem();
+		}
+
+		try {
+			return parseProgramItemOrError();
+		} catch (const StopParsing &) {
+			return nullptr;
+		}
+	}
+
 	ast::ASTNodePtr Parser::parseProgramItem() {
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
 			case lexer::TokenType::KW_CHAR: {
@@ -61,16 +124,16 @@ namespace tinyc::parser {
 
 				auto identifierToken = expect(lexer::TokenType::IDENTIFIER,
 											  "Expected identifier after type");
-				std::string identifier = identifierToken->getLexeme();
+				std::string_view identifier = name(identifierToken);
 
-				return parseNotVoidFunctionOrVariable(std::move(type), identifier, identifierToken->getLocation());
+				return parseNotVoidFunctionOrVariable(std::move(type), identifier, location(identifierToken));
 			}
 
 			case lexer::TokenType::KW_VOID: {
 				// Rule 4: PROGRAM_ITEM -> void VOID_DECL_TAIL
 				// Save location before consuming
-				auto voidLocation = currentToken->getLocation();
-				auto voidToken = consume(); // Consume "void"
+				auto voidLocation = location(currentToken);
+				consume(); // Consume "void"
 				return parseVoidDeclTail(voidLocation);
 			}
 
@@ -89,4 +152,121 @@ namespace tinyc::parser {
 		}
 	}
 
+	ast::ASTNodePtr Parser::parseProgramItemOrError() {
+		std::size_t startToken = consumedTokens;
+		try {
+			return parseProgramItem();
+		} catch (const ParserError &error) {
+			return recover(error, startToken, true);
+		}
+	}
+
+	ast::ASTNodePtr Parser::parseStatementOrError() {
+		std::size_t startToken = consumedTokens;
+		try {
+			return parseStatement();
+		} catch (const ParserError &error) {
+			return recover(error, startToken, false);
+		}
+	}
+
+	ast::ASTNodePtr Parser::recover(const ParserError &error, std::size_t startToken, bool topLevel) {
+		// Errors are thrown at the current token, so consumedTokens identifies where they occurred
+		if (consumedTokens != lastErrorToken) {
+			if (options.maxErrors != 0 && diagnostics.size() >= options.maxErrors) {
+				diagnostics.emplace_back("Too many errors (limit " + std::to_string(options.maxErrors) +
+										 "), stopping", error.getLocation());
+				throw StopParsing();
+			}
+			diagnostics.push_back(error);
+			lastErrorToken = consumedTokens;
+		}
+
+		if (topLevel) {
+			skipDeclaration();
+		} else {
+			skipStatement();
+		}
+
+		// Always make progress, or the caller would fail at the same token again
+		if (consumedTokens == startToken && !check(lexer::TokenType::END_OF_FILE)) {
+			consume();
+		}
+
+		return context->create<ast::ErrorNode>(context->copyString(error.getMessage()), error.getLocation());
+	}
+
+	void Parser::skipStatement() {
+		// Stop after a ';' or a block at depth 0, or before a '}', 'case' or 'default' closing
+		// the enclosing block
+		std::size_t depth = 0;
+		while (!check(lexer::TokenType::END_OF_FILE)) {
+			switch (currentToken.getType()) {
+				case lexer::TokenType::SEMICOLON:
+					consume();
+					if (depth == 0) {
+						return;
+					}
+					break;
+				case lexer::TokenType::LBRACE:
+					consume();
+					++depth;
+					break;
+				case lexer::TokenType::RBRACE:
+					if (depth == 0) {
+						return;
+					}
+					consume();
+					if (--depth == 0) {
+						return;
+					}
+					break;
+				case lexer::TokenType::KW_CASE:
+				case lexer::TokenType::KW_DEFAULT:
+					if (depth == 0) {
+						return;
+					}
+					consume();
+					break;
+				default:
+					consume();
+					break;
+			}
+		}
+	}
+
+	void Parser::skipDeclaration() {
+		// Stop before a type keyword outside braces, where a new declaration can start
+		std::size_t depth = 0;
+		while (!check(lexer::TokenType::END_OF_FILE)) {
+			switch (currentToken.getType()) {
+				case lexer::TokenType::KW_INT:
+				case lexer::TokenType::KW_DOUBLE:
+				case lexer::TokenType::KW_CHAR:
+				case lexer::TokenType::KW_VOID:
+				case lexer::TokenType::KW_STRUCT:
+				case lexer::TokenType::KW_TYPEDEF:
+					if (depth == 0) {
+						return;
+					}
+					consume();
+					break;
+				case lexer::TokenType::LBRACE:
+					consume();
+					++depth;
+					break;
+				case lexer::TokenType::RBRACE:
+					// The error may have been inside a block whose '{' was already consumed
+					consume();
+					if (depth > 0) {
+						--depth;
+					}
+					break;
+				default:
+					consume();
+					break;
+			}
+		}
+	}
+
 } // namespace tinyc::parser
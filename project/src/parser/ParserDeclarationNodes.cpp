@@ -7,11 +7,11 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseNotVoidFunctionOrVariable(
 			ast::ASTNodePtr type,
-			const std::string &identifier,
+			std::string_view identifier,
 			const lexer::SourceLocation &location) {
 		// Rule 7: NOT_VOID_FUNCTION_OR_VARIABLE -> VARIABLE_TAIL
 		// Rule 8: NOT_VOID_FUNCTION_OR_VARIABLE -> FUNCTION_DECLARATION_TAIL
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::LBRACKET:
 			case lexer::TokenType::OP_ASSIGN:
 			case lexer::TokenType::COMMA:
@@ -31,25 +31,25 @@ namespace tinyc::parser {
 		// Rule 10: VOID_DECL_TAIL -> STAR_PLUS identifier FUNC_OR_VAR_TAIL
 
 		// Create void type
-		ast::ASTNodePtr voidType = std::make_unique<ast::PrimitiveTypeNode>(
+		ast::ASTNodePtr voidType = primitiveType(
 				ast::PrimitiveTypeNode::Kind::VOID,
 				voidLocation);
 
 		if (check(lexer::TokenType::IDENTIFIER)) {
 			// Rule 9: identifier FUNCTION_DECLARATION_TAIL
 			auto identifierToken = consume();
-			std::string identifier = identifierToken->getLexeme();
+			std::string_view identifier = name(identifierToken);
 
 			// Only functions can have a void return type directly
-			return parseFunctionDeclarationTail(std::move(voidType), identifier, identifierToken->getLocation());
+			return parseFunctionDeclarationTail(std::move(voidType), identifier, location(identifierToken));
 		} else if (check(lexer::TokenType::OP_MULTIPLY)) {
 			// Rule 10: STAR_PLUS identifier FUNC_OR_VAR_TAIL
 			parseStarPlus(voidType);
 
 			auto identifierToken = expect(lexer::TokenType::IDENTIFIER, "Expected identifier after void*");
-			std::string identifier = identifierToken->getLexeme();
+			std::string_view identifier = name(identifierToken);
 
-			return parseFuncOrVarTail(std::move(voidType), identifier, identifierToken->getLocation());
+			return parseFuncOrVarTail(std::move(voidType), identifier, location(identifierToken));
 		} else {
 			error("Expected identifier or '*' after 'void'");
 		}
@@ -57,11 +57,11 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseFuncOrVarTail(
 			ast::ASTNodePtr type,
-			const std::string &identifier,
+			std::string_view identifier,
 			const lexer::SourceLocation &location) {
 		// Rule 11: FUNC_OR_VAR_TAIL -> VARIABLE_TAIL
 		// Rule 12: FUNC_OR_VAR_TAIL -> FUNCTION_DECLARATION_TAIL
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::LBRACKET:
 			case lexer::TokenType::OP_ASSIGN:
 			case lexer::TokenType::COMMA:
@@ -78,7 +78,7 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseVariableTail(
 			ast::ASTNodePtr type,
-			const std::string &identifier,
+			std::string_view identifier,
 			const lexer::SourceLocation &location) {
 		// Rule 13: VARIABLE_TAIL -> OPT_ARRAY_SIZE OPT_INIT VAR_DECLS_TAIL ;
 
@@ -89,7 +89,7 @@ namespace tinyc::parser {
 		ast::ASTNodePtr initializer = parseOptInit();
 
 		// Create variable declaration node
-		auto varDecl = std::make_unique<ast::VariableNode>(
+		auto varDecl = context->create<ast::VariableNode>(
 				identifier,
 				std::move(type),
 				location,
@@ -97,10 +97,10 @@ namespace tinyc::parser {
 				std::move(initializer));
 
 		// If there are more variables, collect them all
-		std::vector<ast::ASTNodePtr> declarations;
+		ast::NodeList declarations = context->makeList();
 		declarations.push_back(std::move(varDecl));
 
-		declarations = parseVarDeclsTail(std::move(declarations));
+		parseVarDeclsTail(declarations);
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after variable declaration");
 
 		// If only one variable, return it directly
@@ -108,20 +108,20 @@ namespace tinyc::parser {
 			return std::move(declarations[0]);
 		}
 
-		return std::make_unique<ast::MultipleDeclarationNode>(
+		return context->create<ast::MultipleDeclarationNode>(
 				std::move(declarations),
 				location);
 	}
 
 	ast::ASTNodePtr Parser::parseFunctionDeclarationTail(
 			ast::ASTNodePtr returnType,
-			const std::string &identifier,
+			std::string_view identifier,
 			const lexer::SourceLocation &location) {
 		// Rule 14: FUNCTION_DECLARATION_TAIL -> ( OPT_FUN_ARGS ) FUNC_TAIL
 		expect(lexer::TokenType::LPAREN, "Expected '(' after function name");
 
 		// Parse optional function arguments
-		std::vector<ast::ASTNodePtr> parameters = parseOptFunArgs();
+		ast::NodeList parameters = parseOptFunArgs();
 
 		expect(lexer::TokenType::RPAREN, "Expected ')' after function parameters");
 
@@ -129,7 +129,7 @@ namespace tinyc::parser {
 		ast::ASTNodePtr body = parseFuncTail();
 
 		// Create function declaration node
-		return std::make_unique<ast::FunctionDeclarationNode>(
+		return context->create<ast::FunctionDeclarationNode>(
 				identifier,
 				std::move(returnType),
 				std::move(parameters),
@@ -151,10 +151,10 @@ namespace tinyc::parser {
 		}
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseOptFunArgs() {
+	ast::NodeList Parser::parseOptFunArgs() {
 		// Rule 19: OPT_FUN_ARGS -> FUN_ARG FUN_ARG_TAIL
 		// Rule 20: OPT_FUN_ARGS -> ε
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_VOID:
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
@@ -162,28 +162,25 @@ namespace tinyc::parser {
 			case lexer::TokenType::IDENTIFIER:
 			{
 				ast::ASTNodePtr arg = parseFunArg();
-				std::vector<ast::ASTNodePtr> args;
+				ast::NodeList args = context->makeList();
 				args.push_back(std::move(arg));
-				return parseFunArgTail(std::move(args));
+				parseFunArgTail(args);
+				return args;
 			}
 
 			default:
 				// Empty parameter list
-				return {};
+				return context->makeList();
 		}
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseFunArgTail(std::vector<ast::ASTNodePtr> args) {
+	void Parser::parseFunArgTail(ast::NodeList &args) {
 		// Rule 21: FUN_ARG_TAIL -> , FUN_ARG FUN_ARG_TAIL
 		// Rule 22: FUN_ARG_TAIL -> ε
-		if (match(lexer::TokenType::COMMA)) {
+		while (match(lexer::TokenType::COMMA)) {
 			ast::ASTNodePtr arg = parseFunArg();
 			args.push_back(std::move(arg));
-			return parseFunArgTail(std::move(args));
 		}
-
-		// No more parameters
-		return args;
 	}
 
 	ast::ASTNodePtr Parser::parseFunArg() {
@@ -191,13 +188,13 @@ namespace tinyc::parser {
 		ast::ASTNodePtr type = parseType();
 
 		auto identifierToken = expect(lexer::TokenType::IDENTIFIER, "Expected parameter identifier");
-		std::string identifier = identifierToken->getLexeme();
+		std::string_view identifier = name(identifierToken);
 
 		// Create parameter node
-		return std::make_unique<ast::ParameterNode>(
+		return context->create<ast::ParameterNode>(
 				identifier,
 				std::move(type),
-				identifierToken->getLocation());
+				location(identifierToken));
 	}
 
 } // namespace tinyc::parser
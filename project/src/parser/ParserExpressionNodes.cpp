@@ -1,8 +1,60 @@
 #include "tinyc/parser/Parser.h"
+#include <array>
 
 
 namespace tinyc::parser {
 
+	namespace {
+
+		using BinaryOperator = ast::BinaryExpressionNode::Operator;
+
+		// Binary operator a token stands for; precedence 0 means the token is not a binary operator
+		struct BinaryOperatorInfo {
+			int precedence;
+			BinaryOperator op;
+		};
+
+		constexpr std::size_t TOKEN_TYPE_COUNT = static_cast<std::size_t>(lexer::TokenType::ERROR) + 1;
+
+		static_assert(Parser::LOWEST_PRECEDENCE == 1, "The table starts at the || level");
+
+		// Binding strength of every token type; E9 (||) is the loosest level, E1 (* / %) the tightest
+		constexpr std::array<BinaryOperatorInfo, TOKEN_TYPE_COUNT> makeBinaryOperatorTable() {
+			std::array<BinaryOperatorInfo, TOKEN_TYPE_COUNT> table{};
+
+			auto set = [&table](lexer::TokenType type, int precedence, BinaryOperator op) {
+				table[static_cast<std::size_t>(type)] = {precedence, op};
+			};
+
+			set(lexer::TokenType::OP_LOGICAL_OR, 1, BinaryOperator::LOGICAL_OR);         // E9
+			set(lexer::TokenType::OP_LOGICAL_AND, 2, BinaryOperator::LOGICAL_AND);       // E8
+			set(lexer::TokenType::OP_OR, 3, BinaryOperator::BITWISE_OR);                 // E7
+			set(lexer::TokenType::OP_AND, 4, BinaryOperator::BITWISE_AND);               // E6
+			set(lexer::TokenType::OP_EQUAL, 5, BinaryOperator::EQUAL);                   // E5
+			set(lexer::TokenType::OP_NOT_EQUAL, 5, BinaryOperator::NOT_EQUAL);
+			set(lexer::TokenType::OP_LESS, 6, BinaryOperator::LESS);                     // E4
+			set(lexer::TokenType::OP_LESS_EQUAL, 6, BinaryOperator::LESS_EQUAL);
+			set(lexer::TokenType::OP_GREATER, 6, BinaryOperator::GREATER);
+			set(lexer::TokenType::OP_GREATER_EQUAL, 6, BinaryOperator::GREATER_EQUAL);
+			set(lexer::TokenType::OP_LEFT_SHIFT, 7, BinaryOperator::LEFT_SHIFT);         // E3
+			set(lexer::TokenType::OP_RIGHT_SHIFT, 7, BinaryOperator::RIGHT_SHIFT);
+			set(lexer::TokenType::OP_PLUS, 8, BinaryOperator::ADD);                      // E2
+			set(lexer::TokenType::OP_MINUS, 8, BinaryOperator::SUBTRACT);
+			set(lexer::TokenType::OP_MULTIPLY, 9, BinaryOperator::MULTIPLY);             // E1
+			set(lexer::TokenType::OP_DIVIDE, 9, BinaryOperator::DIVIDE);
+			set(lexer::TokenType::OP_MODULO, 9, BinaryOperator::MODULO);
+
+			return table;
+		}
+
+		constexpr auto binaryOperatorTable = makeBinaryOperatorTable();
+
+		const BinaryOperatorInfo &binaryOperatorInfo(lexer::TokenType type) {
+			return binaryOperatorTable[static_cast<std::size_t>(type)];
+		}
+
+	} // anonymous namespace
+
 	// Expression parsing methods
 
 	ast::ASTNodePtr Parser::parseExprs() {
@@ -10,9 +62,9 @@ namespace tinyc::parser {
 		ast::ASTNodePtr expr = parseExpr();
 
 		// Parse comma-separated expressions if any
-		std::vector<ast::ASTNodePtr> expressions;
+		ast::NodeList expressions = context->makeList();
 		expressions.push_back(std::move(expr));
-		expressions = parseExprsTail(std::move(expressions));
+		parseExprsTail(expressions);
 
 		// If only one expression, return it directly
 		if (expressions.size() == 1) {
@@ -20,27 +72,23 @@ namespace tinyc::parser {
 		}
 
 		// Create comma expression node
-		return std::make_unique<ast::CommaExpressionNode>(
+		return context->create<ast::CommaExpressionNode>(
 				std::move(expressions),
 				expressions[0]->getLocation());
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseExprsTail(std::vector<ast::ASTNodePtr> expressions) {
+	void Parser::parseExprsTail(ast::NodeList &expressions) {
 		// Rule 71: EXPRS_TAIL -> , EXPR EXPRS_TAIL
 		// Rule 72: EXPRS_TAIL -> ε
-		if (match(lexer::TokenType::COMMA)) {
+		while (match(lexer::TokenType::COMMA)) {
 			ast::ASTNodePtr expr = parseExpr();
 			expressions.push_back(std::move(expr));
-			return parseExprsTail(std::move(expressions));
 		}
-
-		// No more expressions
-		return expressions;
 	}
 
 	ast::ASTNodePtr Parser::parseExpr() {
 		// Rule 100: EXPR -> E9 EXPR_TAIL
-		ast::ASTNodePtr left = parseE9();
+		ast::ASTNodePtr left = parseBinaryExpression(LOWEST_PRECEDENCE);
 		return parseExprTail(std::move(left));
 	}
 
@@ -51,7 +99,7 @@ namespace tinyc::parser {
 			ast::ASTNodePtr right = parseExpr();
 
 			// Create assignment expression
-			return std::make_unique<ast::BinaryExpressionNode>(
+			return context->create<ast::BinaryExpressionNode>(
 					ast::BinaryExpressionNode::Operator::ASSIGN,
 					std::move(left),
 					std::move(right),
@@ -62,355 +110,50 @@ namespace tinyc::parser {
 		return left;
 	}
 
-	ast::ASTNodePtr Parser::parseE9() {
-		// Rule 103: E9 -> E8 E9_Prime
-		ast::ASTNodePtr left = parseE8();
-		return parseE9Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE9Prime(ast::ASTNodePtr left) {
-		// Rule 104: E9_Prime -> || E8 E9_Prime
-		// Rule 105: E9_Prime -> ε
-		if (match(lexer::TokenType::OP_LOGICAL_OR)) {
-			ast::ASTNodePtr right = parseE8();
-
-			// Create logical OR expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::LOGICAL_OR,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE9Prime(std::move(newLeft));
-		}
-
-		// No logical OR
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE8() {
-		// Rule 106: E8 -> E7 E8_Prime
-		ast::ASTNodePtr left = parseE7();
-		return parseE8Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE8Prime(ast::ASTNodePtr left) {
-		// Rule 107: E8_Prime -> && E7 E8_Prime
-		// Rule 108: E8_Prime -> ε
-		if (match(lexer::TokenType::OP_LOGICAL_AND)) {
-			ast::ASTNodePtr right = parseE7();
-
-			// Create logical AND expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::LOGICAL_AND,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE8Prime(std::move(newLeft));
-		}
-
-		// No logical AND
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE7() {
-		// Rule 109: E7 -> E6 E7_Prime
-		ast::ASTNodePtr left = parseE6();
-		return parseE7Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE7Prime(ast::ASTNodePtr left) {
-		// Rule 110: E7_Prime -> | E6 E7_Prime
-		// Rule 111: E7_Prime -> ε
-		if (match(lexer::TokenType::OP_OR)) {
-			ast::ASTNodePtr right = parseE6();
-
-			// Create bitwise OR expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::BITWISE_OR,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE7Prime(std::move(newLeft));
-		}
-
-		// No bitwise OR
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE6() {
-		// Rule 112: E6 -> E5 E6_Prime
-		ast::ASTNodePtr left = parseE5();
-		return parseE6Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE6Prime(ast::ASTNodePtr left) {
-		// Rule 113: E6_Prime -> & E5 E6_Prime
-		// Rule 114: E6_Prime -> ε
-		if (match(lexer::TokenType::OP_AND)) {
-			ast::ASTNodePtr right = parseE5();
-
-			// Create bitwise AND expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::BITWISE_AND,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE6Prime(std::move(newLeft));
-		}
-
-		// No bitwise AND
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE5() {
-		// Rule 115: E5 -> E4 E5_Prime
-		ast::ASTNodePtr left = parseE4();
-		return parseE5Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE5Prime(ast::ASTNodePtr left) {
-		// Rule 116: E5_Prime -> == E4 E5_Prime
-		// Rule 117: E5_Prime -> != E4 E5_Prime
-		// Rule 118: E5_Prime -> ε
-		if (match(lexer::TokenType::OP_EQUAL)) {
-			ast::ASTNodePtr right = parseE4();
-
-			// Create equality expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::EQUAL,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE5Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_NOT_EQUAL)) {
-			ast::ASTNodePtr right = parseE4();
-
-			// Create inequality expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::NOT_EQUAL,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE5Prime(std::move(newLeft));
-		}
-
-		// No equality/inequality
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE4() {
-		// Rule 119: E4 -> E3 E4_Prime
-		ast::ASTNodePtr left = parseE3();
-		return parseE4Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE4Prime(ast::ASTNodePtr left) {
-		// Rule 120: E4_Prime -> < E3 E4_Prime
-		// Rule 121: E4_Prime -> <= E3 E4_Prime
-		// Rule 122: E4_Prime -> > E3 E4_Prime
-		// Rule 123: E4_Prime -> >= E3 E4_Prime
-		// Rule 124: E4_Prime -> ε
-
-		if (match(lexer::TokenType::OP_LESS)) {
-			ast::ASTNodePtr right = parseE3();
-
-			// Create less-than expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::LESS,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE4Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_LESS_EQUAL)) {
-			ast::ASTNodePtr right = parseE3();
-
-			// Create less-than-or-equal expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::LESS_EQUAL,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE4Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_GREATER)) {
-			ast::ASTNodePtr right = parseE3();
-
-			// Create greater-than expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::GREATER,
-					std::move(left),
-				  	std::move(right),
-					left->getLocation());
-
-			return parseE4Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_GREATER_EQUAL)) {
-			ast::ASTNodePtr right = parseE3();
-
-			// Create greater-than-or-equal expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::GREATER_EQUAL,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE4Prime(std::move(newLeft));
-		}
-
-		// No comparison
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE3() {
-		// Rule 125: E3 -> E2 E3_Prime
-		ast::ASTNodePtr left = parseE2();
-		return parseE3Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE3Prime(ast::ASTNodePtr left) {
-		// Rule 126: E3_Prime -> << E2 E3_Prime
-		// Rule 127: E3_Prime -> >> E2 E3_Prime
-		// Rule 128: E3_Prime -> ε
-
-		if (match(lexer::TokenType::OP_LEFT_SHIFT)) {
-			ast::ASTNodePtr right = parseE2();
-
-			// Create left shift expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::LEFT_SHIFT,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE3Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_RIGHT_SHIFT)) {
-			ast::ASTNodePtr right = parseE2();
-
-			// Create right shift expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::RIGHT_SHIFT,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE3Prime(std::move(newLeft));
-		}
-
-		// No shift
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE2() {
-		// Rule 129: E2 -> E1 E2_Prime
-		ast::ASTNodePtr left = parseE1();
-		return parseE2Prime(std::move(left));
-	}
-
-	ast::ASTNodePtr Parser::parseE2Prime(ast::ASTNodePtr left) {
-		// Rule 130: E2_Prime -> + E1 E2_Prime
-		// Rule 131: E2_Prime -> - E1 E2_Prime
-		// Rule 132: E2_Prime -> ε
-
-		if (match(lexer::TokenType::OP_PLUS)) {
-			ast::ASTNodePtr right = parseE1();
-
-			// Create addition expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::ADD,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE2Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_MINUS)) {
-			ast::ASTNodePtr right = parseE1();
-
-			// Create subtraction expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::SUBTRACT,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
-
-			return parseE2Prime(std::move(newLeft));
-		}
-
-		// No addition/subtraction
-		return left;
-	}
-
-	ast::ASTNodePtr Parser::parseE1() {
-		// Rule 133: E1 -> E_UNARY_PRE E1_Prime
+	ast::ASTNodePtr Parser::parseBinaryExpression(int minPrecedence) {
+		// Rules 103-137: E9 .. E1 and their Prime tails, folded into one precedence-climbing loop.
+		// Every level is left-associative, so the right operand only takes operators that bind
+		// tighter than the current one; this builds exactly the trees of the E9 .. E1 chain.
 		ast::ASTNodePtr left = parseEUnaryPre();
-		return parseE1Prime(std::move(left));
-	}
 
-	ast::ASTNodePtr Parser::parseE1Prime(ast::ASTNodePtr left) {
-		// Rule 134: E1_Prime -> * E_UNARY_PRE E1_Prime
-		// Rule 135: E1_Prime -> / E_UNARY_PRE E1_Prime
-		// Rule 136: E1_Prime -> % E_UNARY_PRE E1_Prime
-		// Rule 137: E1_Prime -> ε
-
-		if (match(lexer::TokenType::OP_MULTIPLY)) {
-			ast::ASTNodePtr right = parseEUnaryPre();
-
-			// Create multiplication expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::MULTIPLY,
-					std::move(left),
-					std::move(right),
-					left->getLocation());
+		for (;;) {
+			const BinaryOperatorInfo &info = binaryOperatorInfo(currentToken.getType());
+			if (info.precedence < minPrecedence) {
+				// Not a binary operator (precedence 0) or one that binds looser than this level
+				return left;
+			}
 
-			return parseE1Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_DIVIDE)) {
-			ast::ASTNodePtr right = parseEUnaryPre();
+			consume();
+			ast::ASTNodePtr right = parseBinaryExpression(info.precedence + 1);
 
-			// Create division expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::DIVIDE,
+			left = createExpression<ast::BinaryExpressionNode>(
+					ast::NodeKey{ast::NodeKind::BINARY_EXPRESSION, static_cast<int>(info.op), {}, left.get(), right.get()},
+					info.op,
 					std::move(left),
 					std::move(right),
 					left->getLocation());
-
-			return parseE1Prime(std::move(newLeft));
-		} else if (match(lexer::TokenType::OP_MODULO)) {
-			ast::ASTNodePtr right = parseEUnaryPre();
-
-			// Create modulo expression
-			ast::ASTNodePtr newLeft = std::make_unique<ast::BinaryExpressionNode>(
-					ast::BinaryExpressionNode::Operator::MODULO,
-					std::move(left),
-				  	std::move(right),
-					left->getLocation());
-
-			return parseE1Prime(std::move(newLeft));
 		}
-
-		// No multiplication/division/modulo
-		return left;
 	}
 
 	ast::ASTNodePtr Parser::parseEUnaryPre() {
 		// Rules 138-146: E_UNARY_PRE -> ...
-		lexer::TokenPtr token = currentToken;
+		// Sub-statements and operands nest through here, so this bounds the recursion depth
+		NestingGuard guard(*this);
 
-		switch (token->getType()) {
+		lexer::TokenRef token = currentToken;
+
+		switch (token.getType()) {
 			case lexer::TokenType::OP_PLUS: {
 				// Rule 138: E_UNARY_PRE -> + E_UNARY_PRE
 				consume();
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create unary plus expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::POSITIVE, operand),
 						ast::UnaryExpressionNode::Operator::POSITIVE,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_MINUS: {
@@ -419,10 +162,11 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create unary minus expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::NEGATIVE, operand),
 						ast::UnaryExpressionNode::Operator::NEGATIVE,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_NOT: {
@@ -431,10 +175,11 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create logical not expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::LOGICAL_NOT, operand),
 						ast::UnaryExpressionNode::Operator::LOGICAL_NOT,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_BITWISE_NOT: {
@@ -443,10 +188,11 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create bitwise not expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::BITWISE_NOT, operand),
 						ast::UnaryExpressionNode::Operator::BITWISE_NOT,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_INCREMENT: {
@@ -455,10 +201,10 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create pre-increment expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return context->create<ast::UnaryExpressionNode>(
 						ast::UnaryExpressionNode::Operator::PRE_INCREMENT,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_DECREMENT: {
@@ -467,10 +213,10 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create pre-decrement expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return context->create<ast::UnaryExpressionNode>(
 						ast::UnaryExpressionNode::Operator::PRE_DECREMENT,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_MULTIPLY: {
@@ -479,10 +225,11 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create dereference expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::DEREFERENCE, operand),
 						ast::UnaryExpressionNode::Operator::DEREFERENCE,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			case lexer::TokenType::OP_AND: {
@@ -491,10 +238,11 @@ namespace tinyc::parser {
 				ast::ASTNodePtr operand = parseEUnaryPre();
 
 				// Create address-of expression
-				return std::make_unique<ast::UnaryExpressionNode>(
+				return createExpression<ast::UnaryExpressionNode>(
+						unaryKey(ast::UnaryExpressionNode::Operator::ADDRESS_OF, operand),
 						ast::UnaryExpressionNode::Operator::ADDRESS_OF,
 						std::move(operand),
-						token->getLocation());
+						location(token));
 			}
 
 			default:
@@ -511,32 +259,34 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseECallIndexMemberPostPrime(ast::ASTNodePtr expr) {
 		// Rules 148-152: E_CALL_INDEX_MEMBER_POST_Prime -> ...
-		switch (currentToken->getType()) {
-			case lexer::TokenType::LPAREN:
-				// Rule 148: E_CALL_INDEX_MEMBER_POST_Prime -> E_CALL E_CALL_INDEX_MEMBER_POST_Prime
-				expr = parseECall(std::move(expr));
-				return parseECallIndexMemberPostPrime(std::move(expr));
-
-			case lexer::TokenType::LBRACKET:
-				// Rule 149: E_CALL_INDEX_MEMBER_POST_Prime -> E_INDEX E_CALL_INDEX_MEMBER_POST_Prime
-				expr = parseEIndex(std::move(expr));
-				return parseECallIndexMemberPostPrime(std::move(expr));
-
-			case lexer::TokenType::OP_DOT:
-			case lexer::TokenType::OP_ARROW:
-				// Rule 150: E_CALL_INDEX_MEMBER_POST_Prime -> E_MEMBER E_CALL_INDEX_MEMBER_POST_Prime
-				expr = parseEMember(std::move(expr));
-				return parseECallIndexMemberPostPrime(std::move(expr));
-
-			case lexer::TokenType::OP_INCREMENT:
-			case lexer::TokenType::OP_DECREMENT:
-				// Rule 151: E_CALL_INDEX_MEMBER_POST_Prime -> E_POST E_CALL_INDEX_MEMBER_POST_Prime
-				expr = parseEPost(std::move(expr));
-				return parseECallIndexMemberPostPrime(std::move(expr));
-
-			default:
-				// Rule 152: E_CALL_INDEX_MEMBER_POST_Prime -> ε
-				return expr;
+		for (;;) {
+			switch (currentToken.getType()) {
+				case lexer::TokenType::LPAREN:
+					// Rule 148: E_CALL_INDEX_MEMBER_POST_Prime -> E_CALL E_CALL_INDEX_MEMBER_POST_Prime
+					expr = parseECall(std::move(expr));
+					break;
+
+				case lexer::TokenType::LBRACKET:
+					// Rule 149: E_CALL_INDEX_MEMBER_POST_Prime -> E_INDEX E_CALL_INDEX_MEMBER_POST_Prime
+					expr = parseEIndex(std::move(expr));
+					break;
+
+				case lexer::TokenType::OP_DOT:
+				case lexer::TokenType::OP_ARROW:
+					// Rule 150: E_CALL_INDEX_MEMBER_POST_Prime -> E_MEMBER E_CALL_INDEX_MEMBER_POST_Prime
+					expr = parseEMember(std::move(expr));
+					break;
+
+				case lexer::TokenType::OP_INCREMENT:
+				case lexer::TokenType::OP_DECREMENT:
+					// Rule 151: E_CALL_INDEX_MEMBER_POST_Prime -> E_POST E_CALL_INDEX_MEMBER_POST_Prime
+					expr = parseEPost(std::move(expr));
+					break;
+
+				default:
+					// Rule 152: E_CALL_INDEX_MEMBER_POST_Prime -> ε
+					return expr;
+			}
 		}
 	}
 
@@ -545,21 +295,21 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::LPAREN, "Expected '(' for function call");
 
 		// Parse optional argument list
-		std::vector<ast::ASTNodePtr> arguments = parseOptExprList();
+		ast::NodeList arguments = parseOptExprList();
 
 		expect(lexer::TokenType::RPAREN, "Expected ')' after function arguments");
 
 		// Create call expression
-		return std::make_unique<ast::CallExpressionNode>(
+		return context->create<ast::CallExpressionNode>(
 				std::move(callee),
 				std::move(arguments),
 				callee->getLocation());
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseOptExprList() {
+	ast::NodeList Parser::parseOptExprList() {
 		// Rule 154: OPT_EXPR_LIST -> EXPR EXPR_TAIL_LIST
 		// Rule 155: OPT_EXPR_LIST -> ε
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::OP_PLUS:
 			case lexer::TokenType::OP_MINUS:
 			case lexer::TokenType::OP_NOT:
@@ -576,28 +326,25 @@ namespace tinyc::parser {
 			case lexer::TokenType::LPAREN:
 			case lexer::TokenType::KW_CAST: {
 				ast::ASTNodePtr expr = parseExpr();
-				std::vector<ast::ASTNodePtr> expressions;
+				ast::NodeList expressions = context->makeList();
 				expressions.push_back(std::move(expr));
-				return parseExprTailList(std::move(expressions));
+				parseExprTailList(expressions);
+				return expressions;
 			}
 
 			default:
 				// Empty argument list
-				return std::vector<ast::ASTNodePtr>();
+				return context->makeList();
 		}
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseExprTailList(std::vector<ast::ASTNodePtr> expressions) {
+	void Parser::parseExprTailList(ast::NodeList &expressions) {
 		// Rule 156: EXPR_TAIL_LIST -> , EXPR EXPR_TAIL_LIST
 		// Rule 157: EXPR_TAIL_LIST -> ε
-		if (match(lexer::TokenType::COMMA)) {
+		while (match(lexer::TokenType::COMMA)) {
 			ast::ASTNodePtr expr = parseExpr();
 			expressions.push_back(std::move(expr));
-			return parseExprTailList(std::move(expressions));
 		}
-
-		// No more expressions
-		return expressions;
 	}
 
 	ast::ASTNodePtr Parser::parseEIndex(ast::ASTNodePtr array) {
@@ -609,7 +356,8 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::RBRACKET, "Expected ']' after array index");
 
 		// Create index expression
-		return std::make_unique<ast::IndexExpressionNode>(
+		return createExpression<ast::IndexExpressionNode>(
+				ast::NodeKey{ast::NodeKind::INDEX_EXPRESSION, 0, {}, array.get(), index.get()},
 				std::move(array),
 				std::move(index),
 				array->getLocation());
@@ -630,10 +378,11 @@ namespace tinyc::parser {
 		}
 
 		auto identifierToken = expect(lexer::TokenType::IDENTIFIER, "Expected member name");
-		std::string memberName = identifierToken->getLexeme();
+		std::string_view memberName = name(identifierToken);
 
 		// Create member expression
-		return std::make_unique<ast::MemberExpressionNode>(
+		return createExpression<ast::MemberExpressionNode>(
+				ast::NodeKey{ast::NodeKind::MEMBER_EXPRESSION, static_cast<int>(kind), memberName, object.get()},
 				kind,
 				std::move(object),
 				memberName,
@@ -655,7 +404,7 @@ namespace tinyc::parser {
 		}
 
 		// Create postfix expression
-		return std::make_unique<ast::UnaryExpressionNode>(
+		return context->create<ast::UnaryExpressionNode>(
 				op,
 				std::move(operand),
 				operand->getLocation());
@@ -663,29 +412,23 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseF() {
 		// Rules 163-169: F -> ...
-		lexer::TokenPtr token = currentToken;
+		lexer::TokenRef token = currentToken;
 
-		switch (token->getType()) {
+		switch (token.getType()) {
 			case lexer::TokenType::INTEGER_LITERAL: {
 				// Rule 163: F -> integer_literal
 				consume();
 
-				// Create integer literal
-				return std::make_unique<ast::LiteralNode>(
-						std::to_string(token->getIntValue()),
-						ast::LiteralNode::Kind::INTEGER,
-						token->getLocation());
+				// Create integer literal from its spelling in the source
+				return literal(ast::LiteralNode::Kind::INTEGER, lexer.text(token), location(token));
 			}
 
 			case lexer::TokenType::DOUBLE_LITERAL: {
 				// Rule 164: F -> double_literal
 				consume();
 
-				// Create double literal
-				return std::make_unique<ast::LiteralNode>(
-						std::to_string(token->getDoubleValue()),
-						ast::LiteralNode::Kind::DOUBLE,
-						token->getLocation());
+				// Create double literal, keeping its original spelling
+				return literal(ast::LiteralNode::Kind::DOUBLE, lexer.text(token), location(token));
 			}
 
 			case lexer::TokenType::CHAR_LITERAL: {
@@ -693,13 +436,9 @@ namespace tinyc::parser {
 				consume();
 
 				// Create char literal
-				std::string value;
-				value.push_back(token->getCharValue());
+				char value = token.getCharValue();
 
-				return std::make_unique<ast::LiteralNode>(
-						value,
-						ast::LiteralNode::Kind::CHAR,
-						token->getLocation());
+				return literal(ast::LiteralNode::Kind::CHAR, std::string_view(&value, 1), location(token));
 			}
 
 			case lexer::TokenType::STRING_LITERAL: {
@@ -707,10 +446,7 @@ namespace tinyc::parser {
 				consume();
 
 				// Create string literal
-				return std::make_unique<ast::LiteralNode>(
-						token->getLexeme(),
-						ast::LiteralNode::Kind::STRING,
-						token->getLocation());
+				return literal(ast::LiteralNode::Kind::STRING, lexer.text(token), location(token));
 			}
 
 			case lexer::TokenType::IDENTIFIER: {
@@ -718,9 +454,11 @@ namespace tinyc::parser {
 				consume();
 
 				// Create identifier
-				return std::make_unique<ast::IdentifierNode>(
-						token->getLexeme(),
-						token->getLocation());
+				std::string_view identifier = name(token);
+				return createExpression<ast::IdentifierNode>(
+						ast::NodeKey{ast::NodeKind::IDENTIFIER, 0, identifier},
+						identifier,
+						location(token));
 			}
 
 			case lexer::TokenType::LPAREN: {
@@ -757,10 +495,11 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::RPAREN, "Expected ')' after cast expression");
 
 		// Create cast expression
-		return std::make_unique<ast::CastExpressionNode>(
+		return createExpression<ast::CastExpressionNode>(
+				ast::NodeKey{ast::NodeKind::CAST_EXPRESSION, 0, {}, targetType.get(), expression.get()},
 				std::move(targetType),
 				std::move(expression),
-				castToken->getLocation());
+				location(castToken));
 	}
 
 } // namespace tinyc::parser
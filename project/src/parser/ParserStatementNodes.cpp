@@ -8,7 +8,10 @@ namespace tinyc::parser {
 
 	ast::ASTNodePtr Parser::parseStatement() {
 		// Rules 24-33: STATEMENT -> ...
-		switch (currentToken->getType()) {
+		// Sub-statements and operands nest through here, so this bounds the recursion depth
+		NestingGuard guard(*this);
+
+		switch (currentToken.getType()) {
 			case lexer::TokenType::LBRACE:
 				// Rule 24: STATEMENT -> BLOCK_STMT
 				return parseBlockStmt();
@@ -77,27 +80,29 @@ namespace tinyc::parser {
 		auto lbraceToken = expect(lexer::TokenType::LBRACE, "Expected '{'");
 
 		// Parse statements
-		std::vector<ast::ASTNodePtr> statements = parseStatementStar();
+		ast::NodeList statements = parseStatementStar();
 
 		expect(lexer::TokenType::RBRACE, "Expected '}'");
 
 		// Create block statement node
-		return std::make_unique<ast::BlockStatementNode>(
+		return context->create<ast::BlockStatementNode>(
 				std::move(statements),
-				lbraceToken->getLocation());
+				location(lbraceToken));
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseStatementStar() {
+	ast::NodeList Parser::parseStatementStar() {
 		// Rule 35: STATEMENT_STAR -> STATEMENT STATEMENT_STAR
 		// Rule 36: STATEMENT_STAR -> ε
-		std::vector<ast::ASTNodePtr> statements;
+		ast::NodeList statements = context->makeList();
 
 		// Parse statements until we reach '}', 'case', or 'default'
-		while (currentToken->getType() != lexer::TokenType::RBRACE &&
-			   currentToken->getType() != lexer::TokenType::KW_CASE &&
-			   currentToken->getType() != lexer::TokenType::KW_DEFAULT) {
+		// (or EOF when recovering, which leaves the missing '}' to the enclosing block)
+		while (currentToken.getType() != lexer::TokenType::RBRACE &&
+			   currentToken.getType() != lexer::TokenType::KW_CASE &&
+			   currentToken.getType() != lexer::TokenType::KW_DEFAULT &&
+			   !(options.recover && check(lexer::TokenType::END_OF_FILE))) {
 
-			ast::ASTNodePtr stmt = parseStatement();
+			ast::ASTNodePtr stmt = options.recover ? parseStatementOrError() : parseStatement();
 			statements.push_back(std::move(stmt));
 		}
 
@@ -123,11 +128,11 @@ namespace tinyc::parser {
 		ast::ASTNodePtr elseBranch = parseElsePart();
 
 		// Create if statement node
-		return std::make_unique<ast::IfStatementNode>(
+		return context->create<ast::IfStatementNode>(
 				std::move(condition),
 				std::move(thenBranch),
 				std::move(elseBranch),
-				ifToken->getLocation());
+				location(ifToken));
 	}
 
 	ast::ASTNodePtr Parser::parseElsePart() {
@@ -152,23 +157,23 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::LBRACE, "Expected '{' after switch declaration");
 
 		// Parse cases
-		std::vector<ast::SwitchStatementNode::Case> cases = parseCaseWithDefaultStmtStar();
+		ast::SwitchStatementNode::CaseList cases = parseCaseWithDefaultStmtStar();
 
 		expect(lexer::TokenType::RBRACE, "Expected '}' after switch body");
 
 		// Create switch statement node
-		return std::make_unique<ast::SwitchStatementNode>(
+		return context->create<ast::SwitchStatementNode>(
 				std::move(expression),
 				std::move(cases),
-				switchToken->getLocation());
+				location(switchToken));
 	}
 
-	std::vector<ast::SwitchStatementNode::Case> Parser::parseCaseWithDefaultStmtStar() {
+	ast::SwitchStatementNode::CaseList Parser::parseCaseWithDefaultStmtStar() {
 		// Rule 41: CASE_WITH_DEFAULT_STMT_STAR -> CASE_STMT CASE_WITH_DEFAULT_STMT_STAR
 		// Rule 42: CASE_WITH_DEFAULT_STMT_STAR -> ε
 		// Rule 43: CASE_WITH_DEFAULT_STMT_STAR -> DEFAULT_CASE CASE_STMT_STAR
 
-		std::vector<ast::SwitchStatementNode::Case> cases;
+		ast::SwitchStatementNode::CaseList cases(context->getResource());
 
 		if (check(lexer::TokenType::KW_CASE)) {
 			// Rule 41: Start with regular cases
@@ -183,7 +188,8 @@ namespace tinyc::parser {
 					cases.push_back(parseDefaultCase());
 
 					// Parse any remaining cases
-					return parseCaseStmtStar(std::move(cases));
+					parseCaseStmtStar(cases);
+					return cases;
 				}
 			}
 		} else if (check(lexer::TokenType::KW_DEFAULT)) {
@@ -191,22 +197,20 @@ namespace tinyc::parser {
 			cases.push_back(parseDefaultCase());
 
 			// Parse any remaining cases
-			return parseCaseStmtStar(std::move(cases));
+			parseCaseStmtStar(cases);
+			return cases;
 		}
 
 		// If no cases, we're done (Rule 42)
 		return cases;
 	}
 
-	std::vector<ast::SwitchStatementNode::Case> Parser::parseCaseStmtStar(
-			std::vector<ast::SwitchStatementNode::Case> cases) {
+	void Parser::parseCaseStmtStar(ast::SwitchStatementNode::CaseList &cases) {
 		// Rule 44: CASE_STMT_STAR -> CASE_STMT CASE_STMT_STAR
 		// Rule 45: CASE_STMT_STAR -> ε
 		while (check(lexer::TokenType::KW_CASE)) {
 			cases.push_back(parseCaseStmt());
 		}
-
-		return cases;
 	}
 
 	ast::SwitchStatementNode::Case Parser::parseCaseStmt() {
@@ -214,23 +218,21 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::KW_CASE, "Expected 'case'");
 
 		auto intLiteralToken = expect(lexer::TokenType::INTEGER_LITERAL, "Expected integer literal after 'case'");
-		int value = intLiteralToken->getIntValue();
+		int value = lexer.intValue(intLiteralToken);
 
 		expect(lexer::TokenType::COLON, "Expected ':' after case value");
 
 		// Parse case body
-		std::vector<ast::ASTNodePtr> body = parseCaseBody();
+		ast::NodeList body = parseCaseBody();
 
 		// Create case
-		ast::SwitchStatementNode::Case caseNode;
-		caseNode.value = value;
-		caseNode.isDefault = false;
-		caseNode.body = std::move(body);
+		// Constructed in place so the body keeps allocating from the AST context
+		ast::SwitchStatementNode::Case caseNode{value, false, std::move(body)};
 
 		return caseNode;
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseCaseBody() {
+	ast::NodeList Parser::parseCaseBody() {
 		// Rule 47: CASE_BODY -> STATEMENT_STAR
 		return parseStatementStar();
 	}
@@ -241,13 +243,11 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::COLON, "Expected ':' after 'default'");
 
 		// Parse case body
-		std::vector<ast::ASTNodePtr> body = parseCaseBody();
+		ast::NodeList body = parseCaseBody();
 
 		// Create default case
-		ast::SwitchStatementNode::Case defaultCase;
-		defaultCase.value = 0; // Default case value doesn't matter
-		defaultCase.isDefault = true;
-		defaultCase.body = std::move(body);
+		// Default case value doesn't matter
+		ast::SwitchStatementNode::Case defaultCase{0, true, std::move(body)};
 
 		return defaultCase;
 	}
@@ -263,10 +263,10 @@ namespace tinyc::parser {
 		ast::ASTNodePtr body = parseStatement();
 
 		// Create while statement node
-		return std::make_unique<ast::WhileStatementNode>(
+		return context->create<ast::WhileStatementNode>(
 				std::move(condition),
 				std::move(body),
-				whileToken->getLocation());
+				location(whileToken));
 	}
 
 	ast::ASTNodePtr Parser::parseDoWhileStmt() {
@@ -282,10 +282,10 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after do-while statement");
 
 		// Create do-while statement node
-		return std::make_unique<ast::DoWhileStatementNode>(
+		return context->create<ast::DoWhileStatementNode>(
 				std::move(body),
 				std::move(condition),
-				doToken->getLocation());
+				location(doToken));
 	}
 
 	ast::ASTNodePtr Parser::parseForStmt() {
@@ -310,18 +310,18 @@ namespace tinyc::parser {
 		ast::ASTNodePtr body = parseStatement();
 
 		// Create for statement node
-		return std::make_unique<ast::ForStatementNode>(
+		return context->create<ast::ForStatementNode>(
 				std::move(initialization),
 				std::move(condition),
 				std::move(update),
 				std::move(body),
-				forToken->getLocation());
+				location(forToken));
 	}
 
 	ast::ASTNodePtr Parser::parseOptExprOrVarDecl() {
 		// Rule 52: OPT_EXPR_OR_VAR_DECL -> EXPR_OR_VAR_DECL
 		// Rule 53: OPT_EXPR_OR_VAR_DECL -> ε
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
 			case lexer::TokenType::KW_CHAR:
@@ -352,7 +352,7 @@ namespace tinyc::parser {
 	ast::ASTNodePtr Parser::parseOptExpr() {
 		// Rule 54: OPT_EXPR -> EXPR
 		// Rule 55: OPT_EXPR -> ε
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::OP_PLUS:
 			case lexer::TokenType::OP_MINUS:
 			case lexer::TokenType::OP_NOT:
@@ -382,7 +382,7 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after 'break'");
 
 		// Create break statement node
-		return std::make_unique<ast::BreakStatementNode>(breakToken->getLocation());
+		return context->create<ast::BreakStatementNode>(location(breakToken));
 	}
 
 	ast::ASTNodePtr Parser::parseContinueStmt() {
@@ -391,7 +391,7 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after 'continue'");
 
 		// Create continue statement node
-		return std::make_unique<ast::ContinueStatementNode>(continueToken->getLocation());
+		return context->create<ast::ContinueStatementNode>(location(continueToken));
 	}
 
 	ast::ASTNodePtr Parser::parseReturnStmt() {
@@ -400,16 +400,16 @@ namespace tinyc::parser {
 
 		// Parse optional expression
 		ast::ASTNodePtr expression = nullptr;
-		if (currentToken->getType() != lexer::TokenType::SEMICOLON) {
+		if (currentToken.getType() != lexer::TokenType::SEMICOLON) {
 			expression = parseExpr();
 		}
 
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after return statement");
 
 		// Create return statement node
-		return std::make_unique<ast::ReturnStatementNode>(
+		return context->create<ast::ReturnStatementNode>(
 				std::move(expression),
-				returnToken->getLocation());
+				location(returnToken));
 	}
 
 	ast::ASTNodePtr Parser::parseExprStmt() {
@@ -417,7 +417,7 @@ namespace tinyc::parser {
 		auto expr = parseExprOrVarDecl();
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after expression");
 
-		return std::make_unique<ast::ExpressionStatementNode>(
+		return context->create<ast::ExpressionStatementNode>(
 				std::move(expr),
 				expr->getLocation());
 	}
@@ -425,7 +425,7 @@ namespace tinyc::parser {
 	ast::ASTNodePtr Parser::parseExprOrVarDecl() {
 		// Rule 60: EXPR_OR_VAR_DECL -> VAR_DECLS
 		// Rule 61: EXPR_OR_VAR_DECL -> EXPRS
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
 			case lexer::TokenType::KW_CHAR:
@@ -433,7 +433,7 @@ namespace tinyc::parser {
 				return parseVarDecls();
 			case lexer::TokenType::IDENTIFIER: {
 				// Check if the next token is also an identifier, like "Point p"
-				if (lexer.peekNextToken()->getType() == lexer::TokenType::IDENTIFIER){
+				if (lexer.peek().getType() == lexer::TokenType::IDENTIFIER){
 					return parseVarDecls();
 				}
 				else return parseExprs();
@@ -465,9 +465,9 @@ namespace tinyc::parser {
 		// Rule 62: VAR_DECLS -> VAR_DECL VAR_DECLS_TAIL
 		ast::ASTNodePtr decl = parseVarDecl();
 
-		std::vector<ast::ASTNodePtr> declarations;
+		ast::NodeList declarations = context->makeList();
 		declarations.push_back(std::move(decl));
-		declarations = parseVarDeclsTail(std::move(declarations));
+		parseVarDeclsTail(declarations);
 
 		// If only one declaration, return it directly
 		if (declarations.size() == 1) {
@@ -475,25 +475,19 @@ namespace tinyc::parser {
 		}
 
 		// Create a multiple declaration node
-		return std::make_unique<ast::MultipleDeclarationNode>(
+		return context->create<ast::MultipleDeclarationNode>(
 				std::move(declarations),
 				declarations[0]->getLocation());
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseVarDeclsTail(std::vector<ast::ASTNodePtr> declarations) {
+	void Parser::parseVarDeclsTail(ast::NodeList &declarations) {
 		// Rule 63: VAR_DECLS_TAIL -> , VAR_DECL VAR_DECLS_TAIL
 		// Rule 64: VAR_DECLS_TAIL -> ε
-		if (match(lexer::TokenType::COMMA)) {
+		while (match(lexer::TokenType::COMMA)) {
 			// In TinyC, each variable in a comma-separated list must have its own type
 			ast::ASTNodePtr varDecl = parseVarDecl();
 			declarations.push_back(std::move(varDecl));
-
-			// Continue parsing any remaining declarations
-			return parseVarDeclsTail(std::move(declarations));
 		}
-
-		// No more declarations
-		return declarations;
 	}
 
 	ast::ASTNodePtr Parser::parseVarDecl() {
@@ -502,7 +496,7 @@ namespace tinyc::parser {
 
 		auto identifierToken = expect(lexer::TokenType::IDENTIFIER,
 									  "parseVarDecl: Expected variable identifier");
-		std::string identifier = identifierToken->getLexeme();
+		std::string_view identifier = name(identifierToken);
 
 		// Parse optional array size
 		ast::ASTNodePtr arraySize = parseOptArraySize();
@@ -511,10 +505,10 @@ namespace tinyc::parser {
 		ast::ASTNodePtr initializer = parseOptInit();
 
 		// Create variable declaration node
-		return std::make_unique<ast::VariableNode>(
+		return context->create<ast::VariableNode>(
 				std::move(identifier),
 				std::move(type),
-				identifierToken->getLocation(),
+				location(identifierToken),
 				std::move(arraySize),
 				std::move(initializer));
 	}
@@ -523,7 +517,7 @@ namespace tinyc::parser {
 		// Rule 66: OPT_ARRAY_SIZE -> [ E9 ]
 		// Rule 67: OPT_ARRAY_SIZE -> ε
 		if (match(lexer::TokenType::LBRACKET)) {
-			ast::ASTNodePtr size = parseE9();
+			ast::ASTNodePtr size = parseBinaryExpression(LOWEST_PRECEDENCE);
 			expect(lexer::TokenType::RBRACKET, "Expected ']' after array size");
 			return size;
 		}
@@ -6,7 +6,7 @@ namespace tinyc::parser {
 	// Type parsing methods
 
 	ast::ASTNodePtr Parser::parseType() {
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
 			case lexer::TokenType::KW_CHAR: {
@@ -28,14 +28,14 @@ namespace tinyc::parser {
 //				// Handle "struct Name" as a type
 //				auto structToken = consume(); // Consume "struct"
 //				auto nameToken = expect(lexer::TokenType::IDENTIFIER, "Expected struct name after 'struct'");
-//				std::string identifier = nameToken->getLexeme();
+//				std::string_view identifier = lexeme(nameToken);
 //
 //				// Create a named type node that represents a struct type
 //				// We can use a special format like "struct:Name" or just use the name directly
 //				// For simplicity, we'll use "struct:Name" to distinguish from regular named types
-//				ast::ASTNodePtr structType = std::make_unique<ast::NamedTypeNode>(
+//				ast::ASTNodePtr structType = context->create<ast::NamedTypeNode>(
 //						"struct:" + identifier,
-//						structToken->getLocation());
+//						location(structToken));
 //
 //				parseStarSeq(structType);
 //				return structType;
@@ -46,9 +46,9 @@ namespace tinyc::parser {
 				auto voidToken = consume(); // Consume "void"
 
 				// Create void type
-				ast::ASTNodePtr voidType = std::make_unique<ast::PrimitiveTypeNode>(
+				ast::ASTNodePtr voidType = primitiveType(
 						ast::PrimitiveTypeNode::Kind::VOID,
-						voidToken->getLocation());
+						location(voidToken));
 
 				// Parse star plus (at least one star)
 				parseStarPlus(voidType);
@@ -62,7 +62,7 @@ namespace tinyc::parser {
 	}
 
 	ast::ASTNodePtr Parser::parseNonVoidType() {
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
 			case lexer::TokenType::KW_CHAR: {
@@ -75,11 +75,12 @@ namespace tinyc::parser {
 			case lexer::TokenType::IDENTIFIER: {
 				// Rule 77: NON_VOID_TYPE -> TYPENAME STAR_SEQ
 				auto identifierToken = consume();
-				std::string identifier = identifierToken->getLexeme();
+				std::string_view identifier = name(identifierToken);
 
-				ast::ASTNodePtr namedType = std::make_unique<ast::NamedTypeNode>(
+				ast::ASTNodePtr namedType = createType<ast::NamedTypeNode>(
+						ast::NodeKey{ast::NodeKind::NAMED_TYPE, 0, identifier},
 						identifier,
-						identifierToken->getLocation());
+						location(identifierToken));
 
 				parseStarSeq(namedType);
 				return namedType;
@@ -92,45 +93,46 @@ namespace tinyc::parser {
 
 
 	ast::ASTNodePtr Parser::parseNamedType() {
-		lexer::TokenPtr token = currentToken;
+		lexer::TokenRef token = currentToken;
 
-		if (token->getType() != lexer::TokenType::IDENTIFIER) {
+		if (token.getType() != lexer::TokenType::IDENTIFIER) {
 			error("Expected identifier for named type");
 		}
 		auto identifierToken = consume();
-		std::string identifier = identifierToken->getLexeme();
+		std::string_view identifier = name(identifierToken);
 
-		ast::ASTNodePtr namedType = std::make_unique<ast::NamedTypeNode>(
+		ast::ASTNodePtr namedType = createType<ast::NamedTypeNode>(
+				ast::NodeKey{ast::NodeKind::NAMED_TYPE, 0, identifier},
 				identifier,
-				identifierToken->getLocation());
+				location(identifierToken));
 
 		return namedType;
 	}
 
 	ast::ASTNodePtr Parser::parseBaseType() {
-		lexer::TokenPtr token = currentToken;
+		lexer::TokenRef token = currentToken;
 
-		switch (token->getType()) {
+		switch (token.getType()) {
 			case lexer::TokenType::KW_INT:
 				// Rule 78: BASE_TYPE -> int
 				consume();
-				return std::make_unique<ast::PrimitiveTypeNode>(
+				return primitiveType(
 						ast::PrimitiveTypeNode::Kind::INT,
-						token->getLocation());
+						location(token));
 
 			case lexer::TokenType::KW_DOUBLE:
 				// Rule 79: BASE_TYPE -> double
 				consume();
-				return std::make_unique<ast::PrimitiveTypeNode>(
+				return primitiveType(
 						ast::PrimitiveTypeNode::Kind::DOUBLE,
-						token->getLocation());
+						location(token));
 
 			case lexer::TokenType::KW_CHAR:
 				// Rule 80: BASE_TYPE -> char
 				consume();
-				return std::make_unique<ast::PrimitiveTypeNode>(
+				return primitiveType(
 						ast::PrimitiveTypeNode::Kind::CHAR,
-						token->getLocation());
+						location(token));
 
 			default:
 				error("Expected base type (int, double, char)");
@@ -138,7 +140,7 @@ namespace tinyc::parser {
 	}
 
 	ast::ASTNodePtr Parser::parseTypeFunRet() {
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_VOID:
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
@@ -155,15 +157,15 @@ namespace tinyc::parser {
 	}
 
 	ast::ASTNodePtr Parser::parseFunRetTypes() {
-		lexer::TokenPtr token = currentToken;
+		lexer::TokenRef token = currentToken;
 
-		switch (token->getType()) {
+		switch (token.getType()) {
 			case lexer::TokenType::KW_VOID:
 				// Rule 82: FUN_RET_TYPES -> void
 				consume();
-				return std::make_unique<ast::PrimitiveTypeNode>(
+				return primitiveType(
 						ast::PrimitiveTypeNode::Kind::VOID,
-						token->getLocation());
+						location(token));
 
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
@@ -181,9 +183,10 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::OP_MULTIPLY, "Expected '*' for pointer type");
 
 		// Create pointer type
-		baseType = std::make_unique<ast::PointerTypeNode>(
+		baseType = createType<ast::PointerTypeNode>(
+				ast::NodeKey{ast::NodeKind::POINTER_TYPE, 0, {}, baseType.get()},
 				std::move(baseType),
-				currentToken->getLocation());
+				location(currentToken));
 
 		// Parse additional stars if any
 		parseStarSeq(baseType);
@@ -194,9 +197,10 @@ namespace tinyc::parser {
 		// Rule 87: STAR_SEQ -> ε
 		while (match(lexer::TokenType::OP_MULTIPLY)) {
 			// Create pointer type for each star
-			baseType = std::make_unique<ast::PointerTypeNode>(
+			baseType = createType<ast::PointerTypeNode>(
+					ast::NodeKey{ast::NodeKind::POINTER_TYPE, 0, {}, baseType.get()},
 					std::move(baseType),
-					currentToken->getLocation());
+					location(currentToken));
 		}
 
 		// If no stars, we're done (Rule 87)
@@ -206,10 +210,10 @@ namespace tinyc::parser {
 		// Rule 88: STRUCT_DECL -> struct identifier [ '{' { TYPE identifier ';' } '}' ] ';'
 		auto structToken = expect(lexer::TokenType::KW_STRUCT, "Expected 'struct'");
 		auto identifierToken = expect(lexer::TokenType::IDENTIFIER, "Expected struct name");
-		std::string identifier = identifierToken->getLexeme();
+		std::string_view identifier = name(identifierToken);
 
 		// Parse optional struct body
-		std::vector <ast::ASTNodePtr> fields;
+		ast::NodeList fields = context->makeList();
 
 		if (match(lexer::TokenType::LBRACE)) {
 			// Parse struct fields
@@ -219,13 +223,13 @@ namespace tinyc::parser {
 
 				// Parse field name
 				auto fieldNameToken = expect(lexer::TokenType::IDENTIFIER, "Expected field name");
-				std::string fieldIdentifier = fieldNameToken->getLexeme();
+				std::string_view fieldIdentifier = name(fieldNameToken);
 
 				// Create variable declaration node for the field
-				auto field = std::make_unique<ast::VariableNode>(
+				auto field = context->create<ast::VariableNode>(
 						fieldIdentifier,
 						std::move(type),
-						fieldNameToken->getLocation(),
+						location(fieldNameToken),
 						nullptr, // No array size
 						nullptr); // No initializer
 
@@ -240,10 +244,10 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after struct declaration");
 
 		// Create struct declaration node
-		return std::make_unique<ast::StructDeclarationNode>(
+		return context->create<ast::StructDeclarationNode>(
 				identifier,
 				std::move(fields),
-				structToken->getLocation());
+				location(structToken));
 	}
 
 	ast::ASTNodePtr Parser::parseFunPtrDecl() {
@@ -255,29 +259,29 @@ namespace tinyc::parser {
 		expect(lexer::TokenType::OP_MULTIPLY, "Expected '*' for function pointer");
 
 		auto identifierToken = expect(lexer::TokenType::IDENTIFIER, "Expected function pointer name");
-		std::string identifier = identifierToken->getLexeme();
+		std::string_view identifier = name(identifierToken);
 
 		expect(lexer::TokenType::RPAREN, "Expected ')' after function pointer name");
 		expect(lexer::TokenType::LPAREN, "Expected '(' for parameter list");
 
 		// Parse optional parameter types
-		std::vector<ast::ASTNodePtr> parameterTypes = parseOptFunPtrArgs();
+		ast::NodeList parameterTypes = parseOptFunPtrArgs();
 
 		expect(lexer::TokenType::RPAREN, "Expected ')' after parameter list");
 		expect(lexer::TokenType::SEMICOLON, "Expected ';' after function pointer declaration");
 
 		// Create function pointer declaration node
-		return std::make_unique<ast::FunctionPointerDeclarationNode>(
+		return context->create<ast::FunctionPointerDeclarationNode>(
 				identifier,
 				std::move(returnType),
 				std::move(parameterTypes),
-				typedefToken->getLocation());
+				location(typedefToken));
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseOptFunPtrArgs() {
+	ast::NodeList Parser::parseOptFunPtrArgs() {
 		// Rule 95: OPT_FUNPTR_ARGS -> FUNPTR_ARGS
 		// Rule 96: OPT_FUNPTR_ARGS -> ε
-		switch (currentToken->getType()) {
+		switch (currentToken.getType()) {
 			case lexer::TokenType::KW_VOID:
 			case lexer::TokenType::KW_INT:
 			case lexer::TokenType::KW_DOUBLE:
@@ -286,30 +290,27 @@ namespace tinyc::parser {
 
 			default:
 				// Empty parameter list
-				return std::vector<ast::ASTNodePtr>();
+				return context->makeList();
 		}
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseFunPtrArgs() {
+	ast::NodeList Parser::parseFunPtrArgs() {
 		// Rule 97: FUNPTR_ARGS -> TYPE FUNPTR_ARGS_TAIL
 		ast::ASTNodePtr type = parseType();
 
-		std::vector<ast::ASTNodePtr> types;
+		ast::NodeList types = context->makeList();
 		types.push_back(std::move(type));
-		return parseFunPtrArgsTail(std::move(types));
+		parseFunPtrArgsTail(types);
+		return types;
 	}
 
-	std::vector<ast::ASTNodePtr> Parser::parseFunPtrArgsTail(std::vector<ast::ASTNodePtr> types) {
+	void Parser::parseFunPtrArgsTail(ast::NodeList &types) {
 		// Rule 98: FUNPTR_ARGS_TAIL -> , TYPE FUNPTR_ARGS_TAIL
 		// Rule 99: FUNPTR_ARGS_TAIL -> ε
-		if (match(lexer::TokenType::COMMA)) {
+		while (match(lexer::TokenType::COMMA)) {
 			ast::ASTNodePtr type = parseType();
 			types.push_back(std::move(type));
-			return parseFunPtrArgsTail(std::move(types));
 		}
-
-		// No more parameters
-		return types;
 	}
 
 } // namespace tinyc::parser
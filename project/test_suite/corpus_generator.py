@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""
+TinyC Corpus Generator
+
+This script generates valid TinyC programs of a given size and shape, for stress tests and
+for measuring how the lexer and parser scale with the input. The output only depends on the
+arguments, so the same seed always gives the same program.
+
+Shapes:
+- nesting: deeply nested blocks, if, while, do-while and for statements
+- expressions: long expression chains with calls, casts, indexing and parentheses
+- switch: huge switch statements with fallthrough cases
+- structs: many structs, function pointer typedefs and functions using them
+- mixed: all of the above, interleaved
+"""
+
+import argparse
+import random
+import re
+import sys
+from typing import Callable, Dict, List
+
+BINARY_OPERATORS = ['+', '-', '*', '/', '%', '<<', '>>', '<', '<=', '>', '>=', '==', '!=', '&', '|', '&&',
+                    '||']
+PRIMITIVE_TYPES = ['int', 'char', 'double']
+
+
+class Generator:
+    """Emits top-level declarations of one shape; names are numbered so they never clash"""
+
+    def __init__(self, seed: int, max_depth: int):
+        self.random = random.Random(seed)
+        self.max_depth = max_depth
+        self.counter = 0
+        self.struct_names: List[str] = []
+        self.callback_names: List[str] = []
+
+    def name(self, prefix: str) -> str:
+        self.counter += 1
+        return f"{prefix}{self.counter}"
+
+    # Expressions
+
+    def operand(self, variables: List[str]) -> str:
+        choice = self.random.random()
+        if choice < 0.5:
+            return self.random.choice(variables)
+        if choice < 0.8:
+            return str(self.random.randint(0, 1000))
+        if choice < 0.9:
+            return f"!{self.random.choice(variables)}"
+        return f"cast<int>({self.random.choice(variables)})"
+
+    def expression(self, variables: List[str], length: int, depth: int = 0) -> str:
+        """An expression of about length operands, nested at most max_depth parentheses deep"""
+        parts = []
+        remaining = length
+        while remaining > 0:
+            if remaining > 2 and depth < self.max_depth and self.random.random() < 0.15:
+                inner = self.random.randint(2, min(remaining, 8))
+                parts.append(f"({self.expression(variables, inner, depth + 1)})")
+                remaining -= inner
+            else:
+                parts.append(self.operand(variables))
+                remaining -= 1
+            if remaining > 0:
+                parts.append(self.random.choice(BINARY_OPERATORS))
+        return ' '.join(parts)
+
+    # Shapes
+
+    def nesting(self) -> str:
+        """A function nesting statements up to max_depth levels"""
+        name = self.name('nested')
+        depth = self.random.randint(self.max_depth // 2, self.max_depth)
+        lines = [f"int {name}(int x, int y) {{", "    int i = 0;"]
+        closers = []
+        for level in range(depth):
+            indent = '    ' * (level + 1)
+            kind = self.random.choice(['block', 'if', 'while', 'for', 'do'])
+            variable = f"v{level}"
+            if kind == 'block':
+                lines.append(f"{indent}{{")
+                closers.append(f"{indent}}}")
+            elif kind == 'if':
+                lines.append(f"{indent}if (x > {level}) {{")
+                closers.append(f"{indent}}} else {{\n{indent}    y = y - 1;\n{indent}}}")
+            elif kind == 'while':
+                lines.append(f"{indent}while (x < {level}) {{")
+                closers.append(f"{indent}    x = x + 1;\n{indent}}}")
+            elif kind == 'for':
+                lines.append(f"{indent}for (i = 0; i < {level}; i++) {{")
+                closers.append(f"{indent}    if (i == y) break;\n{indent}}}")
+            else:
+                lines.append(f"{indent}do {{")
+                closers.append(f"{indent}}} while (x != {level});")
+            lines.append(f"{indent}    int {variable} = x + {level};")
+            lines.append(f"{indent}    y = y + {variable};")
+        lines.append('    ' * (depth + 1) + "return x + y;")
+        lines.extend(reversed(closers))
+        lines.append("    return y;")
+        lines.append("}")
+        return '\n'.join(lines)
+
+    def expressions(self) -> str:
+        """A function computing long expression chains"""
+        name = self.name('compute')
+        helper = self.name('helper')
+        variables = ['a', 'b', 'c']
+        lines = [f"int {helper}(int a, int b) {{", "    return a * b + 1;", "}", "",
+                 f"int {name}(int a, int b, int c) {{", "    int values[16];"]
+        for i in range(self.random.randint(4, 12)):
+            target = self.name('r')
+            length = self.random.randint(10, 200)
+            lines.append(f"    int {target} = {self.expression(variables, length)};")
+            variables.append(target)
+            # Calls and indexing inside expressions
+            lines.append(f"    values[{i} % 16] = {helper}({target}, a) + values[{self.random.choice(variables)} % 16];")
+        lines.append(f"    return {self.expression(variables, 20)};")
+        lines.append("}")
+        return '\n'.join(lines)
+
+    def switch(self) -> str:
+        """A function with a huge switch statement"""
+        name = self.name('dispatch')
+        cases = self.random.randint(50, 2000)
+        lines = [f"char *{name}(int code) {{", "    char *label;", "    int total = 0;", "    switch (code) {"]
+        value = 0
+        for _ in range(cases):
+            value += self.random.randint(1, 3)
+            lines.append(f"        case {value}:")
+            if self.random.random() < 0.2:
+                continue  # Fall through
+            lines.append(f"            total = total + {value} * code;")
+            lines.append(f"            label = \"case {value}\";")
+            lines.append("            break;")
+        lines.append("        default:")
+        lines.append("            label = \"default\";")
+        lines.append("            break;")
+        lines.append("    }")
+        lines.append("    return label;")
+        lines.append("}")
+        return '\n'.join(lines)
+
+    def structs(self) -> str:
+        """A struct, a function pointer typedef and a function using both
+
+        Function pointer types only take primitive parameter types, so records are passed as void *.
+        """
+        struct = self.name('Record')
+        fields = []
+        for _ in range(self.random.randint(2, 12)):
+            field = self.name('field')
+            if self.struct_names and self.random.random() < 0.3:
+                # Pointers to earlier structs
+                fields.append(f"    {self.random.choice(self.struct_names)} *{field};")
+            else:
+                pointer = '*' if self.random.random() < 0.2 else ''
+                fields.append(f"    {self.random.choice(PRIMITIVE_TYPES)} {pointer}{field};")
+        field_names = [re.search(r'(\w+);$', field).group(1) for field in fields]
+
+        callback = self.name('Callback')
+        function = self.name('visit')
+        lines = [f"struct {struct} {{"] + fields + ["};", "",
+                 f"typedef int (*{callback})(void *, int);", "",
+                 f"int {function}({struct} *record, {callback} callback, int depth) {{",
+                 f"    {struct} copy;",
+                 f"    copy.{self.random.choice(field_names)} = record->{self.random.choice(field_names)};",
+                 f"    {callback} next = callback;"]
+        if self.callback_names:
+            lines.append(f"    {self.random.choice(self.callback_names)} other;")
+        lines += ["    if (depth > 0) {",
+                  f"        return next(cast<void*>(&copy), depth - 1) + {function}(record, callback, depth - 1);",
+                  "    }",
+                  f"    return callback(cast<void*>(record), depth);",
+                  "}"]
+        self.struct_names.append(struct)
+        self.callback_names.append(callback)
+        return '\n'.join(lines)
+
+
+def generate(shape: str, size: int, seed: int, max_depth: int) -> str:
+    """Emit declarations of the shape until the program reaches size bytes"""
+    generator = Generator(seed, max_depth)
+    shapes: Dict[str, Callable[[], str]] = {
+        'nesting': generator.nesting,
+        'expressions': generator.expressions,
+        'switch': generator.switch,
+        'structs': generator.structs,
+    }
+    mixed = list(shapes.values())
+
+    parts = [f"// Generated by corpus_generator.py --shape {shape} --size {size} --seed {seed} "
+             f"--max-depth {max_depth}"]
+    total = len(parts[0])
+    while total < size:
+        emit = generator.random.choice(mixed) if shape == 'mixed' else shapes[shape]
+        part = emit()
+        parts.append(part)
+        total += len(part) + 2
+    parts.append(f"int main() {{\n    return 0;\n}}")
+    return '\n\n'.join(parts) + '\n'
+
+
+def parse_size(text: str) -> int:
+    """Parse a size such as 4096, 64K or 8M"""
+    match = re.fullmatch(r'(\d+)([KkMm]?)', text)
+    if not match:
+        raise argparse.ArgumentTypeError(f"invalid size: {text}")
+    multiplier = {'': 1, 'k': 1024, 'm': 1024 * 1024}[match.group(2).lower()]
+    return int(match.group(1)) * multiplier
+
+
+def main():
+    """Main function"""
+    parser = argparse.ArgumentParser(description='Generate valid TinyC programs of a given size and shape')
+    parser.add_argument('--shape', '-s', default='mixed',
+                        choices=['mixed', 'nesting', 'expressions', 'switch', 'structs'],
+                        help='Kind of declarations to generate (default: mixed)')
+    parser.add_argument('--size', type=parse_size, default=parse_size('64K'),
+                        help='Approximate program size in bytes, with an optional K or M suffix (default: 64K)')
+    parser.add_argument('--seed', type=int, default=0, help='Random seed (default: 0)')
+    parser.add_argument('--max-depth', type=int, default=100,
+                        help='Maximum statement nesting and parenthesis depth (default: 100)')
+    parser.add_argument('--output', '-o', help='Output file (default: standard output)')
+    args = parser.parse_args()
+
+    program = generate(args.shape, args.size, args.seed, args.max_depth)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(program)
+    else:
+        sys.stdout.write(program)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
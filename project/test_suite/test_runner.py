@@ -16,8 +16,14 @@ import os
 import sys
 import re
 import json
+import shlex
+import shutil
+import tempfile
+import threading
+import functools
 import subprocess
 import argparse
+import concurrent.futures
 from typing import Dict, List, Optional, Tuple, NamedTuple, Any, Union
 from jsonschema import validate, ValidationError
 
@@ -163,7 +169,46 @@ def parse_test_file(file_path: str) -> Optional[TinyCTest]:
         return None
 
 
-def run_command(command: str, code: str, temp_file: str = "temp_code.tc") -> Tuple[str, int]:
+def shell_syntax(command: str) -> Optional[str]:
+    """
+    Find shell syntax in a command, which only works when it is run with a shell (--shell).
+
+    Args:
+        command: Command to check
+
+    Returns:
+        The first operator, expansion or variable assignment found, or None
+    """
+    lexer = shlex.shlex(command, posix=True, punctuation_chars=True)
+    lexer.whitespace_split = True
+    tokens = list(lexer)
+    if tokens and re.match(r'^[A-Za-z_][A-Za-z0-9_]*=', tokens[0]):
+        return tokens[0]
+    for token in tokens:
+        if re.fullmatch(r'[();<>|&]+', token) or '$' in token or '`' in token:
+            return token
+    return None
+
+
+def command_line(command: str, cwd: Optional[str] = None) -> List[str]:
+    """
+    Split a command into its arguments, so it can be run without a shell.
+
+    Args:
+        command: Command to split
+        cwd: Directory the command will run in; a relative path to the program is made absolute
+
+    Returns:
+        The arguments
+    """
+    args = shlex.split(command)
+    if cwd and args and os.sep in args[0]:
+        args[0] = os.path.abspath(args[0])
+    return args
+
+
+def run_command(command: str, code: str, temp_file: str = "temp_code.tc", cwd: Optional[str] = None,
+                shell: bool = False) -> Tuple[str, int]:
     """
     Run a command on the provided code and return its output and exit code.
 
@@ -171,17 +216,25 @@ def run_command(command: str, code: str, temp_file: str = "temp_code.tc") -> Tup
         command: Command to run
         code: TinyC code to process
         temp_file: Name of the temporary file to create
+        cwd: Directory to create the file and run the command in (default: the current directory)
+        shell: Run the command with a shell instead of splitting it into arguments
 
     Returns:
         Tuple of (output, exit_code)
     """
+    path = os.path.join(cwd, temp_file) if cwd else temp_file
+
     # Create temporary file with the code
     try:
-        with open(temp_file, 'w') as f:
+        with open(path, 'w') as f:
             f.write(code)
 
         # Run the command
-        result = subprocess.run(f"{command} {temp_file}", shell=True, capture_output=True, text=True)
+        if shell:
+            result = subprocess.run(f"{command} {temp_file}", shell=True, cwd=cwd, capture_output=True, text=True)
+        else:
+            result = subprocess.run(command_line(command, cwd) + [temp_file], cwd=cwd, capture_output=True,
+                                    text=True)
 
         # Combine stdout and stderr for output checking
         output = result.stdout.strip()
@@ -196,8 +249,149 @@ def run_command(command: str, code: str, temp_file: str = "temp_code.tc") -> Tup
         return f"Error: {e}", -1
     finally:
         # Clean up temporary file
-        if os.path.exists(temp_file):
-            os.remove(temp_file)
+        if os.path.exists(path):
+            os.remove(path)
+
+
+class CompilerServer:
+    """
+    A compiler started once in server mode (--server), answering a request per test configuration.
+
+    Saves starting a process and writing a temporary file for every configuration. Requests and
+    responses use the length-prefixed protocol described in include/tinyc/driver/Server.h.
+    """
+
+    # Server request mode for each run type it can handle; the others still run the command
+    MODES = {'parser': 'parse'}
+
+    def __init__(self, command: str, shell: bool = False):
+        arguments = f"{command} --server" if shell else command_line(command) + ["--server"]
+        self.process = subprocess.Popen(arguments, shell=shell, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+    def supports(self, run_type: str) -> bool:
+        return run_type in self.MODES
+
+    def run(self, run_type: str, code: str, name: str = "temp_code.tc") -> Tuple[str, int]:
+        """
+        Compile code on the server, with the same output and exit code as run_command.
+
+        Args:
+            run_type: Run type of the configuration (see supports())
+            code: TinyC code to process
+            name: Source name reported in locations and errors
+
+        Returns:
+            Tuple of (output, exit_code)
+        """
+        try:
+            source = code.encode()
+            self.process.stdin.write(f"{self.MODES[run_type]} {len(source)} name={name}\n".encode() + source)
+            self.process.stdin.flush()
+
+            header = self.process.stdout.readline().split()
+            if len(header) != 3:
+                raise RuntimeError("server closed the connection")
+            exit_code, output_length, diagnostics_length = map(int, header)
+            stdout = self.process.stdout.read(output_length).decode().strip()
+            stderr = self.process.stdout.read(diagnostics_length).decode().strip()
+
+            # Combine stdout and stderr as run_command does
+            output = stdout
+            if stderr:
+                if output:
+                    output += "\n"
+                output += stderr
+
+            return output, exit_code
+        except Exception as e:
+            print(f"Error running command: {e}")
+            return f"Error: {e}", -1
+
+    def close(self):
+        try:
+            self.process.stdin.write(b"quit\n")
+            self.process.stdin.close()
+        except OSError:
+            pass
+        self.process.wait()
+
+
+class Worker:
+    """
+    What one worker thread runs test configurations with: a temporary directory of its own for
+    the code files of run_command, and its own compiler server if one is used. With a shell, the
+    command runs in the current directory as written, so there is a single worker.
+    """
+
+    def __init__(self, command: str, server: bool, shell: bool = False):
+        self.shell = shell
+        self.directory = None if shell else tempfile.mkdtemp(prefix="tinyc-test-")
+        self.server = CompilerServer(command, shell) if server else None
+
+    def run(self, run_type: str, command: str, code: str) -> Tuple[str, int]:
+        """
+        Run a configuration on the server if it supports the run type, otherwise run the command.
+
+        Returns:
+            Tuple of (output, exit_code)
+        """
+        if self.server and self.server.supports(run_type):
+            return self.server.run(run_type, code)
+        return run_command(command, code, cwd=self.directory, shell=self.shell)
+
+    def close(self):
+        if self.server:
+            self.server.close()
+        if self.directory:
+            shutil.rmtree(self.directory, ignore_errors=True)
+
+
+class WorkerPool:
+    """
+    Threads running test configurations, each with a Worker of its own.
+
+    The compiler runs in other processes, so the threads wait in parallel; results are returned
+    in submission order.
+    """
+
+    def __init__(self, command: str, jobs: int, server: bool, shell: bool = False):
+        self.command = command
+        self.server = server
+        self.shell = shell
+        self.local = threading.local()
+        self.workers: List[Worker] = []
+        self.lock = threading.Lock()
+        self.executor = concurrent.futures.ThreadPoolExecutor(max_workers=jobs)
+
+    def _worker(self) -> Worker:
+        worker = getattr(self.local, 'worker', None)
+        if worker is None:
+            worker = Worker(self.command, self.server, self.shell)
+            self.local.worker = worker
+            with self.lock:
+                self.workers.append(worker)
+        return worker
+
+    def map(self, tasks: List[Tuple[str, str, str]]):
+        """
+        Run (run_type, command, code) tasks, yielding their (output, exit_code) in order.
+        """
+        return self.executor.map(lambda task: self._worker().run(*task), tasks)
+
+    def close(self):
+        self.executor.shutdown()
+        for worker in self.workers:
+            worker.close()
+
+
+@functools.lru_cache(maxsize=None)
+def load_schema() -> Dict[str, Any]:
+    """
+    Load the JSON schema of the AST once per run.
+    """
+    schema_path = os.path.join(os.path.dirname(__file__), 'tinyc-ast-schema.json')
+    with open(schema_path, 'r') as f:
+        return json.load(f)
 
 
 def compare_json_objects(expected: Dict[str, Any], actual: Dict[str, Any], path: str = "") -> Tuple[bool, List[str]]:
@@ -285,13 +479,9 @@ def validate_parser_output(config: TestConfig, actual_output: str, verbose: bool
         # For success tests, validate the JSON output
         try:
             # First validate against schema
-            schema_path = os.path.join(os.path.dirname(__file__), 'tinyc-ast-schema.json')
-            with open(schema_path, 'r') as f:
-                schema = json.load(f)
-            
             actual_json = json.loads(actual_output)
             try:
-                validate(instance=actual_json, schema=schema)
+                validate(instance=actual_json, schema=load_schema())
             except ValidationError as e:
                 return False, f"JSON schema validation failed: {str(e)}"
 
@@ -482,7 +672,7 @@ def get_test_files(test_dir: str, test_num: Optional[int] = None,
 
 def run_tests(base_command: str, test_dir: str, test_num: Optional[int] = None,
               test_range: Optional[Tuple[int, int]] = None, run_type_filter: Optional[str] = None,
-              verbose: bool = False) -> Tuple[int, int]:
+              verbose: bool = False, jobs: int = 1, server: bool = False, shell: bool = False) -> Tuple[int, int]:
     """
     Run tests against the TinyC compiler.
 
@@ -493,6 +683,9 @@ def run_tests(base_command: str, test_dir: str, test_num: Optional[int] = None,
         test_range: If provided, only run tests in this range (start, end) inclusive
         run_type_filter: If provided, only run test configs with this run type
         verbose: Whether to print detailed comparison information
+        jobs: Number of configurations run at the same time
+        server: Run the configurations the server supports on a compiler in server mode, one per job
+        shell: Run the command with a shell, in the current directory (needs jobs == 1)
 
     Returns:
         Tuple of (passed_count, failed_count)
@@ -535,77 +728,118 @@ def run_tests(base_command: str, test_dir: str, test_num: Optional[int] = None,
         'typechecker': '--typecheck'
     }
 
-    for i, test_file in enumerate(test_files, 1):
+    # Parse every test file first, so configurations can run while earlier results are reported
+    tests = []
+    tasks = []
+    for test_file in test_files:
         test = parse_test_file(test_file)
-        if not test:
-            print(f"Skipping invalid test file: {test_file}")
-            continue
+        filtered_configs = [c for c in test.configs if run_type_filter is None or c.run_type == run_type_filter] \
+            if test else []
+        tests.append((test_file, test, filtered_configs))
 
-        print(f"\nTest file {i}/{len(test_files)}: {test.name}")
-        print(f"  Description: {test.description}")
+        for config in filtered_configs:
+            # Choose the appropriate command based on the run type
+            cmd_arg = command_args.get(config.run_type, '')
+            cmd = f"{base_command} {cmd_arg}".strip()
+            tasks.append((config.run_type, cmd, test.code))
 
-        # Count configs that match the filter
-        filtered_configs = [c for c in test.configs if run_type_filter is None or c.run_type == run_type_filter]
-        total_configs += len(filtered_configs)
+    pool = WorkerPool(base_command, jobs, server, shell)
+    try:
+        results = pool.map(tasks)
+        for i, (test_file, test, filtered_configs) in enumerate(tests, 1):
+            test_passed, test_failed, configs = report_test(i, len(test_files), test_file, test, filtered_configs,
+                                                            results, validation_functions, run_type_filter, verbose)
+            passed += test_passed
+            failed += test_failed
+            total_configs += configs
+    finally:
+        pool.close()
 
-        if not filtered_configs:
-            if run_type_filter:
-                print(f"  Skipping - no configurations for run type '{run_type_filter}'")
-            else:
-                print(f"  Warning: No valid test configurations found")
+    return passed, failed
+
+
+def report_test(index: int, count: int, test_file: str, test: Optional[TinyCTest], filtered_configs: List[TestConfig],
+                results, validation_functions, run_type_filter: Optional[str], verbose: bool) -> Tuple[int, int, int]:
+    """
+    Validate and print the results of the configurations of one test file.
+
+    Args:
+        index: Position of the test file in the run (1-based)
+        count: Number of test files in the run
+        test_file: Path to the test file
+        test: The parsed test, None if the file is invalid
+        filtered_configs: The configurations of the test that were run
+        results: Iterator over the (output, exit_code) of the configurations, in order
+        validation_functions: Validation function for each run type
+        run_type_filter: Run type the configurations were filtered by, if any
+        verbose: Whether to print detailed comparison information
+
+    Returns:
+        Tuple of (passed_count, failed_count, config_count)
+    """
+    passed = 0
+    failed = 0
+
+    if not test:
+        print(f"Skipping invalid test file: {test_file}")
+        return 0, 0, 0
+
+    print(f"\nTest file {index}/{count}: {test.name}")
+    print(f"  Description: {test.description}")
+
+    if not filtered_configs:
+        if run_type_filter:
+            print(f"  Skipping - no configurations for run type '{run_type_filter}'")
+        else:
+            print(f"  Warning: No valid test configurations found")
+        return 0, 0, 0
+
+    # Report each test configuration
+    for j, config in enumerate(filtered_configs, 1):
+        print(f"  Configuration {j}/{len(filtered_configs)}: {config.run_type} (Expect: {config.expect})")
+
+        actual_output, exit_code = next(results)
+
+        # Check for catastrophic failure
+        if not actual_output and exit_code != 0 and config.expect == 'SUCCESS':
+            print(f"    ❌ FAILED (Command failed with exit code {exit_code})")
+            failed += 1
             continue
 
-        # Run each test configuration
-        for j, config in enumerate(filtered_configs, 1):
-            print(f"  Configuration {j}/{len(filtered_configs)}: {config.run_type} (Expect: {config.expect})")
+        # Get the appropriate validation function
+        validation_func = validation_functions.get(config.run_type)
+        if not validation_func:
+            print(f"    ❌ FAILED (No validation function for run type: {config.run_type})")
+            failed += 1
+            continue
 
-            # Choose the appropriate command based on the run type
-            cmd_arg = command_args.get(config.run_type, '')
-            cmd = f"{base_command} {cmd_arg}".strip()
+        # Validate the output
+        if config.run_type == 'exec':
+            passed_test, error_msg = validation_func(config, actual_output, exit_code, verbose)
+        else:
+            passed_test, error_msg = validation_func(config, actual_output, verbose)
 
-            # Run the command on the test code
-            actual_output, exit_code = run_command(cmd, test.code)
-
-            # Check for catastrophic failure
-            if not actual_output and exit_code != 0 and config.expect == 'SUCCESS':
-                print(f"    ❌ FAILED (Command failed with exit code {exit_code})")
-                failed += 1
-                continue
-
-            # Get the appropriate validation function
-            validation_func = validation_functions.get(config.run_type)
-            if not validation_func:
-                print(f"    ❌ FAILED (No validation function for run type: {config.run_type})")
-                failed += 1
-                continue
-
-            # Validate the output
-            if config.run_type == 'exec':
-                passed_test, error_msg = validation_func(config, actual_output, exit_code, verbose)
-            else:
-                passed_test, error_msg = validation_func(config, actual_output, verbose)
+        if passed_test:
+            print(f"    ✅ PASSED")
+            passed += 1
+        else:
+            print(f"    ❌ FAILED")
+            if error_msg:
+                print(f"    {error_msg}")
+
+            # Show preview of expected/actual (for non-verbose mode)
+            if not verbose:
+                if config.expect == 'SUCCESS' and config.result:
+                    expected_preview = config.result[:80] + "..." if len(config.result) > 80 else config.result
+                    actual_preview = actual_output[:80] + "..." if len(actual_output) > 80 else actual_output
+                    print(f"    Expected: {expected_preview}")
+                    print(f"    Actual  : {actual_preview}")
+                else:
+                    print(f"    Actual output: {actual_output[:80]}" + ("..." if len(actual_output) > 80 else ""))
 
-            if passed_test:
-                print(f"    ✅ PASSED")
-                passed += 1
-            else:
-                print(f"    ❌ FAILED")
-                if error_msg:
-                    print(f"    {error_msg}")
-
-                # Show preview of expected/actual (for non-verbose mode)
-                if not verbose:
-                    if config.expect == 'SUCCESS' and config.result:
-                        expected_preview = config.result[:80] + "..." if len(config.result) > 80 else config.result
-                        actual_preview = actual_output[:80] + "..." if len(actual_output) > 80 else actual_output
-                        print(f"    Expected: {expected_preview}")
-                        print(f"    Actual  : {actual_preview}")
-                    else:
-                        print(f"    Actual output: {actual_output[:80]}" + ("..." if len(actual_output) > 80 else ""))
-
-                failed += 1
+            failed += 1
 
-    return passed, failed
+    return passed, failed, len(filtered_configs)
 
 
 def parse_range(range_str: str) -> Optional[Tuple[int, int]]:
@@ -639,6 +873,14 @@ def main():
     parser.add_argument('--test-dir', '-d', default='tests', help='Directory containing test files (default: tests)')
     parser.add_argument('--verbose', '-v', action='store_true', help='Enable verbose output with detailed differences')
     parser.add_argument('--skip-schema', action='store_true', help='Skip JSON schema validation')
+    parser.add_argument('--server', action='store_true',
+                        help='Start the compiler once in server mode (once per job) instead of once per test '
+                             'configuration')
+    parser.add_argument('--shell', action='store_true',
+                        help='Run the command with a shell, in the current directory, so it can use shell syntax '
+                             '(variable assignments, redirections, pipelines); needs --jobs 1')
+    parser.add_argument('--jobs', '-j', type=int, default=1,
+                        help='Number of test configurations run at the same time, 0 for one per CPU (default: 1)')
 
     # Add optional filter for run type
     parser.add_argument('--run-type', '-rt', help='Only run test configurations of a specific type')
@@ -665,7 +907,25 @@ def main():
         print("Install it using: pip install jsonschema")
         return 1
 
-    passed, failed = run_tests(args.command, args.test_dir, args.test, test_range, args.run_type, args.verbose)
+    if args.jobs < 0:
+        print(f"Invalid number of jobs: {args.jobs}")
+        return 1
+    jobs = args.jobs or os.cpu_count() or 1
+
+    # Without a shell, shell syntax would be passed to the compiler as arguments
+    if args.shell:
+        if jobs != 1:
+            print("Error: --shell runs the command in the current directory and needs --jobs 1")
+            return 1
+    else:
+        syntax = shell_syntax(args.command)
+        if syntax is not None:
+            print(f"Error: The command uses shell syntax ({syntax}), but commands run without a shell; "
+                  f"pass --shell to run it with one")
+            return 1
+
+    passed, failed = run_tests(args.command, args.test_dir, args.test, test_range, args.run_type, args.verbose,
+                               jobs, args.server, args.shell)
 
     print("\n" + "=" * 50)
     print(f"Test Results: {passed} passed, {failed} failed")
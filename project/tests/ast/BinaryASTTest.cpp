@@ -0,0 +1,167 @@
+#include "tinyc/ast/BinaryAST.h"
+#include "tinyc/ast/visitors/BinaryVisitor.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	// Uses every node class, optional children both present and absent, and repeated strings
+	const char *const PROGRAM = R"(
+struct Point { int x; int y; };
+struct Opaque;
+typedef int (*Compare)(int, int);
+int a, int b = 2, int c[10];
+double d = 1.5;
+char *s = "a\tb";
+int compare(int x, int y);
+void run(Point *p, Point q) {
+	int i = 0;
+	if (i < 10) i++; else --i;
+	if (!a) a = ~b;
+	while (a != 0 && b >= 1) { a = a - 1; continue; }
+	do { b = -b; } while (b << 1 > 0);
+	for (i = 0; i < 3; i++) { c[i] = cast<int>(d) * 2; }
+	for (;;) break;
+	switch (i) { case 1: a = 1; break; case 2: default: a = 'x'; }
+	p->x = q.y, *s = *&s[0];
+	compare(a, b);
+	return;
+}
+int main() { return compare(1, 2) % 3; }
+)";
+
+	ASTNodePtr parse(const std::string &source, const std::string &name = "<test>") {
+		lexer::Lexer lexer(source, name);
+		parser::Parser parser(lexer);
+		return parser.parseProgram();
+	}
+
+	std::string toJSON(const ASTNode &node) {
+		JSONVisitor visitor(true);
+		node.accept(visitor);
+		return visitor.getJSON();
+	}
+
+	std::string toBinary(const ASTNode &node) {
+		BinaryVisitor visitor;
+		node.accept(visitor);
+		return visitor.getBinary();
+	}
+
+	void collectKinds(const BinaryNodeView &view, std::set<NodeKind> &kinds) {
+		if (!view.isCase()) {
+			kinds.insert(view.kind());
+		}
+		for (std::size_t i = 0; i < view.childCount(); ++i) {
+			if (view.hasChild(i)) {
+				collectKinds(view.child(i), kinds);
+			}
+		}
+	}
+
+} // namespace
+
+// Test that a tree survives being written and read back
+TEST(BinaryASTTest, RoundTrip) {
+	auto original = parse(PROGRAM);
+	std::string bytes = toBinary(*original);
+
+	BinaryAST binary = BinaryAST::fromBytes(bytes);
+	EXPECT_EQ(binary.size(), bytes.size());
+
+	auto restored = readTree(binary);
+	EXPECT_EQ(toJSON(*restored), toJSON(*original));
+
+	// Serializing the restored tree gives the same bytes
+	EXPECT_EQ(toBinary(*restored), bytes);
+}
+
+// Test walking a binary AST without rebuilding the tree
+TEST(BinaryASTTest, WalkInPlace) {
+	auto original = parse(PROGRAM);
+	BinaryAST binary = BinaryAST::fromBytes(toBinary(*original));
+
+	std::set<NodeKind> kinds;
+	collectKinds(binary.root(), kinds);
+	// Every kind but ERROR_NODE, which only a recovering parse produces
+	EXPECT_EQ(kinds.size(), static_cast<std::size_t>(NODE_KIND_COUNT) - 1);
+	EXPECT_EQ(kinds.count(NodeKind::ERROR_NODE), 0u);
+
+	BinaryNodeView root = binary.root();
+	EXPECT_EQ(root.kind(), NodeKind::PROGRAM);
+	EXPECT_EQ(root.fileName(), "<test>");
+
+	// struct Point { int x; int y; };
+	BinaryNodeView point = root.child(0);
+	EXPECT_EQ(point.kind(), NodeKind::STRUCT_DECLARATION);
+	EXPECT_EQ(point.text(), "Point");
+	EXPECT_EQ(point.line(), 2);
+	ASSERT_EQ(point.childCount(), 2u);
+	EXPECT_EQ(point.child(1).text(), "y");
+	EXPECT_EQ(point.child(1).child(0).detail(), static_cast<int>(PrimitiveTypeNode::Kind::INT));
+
+	// int a, int b = 2, int c[10];
+	BinaryNodeView variables = root.child(3);
+	EXPECT_EQ(variables.kind(), NodeKind::MULTIPLE_DECLARATION);
+	EXPECT_FALSE(variables.child(0).hasChild(2));
+	EXPECT_EQ(variables.child(1).child(2).text(), "2");
+	EXPECT_EQ(variables.child(2).child(1).kind(), NodeKind::LITERAL);
+
+	EXPECT_THROW(static_cast<void>(point.child(2)), BinaryFormatError);
+}
+
+// Test reading a binary AST from a file
+TEST(BinaryASTTest, MappedFile) {
+	auto original = parse(PROGRAM, "mapped.tc");
+	std::string path = testing::TempDir() + "tinyc_binary_ast.tcast";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << toBinary(*original);
+	}
+
+	{
+		BinaryAST binary = BinaryAST::fromFile(path);
+		EXPECT_EQ(binary.root().fileName(), "mapped.tc");
+		EXPECT_EQ(toJSON(*readTree(binary)), toJSON(*original));
+	}
+	std::remove(path.c_str());
+}
+
+// Test that malformed input is rejected rather than read out of bounds
+TEST(BinaryASTTest, RejectsMalformedInput) {
+	std::string bytes = toBinary(*parse("int main() { return 1 + 2; }"));
+
+	EXPECT_THROW(BinaryAST::fromBytes(""), BinaryFormatError);
+	EXPECT_THROW(BinaryAST::fromBytes(bytes.substr(0, bytes.size() - 1)), BinaryFormatError);
+	EXPECT_THROW(BinaryAST::fromBytes("TCAB" + bytes.substr(4, 20)), BinaryFormatError);
+
+	std::string badMagic = bytes;
+	badMagic[0] = 'X';
+	EXPECT_THROW(BinaryAST::fromBytes(badMagic), BinaryFormatError);
+
+	std::string badVersion = bytes;
+	badVersion[4] = 99;
+	EXPECT_THROW(BinaryAST::fromBytes(badVersion), BinaryFormatError);
+
+	// Point the root's first child back at the root
+	std::string cycle = bytes;
+	std::uint32_t self = 0;
+	std::size_t childTable = sizeof(binary::Header) + BinaryAST::fromBytes(bytes).nodeCount() * sizeof(binary::NodeRecord);
+	std::memcpy(&cycle[childTable], &self, sizeof(self));
+	EXPECT_THROW(readTree(BinaryAST::fromBytes(cycle)), BinaryFormatError);
+
+	// An unknown node kind
+	std::string badKind = bytes;
+	badKind[sizeof(binary::Header) + sizeof(binary::NodeRecord)] = 100;
+	EXPECT_THROW(readTree(BinaryAST::fromBytes(badKind)), BinaryFormatError);
+}
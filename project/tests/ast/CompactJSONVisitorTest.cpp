@@ -0,0 +1,63 @@
+#include "tinyc/ast/visitors/CompactJSONVisitor.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	// Parse a source, recovering from errors, and write it with both visitors
+	void expectSameJSON(const std::string &source, const std::string &name) {
+		lexer::Lexer lexer(source, name);
+		parser::ParserOptions options;
+		options.recover = true;
+		parser::Parser parser(lexer, options);
+		ASTNodePtr program = parser.parseProgram();
+
+		JSONVisitor reference(false);
+		program->accept(reference);
+
+		StringSink sink;
+		CompactJSONVisitor compact(sink);
+		program->accept(compact);
+
+		EXPECT_EQ(sink.str(), reference.getJSON());
+	}
+
+} // namespace
+
+// Test that every kind of node is written as JSONVisitor writes it without pretty printing
+TEST(CompactJSONVisitorTest, MatchesJSONVisitor) {
+	expectSameJSON("struct Point { int x; double y; };\n"
+				   "struct Opaque;\n"
+				   "typedef int (*Operation)(int, char*);\n"
+				   "int count, limit = 10, table[4];\n"
+				   "void declared(void* p);\n"
+				   "int apply(Operation op, struct Point* p, char c) {\n"
+				   "    int values[3];\n"
+				   "    double d = 1.5e3 + 0.25;\n"
+				   "    char* s = \"tab\\there \\\"quoted\\\"\\n\";\n"
+				   "    p->x = op(p->x, s) * -values[2] % 7;\n"
+				   "    (*p).y = cast<double>(c) / 2.0;\n"
+				   "    if (!c && ~count || c != 'a') { ++count; } else count--;\n"
+				   "    while (count < limit) { count += 1, limit <<= 1; continue; }\n"
+				   "    do { --limit; } while (limit >= 0);\n"
+				   "    for (int i = 0; i <= 3; i++) { values[i] = i >> 1 & 1 | 2; }\n"
+				   "    for (;;) break;\n"
+				   "    switch (c) { case 1: count = 1; break; case 2: case 3: default: return &count == 0; }\n"
+				   "    switch (count) { }\n"
+				   "    return 0;\n"
+				   "}\n", "compact.tc");
+}
+
+// Test file names and values that need escaping, and error nodes of a recovered parse
+TEST(CompactJSONVisitorTest, EscapesLikeJSONVisitor) {
+	expectSameJSON("char* s = \"caf\xc3\xa9 \\\\ \x01\";\n"
+				   "int broken = ;\n"
+				   "char c = '\\'';\n", "dir\\with \"quotes\"\t.tc");
+	expectSameJSON("", "empty.tc");
+}
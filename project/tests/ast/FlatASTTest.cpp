@@ -0,0 +1,181 @@
+#include "tinyc/ast/FlatAST.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	const char *const PROGRAM = R"(
+struct Point { int x; int y; };
+typedef int (*Compare)(int, int);
+int a, int b = 2, int c[10];
+char *s = "text";
+int compare(int x, int y);
+void run(Point *p) {
+	for (;;) break;
+	for (a = 0; a < 3; a++) { c[a] = cast<int>(1.5) * 2; }
+	if (a) a = -b; else { p->x = s[0]; }
+	switch (a) { case 1: a = 1; break; default: a = 'x'; }
+	do { b = b - 1; } while (b > a);
+	return;
+}
+int main() { return compare(1, 2) % 3; }
+)";
+
+	ASTNodePtr parse(const std::string &source) {
+		lexer::Lexer lexer(source, "<flat>");
+		parser::Parser parser(lexer);
+		return parser.parseProgram();
+	}
+
+	FlatAST parseFlat(const std::string &source) {
+		lexer::Lexer lexer(source, "<flat>");
+		parser::Parser parser(lexer);
+		return parser.parseProgramFlat();
+	}
+
+	// Find the first node of a kind after a given index
+	std::uint32_t find(const FlatAST &flat, NodeKind kind, std::uint32_t from = 0) {
+		const auto &kinds = flat.kinds();
+		auto it = std::find(kinds.begin() + from, kinds.end(), static_cast<std::uint8_t>(kind));
+		return it == kinds.end() ? FlatAST::NONE : static_cast<std::uint32_t>(it - kinds.begin());
+	}
+
+} // namespace
+
+// Test that parsing directly into a flat AST gives the same nodes as flattening the tree
+TEST(FlatASTTest, ParserMatchesConversion) {
+	FlatAST direct = parseFlat(PROGRAM);
+	FlatAST converted = FlatAST::fromTree(*parse(PROGRAM));
+
+	ASSERT_EQ(direct.size(), converted.size());
+	for (std::uint32_t i = 0; i < direct.size(); ++i) {
+		SCOPED_TRACE(i);
+		EXPECT_EQ(direct.kinds()[i], converted.kinds()[i]);
+		EXPECT_EQ(direct.detail(i), converted.detail(i));
+		EXPECT_EQ(direct.parent(i), converted.parent(i));
+		EXPECT_EQ(direct.firstChild(i), converted.firstChild(i));
+		EXPECT_EQ(direct.nextSibling(i), converted.nextSibling(i));
+		EXPECT_EQ(direct.slot(i), converted.slot(i));
+		EXPECT_EQ(direct.text(i), converted.text(i));
+		EXPECT_EQ(direct.value(i), converted.value(i));
+		EXPECT_EQ(direct.location(i).line, converted.location(i).line);
+		EXPECT_EQ(direct.location(i).column, converted.location(i).column);
+		EXPECT_EQ(direct.location(i).getFilename(), converted.location(i).getFilename());
+	}
+}
+
+// Test the pre-order layout and the links between nodes
+TEST(FlatASTTest, Layout) {
+	FlatAST flat = parseFlat(PROGRAM);
+	ASSERT_GT(flat.size(), 0u);
+	EXPECT_EQ(flat.kind(0), NodeKind::PROGRAM);
+	EXPECT_EQ(flat.parent(0), FlatAST::NONE);
+	EXPECT_EQ(flat.subtreeEnd(0), flat.size());
+
+	for (std::uint32_t i = 0; i < flat.size(); ++i) {
+		SCOPED_TRACE(i);
+		if (i > 0) {
+			EXPECT_LT(flat.parent(i), i);
+		}
+		if (flat.firstChild(i) != FlatAST::NONE) {
+			EXPECT_EQ(flat.firstChild(i), i + 1);
+			EXPECT_EQ(flat.parent(i + 1), i);
+		}
+		if (flat.nextSibling(i) != FlatAST::NONE) {
+			EXPECT_EQ(flat.nextSibling(i), flat.subtreeEnd(i));
+			EXPECT_EQ(flat.parent(flat.nextSibling(i)), flat.parent(i));
+		}
+	}
+
+	// for (;;) break; has only its body
+	std::uint32_t emptyFor = find(flat, NodeKind::FOR_STATEMENT);
+	ASSERT_NE(emptyFor, FlatAST::NONE);
+	EXPECT_EQ(flat.child(emptyFor, 0), FlatAST::NONE);
+	EXPECT_EQ(flat.child(emptyFor, 2), FlatAST::NONE);
+	EXPECT_EQ(flat.kind(flat.child(emptyFor, 3)), NodeKind::BREAK_STATEMENT);
+	EXPECT_EQ(flat.kind(flat.child(find(flat, NodeKind::FOR_STATEMENT, emptyFor + 1), 0)),
+			  NodeKind::BINARY_EXPRESSION);
+
+	// void run(Point *p) { ... }: the parameter precedes the body but keeps its slot
+	std::uint32_t run = find(flat, NodeKind::FUNCTION_DECLARATION, find(flat, NodeKind::FUNCTION_DECLARATION) + 1);
+	EXPECT_EQ(flat.text(run), "run");
+	std::uint32_t parameter = flat.child(run, 2);
+	std::uint32_t body = flat.child(run, 1);
+	EXPECT_EQ(flat.kind(parameter), NodeKind::PARAMETER);
+	EXPECT_EQ(flat.kind(body), NodeKind::BLOCK_STATEMENT);
+	EXPECT_LT(parameter, body);
+	EXPECT_EQ(flat.location(run).line, 7);
+
+	// switch (a) { case 1: ... default: ... }
+	std::uint32_t switchNode = find(flat, NodeKind::SWITCH_STATEMENT);
+	std::uint32_t firstCase = flat.child(switchNode, 1);
+	std::uint32_t defaultCase = flat.child(switchNode, 2);
+	ASSERT_TRUE(flat.isCase(firstCase));
+	EXPECT_EQ(flat.value(firstCase), 1);
+	EXPECT_EQ(flat.detail(firstCase), 0);
+	EXPECT_EQ(flat.detail(defaultCase), 1);
+	EXPECT_EQ(flat.kind(flat.firstChild(defaultCase)), NodeKind::EXPRESSION_STATEMENT);
+}
+
+// Test a pass implemented as a linear scan of the arrays
+TEST(FlatASTTest, LinearScan) {
+	FlatAST flat = parseFlat("int f(int a) { return a + g(a, b) * a; }");
+
+	// Count the uses of each identifier without walking the tree
+	int uses = 0;
+	for (std::uint32_t i = 0; i < flat.size(); ++i) {
+		if (flat.kinds()[i] == static_cast<std::uint8_t>(NodeKind::IDENTIFIER) && flat.text(i) == "a") {
+			++uses;
+		}
+	}
+	EXPECT_EQ(uses, 3);
+
+	// The subtree of the return statement is a contiguous range
+	std::uint32_t ret = find(flat, NodeKind::RETURN_STATEMENT);
+	EXPECT_EQ(flat.subtreeEnd(ret), flat.size());
+	EXPECT_EQ(flat.detail(ret + 1), static_cast<std::uint8_t>(BinaryExpressionNode::Operator::ADD));
+}
+
+// Test that a subtree can only be appended where it keeps the nodes in pre-order
+TEST(FlatASTTest, AppendKeepsPreOrder) {
+	FlatAST flat;
+	flat.append(ProgramNode("<append>"), FlatAST::NONE);
+	EXPECT_THROW(flat.append(ProgramNode("<append>"), FlatAST::NONE), std::invalid_argument);
+
+	BreakStatementNode first{lexer::SourceLocation()};
+	ContinueStatementNode second{lexer::SourceLocation()};
+	EXPECT_EQ(flat.append(first, 0), 1u);
+	EXPECT_EQ(flat.append(second, 0), 2u);
+	EXPECT_EQ(flat.slot(2), 1u);
+	EXPECT_EQ(flat.nextSibling(1), 2u);
+
+	// Node 1 is no longer on the path to the last node
+	EXPECT_THROW(flat.append(second, 1), std::invalid_argument);
+}
+
+// Test that a recovering parse flattens its error nodes
+TEST(FlatASTTest, ErrorNodes) {
+	parser::ParserOptions options;
+	options.recover = true;
+	lexer::Lexer lexer("int a = ;\nvoid f() { x = ; return; }\n", "<flat>");
+	parser::Parser parser(lexer, options);
+	FlatAST flat = parser.parseProgramFlat();
+	ASSERT_EQ(parser.getDiagnostics().size(), 2u);
+
+	std::uint32_t first = find(flat, NodeKind::ERROR_NODE);
+	ASSERT_NE(first, FlatAST::NONE);
+	EXPECT_EQ(flat.parent(first), 0u);
+	EXPECT_EQ(flat.text(first), "Expected expression");
+	EXPECT_EQ(flat.location(first).line, 1);
+
+	std::uint32_t second = find(flat, NodeKind::ERROR_NODE, first + 1);
+	ASSERT_NE(second, FlatAST::NONE);
+	EXPECT_EQ(flat.kind(flat.parent(second)), NodeKind::BLOCK_STATEMENT);
+	EXPECT_EQ(flat.kind(flat.nextSibling(second)), NodeKind::RETURN_STATEMENT);
+}
@@ -0,0 +1,100 @@
+#include "tinyc/ast/visitors/OutputSink.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+// Test that numbers are formatted like the default std::ostream formatting
+TEST(OutputSinkTest, NumberFormatting) {
+	StringSink sink;
+	std::ostringstream expected;
+
+	for (int value: {0, 1, -1, 42, 1000000, INT_MAX, INT_MIN}) {
+		sink << value << ' ';
+		expected << value << ' ';
+	}
+	for (double value: {0.0, 1.5, -2.25, 3.14159265, 1e300, 1.5e-7, 100000.0, 1234567.0}) {
+		sink << value << ' ';
+		expected << value << ' ';
+	}
+
+	EXPECT_EQ(sink.str(), expected.str());
+}
+
+// Test output larger than the buffer, both in small pieces and in single large writes
+TEST(OutputSinkTest, LargeOutput) {
+	std::ostringstream stream;
+	std::string expected;
+	{
+		StreamSink sink(stream);
+		std::string block(OutputSink::BUFFER_SIZE + 17, 'x');
+
+		for (int i = 0; i < 20000; ++i) {
+			sink << "line " << i << '\n';
+			expected += "line " + std::to_string(i) + "\n";
+		}
+		sink << block;
+		sink.fill(' ', 3 * OutputSink::BUFFER_SIZE);
+		expected += block + std::string(3 * OutputSink::BUFFER_SIZE, ' ');
+
+		// Nothing reaches the stream before a flush beyond full buffers
+		EXPECT_LT(stream.str().size(), expected.size());
+	}
+
+	EXPECT_EQ(stream.str(), expected);
+}
+
+// Test writing through a C stream
+TEST(OutputSinkTest, FileSink) {
+	std::FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	{
+		FileSink sink(file);
+		sink << "value: " << -7 << '\n';
+	}
+
+	std::rewind(file);
+	char text[32] = {};
+	ASSERT_NE(std::fgets(text, sizeof(text), file), nullptr);
+	EXPECT_STREQ(text, "value: -7\n");
+	std::fclose(file);
+}
+
+// Test that streaming the JSON produces the same document as collecting it
+TEST(OutputSinkTest, JSONVisitorStreaming) {
+	std::string source = "struct S { int a; };\n"
+						 "int f(char c, double d) { char* s = \"a\\tb\\\"\"; return c + 'x' * 2.5; }";
+
+	for (bool pretty: {false, true}) {
+		lexer::Lexer lexer(source, "stream.tc");
+		parser::Parser parser(lexer);
+		auto ast = parser.parseProgram();
+
+		JSONVisitor collecting(pretty);
+		ast->accept(collecting);
+
+		std::ostringstream stream;
+		{
+			StreamSink sink(stream);
+			JSONVisitor streaming(sink, pretty);
+			ast->accept(streaming);
+			EXPECT_EQ(streaming.getJSON(), "");
+		}
+
+		EXPECT_EQ(stream.str(), collecting.getJSON());
+		// Literal values keep their quotes and escapes, which are escaped again
+		EXPECT_NE(stream.str().find(R"("\"a\\tb\\\"\"")"), std::string::npos);
+	}
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include "tinyc/ast/StaticVisitor.h"
+#include "tinyc/ast/FlatAST.h"
+#include "tinyc/ast/visitors/DumpVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	ASTNodePtr parse(const std::string &source) {
+		lexer::Lexer lexer(source, "<static>");
+		parser::Parser parser(lexer);
+		return parser.parseProgram();
+	}
+
+	// Evaluates constant integer expressions; every other node is rejected by the catch-all
+	class Evaluator : public StaticVisitor<Evaluator, long> {
+	public:
+		long visit(const LiteralNode &node) {
+			return std::stol(std::string(node.getValue()));
+		}
+
+		long visit(const UnaryExpressionNode &node) {
+			long operand = dispatch(*node.getOperand());
+			return node.getOperator() == UnaryExpressionNode::Operator::NEGATIVE ? -operand : operand;
+		}
+
+		long visit(const BinaryExpressionNode &node) {
+			long left = dispatch(*node.getLeft());
+			long right = dispatch(*node.getRight());
+			switch (node.getOperator()) {
+				case BinaryExpressionNode::Operator::ADD:
+					return left + right;
+				case BinaryExpressionNode::Operator::SUBTRACT:
+					return left - right;
+				case BinaryExpressionNode::Operator::MULTIPLY:
+					return left * right;
+				default:
+					throw std::invalid_argument("unsupported operator");
+			}
+		}
+
+		template<typename Node>
+		long visit(const Node &) {
+			throw std::invalid_argument("not a constant expression");
+		}
+	};
+
+	// Records the kind of every node it reaches
+	class KindCollector : public StaticVisitor<KindCollector> {
+	public:
+		std::vector<NodeKind> kinds;
+
+		void visit(const ProgramNode &node) {
+			kinds.push_back(node.getNodeKind());
+			for (const auto &declaration: node.getDeclarations()) {
+				dispatch(*declaration);
+			}
+		}
+
+		void visit(const FunctionDeclarationNode &node) {
+			kinds.push_back(node.getNodeKind());
+			dispatch(*node.getBody());
+		}
+
+		void visit(const BlockStatementNode &node) {
+			kinds.push_back(node.getNodeKind());
+			for (const auto &statement: node.getStatements()) {
+				dispatch(*statement);
+			}
+		}
+
+		template<typename Node>
+		void visit(const Node &node) {
+			kinds.push_back(node.getNodeKind());
+		}
+	};
+
+} // namespace
+
+// Test handlers returning values, with a catch-all for unhandled classes
+TEST(StaticVisitorTest, ReturnsValues) {
+	auto ast = parse("int x = 2 + 3 * -4 - 1; int y = z;");
+	const auto &declarations = dynamic_cast<const ProgramNode &>(*ast).getDeclarations();
+
+	const auto &x = dynamic_cast<const VariableNode &>(*declarations[0]);
+	EXPECT_EQ(Evaluator().dispatch(*x.getInitializer()), -11);
+
+	const auto &y = dynamic_cast<const VariableNode &>(*declarations[1]);
+	EXPECT_THROW(Evaluator().dispatch(*y.getInitializer()), std::invalid_argument);
+}
+
+// Test that nodes report the kind of their class
+TEST(StaticVisitorTest, NodeKinds) {
+	auto ast = parse("struct S; void f() { break; continue; return; { } }");
+
+	KindCollector collector;
+	collector.dispatch(*ast);
+	EXPECT_EQ(collector.kinds, (std::vector<NodeKind>{
+			NodeKind::PROGRAM, NodeKind::STRUCT_DECLARATION, NodeKind::FUNCTION_DECLARATION,
+			NodeKind::BLOCK_STATEMENT, NodeKind::BREAK_STATEMENT, NodeKind::CONTINUE_STATEMENT,
+			NodeKind::RETURN_STATEMENT, NodeKind::BLOCK_STATEMENT}));
+
+	// The flattened tree derives its kinds from the node classes independently
+	auto flat = FlatAST::fromTree(*ast);
+	ASSERT_EQ(flat.size(), 9u);  // Also holds the return type
+	EXPECT_EQ(flat.kind(1), NodeKind::STRUCT_DECLARATION);
+	EXPECT_EQ(flat.kind(3), NodeKind::PRIMITIVE_TYPE);
+	EXPECT_EQ(flat.kind(8), NodeKind::BLOCK_STATEMENT);
+}
+
+// Test that the ported DumpVisitor still works through accept() and dispatch()
+TEST(StaticVisitorTest, DumpVisitorEntryPoints) {
+	auto ast = parse("int main() { return 1 + 2; }");
+
+	std::ostringstream viaAccept, viaDispatch;
+	DumpVisitor acceptVisitor(viaAccept);
+	ast->accept(acceptVisitor);
+	DumpVisitor dispatchVisitor(viaDispatch);
+	dispatchVisitor.dispatch(*ast);
+
+	EXPECT_EQ(viaAccept.str(), viaDispatch.str());
+	EXPECT_NE(viaAccept.str().find("BinaryExpression"), std::string::npos);
+}
@@ -0,0 +1,199 @@
+#include "tinyc/ast/StructuralHash.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/ast/FlatAST.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	ASTNodePtr parse(const std::string &source, parser::NodeSharing sharing = parser::NodeSharing::NONE,
+					 const std::string &name = "hash.tc") {
+		lexer::Lexer lexer(source, name);
+		parser::ParserOptions options;
+		options.sharing = sharing;
+		parser::Parser parser(lexer, options);
+		return parser.parseProgram();
+	}
+
+	const ASTNode &declaration(const ASTNodePtr &program, std::size_t index) {
+		return *static_cast<const ProgramNode &>(*program).getDeclarations()[index];
+	}
+
+	// Type of a variable declared at the top level
+	const ASTNode *variableType(const ASTNodePtr &program, std::size_t index) {
+		return static_cast<const VariableNode &>(declaration(program, index)).getType().get();
+	}
+
+	// Expression returned by the only statement of a function
+	const ASTNode *returned(const ASTNodePtr &program, std::size_t index) {
+		const auto &function = static_cast<const FunctionDeclarationNode &>(declaration(program, index));
+		const auto &body = static_cast<const BlockStatementNode &>(*function.getBody());
+		return static_cast<const ReturnStatementNode &>(*body.getStatements()[0]).getExpression().get();
+	}
+
+	const std::string PROGRAM = "struct Point { int x; int y; };\n"
+								"typedef int (*Compare)(char*, char*);\n"
+								"int f(Point* p, int n) {\n"
+								"    int values[4];\n"
+								"    for (int i = 0; i < n; i++) { values[i] = p->x * i + cast<int>(1.5); }\n"
+								"    switch (n) { case 1: return 'a'; default: break; }\n"
+								"    if (n > 2) { while (n) --n; } else do { n = f(p, n - 1); } while (0);\n"
+								"    return values[0] == -p->y && \"text\";\n"
+								"}\n";
+
+} // namespace
+
+// Test that the hash ignores locations and source names but not the structure
+TEST(StructuralHashTest, HashesStructure) {
+	ASTNodePtr first = parse(PROGRAM);
+	ASTNodePtr moved = parse("\n\n   " + PROGRAM, parser::NodeSharing::NONE, "other.tc");
+	EXPECT_EQ(structuralHash(*first), structuralHash(*moved));
+	EXPECT_TRUE(structurallyEqual(*first, *moved));
+
+	for (const char *changed: {"struct Point { int x; int z; };", "struct Point { int x; char y; };",
+									  "struct Point { int x; };", "struct Point;"}) {
+		ASTNodePtr other = parse(std::string(changed) + PROGRAM.substr(PROGRAM.find('\n')));
+		EXPECT_NE(structuralHash(*first), structuralHash(*other)) << changed;
+		EXPECT_FALSE(structurallyEqual(*first, *other)) << changed;
+	}
+
+	// Operands in another order, another operator, another literal kind
+	ASTNodePtr expressions = parse("int a = 1 + 2; int b = 2 + 1; int c = 1 - 2; double d = 1.0 + 2; int e = 1 + 2;");
+	std::uint64_t hashes[5];
+	for (std::size_t i = 0; i < 5; ++i) {
+		hashes[i] = structuralHash(declaration(expressions, i));
+	}
+	EXPECT_NE(hashes[0], hashes[1]);
+	EXPECT_NE(hashes[0], hashes[2]);
+	EXPECT_NE(hashes[0], hashes[3]);
+	EXPECT_NE(hashes[0], hashes[4]);  // The names differ
+	EXPECT_EQ(structuralHash(*static_cast<const VariableNode &>(declaration(expressions, 0)).getInitializer()),
+			  structuralHash(*static_cast<const VariableNode &>(declaration(expressions, 4)).getInitializer()));
+}
+
+// Test that the hash of a node is the same in every run and on every platform
+TEST(StructuralHashTest, HashIsStable) {
+	PrimitiveTypeNode integer(PrimitiveTypeNode::Kind::INT, lexer::SourceLocation());
+	EXPECT_EQ(structuralHash(integer), 0x2bc5822166bf4786ULL);
+
+	ASTNodePtr program = parse("char** p;");
+	EXPECT_EQ(structuralHash(*program), 0x539b5bb73ddde24fULL);
+}
+
+// Test that a hasher caches the hashes of the subtrees it visits
+TEST(StructuralHashTest, HasherCachesSubtrees) {
+	ASTNodePtr program = parse(PROGRAM);
+	StructuralHasher hasher;
+	std::uint64_t whole = hasher.hash(*program);
+	EXPECT_EQ(hasher.hash(*program), whole);
+	EXPECT_EQ(whole, structuralHash(*program));
+
+	const ASTNode &function = declaration(program, 2);
+	EXPECT_EQ(hasher.hash(function), structuralHash(function));
+	hasher.clear();
+	EXPECT_EQ(hasher.hash(function), structuralHash(function));
+}
+
+// Test that equal types share their nodes, and other subtrees do not
+TEST(StructuralHashTest, SharesTypes) {
+	const std::string source = "int* a; int* b; char** c; char** d; int e; double f; struct S { Point* g; Point* h; };";
+	ASTNodePtr separate = parse(source);
+	EXPECT_NE(variableType(separate, 0), variableType(separate, 1));
+
+	ASTNodePtr shared = parse(source, parser::NodeSharing::TYPES);
+	EXPECT_EQ(variableType(shared, 0), variableType(shared, 1));
+	EXPECT_EQ(variableType(shared, 2), variableType(shared, 3));
+	EXPECT_NE(variableType(shared, 0), variableType(shared, 2));
+	EXPECT_NE(variableType(shared, 4), variableType(shared, 5));
+	EXPECT_TRUE(variableType(shared, 0)->isShared());
+	EXPECT_FALSE(declaration(shared, 0).isShared());
+
+	// The base of int* is the int of e
+	const auto &pointer = static_cast<const PointerTypeNode &>(*variableType(shared, 0));
+	EXPECT_EQ(pointer.getBaseType().get(), variableType(shared, 4));
+
+	// Named types, here of struct fields
+	const auto &fields = static_cast<const StructDeclarationNode &>(declaration(shared, 6)).getFields();
+	EXPECT_EQ(static_cast<const VariableNode &>(*fields[0]).getType().get(),
+			  static_cast<const VariableNode &>(*fields[1]).getType().get());
+
+	// Sharing changes nothing but the identity and locations of the nodes
+	EXPECT_TRUE(structurallyEqual(*separate, *shared));
+	EXPECT_EQ(structuralHash(*separate), structuralHash(*shared));
+}
+
+// Test that equal pure expressions share their nodes, and impure ones do not
+TEST(StructuralHashTest, SharesPureExpressions) {
+	const std::string source = "int f(int x) { return x * 2 + (*p).y; }\n"
+							   "int g(int x) { return x * 2 + (*p).y; }\n"
+							   "int h(int x) { return f(x) + 1; }\n"
+							   "int i(int x) { return f(x) + 1; }\n"
+							   "int j(int x) { return x++ - 1; }\n"
+							   "int k(int x) { return x++ - 1; }\n"
+							   "int l(int x) { return cast<int*>(x)[0]; }\n"
+							   "int m(int x) { return cast<int*>(x)[0]; }\n";
+
+	ASTNodePtr types = parse(source, parser::NodeSharing::TYPES);
+	EXPECT_NE(returned(types, 0), returned(types, 1));
+
+	ASTNodePtr shared = parse(source, parser::NodeSharing::EXPRESSIONS);
+	EXPECT_EQ(returned(shared, 0), returned(shared, 1));
+	EXPECT_EQ(returned(shared, 6), returned(shared, 7));
+
+	// Calls and increments are built for every occurrence, their pure operands are shared
+	const auto &firstCall = static_cast<const BinaryExpressionNode &>(*returned(shared, 2));
+	const auto &secondCall = static_cast<const BinaryExpressionNode &>(*returned(shared, 3));
+	EXPECT_NE(&firstCall, &secondCall);
+	EXPECT_NE(firstCall.getLeft().get(), secondCall.getLeft().get());
+	EXPECT_EQ(firstCall.getRight().get(), secondCall.getRight().get());
+	EXPECT_NE(returned(shared, 4), returned(shared, 5));
+
+	EXPECT_TRUE(structurallyEqual(*types, *shared));
+}
+
+// Test that nothing is shared across a reset, so flat parsing works with sharing
+TEST(StructuralHashTest, SharingInFlatParse) {
+	const std::string source = "int* a; int* b; int f(int* p) { return *p + *p; }";
+	lexer::Lexer lexer(source, "flat.tc");
+	parser::ParserOptions options;
+	options.sharing = parser::NodeSharing::EXPRESSIONS;
+	parser::Parser parser(lexer, options);
+	FlatAST flat = parser.parseProgramFlat();
+	EXPECT_EQ(flat.size(), FlatAST::fromTree(*parse(source)).size());
+
+	ASTContext context;
+	auto share = [&context]() {
+		return context.createShared<IdentifierNode>(NodeKey(NodeKind::IDENTIFIER, 0, "x"), "x", lexer::SourceLocation())
+				.release();
+	};
+	IdentifierNode *node = share();
+	EXPECT_EQ(share(), node);
+	EXPECT_EQ(context.sharedNodeCount(), 1u);
+	context.reset();
+	EXPECT_EQ(context.sharedNodeCount(), 0u);
+}
+
+// Test that share() only makes a node for a new key, so its text is copied once
+TEST(StructuralHashTest, ShareMakesNodeOnce) {
+	ASTContext context;
+	int made = 0;
+	auto share = [&context, &made](std::string text) {
+		return context
+				.share<LiteralNode>(NodeKey(NodeKind::LITERAL, 0, text), [&]() {
+					++made;
+					return context.create<LiteralNode>(context.copyString(text), LiteralNode::Kind::INTEGER,
+													   lexer::SourceLocation());
+				})
+				.release();
+	};
+	LiteralNode *node = share("42");
+	EXPECT_EQ(share("42"), node);
+	EXPECT_NE(share("7"), node);
+	EXPECT_EQ(made, 2);
+	EXPECT_EQ(node->getValue(), "42");
+}
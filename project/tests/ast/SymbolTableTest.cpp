@@ -0,0 +1,113 @@
+#include "tinyc/ast/SymbolTable.h"
+#include "tinyc/ast/ASTContext.h"
+#include "tinyc/driver/ParallelMap.h"
+#include "tinyc/driver/ParallelParser.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace tinyc;
+using namespace tinyc::ast;
+
+namespace {
+
+	// Get the name of a variable declared at the top level of a program
+	std::string_view declarationName(const ASTNode &program, std::size_t index) {
+		const auto &declarations = static_cast<const ProgramNode &>(program).getDeclarations();
+		return static_cast<const VariableNode &>(*declarations[index]).getIdentifier();
+	}
+
+} // namespace
+
+// Test that equal names share one copy and get dense ids
+TEST(SymbolTableTest, InternsNames) {
+	SymbolTable table;
+	std::string first = "count";
+	std::string second = "count";
+
+	std::string_view a = table.intern(first);
+	std::string_view b = table.intern(second);
+	std::string_view c = table.intern("total");
+	EXPECT_EQ(a, "count");
+	EXPECT_EQ(a.data(), b.data());
+	EXPECT_NE(a.data(), first.data());
+	EXPECT_NE(a.data(), c.data());
+	EXPECT_EQ(SymbolTable::symbol(a), 0u);
+	EXPECT_EQ(SymbolTable::symbol(b), 0u);
+	EXPECT_EQ(SymbolTable::symbol(c), 1u);
+	EXPECT_EQ(table.size(), 2u);
+
+	// The table grows without moving the names interned before
+	std::vector<std::string_view> names;
+	for (int i = 0; i < 5000; ++i) {
+		names.push_back(table.intern("name" + std::to_string(i)));
+	}
+	EXPECT_EQ(table.size(), 5002u);
+	std::set<Symbol> ids;
+	for (int i = 0; i < 5000; ++i) {
+		std::string_view again = table.intern("name" + std::to_string(i));
+		EXPECT_EQ(again.data(), names[i].data());
+		ids.insert(SymbolTable::symbol(again));
+	}
+	EXPECT_EQ(ids.size(), 5000u);
+	EXPECT_EQ(*ids.rbegin(), 5001u);
+	EXPECT_EQ(table.intern("count").data(), a.data());
+	EXPECT_EQ(table.intern(""), "");
+}
+
+// Test a table shared by several threads
+TEST(SymbolTableTest, ConcurrentInterning) {
+	SymbolTable table(true);
+	driver::ParallelMap<std::vector<std::string_view>> results(8, 8, [&](std::size_t) {
+		std::vector<std::string_view> names;
+		for (int i = 0; i < 500; ++i) {
+			names.push_back(table.intern("v" + std::to_string(i)));
+		}
+		return names;
+	});
+
+	std::vector<std::string_view> first = results.get(0);
+	for (std::size_t task = 1; task < 8; ++task) {
+		std::vector<std::string_view> names = results.get(task);
+		ASSERT_EQ(names, first);
+		for (int i = 0; i < 500; ++i) {
+			EXPECT_EQ(names[i].data(), first[i].data());
+		}
+	}
+	EXPECT_EQ(table.size(), 500u);
+}
+
+// Test that the parsers intern the names of the nodes they build
+TEST(SymbolTableTest, ParsersShareNames) {
+	std::string source = "int alpha = 1;\nint beta = alpha;\nint alpha = beta;\n";
+	lexer::Lexer lexer(source);
+	parser::Parser parser(lexer);
+	ASTNodePtr program = parser.parseProgram();
+	EXPECT_EQ(declarationName(*program, 0).data(), declarationName(*program, 2).data());
+	EXPECT_NE(declarationName(*program, 0).data(), declarationName(*program, 1).data());
+
+	// The chunks of a parallel parse use one table
+	std::string large;
+	for (int i = 0; i < 4000; ++i) {
+		large += "int shared" + std::to_string(i % 3) + " = " + std::to_string(i) + ";\n";
+	}
+	auto buffer = lexer::SourceBuffer::fromString(large);
+	driver::ParallelParser parallel(buffer, {}, 4, 1024);
+	ASTNodePtr parsed = parallel.parseProgram();
+	ASSERT_GT(parallel.getParallelChunks(), 1u);
+	const auto &declarations = static_cast<const ProgramNode &>(*parsed).getDeclarations();
+	ASSERT_EQ(declarations.size(), 4000u);
+	EXPECT_EQ(declarationName(*parsed, 0).data(), declarationName(*parsed, 3999).data());
+	EXPECT_EQ(SymbolTable::symbol(declarationName(*parsed, 3999)), SymbolTable::symbol(declarationName(*parsed, 0)));
+
+	// Resetting a context drops its table
+	ASTContext context;
+	std::shared_ptr<SymbolTable> table = context.getSymbols();
+	context.intern("x");
+	context.reset();
+	EXPECT_NE(context.getSymbols(), table);
+	EXPECT_EQ(context.getSymbols()->size(), 0u);
+}
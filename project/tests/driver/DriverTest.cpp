@@ -0,0 +1,322 @@
+#include "tinyc/driver/Driver.h"
+#include "tinyc/driver/ParallelMap.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+// Files written to the gtest temporary directory, removed at the end of the test
+class TempFiles {
+public:
+	std::string add(const std::string &name, const std::string &contents) {
+		std::string path = testing::TempDir() + "tinyc_driver_" + name;
+		std::ofstream file(path, std::ios::binary);
+		file << contents;
+		paths.push_back(path);
+		return path;
+	}
+
+	~TempFiles() {
+		for (const auto &path: paths) std::remove(path.c_str());
+	}
+
+	std::vector<std::string> paths;
+};
+
+// Test that each kind of failure maps to its exit code
+TEST(DriverTest, CompileSourceExitCodes) {
+	CompileOptions options;
+
+	auto ok = compileSource(lexer::SourceBuffer::fromString("int x;"), options);
+	EXPECT_EQ(ok.exitCode, EXIT_OK);
+	EXPECT_EQ(ok.output.substr(0, 1), "{");
+	EXPECT_TRUE(ok.diagnostics.empty());
+
+	auto lexError = compileSource(lexer::SourceBuffer::fromString("int x = 'ab';"), options);
+	EXPECT_EQ(lexError.exitCode, EXIT_LEXER_ERROR);
+	EXPECT_TRUE(lexError.output.empty());
+	EXPECT_EQ(lexError.diagnostics.rfind("Lexer error: ", 0), 0u);
+
+	auto parseError = compileSource(lexer::SourceBuffer::fromString("int x"), options);
+	EXPECT_EQ(parseError.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_EQ(parseError.diagnostics.rfind("Parser error: <input>:", 0), 0u);
+
+	auto missing = compileFile(testing::TempDir() + "tinyc_driver_missing.tc", options);
+	EXPECT_EQ(missing.exitCode, EXIT_OTHER_ERROR);
+	EXPECT_EQ(missing.diagnostics.rfind("Error: Could not open file", 0), 0u);
+
+	options.lexOnly = true;
+	auto tokens = compileSource(lexer::SourceBuffer::fromString("x", "t.tc"), options);
+	EXPECT_EQ(tokens.output.rfind("Tokens from t.tc:\n", 0), 0u);
+}
+
+// Test that a batch writes results in input order and exits with the worst code
+TEST(DriverTest, BatchIsOrderedAndAggregatesExitCodes) {
+	TempFiles files;
+	std::vector<std::string> inputs;
+	for (int i = 0; i < 40; ++i) {
+		std::string source = i == 7 ? "int x" : "int v" + std::to_string(i) + ";";
+		inputs.push_back(files.add("batch" + std::to_string(i) + ".tc", source));
+	}
+
+	CompileOptions options;
+	BatchOptions batch;
+	batch.jobs = 4;
+	std::ostringstream out, err;
+	int exitCode = compileBatch(inputs, options, batch, out, err);
+	EXPECT_EQ(exitCode, EXIT_PARSER_ERROR);
+
+	// Compare against compiling the files one by one
+	std::string expected;
+	for (const auto &input: inputs) {
+		expected += compileFile(input, options).output;
+	}
+	EXPECT_EQ(out.str(), expected);
+	EXPECT_NE(err.str().find("batch7.tc"), std::string::npos);
+
+	// A lexer error alone gives 1, a missing file outranks parser errors
+	std::ostringstream ignored;
+	inputs.push_back(files.add("lex.tc", "@"));
+	EXPECT_EQ(compileBatch({inputs.back()}, options, batch, ignored, ignored), EXIT_LEXER_ERROR);
+	inputs.push_back(testing::TempDir() + "tinyc_driver_missing.tc");
+	EXPECT_EQ(compileBatch(inputs, options, batch, ignored, ignored), EXIT_OTHER_ERROR);
+}
+
+// Test writing one output file per input
+TEST(DriverTest, BatchOutputDirectory) {
+	TempFiles files;
+	std::vector<std::string> inputs = {files.add("dir_a.tc", "int a;"), files.add("dir_b.tc", "int b")};
+
+	CompileOptions options;
+	BatchOptions batch;
+	batch.outputDir = testing::TempDir();
+	std::ostringstream out, err;
+	EXPECT_EQ(compileBatch(inputs, options, batch, out, err), EXIT_PARSER_ERROR);
+	EXPECT_TRUE(out.str().empty());
+
+	std::string path = outputPathFor(inputs[0], batch.outputDir, options);
+	files.paths.push_back(path);
+	std::ifstream written(path);
+	std::stringstream contents;
+	contents << written.rdbuf();
+	EXPECT_EQ(contents.str(), compileFile(inputs[0], options).output);
+
+	// Failed inputs produce no output file
+	EXPECT_FALSE(std::ifstream(outputPathFor(inputs[1], batch.outputDir, options)).good());
+
+	EXPECT_EQ(outputPathFor("src/dir/file.tc", "out", options), "out/src/dir/file.json");
+	EXPECT_EQ(outputPathFor("./src/../file.tc", "out", options), "out/file.json");
+	EXPECT_EQ(outputPathFor("../up/file.tc", "out", options), "out/file.json");
+	EXPECT_EQ(outputPathFor("/abs/file.tc", "out", options), "out/file.json");
+	options.format = OutputFormat::BINARY;
+	EXPECT_EQ(outputPathFor("src/dir/file.tc", "out", options), "out/src/dir/file.tcast");
+	options.lexOnly = true;
+	EXPECT_EQ(outputPathFor("file", "out/", options), "out/file.tokens");
+}
+
+// Test that same-named inputs from different directories get outputs of their own
+TEST(DriverTest, BatchOutputSameNames) {
+	namespace fs = std::filesystem;
+	fs::path root = "tinyc_driver_same_names";
+	fs::create_directories(root / "a");
+	fs::create_directories(root / "b");
+	std::ofstream(root / "a" / "main.tc") << "int a;";
+	std::ofstream(root / "b" / "main.tc") << "int b;";
+	std::vector<std::string> inputs = {(root / "a" / "main.tc").string(), (root / "b" / "main.tc").string()};
+
+	CompileOptions options;
+	BatchOptions batch;
+	batch.outputDir = (root / "out").string();
+	std::ostringstream out, err;
+	EXPECT_EQ(compileBatch(inputs, options, batch, out, err), EXIT_OK);
+	for (const auto &input: inputs) {
+		std::ifstream written(root / "out" / fs::path(input).parent_path() / "main.json");
+		std::stringstream contents;
+		contents << written.rdbuf();
+		EXPECT_EQ(contents.str(), compileFile(input, options).output) << input;
+	}
+
+	// Absolute inputs keep only their name, so a clash fails the batch before compiling
+	std::vector<std::string> absolute = {fs::absolute(inputs[0]).string(), fs::absolute(inputs[1]).string()};
+	batch.outputDir = (root / "flat").string();
+	std::ostringstream clashOut, clashErr;
+	EXPECT_EQ(compileBatch(absolute, options, batch, clashOut, clashErr), EXIT_OTHER_ERROR);
+	EXPECT_NE(clashErr.str().find("would both be written to"), std::string::npos);
+	EXPECT_FALSE(fs::exists(root / "flat"));
+
+	fs::remove_all(root);
+}
+
+// Test that recovered parser errors are reported along with the AST
+TEST(DriverTest, RecoveredErrors) {
+	CompileOptions options;
+	options.recover = true;
+
+	auto result = compileSource(lexer::SourceBuffer::fromString("int a = ;\nint b = ;\nint c;"), options);
+	EXPECT_EQ(result.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_EQ(result.diagnostics, "Parser error: <input>:1:9: Expected expression\n"
+								  "Parser error: <input>:2:9: Expected expression\n");
+	EXPECT_NE(result.output.find("\"nodeType\": \"Error\""), std::string::npos);
+	EXPECT_NE(result.output.find("\"identifier\": \"c\""), std::string::npos);
+
+	// A lexer error stays fatal but keeps the errors recovered before it (and their exit code)
+	auto lexError = compileSource(lexer::SourceBuffer::fromString("int a = ;\nint b = 'ab';"), options);
+	EXPECT_EQ(lexError.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_TRUE(lexError.output.empty());
+	EXPECT_EQ(lexError.diagnostics.rfind("Parser error: <input>:1:9", 0), 0u);
+	EXPECT_NE(lexError.diagnostics.find("\nLexer error: "), std::string::npos);
+
+	// Batch mode writes the partial AST
+	TempFiles files;
+	std::vector<std::string> inputs = {files.add("recover.tc", "int a = ;")};
+	BatchOptions batch;
+	batch.outputDir = testing::TempDir();
+	std::ostringstream out, err;
+	EXPECT_EQ(compileBatch(inputs, options, batch, out, err), EXIT_PARSER_ERROR);
+	std::string path = outputPathFor(inputs[0], batch.outputDir, options);
+	files.paths.push_back(path);
+	EXPECT_TRUE(std::ifstream(path).good());
+	EXPECT_NE(err.str().find("Expected expression"), std::string::npos);
+
+	// An output that cannot be written adds its error to the recovered ones
+	batch.outputDir = files.add("not_a_directory", "");
+	std::ostringstream failedOut, failedErr;
+	EXPECT_EQ(compileBatch(inputs, options, batch, failedOut, failedErr), EXIT_OTHER_ERROR);
+	EXPECT_EQ(failedErr.str().rfind("Parser error: ", 0), 0u);
+	EXPECT_NE(failedErr.str().find("Expected expression\nError: Could not write file: "), std::string::npos);
+}
+
+// Test expanding response files
+TEST(DriverTest, ResponseFiles) {
+	TempFiles files;
+	std::string list = files.add("list.rsp", "a.tc  b.tc\n--lex\n\tc.tc\n");
+
+	auto args = expandResponseFiles({"-j", "2", "@" + list, "d.tc"});
+	std::vector<std::string> expected = {"-j", "2", "a.tc", "b.tc", "--lex", "c.tc", "d.tc"};
+	EXPECT_EQ(args, expected);
+
+	EXPECT_THROW(expandResponseFiles({"@" + testing::TempDir() + "tinyc_driver_missing.rsp"}),
+				 std::runtime_error);
+}
+
+// Test that counts and sizes given on the command line are checked, not truncated or thrown on
+TEST(DriverTest, ParseCountsAndSizes) {
+	std::size_t count = 7;
+	EXPECT_TRUE(parseCount("0", count));
+	EXPECT_EQ(count, 0u);
+	EXPECT_TRUE(parseCount("18446744073709551615", count));
+	EXPECT_EQ(count, SIZE_MAX);
+	count = 7;
+	for (const char *invalid: {"", "-1", "+1", " 1", "1 ", "4x", "99999999999999999999999"}) {
+		EXPECT_FALSE(parseCount(invalid, count)) << invalid;
+	}
+	EXPECT_EQ(count, 7u);
+
+	std::uintmax_t size = 7;
+	EXPECT_TRUE(parseSize("4096", size));
+	EXPECT_EQ(size, 4096u);
+	EXPECT_TRUE(parseSize("64k", size));
+	EXPECT_EQ(size, 64u * 1024);
+	EXPECT_TRUE(parseSize("2G", size));
+	EXPECT_EQ(size, std::uintmax_t(2) << 30);
+	size = 7;
+	for (const char *invalid: {"", "K", "1KB", "1T", "-1M", "99999999999999999999999", "17179869184G"}) {
+		EXPECT_FALSE(parseSize(invalid, size)) << invalid;
+	}
+	EXPECT_EQ(size, 7u);
+}
+
+// Test compiling a stream: lexer mode writes tokens as it goes, parser mode reads it all
+TEST(DriverTest, CompileStream) {
+	std::string source = "int main() {\n\treturn 1 + 2;\n}\n";
+	CompileOptions lex;
+	lex.lexOnly = true;
+	lex.stats = StatsFormat::TEXT;
+
+	std::istringstream input(source);
+	ast::StringSink out;
+	CompileResult streamed = compileStream(input, "<stdin>", lex, out);
+	EXPECT_EQ(streamed.exitCode, EXIT_OK);
+	EXPECT_EQ(out.str(), compileSource(lexer::SourceBuffer::fromString(source, "<stdin>"), lex).output);
+	EXPECT_EQ(streamed.stats.tokens, 11u);
+	EXPECT_EQ(streamed.stats.outputBytes, out.str().size());
+
+	// The tokens before a lexer error are still written
+	std::istringstream broken("int x = @;");
+	ast::StringSink partial;
+	CompileResult failed = compileStream(broken, "<stdin>", lex, partial);
+	EXPECT_EQ(failed.exitCode, EXIT_LEXER_ERROR);
+	EXPECT_NE(failed.diagnostics.find("<stdin>:1:9"), std::string::npos);
+	EXPECT_NE(partial.str().find("'='"), std::string::npos);
+
+	CompileOptions parse;
+	std::istringstream parseInput(source);
+	ast::StringSink ast;
+	EXPECT_EQ(compileStream(parseInput, "<stdin>", parse, ast).exitCode, EXIT_OK);
+	EXPECT_EQ(ast.str(), compileSource(lexer::SourceBuffer::fromString(source, "<stdin>"), parse).output);
+}
+
+// Test that every task runs once and results and exceptions reach the right index
+TEST(ParallelMapTest, RunsAllTasks) {
+	std::atomic<int> counter{0};
+	ParallelMap<int> results(100, 3, [&counter](std::size_t i) -> int {
+		++counter;
+		if (i == 42) throw std::runtime_error("task failed");
+		return static_cast<int>(i * i);
+	});
+	EXPECT_EQ(results.threadCount(), 3u);
+
+	for (int i = 0; i < 100; ++i) {
+		if (i == 42) {
+			EXPECT_THROW(results.get(i), std::runtime_error);
+		} else {
+			EXPECT_EQ(results.get(i), i * i);
+		}
+	}
+	EXPECT_EQ(counter.load(), 100);
+
+	// Never more threads than tasks
+	ParallelMap<int> small(2, 8, [](std::size_t i) { return static_cast<int>(i); });
+	EXPECT_EQ(small.threadCount(), 2u);
+	EXPECT_EQ(small.get(1), 1);
+}
+
+// Test that workers with a window do not start tasks too far ahead of the results taken
+TEST(ParallelMapTest, WindowBoundsLookAhead) {
+	std::atomic<std::size_t> started{0};
+	std::atomic<bool> overrun{false};
+	std::atomic<std::size_t> takenCount{0};
+	ParallelMap<std::size_t> results(200, 4, [&](std::size_t i) {
+		++started;
+		if (i >= takenCount.load() + 4) overrun = true;  // The count is set just after get()
+		return i;
+	}, 3);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_LE(started.load(), 3u);
+	for (std::size_t i = 0; i < 200; ++i) {
+		EXPECT_EQ(results.get(i), i);
+		takenCount = i + 1;
+	}
+	EXPECT_EQ(started.load(), 200u);
+	EXPECT_FALSE(overrun.load());
+
+	// Destroying the map while workers wait for the window stops them
+	ParallelMap<int> abandoned(100, 4, [](std::size_t) { return 0; }, 1);
+	EXPECT_EQ(abandoned.get(0), 0);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
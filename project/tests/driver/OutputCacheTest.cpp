@@ -0,0 +1,199 @@
+#include "tinyc/driver/OutputCache.h"
+#include "tinyc/driver/Driver.h"
+#include "tinyc/driver/ParallelMap.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+namespace fs = std::filesystem;
+
+// Cache directory in the gtest temporary directory, removed at the end of the test
+class CacheDirectory {
+public:
+	explicit CacheDirectory(const std::string &name) : path(testing::TempDir() + "tinyc_cache_" + name) {
+		fs::remove_all(path);
+	}
+
+	~CacheDirectory() { fs::remove_all(path); }
+
+	[[nodiscard]] std::size_t entries() const {
+		std::size_t count = 0;
+		for (const auto &entry: fs::directory_iterator(path)) {
+			count += entry.path().extension() == ".entry";
+		}
+		return count;
+	}
+
+	std::string path;
+};
+
+// Test the hash against the reference MurmurHash3_x64_128 outputs
+TEST(OutputCacheTest, HashBytes) {
+	EXPECT_EQ(hashBytes(""), (std::array<std::uint64_t, 2>{0, 0}));
+	EXPECT_EQ(hashBytes("hello"), (std::array<std::uint64_t, 2>{0xcbd8a7b341bd9b02ULL, 0x5b1e906a48ae1d19ULL}));
+	EXPECT_NE(hashBytes("hello", 1), hashBytes("hello"));
+
+	// Every tail length changes the hash
+	std::string text = "The quick brown fox jumps over the lazy dog";
+	for (std::size_t length = 1; length < text.size(); ++length) {
+		EXPECT_NE(hashBytes(text.substr(0, length)), hashBytes(text.substr(0, length - 1)));
+	}
+}
+
+// Test that the key covers the source, its name and the options changing the output
+TEST(OutputCacheTest, Keys) {
+	CacheDirectory directory("keys");
+	OutputCache cache(directory.path);
+	CompileOptions options;
+
+	auto source = lexer::SourceBuffer::fromString("int x;", "a.tc");
+	std::string key = cache.key(source, options);
+	EXPECT_EQ(key.size(), 32u);
+	EXPECT_EQ(key, cache.key(lexer::SourceBuffer::fromString("int x;", "a.tc"), options));
+	EXPECT_NE(key, cache.key(lexer::SourceBuffer::fromString("int y;", "a.tc"), options));
+	EXPECT_NE(key, cache.key(lexer::SourceBuffer::fromString("int x;", "b.tc"), options));
+
+	CompileOptions changed = options;
+	changed.prettyPrint = true;
+	EXPECT_NE(key, cache.key(source, changed));
+	changed = options;
+	changed.format = OutputFormat::BINARY;
+	EXPECT_NE(key, cache.key(source, changed));
+	changed.prettyPrint = true;
+	CompileOptions binary;
+	binary.format = OutputFormat::BINARY;
+	EXPECT_EQ(cache.key(source, changed), cache.key(source, binary));
+	changed = options;
+	changed.lexOnly = true;
+	EXPECT_NE(key, cache.key(source, changed));
+
+	// Options that do not change a successful output share entries
+	changed = options;
+	changed.recover = true;
+	changed.parseJobs = 4;
+	EXPECT_EQ(key, cache.key(source, changed));
+}
+
+// Test storing, finding and replacing entries
+TEST(OutputCacheTest, StoreAndLookup) {
+	CacheDirectory directory("store");
+	OutputCache cache(directory.path);
+	std::string key = std::string(32, 'a');
+	std::string output;
+
+	EXPECT_FALSE(cache.lookup(key, output));
+	cache.store(key, "first");
+	ASSERT_TRUE(cache.lookup(key, output));
+	EXPECT_EQ(output, "first");
+
+	std::string binary("\0\x01\n\xff", 4);
+	cache.store(key, binary);
+	ASSERT_TRUE(cache.lookup(key, output));
+	EXPECT_EQ(output, binary);
+	EXPECT_EQ(cache.hits(), 2u);
+	EXPECT_EQ(cache.misses(), 1u);
+	EXPECT_EQ(directory.entries(), 1u);
+
+	// Damaged entries are misses
+	std::ofstream(directory.path + "/" + key + ".entry", std::ios::binary) << "tinyc-cache\n" << key << " 10\nshort";
+	EXPECT_FALSE(cache.lookup(key, output));
+	std::ofstream(directory.path + "/" + key + ".entry", std::ios::binary) << "tinyc-cache\n" << std::string(32, 'b')
+																			<< " 2\nok";
+	EXPECT_FALSE(cache.lookup(key, output));
+
+	EXPECT_THROW(OutputCache(directory.path + "/" + key + ".entry/sub"), std::runtime_error);
+}
+
+// Test that the least recently used entries are evicted past the size bound
+TEST(OutputCacheTest, Eviction) {
+	CacheDirectory directory("evict");
+	OutputCache cache(directory.path, 1000);
+	std::string payload(150, 'x');
+	auto now = fs::file_time_type::clock::now();
+
+	for (int i = 0; i < 6; ++i) {
+		std::string key = std::string(31, 'a') + static_cast<char>('0' + i);
+		cache.store(key, payload);
+		fs::last_write_time(directory.path + "/" + key + ".entry", now - std::chrono::minutes(60 - i));
+	}
+	EXPECT_EQ(directory.entries(), 6u);
+
+	// Using the oldest entry makes it the newest
+	std::string output;
+	ASSERT_TRUE(cache.lookup(std::string(31, 'a') + '0', output));
+
+	// A stale temporary file is removed, a recent one is kept
+	std::ofstream(directory.path + "/stale.tmp") << "x";
+	fs::last_write_time(directory.path + "/stale.tmp", now - std::chrono::hours(2));
+	std::ofstream(directory.path + "/fresh.tmp") << "x";
+
+	// Past the bound, the entries (about 200 bytes with their headers) are trimmed to three quarters of it
+	cache.store(std::string(31, 'a') + '6', payload);
+	EXPECT_EQ(directory.entries(), 3u);
+	EXPECT_TRUE(cache.lookup(std::string(31, 'a') + '0', output));
+	EXPECT_FALSE(cache.lookup(std::string(31, 'a') + '1', output));
+	EXPECT_FALSE(cache.lookup(std::string(31, 'a') + '4', output));
+	EXPECT_TRUE(cache.lookup(std::string(31, 'a') + '5', output));
+	EXPECT_TRUE(cache.lookup(std::string(31, 'a') + '6', output));
+	EXPECT_FALSE(fs::exists(directory.path + "/stale.tmp"));
+	EXPECT_TRUE(fs::exists(directory.path + "/fresh.tmp"));
+}
+
+// Test compiling through the cache, also from several threads at once
+TEST(OutputCacheTest, CompileThroughCache) {
+	CacheDirectory directory("compile");
+	CompileOptions options;
+	options.cache = std::make_shared<OutputCache>(directory.path);
+	CompileOptions uncached;
+
+	auto source = lexer::SourceBuffer::fromString("int main() { return 1 + 2; }", "m.tc");
+	auto first = compileSource(source, options);
+	auto second = compileSource(source, options);
+	EXPECT_EQ(first.output, compileSource(source, uncached).output);
+	EXPECT_EQ(second.output, first.output);
+	EXPECT_EQ(second.exitCode, EXIT_OK);
+	EXPECT_EQ(options.cache->misses(), 1u);
+	EXPECT_EQ(options.cache->hits(), 1u);
+
+	// A hit has nothing to count but says so in the statistics
+	EXPECT_FALSE(first.stats.cacheHit);
+	EXPECT_TRUE(second.stats.cacheHit);
+	EXPECT_NE(second.stats.toText().find("cache:                        hit"), std::string::npos);
+	EXPECT_NE(second.stats.toJSON().find("\"cacheHit\":true"), std::string::npos);
+
+	// Lexer mode has entries of its own
+	options.lexOnly = true;
+	EXPECT_EQ(compileSource(source, options).output, [&] {
+		CompileOptions lex;
+		lex.lexOnly = true;
+		return compileSource(source, lex).output;
+	}());
+	EXPECT_EQ(options.cache->hits(), 1u);
+
+	// Runs with errors are not stored
+	options.lexOnly = false;
+	options.recover = true;
+	auto broken = lexer::SourceBuffer::fromString("int a = ;\nint b;", "e.tc");
+	EXPECT_EQ(compileSource(broken, options).exitCode, EXIT_PARSER_ERROR);
+	auto again = compileSource(broken, options);
+	EXPECT_EQ(again.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_FALSE(again.diagnostics.empty());
+	EXPECT_EQ(directory.entries(), 2u);
+
+	// Concurrent writers and readers of the same entries
+	options.recover = false;
+	ParallelMap<std::string> outputs(64, 8, [&](std::size_t i) {
+		auto input = lexer::SourceBuffer::fromString("int v" + std::to_string(i % 4) + ";", "t.tc");
+		return compileSource(input, options).output;
+	});
+	for (std::size_t i = 0; i < 64; ++i) {
+		auto input = lexer::SourceBuffer::fromString("int v" + std::to_string(i % 4) + ";", "t.tc");
+		EXPECT_EQ(outputs.get(i), compileSource(input, uncached).output);
+	}
+	EXPECT_EQ(directory.entries(), 6u);
+}
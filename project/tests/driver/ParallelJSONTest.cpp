@@ -0,0 +1,60 @@
+#include "tinyc/driver/ParallelJSON.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include "tinyc/parser/Parser.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+namespace {
+
+	ast::ASTNodePtr parse(const std::string &source) {
+		lexer::Lexer lexer(source, "parallel.tc");
+		parser::Parser parser(lexer);
+		return parser.parseProgram();
+	}
+
+	std::string sequentialJSON(const ast::ASTNode &node, bool prettyPrint) {
+		ast::JSONVisitor visitor(prettyPrint);
+		node.accept(visitor);
+		return visitor.getJSON();
+	}
+
+	std::string parallelJSON(const ast::ASTNode &node, bool prettyPrint, std::size_t jobs) {
+		ast::StringSink out;
+		writeJSON(node, out, prettyPrint, jobs);
+		return out.str();
+	}
+
+} // namespace
+
+// Test that serializing on several threads writes the JSON of the sequential visitor
+TEST(ParallelJSONTest, MatchesSequentialVisitor) {
+	std::string source;
+	for (int i = 0; i < 300; ++i) {
+		std::string n = std::to_string(i);
+		source += "struct S" + n + " { int a; char* b; };\n";
+		source += "int f" + n + "(int x) { switch (x) { case 1: return x * " + n + "; default: break; } return 0; }\n";
+		source += "char* s" + n + " = \"a\\\"b\", char* t" + n + " = \"c\";\n";
+	}
+	ast::ASTNodePtr program = parse(source);
+
+	for (bool pretty: {false, true}) {
+		std::string expected = sequentialJSON(*program, pretty);
+		for (std::size_t jobs: {1, 2, 3, 8, 0}) {
+			EXPECT_EQ(parallelJSON(*program, pretty, jobs), expected) << "jobs " << jobs << ", pretty " << pretty;
+		}
+	}
+}
+
+// Test programs with fewer declarations than ranges
+TEST(ParallelJSONTest, SmallPrograms) {
+	for (const std::string source: {"", "int x;", "int x; double y = 1.5;"}) {
+		ast::ASTNodePtr program = parse(source);
+		for (bool pretty: {false, true}) {
+			EXPECT_EQ(parallelJSON(*program, pretty, 4), sequentialJSON(*program, pretty)) << source;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#include "tinyc/driver/ParallelParser.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+namespace {
+
+	// Declarations of every shape, with braces, semicolons and newlines in comments and literals
+	std::string makeSource(int count) {
+		std::string source;
+		for (int i = 0; i < count; ++i) {
+			std::string n = std::to_string(i);
+			source += "int f" + n + "(int x) {\n\tif (x) { return x; }\n\treturn '}';\n}\n";
+			source += "/* } ; int broken(\n */ char *s" + n + " = \"};\\\" {\";\n";
+			source += "struct S" + n + " { int a; int b; }; // } ;\n";
+			source += "int g" + n + "(); int v" + n + " = " + n + ", int w" + n + " = 1;\n";
+		}
+		return source;
+	}
+
+	std::string toJSON(const ast::ASTNode &node) {
+		ast::StringSink out;
+		ast::JSONVisitor visitor(out, false);
+		node.accept(visitor);
+		return out.str();
+	}
+
+	// JSON and diagnostics of a sequential parse
+	struct Sequential {
+		std::string json;
+		std::vector<std::string> errors;
+	};
+
+	Sequential parseSequentially(const lexer::SourceBuffer &source, parser::ParserOptions options) {
+		lexer::Lexer lexer(source);
+		parser::Parser parser(lexer, options);
+		Sequential result{toJSON(*parser.parseProgram()), {}};
+		for (const auto &error: parser.getDiagnostics()) {
+			result.errors.emplace_back(error.what());
+		}
+		return result;
+	}
+
+	std::vector<std::string> messages(const std::vector<parser::ParserError> &errors) {
+		std::vector<std::string> result;
+		for (const auto &error: errors) {
+			result.emplace_back(error.what());
+		}
+		return result;
+	}
+
+} // namespace
+
+// Test that boundaries follow top-level declarations only
+TEST(ParallelParserTest, FindBoundaries) {
+	std::string text = "int a;\n/* ; */ int f() { x; }\n;\"}\" int b; // ;\n  char c;";
+	auto boundaries = ParallelParser::findBoundaries(text, 1);
+
+	std::vector<std::size_t> offsets;
+	for (const auto &boundary: boundaries) {
+		offsets.push_back(boundary.offset);
+	}
+	// After "int a;", "int f() { x; }" with its ';', "\"}\" int b;"
+	std::vector<std::size_t> expected = {0, text.find("int f"), text.find("\"}\""), text.find("char c")};
+	EXPECT_EQ(offsets, expected);
+	EXPECT_EQ(boundaries[1].line, 2);
+	EXPECT_EQ(boundaries[1].column, 9);
+	EXPECT_EQ(boundaries[3].line, 4);
+	EXPECT_EQ(boundaries[3].column, 3);
+
+	// Boundaries closer than the chunk size are dropped
+	EXPECT_EQ(ParallelParser::findBoundaries(text, text.size()).size(), 1u);
+}
+
+// Test that a parallel parse gives the AST of a sequential one
+TEST(ParallelParserTest, MatchesSequentialParse) {
+	auto source = lexer::SourceBuffer::fromString(makeSource(200), "<parallel>");
+	Sequential expected = parseSequentially(source, parser::ParserOptions());
+
+	ParallelParser parser(source, parser::ParserOptions(), 4, 256);
+	EXPECT_EQ(toJSON(*parser.parseProgram()), expected.json);
+	EXPECT_GT(parser.getParallelChunks(), 1u);
+	EXPECT_TRUE(parser.getDiagnostics().empty());
+
+	// A single thread parses sequentially
+	ParallelParser single(source, parser::ParserOptions(), 1, 256);
+	EXPECT_EQ(toJSON(*single.parseProgram()), expected.json);
+	EXPECT_EQ(single.getParallelChunks(), 0u);
+}
+
+// Test that errors are reported as a sequential parse reports them
+TEST(ParallelParserTest, Errors) {
+	std::string text = makeSource(100);
+	text.insert(text.find("int f50"), "int broken(int = 1;\n");
+	text.insert(text.find("int f80"), "struct T { int; };\n");
+	auto source = lexer::SourceBuffer::fromString(text, "<parallel>");
+
+	// Without recovery the first error is thrown
+	std::string message;
+	try {
+		parseSequentially(source, parser::ParserOptions());
+	} catch (const parser::ParserError &error) {
+		message = error.what();
+	}
+	ASSERT_FALSE(message.empty());
+	ParallelParser failing(source, parser::ParserOptions(), 4, 256);
+	try {
+		failing.parseProgram();
+		FAIL() << "Expected a ParserError";
+	} catch (const parser::ParserError &error) {
+		EXPECT_EQ(error.what(), message);
+	}
+
+	// With recovery, the same errors and Error nodes
+	parser::ParserOptions options;
+	options.recover = true;
+	Sequential expected = parseSequentially(source, options);
+	ASSERT_GE(expected.errors.size(), 2u);
+
+	ParallelParser recovering(source, options, 4, 256);
+	EXPECT_EQ(toJSON(*recovering.parseProgram()), expected.json);
+	EXPECT_EQ(messages(recovering.getDiagnostics()), expected.errors);
+	EXPECT_GT(recovering.getParallelChunks(), 1u);
+}
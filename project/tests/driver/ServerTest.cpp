@@ -0,0 +1,171 @@
+#include "tinyc/driver/Server.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+namespace {
+
+	std::string request(const std::string &header, const std::string &source) {
+		std::size_t space = header.find(' ');
+		std::string mode = header.substr(0, space);
+		std::string flags = space == std::string::npos ? "" : header.substr(space);
+		return mode + " " + std::to_string(source.size()) + flags + "\n" + source;
+	}
+
+	std::string response(const CompileResult &result) {
+		return std::to_string(result.exitCode) + " " + std::to_string(result.output.size()) + " " +
+			   std::to_string(result.diagnostics.size()) + "\n" + result.output + result.diagnostics;
+	}
+
+} // namespace
+
+// Test that each request gets the response of a compiler run on its source
+TEST(ServerTest, AnswersRequests) {
+	CompileOptions parse;
+	CompileOptions lex;
+	lex.lexOnly = true;
+	CompileOptions pretty;
+	pretty.prettyPrint = true;
+	CompileOptions recovering;
+	recovering.recover = true;
+
+	std::string valid = "int main() { return 0; }";
+	std::string broken = "int x = ;\nint y;\n";
+	std::string expected;
+	std::string requests;
+	auto add = [&](const std::string &header, const std::string &source, const CompileOptions &options,
+				   const std::string &name = "<input>") {
+		requests += request(header, source);
+		expected += response(compileSource(lexer::SourceBuffer::fromString(source, name), options));
+	};
+
+	add("parse", valid, parse);
+	add("lex", valid, lex);
+	add("parse pretty name=main.tc", valid, pretty, "main.tc");
+	add("parse", broken, parse);
+	add("parse recover", broken, recovering);
+	add("lex", "int \"x", lex);
+	add("parse", "", parse);
+	// Warm requests give the same output as the first one
+	add("parse", valid, parse);
+
+	std::istringstream in(requests + "quit\nparse 3\nint");
+	std::ostringstream out;
+	Server server;
+	EXPECT_FALSE(server.serve(in, out));
+	EXPECT_EQ(out.str(), expected);
+	EXPECT_EQ(server.requestCount(), 8u);
+}
+
+// Test that bad requests are answered with errors
+TEST(ServerTest, BadRequests) {
+	std::istringstream in(request("compile", "int x;") + request("parse verbose", "int x;") +
+						  request("parse", "int x;") + "shutdown\n");
+	std::ostringstream out;
+	Server server;
+	EXPECT_TRUE(server.serve(in, out));
+
+	std::string text = out.str();
+	EXPECT_EQ(text.find("3 0 "), 0u);
+	EXPECT_NE(text.find("Error: Unknown request mode: compile\n"), std::string::npos);
+	EXPECT_NE(text.find("Error: Unknown request flag: verbose\n"), std::string::npos);
+	EXPECT_NE(text.find("\n0 "), std::string::npos);
+
+	// A header without a length, or a truncated source, ends the stream
+	std::istringstream garbage("parse x\nint x;");
+	std::ostringstream garbageOut;
+	EXPECT_FALSE(server.serve(garbage, garbageOut));
+	EXPECT_EQ(garbageOut.str().find("3 0 "), 0u);
+
+	std::istringstream truncated("parse 100\nint x;");
+	std::ostringstream truncatedOut;
+	EXPECT_FALSE(server.serve(truncated, truncatedOut));
+	EXPECT_NE(truncatedOut.str().find("ended before its 100 bytes"), std::string::npos);
+
+	// Oversized lengths are refused without allocating the source, and the server keeps serving
+	for (const std::string &length: {std::to_string(Server::MAX_REQUEST_SIZE + 1), std::string("18446744073709551615"),
+									  std::string("99999999999999999999")}) {
+		std::istringstream oversized("json " + length + "\nint x;");
+		std::ostringstream oversizedOut;
+		EXPECT_FALSE(server.serve(oversized, oversizedOut)) << length;
+		EXPECT_EQ(oversizedOut.str().find("3 0 "), 0u) << length;
+	}
+	std::istringstream tooLarge("parse " + std::to_string(Server::MAX_REQUEST_SIZE + 1) + "\n");
+	std::ostringstream tooLargeOut;
+	EXPECT_FALSE(server.serve(tooLarge, tooLargeOut));
+	EXPECT_NE(tooLargeOut.str().find("exceeds the limit of"), std::string::npos);
+
+	std::istringstream after(request("parse", "int x;"));
+	std::ostringstream afterOut;
+	server.serve(after, afterOut);
+	EXPECT_EQ(afterOut.str().find("0 "), 0u);
+}
+
+// Test that the arena blocks are kept between requests
+TEST(ServerTest, BlockCacheReusesBlocks) {
+	BlockCache cache;
+	void *first = cache.allocate(4096, 16);
+	cache.deallocate(first, 4096, 16);
+	EXPECT_EQ(cache.cachedBytes(), 4096u);
+
+	EXPECT_EQ(cache.allocate(4096, 16), first);
+	EXPECT_EQ(cache.cachedBytes(), 0u);
+	void *other = cache.allocate(1024, 16);
+	EXPECT_NE(other, first);
+	cache.deallocate(other, 1024, 16);
+	cache.deallocate(first, 4096, 16);
+}
+
+#ifndef _WIN32
+// Test serving over a Unix domain socket
+TEST(ServerTest, Socket) {
+	std::string path = testing::TempDir() + "tinyc_server_test.sock";
+	Server server;
+	std::thread thread([&]() { server.serveSocket(path); });
+
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	// Connect once the server listens, then send everything and read until it hangs up
+	auto exchange = [&](const std::string &requests) {
+		int fd = -1;
+		for (int attempt = 0; attempt < 500; ++attempt) {
+			fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0) {
+				break;
+			}
+			::close(fd);
+			fd = -1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		EXPECT_GE(fd, 0);
+		EXPECT_EQ(::send(fd, requests.data(), requests.size(), 0), static_cast<ssize_t>(requests.size()));
+		std::string received;
+		char buffer[4096];
+		for (ssize_t n; (n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0;) {
+			received.append(buffer, static_cast<std::size_t>(n));
+		}
+		::close(fd);
+		return received;
+	};
+
+	std::string expected = response(compileSource(lexer::SourceBuffer::fromString("int x;"), CompileOptions()));
+	EXPECT_EQ(exchange(request("parse", "int x;") + "quit\n"), expected);
+	EXPECT_EQ(exchange(request("parse", "int x;") + "shutdown\n"), expected);
+	thread.join();
+	EXPECT_EQ(server.requestCount(), 2u);
+}
+#endif
@@ -0,0 +1,142 @@
+#include "tinyc/driver/Driver.h"
+#include "tinyc/driver/Stats.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace tinyc;
+using namespace tinyc::driver;
+
+// Test that timers add the time of each scope to their counter
+TEST(StatsTest, ScopedTimerAccumulates) {
+	double seconds = 0;
+	{
+		ScopedTimer timer(seconds);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	double first = seconds;
+	EXPECT_GE(first, 0.002);
+	{
+		ScopedTimer timer(seconds);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	EXPECT_GE(seconds, first + 0.002);
+}
+
+// Test that the counter tracks live and peak bytes
+TEST(StatsTest, AllocationCounterTracksPeak) {
+	AllocationCounter counter;
+	void *a = counter.allocate(100, 8);
+	void *b = counter.allocate(50, 16);
+	EXPECT_EQ(counter.currentBytes(), 150u);
+	counter.deallocate(a, 100, 8);
+	void *c = counter.allocate(20, 8);
+	EXPECT_EQ(counter.currentBytes(), 70u);
+	EXPECT_EQ(counter.peakBytes(), 150u);
+	counter.deallocate(b, 50, 16);
+	counter.deallocate(c, 20, 8);
+	EXPECT_EQ(counter.currentBytes(), 0u);
+}
+
+// Test the counts collected while parsing, on one and on several threads
+TEST(StatsTest, CompileSourceCollectsStats) {
+	CompileOptions options;
+	options.stats = StatsFormat::TEXT;
+
+	auto result = compileSource(lexer::SourceBuffer::fromString("int x = 1 + 2;", "s.tc"), options);
+	ASSERT_EQ(result.exitCode, EXIT_OK);
+	const CompileStats &stats = result.stats;
+	EXPECT_EQ(stats.name, "s.tc");
+	EXPECT_EQ(stats.tokens, 7u);
+	EXPECT_EQ(stats.lexSeconds, 0.0);  // Lexing is part of the parse, not a pass of its own
+	EXPECT_GT(stats.parseSeconds, 0.0);
+	EXPECT_EQ(stats.nodesByKind[static_cast<int>(ast::NodeKind::PROGRAM)], 1u);
+	EXPECT_EQ(stats.nodesByKind[static_cast<int>(ast::NodeKind::LITERAL)], 2u);
+	EXPECT_EQ(stats.nodesByKind[static_cast<int>(ast::NodeKind::BINARY_EXPRESSION)], 1u);
+	EXPECT_EQ(stats.nodes(), 6u);
+	EXPECT_GT(stats.astBytes, 0u);
+	EXPECT_EQ(stats.outputBytes, result.output.size());
+
+	std::string source;
+	for (int i = 0; i < 2000; ++i) {
+		source += "int f" + std::to_string(i) + "(int a) { switch (a) { case 1: return a; default: break; } return 0; }\n";
+	}
+	options.stats = StatsFormat::JSON;
+	auto sequential = compileSource(lexer::SourceBuffer::fromString(source), options);
+	options.parseJobs = 4;
+	auto parallel = compileSource(lexer::SourceBuffer::fromString(source), options);
+	ASSERT_EQ(parallel.exitCode, EXIT_OK);
+	EXPECT_EQ(parallel.stats.tokens, sequential.stats.tokens);
+	EXPECT_EQ(parallel.stats.nodesByKind, sequential.stats.nodesByKind);
+	EXPECT_EQ(parallel.stats.nodesByKind[static_cast<int>(ast::NodeKind::SWITCH_STATEMENT)], 2000u);
+	EXPECT_GT(parallel.stats.astBytes, 0u);
+
+	options.lexOnly = true;
+	auto tokens = compileSource(lexer::SourceBuffer::fromString("int x;"), options);
+	EXPECT_EQ(tokens.stats.tokens, 3u);
+	EXPECT_EQ(tokens.stats.nodes(), 0u);
+	EXPECT_EQ(tokens.stats.outputBytes, tokens.output.size());
+}
+
+// Test that errors keep the statistics gathered before them
+TEST(StatsTest, ErrorsKeepStats) {
+	CompileOptions options;
+	options.stats = StatsFormat::TEXT;
+
+	auto parseError = compileSource(lexer::SourceBuffer::fromString("int x int y;"), options);
+	EXPECT_EQ(parseError.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_EQ(parseError.stats.tokens, 2u);  // The parse stops at the second int
+	EXPECT_EQ(parseError.stats.outputBytes, 0u);
+
+	// Only the tokens before a lexer error are counted, and the error is still reported
+	auto lexError = compileSource(lexer::SourceBuffer::fromString("int x = 'ab';"), options);
+	EXPECT_EQ(lexError.exitCode, EXIT_LEXER_ERROR);
+	EXPECT_EQ(lexError.stats.tokens, 2u);  // = was read but not consumed
+
+	options.lexOnly = true;
+	auto listed = compileSource(lexer::SourceBuffer::fromString("int x = 'ab';"), options);
+	EXPECT_EQ(listed.stats.tokens, 3u);
+
+	// The parallel parser counts the tokens of its chunks and of the sequential rest
+	std::string source;
+	for (int i = 0; i < 3000; ++i) {
+		source += "int v" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+	}
+	options.lexOnly = false;
+	options.parseJobs = 4;
+	auto parallelError = compileSource(lexer::SourceBuffer::fromString(source + "int x int y;"), options);
+	EXPECT_EQ(parallelError.exitCode, EXIT_PARSER_ERROR);
+	EXPECT_EQ(parallelError.stats.tokens, 3000u * 5 + 2);
+}
+
+// Test the text and JSON reports
+TEST(StatsTest, Formats) {
+	CompileStats stats;
+	stats.name = "a \"b\".tc";
+	stats.parseSeconds = 0.5;
+	stats.tokens = 12;
+	stats.nodesByKind[static_cast<int>(ast::NodeKind::PROGRAM)] = 1;
+	stats.nodesByKind[static_cast<int>(ast::NodeKind::ERROR_NODE)] = 2;
+	stats.astBytes = 4096;
+	stats.outputBytes = 77;
+
+	std::string text = stats.toText();
+	EXPECT_EQ(text.rfind("Statistics for a \"b\".tc:\n", 0), 0u);
+	EXPECT_NE(text.find("parse:                        500.000 ms (including lexing)\n"), std::string::npos);
+	EXPECT_NE(text.find("AST nodes:                    3\n"), std::string::npos);
+	EXPECT_NE(text.find("    Error:                      2\n"), std::string::npos);
+	EXPECT_EQ(text.find("Literal"), std::string::npos);
+	EXPECT_EQ(text.find("lex:"), std::string::npos);
+
+	EXPECT_EQ(stats.toJSON(),
+			  "{\"name\":\"a \\\"b\\\".tc\",\"readSeconds\":0,\"lexSeconds\":0,\"parseSeconds\":0.5,"
+			  "\"serializeSeconds\":0,\"tokens\":12,\"nodes\":{\"Program\":1,\"Error\":2},\"nodeCount\":3,"
+			  "\"astBytes\":4096,\"outputBytes\":77,\"cacheHit\":false}\n");
+	EXPECT_EQ(stats.format(StatsFormat::NONE), "");
+	EXPECT_EQ(stats.format(StatsFormat::JSON), stats.toJSON());
+
+	EXPECT_STREQ(nodeKindName(ast::NodeKind::PROGRAM), "Program");
+	EXPECT_STREQ(nodeKindName(ast::NodeKind::FOR_STATEMENT), "ForStatement");
+	EXPECT_STREQ(nodeKindName(ast::NodeKind::ERROR_NODE), "Error");
+}
@@ -1,8 +1,16 @@
 #include "tinyc/lexer/Lexer.h"
+#include "tinyc/lexer/SourceBuffer.h"
+#include "tinyc/lexer/CharScan.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
 #include <memory>
 #include <vector>
 #include <limits>
+#include <random>
+#include <sstream>
 
 using namespace tinyc::lexer;
 
@@ -125,6 +133,20 @@ TEST(LexerTest, KeywordLikeIdentifiers) {
 	}
 }
 
+// Test identifiers sharing length and leading characters with a keyword
+TEST(LexerTest, KeywordNearMisses) {
+	std::string source = "i in it id dp fox inx elsa cash casf chat cha voice whilE brake "
+						 "switcg strucd retury doublf defaulx typedee continuf";
+	Lexer lexer(source);
+
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+
+	ASSERT_EQ(tokens.size(), 23);
+	for (size_t i = 0; i < tokens.size() - 1; ++i) { // -1 for EOF
+		EXPECT_EQ(tokens[i]->getType(), TokenType::IDENTIFIER) << tokens[i]->getLexeme();
+	}
+}
+
 // Test integer literals with various formats
 TEST(LexerTest, IntegerLiterals) {
 	std::string source = "0 1 123 42000 100 9 0123456789";
@@ -157,6 +179,76 @@ TEST(LexerTest, IntegerBoundaryValues) {
 	EXPECT_EQ(tokens[0]->getIntValue(), std::numeric_limits<int>::max());
 }
 
+// Test that numeric tokens are decoded on demand and that literals out of range are rejected
+TEST(LexerTest, NumericLiteralRange) {
+	Lexer lexer("0002147483647 0 1.5e3 123. " + std::string(300, '1') + ".0e-250", "range.tc");
+	TokenRef padded = lexer.next();
+	EXPECT_EQ(lexer.text(padded), "0002147483647");
+	EXPECT_EQ(lexer.intValue(padded), std::numeric_limits<int>::max());
+	EXPECT_EQ(lexer.intValue(lexer.next()), 0);
+	TokenRef exponent = lexer.next();
+	EXPECT_EQ(lexer.text(exponent), "1.5e3");
+	EXPECT_DOUBLE_EQ(lexer.doubleValue(exponent), 1500.0);
+	EXPECT_DOUBLE_EQ(lexer.doubleValue(lexer.next()), 123.0);
+	EXPECT_NEAR(lexer.doubleValue(lexer.next()), 1.1111111111111111e49, 1e34);
+
+	std::vector<std::string> outOfRangeLiterals = {"2147483648", "99999999999", "1e400", "1.8e308", "1e-400",
+												   "0." + std::string(400, '0') + "1"};
+	for (const auto &literal: outOfRangeLiterals) {
+		Lexer outOfRange(literal);
+		try {
+			outOfRange.next();
+			ADD_FAILURE() << literal << " was accepted";
+		} catch (const LexerError &e) {
+			EXPECT_NE(std::string(e.what()).find("Invalid"), std::string::npos);
+		}
+	}
+}
+
+// Test the limits of double literals on the fast path (mantissa of at most 200 characters and
+// an exponent of at most two digits, never converted) and on the from_chars path
+TEST(LexerTest, DoubleLiteralLimits) {
+	auto value = [](const std::string &literal) {
+		Lexer lexer(literal);
+		TokenRef token = lexer.next();
+		EXPECT_EQ(token.type, TokenType::DOUBLE_LITERAL) << literal;
+		EXPECT_EQ(lexer.text(token), literal);
+		return lexer.doubleValue(token);
+	};
+
+	// Fast path, up to its bounds
+	EXPECT_DOUBLE_EQ(value("9.9e99"), 9.9e99);
+	EXPECT_DOUBLE_EQ(value("1e-99"), 1e-99);
+	std::string longest = std::string(198, '9') + ".0";
+	EXPECT_DOUBLE_EQ(value(longest + "e99"), 1e297);
+	EXPECT_DOUBLE_EQ(value("0." + std::string(197, '0') + "1e-99"), 1e-297);
+
+	// A mantissa over 200 characters is converted, and accepted while it stays in range
+	EXPECT_DOUBLE_EQ(value(std::string(201, '1') + ".0"), 1.111111111111111e200);
+	EXPECT_DOUBLE_EQ(value("0." + std::string(250, '0') + "1"), 1e-251);
+
+	// The largest finite double, and a spelling that still rounds down to it
+	EXPECT_EQ(value("1.7976931348623157e308"), std::numeric_limits<double>::max());
+	EXPECT_EQ(value("1.7976931348623158e308"), std::numeric_limits<double>::max());
+
+	// Subnormals are accepted, down to the smallest one
+	EXPECT_EQ(value("1e-310"), 1e-310);
+	EXPECT_EQ(value("0.5e-320"), 0.5e-320);
+	EXPECT_EQ(value("4.9406564584124654e-324"), std::numeric_limits<double>::denorm_min());
+	Lexer subnormal("2.5e-308");
+	std::string description;
+	subnormal.describe(subnormal.next(), description);
+	EXPECT_NE(description.find("(value: 2.5e-308)"), std::string::npos) << description;
+
+	// Literals rounding to infinity or to zero are rejected on either path
+	for (const std::string &literal: {std::string("1e400"), std::string("1.7976931348623159e308"),
+									  std::string("2e-324"), std::string("1e-330"),
+									  std::string(250, '1') + ".0e99", std::string(201, '9') + ".0e200"}) {
+		Lexer outOfRange(literal);
+		EXPECT_THROW(outOfRange.next(), LexerError) << literal;
+	}
+}
+
 // Test double literals with various formats
 TEST(LexerTest, DoubleLiterals) {
 	// Note: Adjusted to match lexer behavior - '.123' will be tokenized as '.' and '123'
@@ -664,6 +756,310 @@ TEST(LexerTest, ConsecutiveOperators) {
 	EXPECT_EQ(tokens[3]->getLexeme(), "b");
 }
 
+// Test that peeked tokens are lexed once and handed out in order
+TEST(LexerTest, Lookahead) {
+	std::string source = "Point p = a + b;";
+	Lexer lexer(source);
+	Lexer reference(source);
+
+	EXPECT_EQ(lexer.text(lexer.peek(1)), "p");
+	EXPECT_EQ(lexer.text(lexer.peek(3)), "a");
+	// The source is scanned up to the furthest peeked token only, and not again by next()
+	EXPECT_EQ(lexer.getCurrentLocation().column, 12);
+	EXPECT_EQ(lexer.text(lexer.peek()), "Point");
+
+	for (int i = 0; i < 5; ++i) {
+		TokenRef expected = reference.next();
+		TokenRef token = lexer.next();
+		EXPECT_EQ(token.type, expected.type);
+		EXPECT_EQ(token.offset, expected.offset);
+		EXPECT_EQ(token.column, expected.column);
+	}
+	EXPECT_EQ(lexer.getCurrentLocation().column, 14);
+	EXPECT_THROW(lexer.peek(Lexer::MAX_LOOKAHEAD), std::out_of_range);
+
+	// Past the end every peek is the end of file
+	EXPECT_EQ(lexer.peek(3).getType(), TokenType::END_OF_FILE);
+	EXPECT_EQ(lexer.text(lexer.next()), "b");
+	EXPECT_EQ(lexer.next().getType(), TokenType::SEMICOLON);
+	EXPECT_EQ(lexer.next().getType(), TokenType::END_OF_FILE);
+	EXPECT_EQ(lexer.next().getType(), TokenType::END_OF_FILE);
+
+	// Seeking drops the peeked tokens
+	lexer.peek(2);
+	lexer.seek(6, 1, 7);
+	EXPECT_EQ(lexer.text(lexer.next()), "p");
+
+	// Tokens peeked before one that fails to lex are kept
+	Lexer failing("x @");
+	EXPECT_THROW(failing.peek(1), LexerError);
+	EXPECT_EQ(failing.text(failing.next()), "x");
+}
+
+// Test the allocation-free token stream against the owning tokens
+TEST(LexerTest, TokenRefStream) {
+	std::string source = "int x = 'a' + 2.5;\n\"str\" y";
+	Lexer refLexer(source, "test.tc");
+	Lexer ptrLexer(source, "test.tc");
+
+	TokenRef peeked = refLexer.peek();
+	EXPECT_EQ(peeked.getType(), TokenType::KW_INT);
+
+	TokenRef token;
+	do {
+		token = refLexer.next();
+		TokenPtr expected = ptrLexer.nextToken();
+
+		EXPECT_EQ(token.getType(), expected->getType());
+		EXPECT_EQ(refLexer.text(token), expected->getLexeme());
+		EXPECT_EQ(refLexer.location(token).getFilename(), "test.tc");
+		EXPECT_EQ(token.line, expected->getLocation().line);
+		EXPECT_EQ(token.column, expected->getLocation().column);
+	} while (token.getType() != TokenType::END_OF_FILE);
+
+	Lexer valueLexer(source);
+	valueLexer.next(); // int
+	valueLexer.next(); // x
+	valueLexer.next(); // =
+	EXPECT_EQ(valueLexer.next().getCharValue(), 'a');
+	valueLexer.next(); // +
+	EXPECT_DOUBLE_EQ(valueLexer.doubleValue(valueLexer.next()), 2.5);
+}
+
+// Test that lexing a stream in chunks of any size gives the tokens of the whole text
+TEST(LexerTest, StreamedInput) {
+	std::string source = "int main() { /* a comment\n over lines */ double d = 12.5e-3;\n"
+						 "// line comment\nchar *s = \"a \\\"quoted\\\" string\"; x <<= y >> 2; c = '\\n'; }";
+	for (std::size_t chunkSize: {1, 2, 3, 7, 64, 4096}) {
+		std::istringstream input(source);
+		Lexer streamed(input, "stream.tc", chunkSize);
+		Lexer reference(source, "stream.tc");
+
+		TokenRef expected;
+		do {
+			expected = reference.next();
+			TokenRef token = streamed.next();
+			ASSERT_EQ(token.getType(), expected.getType()) << "chunk size " << chunkSize;
+			EXPECT_EQ(streamed.text(token), reference.text(expected));
+			EXPECT_EQ(token.line, expected.line);
+			EXPECT_EQ(token.column, expected.column);
+			EXPECT_EQ(token.getCharValue(), expected.getCharValue());
+		} while (expected.getType() != TokenType::END_OF_FILE);
+		EXPECT_EQ(streamed.next().getType(), TokenType::END_OF_FILE);
+	}
+
+	// Peeked tokens keep their text while the window moves on
+	std::istringstream peekInput("alpha beta gamma delta");
+	Lexer peeking(peekInput, "<stdin>", 2);
+	TokenRef first = peeking.peek();
+	EXPECT_EQ(peeking.text(peeking.peek(3)), "delta");
+	EXPECT_EQ(peeking.text(first), "alpha");
+	EXPECT_EQ(peeking.text(peeking.next()), "alpha");
+	EXPECT_EQ(peeking.text(peeking.next()), "beta");
+	EXPECT_THROW(peeking.seek(0, 1, 1), std::logic_error);
+
+	// Tokens that only look broken at the end of a chunk are lexed whole, real errors are reported
+	std::istringstream lateInput("x = 1e5; /* closed */ y");
+	Lexer late(lateInput, "<stdin>", 3);
+	std::vector<std::string> texts;
+	for (TokenRef token = late.next(); token.getType() != TokenType::END_OF_FILE; token = late.next()) {
+		texts.emplace_back(late.text(token));
+	}
+	EXPECT_EQ(texts, (std::vector<std::string>{"x", "=", "1e5", ";", "y"}));
+
+	std::istringstream unclosed("int x; /* never closed");
+	Lexer failing(unclosed, "<stdin>", 4);
+	failing.next();
+	failing.next();
+	failing.next();
+	try {
+		failing.next();
+		FAIL() << "Expected a LexerError";
+	} catch (const LexerError &e) {
+		EXPECT_EQ(e.getLocation().column, 23);
+	}
+}
+
+// Test that token descriptions match the stream operator of the owning tokens
+TEST(LexerTest, DescribeTokens) {
+	std::string source = "x 42 2.5e10 0.1 'q' \"s\" <=";
+	Lexer refLexer(source, "d.tc");
+	Lexer ptrLexer(source, "d.tc");
+
+	TokenRef token;
+	do {
+		token = refLexer.next();
+		std::ostringstream expected;
+		expected << *ptrLexer.nextToken();
+		std::string description = "prefix ";
+		refLexer.describe(token, description);
+		EXPECT_EQ(description, "prefix " + expected.str());
+	} while (token.getType() != TokenType::END_OF_FILE);
+}
+
+// Test that locations share interned file names
+TEST(LexerTest, InternedFileNames) {
+	Lexer first("a", "shared.tc");
+	Lexer second("b", "shared.tc");
+	Lexer other("c", "other.tc");
+
+	SourceLocation firstLocation = first.nextToken()->getLocation();
+	SourceLocation secondLocation = second.nextToken()->getLocation();
+	SourceLocation otherLocation = other.nextToken()->getLocation();
+
+	EXPECT_EQ(firstLocation.fileId, secondLocation.fileId);
+	EXPECT_NE(firstLocation.fileId, otherLocation.fileId);
+	EXPECT_EQ(&firstLocation.getFilename(), &secondLocation.getFilename());
+	EXPECT_EQ(otherLocation.getFilename(), "other.tc");
+	EXPECT_EQ(SourceLocation().getFilename(), "");
+
+	try {
+		Lexer failing("@", "error.tc");
+		failing.nextToken();
+		FAIL() << "Expected LexerError";
+	} catch (const LexerError &e) {
+		EXPECT_EQ(std::string(e.what()).rfind("error.tc:1:1: ", 0), 0u);
+	}
+}
+
+// Helper writing a temporary source file, removed when the test finishes
+class TempSourceFile {
+public:
+	explicit TempSourceFile(const std::string &contents)
+			: path(testing::TempDir() + "tinyc_lexer_" +
+				   testing::UnitTest::GetInstance()->current_test_info()->name() + ".tc") {
+		std::ofstream file(path, std::ios::binary);
+		file << contents;
+	}
+
+	~TempSourceFile() { std::remove(path.c_str()); }
+
+	const std::string path;
+};
+
+// Test lexing from a memory-mapped file
+TEST(SourceBufferTest, MappedFile) {
+	TempSourceFile file("int main() {\n  return 42;\n}\n");
+	SourceBuffer buffer = SourceBuffer::fromFile(file.path);
+
+	EXPECT_TRUE(buffer.isMapped());
+	EXPECT_EQ(buffer.getName(), file.path);
+
+	Lexer lexer(buffer);
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+
+	assertTokenTypes(tokens, {
+			TokenType::KW_INT, TokenType::IDENTIFIER, TokenType::LPAREN, TokenType::RPAREN, TokenType::LBRACE,
+			TokenType::KW_RETURN, TokenType::INTEGER_LITERAL, TokenType::SEMICOLON, TokenType::RBRACE
+	});
+
+	EXPECT_EQ(tokens[6]->getIntValue(), 42);
+	EXPECT_EQ(tokens[6]->getLocation().getFilename(), file.path);
+	EXPECT_EQ(tokens[6]->getLocation().line, 2);
+	EXPECT_EQ(tokens[6]->getLocation().column, 10);
+}
+
+// Test that an empty file yields a single EOF token
+TEST(SourceBufferTest, EmptyFile) {
+	TempSourceFile file("");
+	SourceBuffer buffer = SourceBuffer::fromFile(file.path);
+
+	EXPECT_TRUE(buffer.getText().empty());
+
+	Lexer lexer(buffer);
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+
+	ASSERT_EQ(tokens.size(), 1);
+	EXPECT_EQ(tokens[0]->getType(), TokenType::END_OF_FILE);
+}
+
+// Test lexing from an in-memory buffer, including after moving it
+TEST(SourceBufferTest, StringBuffer) {
+	SourceBuffer original = SourceBuffer::fromString("x = 1;", "<memory>");
+	SourceBuffer buffer = std::move(original);
+
+	EXPECT_FALSE(buffer.isMapped());
+	EXPECT_EQ(buffer.getText(), "x = 1;");
+
+	Lexer lexer(buffer);
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+
+	assertTokenLexemes(tokens, {"x", "=", "1", ";"});
+	EXPECT_EQ(tokens[0]->getLocation().getFilename(), "<memory>");
+}
+
+// Test lexing a caller-owned text from the middle
+TEST(SourceBufferTest, ViewAndSeek) {
+	std::string text = "int a;\nint bb = 2;";
+	SourceBuffer original = SourceBuffer::view(text, "<view>");
+	SourceBuffer buffer = std::move(original);
+	EXPECT_EQ(buffer.getText().data(), text.data());
+
+	Lexer lexer(buffer);
+	lexer.seek(text.find("bb"), 2, 5);
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+
+	assertTokenLexemes(tokens, {"bb", "=", "2", ";"});
+	EXPECT_EQ(tokens[0]->getLocation().line, 2);
+	EXPECT_EQ(tokens[2]->getLocation().column, 10);
+	EXPECT_THROW(lexer.seek(text.size() + 1, 1, 1), std::out_of_range);
+}
+
+// Test that a missing file is reported
+TEST(SourceBufferTest, MissingFile) {
+	EXPECT_THROW(SourceBuffer::fromFile(testing::TempDir() + "tinyc_does_not_exist.tc"), std::runtime_error);
+}
+
+// Test the block scanners against byte-at-a-time references for every length and alignment
+TEST(CharScanTest, MatchesScalarReference) {
+	const std::string alphabet = " \t\n\r\v\f_azAZ09*/@[`{\x80\xff";
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+
+	for (int round = 0; round < 200; ++round) {
+		// Long uniform runs reach the vector loop, a random tail exercises the exits
+		std::string text(random() % 80, alphabet[pick(random)]);
+		for (size_t i = random() % 40; i > 0; --i) text += alphabet[pick(random)];
+
+		for (size_t start = 0; start < text.size() && start < 33; ++start) {
+			const char *p = text.data() + start;
+			size_t length = text.size() - start;
+
+			size_t spaces = 0;
+			while (spaces < length && std::isspace(static_cast<unsigned char>(p[spaces]))) ++spaces;
+			size_t identifier = 0;
+			while (identifier < length && (std::isalnum(static_cast<unsigned char>(p[identifier])) ||
+										   p[identifier] == '_')) ++identifier;
+			size_t close = std::string_view(p, length).find("*/");
+
+			EXPECT_EQ(scan::whitespaceRun(p, length), spaces);
+			EXPECT_EQ(scan::identifierRun(p, length), identifier);
+			EXPECT_EQ(scan::countNewlines(p, length), static_cast<size_t>(std::count(p, p + length, '\n')));
+			EXPECT_EQ(scan::findCommentClose(p, length), close == std::string_view::npos ? length : close);
+		}
+	}
+}
+
+// Test that locations stay exact after skipping long comments and whitespace runs in bulk
+TEST(CharScanTest, LocationsAfterLongComments) {
+	std::string header = "/*" + std::string(100, '*') + "\n * generated\n" + std::string(50, ' ') + "*/";
+	std::string source = header + "\n\n   // " + std::string(70, 'x') + "\n\t" +
+						 std::string(40, 'a') + "  b\n/* ** */c";
+	Lexer lexer(source);
+
+	std::vector<TokenPtr> tokens = lexer.tokenize();
+	assertTokenLexemes(tokens, {std::string(40, 'a'), "b", "c"});
+
+	EXPECT_EQ(tokens[0]->getLocation().line, 6);
+	EXPECT_EQ(tokens[0]->getLocation().column, 2);
+	EXPECT_EQ(tokens[1]->getLocation().line, 6);
+	EXPECT_EQ(tokens[1]->getLocation().column, 44);
+	EXPECT_EQ(tokens[2]->getLocation().line, 7);
+	EXPECT_EQ(tokens[2]->getLocation().column, 9);
+
+	EXPECT_THROW(Lexer("x /*" + std::string(100, ' ') + "*").tokenize(), LexerError);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
@@ -0,0 +1,139 @@
+#include "tinyc/parser/IncrementalParser.h"
+#include "tinyc/ast/visitors/JSONVisitor.h"
+#include "tinyc/lexer/Lexer.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace tinyc;
+
+namespace {
+
+	const char *const SOURCE =
+			"int a = 1;\n"
+			"int f(int x) {\n"
+			"\treturn x * 2;\n"
+			"}\n"
+			"struct Point { int x; int y; };\n"
+			"int main() { return f(a); }\n";
+
+	std::string toJSON(const ast::ASTNode &node) {
+		ast::StringSink out;
+		ast::JSONVisitor visitor(out, false);
+		node.accept(visitor);
+		return out.str();
+	}
+
+	// JSON of the whole text parsed from scratch
+	std::string parseJSON(const std::string &source, parser::ParserOptions options = parser::ParserOptions()) {
+		lexer::Lexer lexer(source, "<edit>");
+		parser::Parser parser(lexer, options);
+		return toJSON(*parser.parseProgram());
+	}
+
+} // namespace
+
+// Test that an edit inside a declaration reparses only that declaration
+TEST(IncrementalParserTest, ReusesUnchangedDeclarations) {
+	parser::IncrementalParser document(SOURCE, "<edit>");
+	const auto &declarations = document.getProgram().getDeclarations();
+	ASSERT_EQ(declarations.size(), 4u);
+	const ast::ASTNode *first = declarations[0].get();
+	const ast::ASTNode *last = declarations[3].get();
+
+	// "x * 2" becomes "x * 20 + 1"
+	std::size_t offset = document.getSource().find("2;");
+	EXPECT_EQ(document.applyEdit(offset + 1, 0, "0 + 1"), 1u);
+	EXPECT_EQ(toJSON(document.getProgram()), parseJSON(document.getSource()));
+
+	EXPECT_EQ(document.getProgram().getDeclarations()[0].get(), first);
+	EXPECT_EQ(document.getProgram().getDeclarations()[3].get(), last);
+
+	// Splitting a declaration in two and joining them again
+	offset = document.getSource().find("struct");
+	document.applyEdit(offset, 0, "double d; ");
+	EXPECT_EQ(document.getProgram().getDeclarations().size(), 5u);
+	EXPECT_EQ(toJSON(document.getProgram()), parseJSON(document.getSource()));
+	document.applyEdit(offset, 10, "");
+	EXPECT_EQ(document.getProgram().getDeclarations().size(), 4u);
+	EXPECT_EQ(toJSON(document.getProgram()), parseJSON(document.getSource()));
+}
+
+// Test that the declarations after an edit are moved by the lines and columns it added
+TEST(IncrementalParserTest, MovesLocations) {
+	parser::IncrementalParser document("int a; int b;\nint c;\n", "<edit>");
+
+	// Longer name on the first line: b moves right, c stays
+	document.applyEdit(4, 1, "abc");
+	const auto &declarations = document.getProgram().getDeclarations();
+	EXPECT_EQ(declarations[1]->getLocation().column, 14);
+	EXPECT_EQ(declarations[2]->getLocation().line, 2);
+	EXPECT_EQ(declarations[2]->getLocation().column, 5);
+
+	// Two new lines at the top move everything down
+	EXPECT_EQ(document.applyEdit(0, 0, "\n\n"), 0u);
+	EXPECT_EQ(document.getProgram().getDeclarations()[2]->getLocation().line, 4);
+	EXPECT_EQ(toJSON(document.getProgram()), parseJSON(document.getSource()));
+}
+
+// Test that failed edits leave the document unchanged and recovery mode keeps going
+TEST(IncrementalParserTest, Errors) {
+	parser::IncrementalParser document(SOURCE, "<edit>");
+	std::string json = toJSON(document.getProgram());
+
+	EXPECT_THROW(document.applyEdit(document.getSource().size() + 1, 0, "x"), std::out_of_range);
+	EXPECT_THROW(document.applyEdit(0, 3, "int ="), parser::ParserError);
+	EXPECT_EQ(document.getSource(), SOURCE);
+	EXPECT_EQ(toJSON(document.getProgram()), json);
+
+	parser::ParserOptions options;
+	options.recover = true;
+	parser::IncrementalParser recovering(SOURCE, "<edit>", options);
+	recovering.applyEdit(recovering.getSource().find("2;"), 1, "");
+	ASSERT_EQ(recovering.getDiagnostics().size(), 1u);
+	EXPECT_EQ(recovering.getDiagnostics()[0].getLocation().line, 3);
+
+	// The error moves with its declaration, then goes away with the fix
+	recovering.applyEdit(0, 0, "\n");
+	EXPECT_EQ(recovering.getDiagnostics()[0].getLocation().line, 4);
+	recovering.applyEdit(recovering.getSource().find(";\n}"), 0, "2");
+	EXPECT_TRUE(recovering.getDiagnostics().empty());
+	EXPECT_EQ(toJSON(recovering.getProgram()), parseJSON("\n" + std::string(SOURCE)));
+}
+
+// Test random edits against parsing the edited text from scratch
+TEST(IncrementalParserTest, MatchesFullParse) {
+	const std::vector<std::string> snippets = {
+			"int ", "x", " ", "\n", ";", "{", "}", "(", ")", "=", "1", "+", ",", "/*", "*/", "//",
+			"void g() { return; }\n", "char c;", "struct S { int v; };", "while (x) { x = x - 1; }"};
+
+	parser::ParserOptions options;
+	options.recover = true;
+	options.maxErrors = 0;
+	parser::IncrementalParser document(SOURCE, "<edit>", options);
+
+	std::mt19937 random(42);
+	for (int i = 0; i < 1000; ++i) {
+		const std::string &source = document.getSource();
+		std::size_t offset = random() % (source.size() + 1);
+		std::size_t length = std::min<std::size_t>(random() % 4, source.size() - offset);
+		const std::string &text = snippets[random() % snippets.size()];
+
+		std::string edited = source.substr(0, offset) + text + source.substr(offset + length);
+		std::string expected;
+		try {
+			expected = parseJSON(edited, options);
+		} catch (const lexer::LexerError &) {
+			// Lexer errors are not recovered from: the edit is rejected
+			EXPECT_THROW(document.applyEdit(offset, length, text), lexer::LexerError);
+			continue;
+		}
+
+		SCOPED_TRACE(edited);
+		document.applyEdit(offset, length, text);
+		ASSERT_EQ(document.getSource(), edited);
+		ASSERT_EQ(toJSON(document.getProgram()), expected);
+	}
+}
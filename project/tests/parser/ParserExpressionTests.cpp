@@ -95,6 +95,14 @@ TEST(ParserExpressionTest, LiteralExpressions) {
 		EXPECT_TRUE(literal->getValue().find("3.14") != std::string::npos);
 	}
 
+	// Numeric literals keep their spelling
+	{
+		auto ast = parseExpression("2.50e-3");
+		const auto* literal = as<ast::LiteralNode>(getExpressionNode(ast));
+		ASSERT_NE(literal, nullptr);
+		EXPECT_EQ(literal->getValue(), "2.50e-3");
+	}
+
 	// Test char literal
 	{
 		auto ast = parseExpression("'a'");
@@ -481,6 +489,72 @@ TEST(ParserExpressionTest, OperatorPrecedence) {
 	}
 }
 
+/**
+ * @test OperatorAssociativity
+ * @brief Test that binary operators associate left and assignment associates right
+ */
+TEST(ParserExpressionTest, OperatorAssociativity) {
+	// Test left associativity within one level
+	{
+		auto ast = parseExpression("a - b - c");
+		const auto* binary = as<ast::BinaryExpressionNode>(getExpressionNode(ast));
+		ASSERT_NE(binary, nullptr);
+		EXPECT_EQ(binary->getOperator(), ast::BinaryExpressionNode::Operator::SUBTRACT);
+
+		const auto* left = as<ast::BinaryExpressionNode>(binary->getLeft().get());
+		ASSERT_NE(left, nullptr);
+		EXPECT_EQ(left->getOperator(), ast::BinaryExpressionNode::Operator::SUBTRACT);
+
+		const auto* right = as<ast::IdentifierNode>(binary->getRight().get());
+		ASSERT_NE(right, nullptr);
+		EXPECT_EQ(right->getIdentifier(), "c");
+	}
+
+	// Test mixed levels: a || b && c == d << e + f * g
+	{
+		auto ast = parseExpression("a || b && c == d << e + f * g");
+		const auto* orExpr = as<ast::BinaryExpressionNode>(getExpressionNode(ast));
+		ASSERT_NE(orExpr, nullptr);
+		EXPECT_EQ(orExpr->getOperator(), ast::BinaryExpressionNode::Operator::LOGICAL_OR);
+
+		const auto* andExpr = as<ast::BinaryExpressionNode>(orExpr->getRight().get());
+		ASSERT_NE(andExpr, nullptr);
+		EXPECT_EQ(andExpr->getOperator(), ast::BinaryExpressionNode::Operator::LOGICAL_AND);
+
+		const auto* equalExpr = as<ast::BinaryExpressionNode>(andExpr->getRight().get());
+		ASSERT_NE(equalExpr, nullptr);
+		EXPECT_EQ(equalExpr->getOperator(), ast::BinaryExpressionNode::Operator::EQUAL);
+
+		const auto* shiftExpr = as<ast::BinaryExpressionNode>(equalExpr->getRight().get());
+		ASSERT_NE(shiftExpr, nullptr);
+		EXPECT_EQ(shiftExpr->getOperator(), ast::BinaryExpressionNode::Operator::LEFT_SHIFT);
+
+		const auto* addExpr = as<ast::BinaryExpressionNode>(shiftExpr->getRight().get());
+		ASSERT_NE(addExpr, nullptr);
+		EXPECT_EQ(addExpr->getOperator(), ast::BinaryExpressionNode::Operator::ADD);
+
+		const auto* mulExpr = as<ast::BinaryExpressionNode>(addExpr->getRight().get());
+		ASSERT_NE(mulExpr, nullptr);
+		EXPECT_EQ(mulExpr->getOperator(), ast::BinaryExpressionNode::Operator::MULTIPLY);
+	}
+
+	// Test right associativity of assignment
+	{
+		auto ast = parseExpression("a = b = c");
+		const auto* assign = as<ast::BinaryExpressionNode>(getExpressionNode(ast));
+		ASSERT_NE(assign, nullptr);
+		EXPECT_EQ(assign->getOperator(), ast::BinaryExpressionNode::Operator::ASSIGN);
+
+		const auto* left = as<ast::IdentifierNode>(assign->getLeft().get());
+		ASSERT_NE(left, nullptr);
+		EXPECT_EQ(left->getIdentifier(), "a");
+
+		const auto* right = as<ast::BinaryExpressionNode>(assign->getRight().get());
+		ASSERT_NE(right, nullptr);
+		EXPECT_EQ(right->getOperator(), ast::BinaryExpressionNode::Operator::ASSIGN);
+	}
+}
+
 /**
  * @test MemberExpressions
  * @brief Test member access expressions
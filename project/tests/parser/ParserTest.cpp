@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 #include <sstream>
 #include <memory>
+#include <utility>
+#include <vector>
 
 using namespace tinyc;
 
@@ -231,6 +233,190 @@ TEST(ParserTest, Errors) {
 				 }, parser::ParserError);
 }
 
+// Test that nodes are allocated from the arena and outlive the lexer and parser
+TEST(ParserTest, ArenaAllocation) {
+	auto contextHandle = std::make_shared<ast::ASTContext>();
+	ast::ASTNodePtr ast;
+	{
+		lexer::Lexer lexer("int f(int a) { return a + 1; }");
+		parser::Parser parser(lexer, contextHandle);
+		ast = parser.parseProgram();
+	}
+
+	auto* program = as<ast::ProgramNode>(ast);
+	ASSERT_NE(program, nullptr);
+	EXPECT_FALSE(program->isArenaAllocated());
+
+	ASSERT_EQ(program->getDeclarations().size(), 1);
+	auto* function = as<ast::FunctionDeclarationNode>(program->getDeclarations()[0]);
+	ASSERT_NE(function, nullptr);
+	EXPECT_TRUE(function->isArenaAllocated());
+	EXPECT_EQ(function->getIdentifier(), "f");
+	EXPECT_EQ(function->getParameters().get_allocator().resource(), contextHandle->getResource());
+
+	// The program keeps the context alive on its own
+	std::weak_ptr<ast::ASTContext> weakContext = contextHandle;
+	contextHandle.reset();
+	EXPECT_FALSE(weakContext.expired());
+	ast.reset();
+	EXPECT_TRUE(weakContext.expired());
+}
+
+// Test that long comma-separated lists are parsed without growing the stack per element
+TEST(ParserTest, LongLists) {
+	const int count = 100000;
+	std::string params = "int p0";
+	std::string args = "0";
+	for (int i = 1; i < count; ++i) {
+		params += ", int p" + std::to_string(i);
+		args += ", " + std::to_string(i);
+	}
+
+	auto ast = parseString("void f(" + params + ");\nvoid g() { f(" + args + "); }");
+	auto* program = as<ast::ProgramNode>(ast);
+	ASSERT_NE(program, nullptr);
+	ASSERT_EQ(program->getDeclarations().size(), 2);
+
+	auto* f = as<ast::FunctionDeclarationNode>(program->getDeclarations()[0]);
+	ASSERT_NE(f, nullptr);
+	EXPECT_EQ(f->getParameters().size(), static_cast<size_t>(count));
+}
+
+// Test that deeply nested constructs are rejected instead of overflowing the stack
+TEST(ParserTest, NestingDepthLimit) {
+	auto parseNested = [](const std::string &open, const std::string &close, int depth,
+						  parser::ParserOptions options) {
+		std::string source = "void f() { ";
+		for (int i = 0; i < depth; ++i) source += open;
+		source += "x";
+		for (int i = 0; i < depth; ++i) source += close;
+		source += "; }";
+		lexer::Lexer lexer(source);
+		parser::Parser parser(lexer, options);
+		return parser.parseProgram();
+	};
+
+	parser::ParserOptions options;
+	options.maxNestingDepth = 64;
+	EXPECT_NO_THROW(parseNested("(", ")", 32, options));
+	EXPECT_THROW(parseNested("(", ")", 64, options), parser::ParserError);
+	EXPECT_THROW(parseNested("{ ", " }", 64, options), parser::ParserError);
+	EXPECT_THROW(parseNested("- ", "", 64, options), parser::ParserError);
+
+	// The default limit is far below what would exhaust the stack
+	EXPECT_THROW(parseNested("(", ")", 100000, parser::ParserOptions{}), parser::ParserError);
+
+	try {
+		parseNested("(", ")", 64, options);
+		FAIL() << "Expected ParserError";
+	} catch (const parser::ParserError &e) {
+		EXPECT_NE(std::string(e.what()).find("Maximum nesting depth of 64 exceeded"), std::string::npos);
+	}
+}
+
+// Parse in recovery mode, returning the AST and the recorded errors
+std::pair<ast::ASTNodePtr, std::vector<parser::ParserError>> parseRecovering(const std::string &source,
+																			   std::size_t maxErrors = 0) {
+	parser::ParserOptions options;
+	options.recover = true;
+	options.maxErrors = maxErrors;
+	lexer::Lexer lexer(source);
+	parser::Parser parser(lexer, options);
+	auto ast = parser.parseProgram();
+	return {std::move(ast), parser.getDiagnostics()};
+}
+
+// Test that a recovering parse reports every error and keeps the rest of the program
+TEST(ParserTest, ErrorRecovery) {
+	auto [ast, errors] = parseRecovering(
+			"int a = ;\n"
+			"int f(int x) { x = 1 +; if (x) { y = ; } return x; }\n"
+			"int g() { return 2 }\n"
+			"double d = 1.5;\n");
+
+	ASSERT_EQ(errors.size(), 4u);
+	EXPECT_EQ(errors[0].getLocation().line, 1);
+	EXPECT_EQ(errors[1].getMessage(), "Expected expression");
+	EXPECT_EQ(errors[3].getMessage(), "Expected ';' after return statement");
+	EXPECT_EQ(errors[3].getLocation().line, 3);
+
+	auto* program = as<ast::ProgramNode>(ast);
+	ASSERT_NE(program, nullptr);
+	const auto &declarations = program->getDeclarations();
+	ASSERT_EQ(declarations.size(), 4u);
+
+	// The failed declaration is replaced by an error node
+	auto* error = as<ast::ErrorNode>(declarations[0]);
+	ASSERT_NE(error, nullptr);
+	EXPECT_EQ(error->getMessage(), "Expected expression");
+	EXPECT_EQ(error->getNodeKind(), ast::NodeKind::ERROR_NODE);
+
+	// Statements after an error in the same block are kept
+	auto* f = as<ast::FunctionDeclarationNode>(declarations[1]);
+	ASSERT_NE(f, nullptr);
+	const auto &statements = as<ast::BlockStatementNode>(f->getBody())->getStatements();
+	ASSERT_EQ(statements.size(), 3u);
+	EXPECT_NE(as<ast::ErrorNode>(statements[0]), nullptr);
+	auto* ifStmt = as<ast::IfStatementNode>(statements[1]);
+	ASSERT_NE(ifStmt, nullptr);
+	EXPECT_NE(as<ast::ErrorNode>(as<ast::BlockStatementNode>(ifStmt->getThenBranch())->getStatements()[0]), nullptr);
+	EXPECT_NE(as<ast::ReturnStatementNode>(statements[2]), nullptr);
+
+	EXPECT_NE(as<ast::FunctionDeclarationNode>(declarations[2]), nullptr);
+	EXPECT_NE(as<ast::VariableNode>(declarations[3]), nullptr);
+
+	// Without recovery the first error is thrown
+	EXPECT_THROW(parseString("int a = ;\nint b;"), parser::ParserError);
+}
+
+// Test the error limit and errors at the end of the input
+TEST(ParserTest, ErrorLimit) {
+	std::string source;
+	for (int i = 0; i < 10; ++i) {
+		source += "int f" + std::to_string(i) + "() { x = ; }\n";
+	}
+
+	auto [ast, errors] = parseRecovering(source, 3);
+	ASSERT_EQ(errors.size(), 4u);
+	EXPECT_NE(errors[3].getMessage().find("Too many errors (limit 3)"), std::string::npos);
+	EXPECT_EQ(errors[3].getLocation().line, 4);
+	// The declarations before the one that hit the limit are returned
+	EXPECT_EQ(as<ast::ProgramNode>(ast)->getDeclarations().size(), 3u);
+
+	EXPECT_EQ(parseRecovering(source, 0).second.size(), 10u);
+
+	// A block left open at EOF is one error, not one per nesting level
+	auto [unclosed, unclosedErrors] = parseRecovering("void f() { while (1) { if (x) { y = 1;");
+	ASSERT_EQ(unclosedErrors.size(), 1u);
+	EXPECT_EQ(unclosedErrors[0].getMessage(), "Expected '}'");
+	EXPECT_NE(as<ast::ErrorNode>(as<ast::ProgramNode>(unclosed)->getDeclarations()[0]), nullptr);
+}
+
+// Test that recovery always terminates and stays linear in the input
+TEST(ParserTest, RecoveryMakesProgress) {
+	const char *garbage[] = {
+			"}", "} } ;", "case 1: ;", "int", "int f(", "int f() { case 1: x; }", "struct { } }",
+			"; ; int x; )", "void f() { default: } int y;", "{ { { ", "int f() { } } } int g;"};
+	for (const char *source: garbage) {
+		SCOPED_TRACE(source);
+		auto [ast, errors] = parseRecovering(source);
+		EXPECT_FALSE(errors.empty());
+		EXPECT_NE(as<ast::ProgramNode>(ast), nullptr);
+	}
+
+	// Many errors, and a nesting overflow whose rest is skipped in one pass
+	std::string source;
+	const int count = 5000;
+	for (int i = 0; i < count; ++i) {
+		source += "int f() { x = ; y + ; } int g() { ) }\n";
+	}
+	source += "void h() " + std::string(100000, '{') + std::string(100000, '}') + "\nint last;";
+	auto [ast, errors] = parseRecovering(source);
+	EXPECT_EQ(errors.size(), static_cast<std::size_t>(3 * count + 1));
+	const auto &declarations = as<ast::ProgramNode>(ast)->getDeclarations();
+	EXPECT_NE(as<ast::VariableNode>(declarations.back()), nullptr);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();